@@ -0,0 +1,194 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+//
+// This driver constructs the 2D Laplace operator, searches for the
+// BoomerAMG parameters that solve it fastest with PCG, and then solves
+// the system again with the parameters it found.
+//
+#include "Tpetra_Map.hpp"
+#include "Tpetra_CrsMatrix.hpp"
+#include "Tpetra_DefaultPlatform.hpp"
+
+#include "Ifpack2_Hypre.hpp"
+#include "Ifpack2_HypreTuner.hpp"
+
+#include "Teuchos_CommandLineProcessor.hpp"
+#include "Teuchos_ParameterList.hpp"
+#include "Teuchos_StandardCatchMacros.hpp"
+
+int main(int argc, char *argv[]) {
+  using Teuchos::Array;
+  using Teuchos::RCP;
+  using Teuchos::rcp;
+  using Teuchos::ParameterList;
+
+  //
+  // Specify types used in this example
+  //
+  typedef Tpetra::CrsMatrix<>::scalar_type Scalar;
+  typedef Tpetra::CrsMatrix<>::local_ordinal_type LO;
+  typedef Tpetra::CrsMatrix<>::global_ordinal_type GO;
+  typedef Tpetra::CrsMatrix<>::node_type Node;
+  typedef Tpetra::DefaultPlatform::DefaultPlatformType Platform;
+  typedef Tpetra::CrsMatrix<Scalar> CrsMatrix;
+  typedef Tpetra::MultiVector<Scalar> MV;
+  typedef Tpetra::Map<> Map;
+
+  //
+  // Initialize the MPI session
+  //
+  Teuchos::oblackholestream blackhole;
+  Teuchos::GlobalMPISession mpiSession(&argc,&argv,&blackhole);
+
+  //
+  // Get the default communicator
+  //
+  Platform &platform = Tpetra::DefaultPlatform::getDefaultPlatform();
+  RCP<const Teuchos::Comm<int> > comm = platform.getComm();
+
+  //
+  // Get parameters from command-line processor
+  //
+  int nx = 50;
+  Scalar tol = 1e-8;
+  double budget = 30.0;
+  Teuchos::CommandLineProcessor cmdp(false,true);
+  cmdp.setOption("nx",&nx, "Number of mesh points in x direction.");
+  cmdp.setOption("tolerance",&tol, "Relative residual used for solver.");
+  cmdp.setOption("budget",&budget, "Number of seconds after which the tuner stops trying new parameters.");
+  if(cmdp.parse(argc,argv) != Teuchos::CommandLineProcessor::PARSE_SUCCESSFUL) {
+    return -1;
+  }
+
+  //
+  // Create the row map
+  //
+  int n = nx*nx;
+  RCP<Map> map = rcp(new Map(n,0,comm));
+
+  //
+  // Create the 2D Laplace operator
+  //
+  RCP<CrsMatrix> A = rcp(new CrsMatrix(map,5));
+  for(LO i = 0; i<nx; i++) {
+    for(LO j = 0; j<nx; j++) {
+      GO row = i*nx+j;
+      if(!map->isNodeGlobalElement(row))
+        continue;
+
+      Array<LO> indices;
+      Array<Scalar> values;
+
+      if(i > 0) {
+        indices.push_back(row - nx);
+        values.push_back(-1.0);
+      }
+      if(i < nx-1) {
+        indices.push_back(row + nx);
+        values.push_back(-1.0);
+      }
+      indices.push_back(row);
+      values.push_back(4.0);
+      if(j > 0) {
+        indices.push_back(row-1);
+        values.push_back(-1.0);
+      }
+      if(j < nx-1) {
+        indices.push_back(row+1);
+        values.push_back(-1.0);
+      }
+      A->insertGlobalValues(row,indices,values);
+    }
+  }
+  A->fillComplete();
+
+  //
+  // Search the BoomerAMG parameters
+  //
+  ParameterList tunerList;
+  tunerList.set("Solver", Ifpack2::Hypre::PCG);
+  tunerList.set("Tolerance", (double)tol);
+  tunerList.set("Maximum Iterations", 1000);
+  tunerList.set("Time Budget", budget);
+  Ifpack2::Ifpack2_HypreTuner<Scalar,LO,GO,Node> tuner(A);
+  tuner.setParameters(tunerList);
+  tuner.tune();
+  tuner.Print(std::cout);
+
+  RCP<const ParameterList> bestList = tuner.getBestParameters();
+  if(comm->getRank() == 0) {
+    std::cout << "Best parameters:" << std::endl;
+    bestList->print(std::cout, 2);
+  }
+
+  //
+  // Solve a new system with the best parameters
+  //
+  RCP<MV> trueX = rcp(new MV(A->getRowMap(),1,false));
+  RCP<MV> X = rcp(new MV(A->getRowMap(),1));
+  RCP<MV> B = rcp(new MV(A->getRowMap(),1,false));
+  trueX->randomize();
+  A->apply(*trueX,*B);
+
+  // The list holds the solver, its tolerance and the tuned BoomerAMG values
+  Ifpack2::Ifpack2_Hypre<Scalar,LO,GO,Node> prec(A);
+  prec.setParameters(*bestList);
+  prec.initialize();
+  prec.compute();
+  prec.apply(*B,*X);
+
+  //
+  // Check the residual
+  //
+  MV R(*B,Teuchos::Copy);
+  A->apply(*X,R,Teuchos::NO_TRANS,-1,1);
+  std::vector<Scalar> normR(1), normB(1);
+  R.norm2(normR);
+  B->norm2(normB);
+  if(comm->getRank() == 0) std::cout << "Relative residual: " << normR[0] / normB[0] << std::endl;
+  if(normR[0] / normB[0] > tol)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
@@ -51,15 +51,23 @@
 #include "HYPRE_parcsr_ls.h"
 #include "krylov.h"
 #include "_hypre_parcsr_mv.h"
+#include "_hypre_parcsr_ls.h"
 #include "_hypre_IJ_mv.h"
 #include "HYPRE_parcsr_mv.h"
 #include "HYPRE.h"
 
 #include "Ifpack2_Preconditioner.hpp"
+#include "Tpetra_LocalRowsCopy.hpp"
 #include "Ifpack2_Condest.hpp"
 
+#include "Teuchos_CommHelpers.hpp"
 #include "Teuchos_RCP.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
 namespace Ifpack2 {
 
 #ifndef HYPRE_ENUMS
@@ -87,6 +95,167 @@ enum Hypre_Chooser{
 } // namespace Hypre
 #endif //HYPRE_ENUMS
 
+namespace Hypre {
+//! The hypre functions that create, destroy, set up and apply one kind of solver or preconditioner.
+struct SolverStrategy{
+  //! Which solver the functions belong to
+  Hypre_Solver type;
+  //! Whether the solver may be chosen with SolveOrPrecondition set to Solver
+  bool isSolver;
+  //! Whether the solver may be used as a preconditioner
+  bool isPreconditioner;
+  //! Whether a solver object that has been set up may be set up again with a new matrix
+  bool canResetup;
+  int (*create)(MPI_Comm, HYPRE_Solver*);
+  int (*destroy)(HYPRE_Solver);
+  int (*setup)(HYPRE_Solver, HYPRE_ParCSRMatrix, HYPRE_ParVector, HYPRE_ParVector);
+  int (*solve)(HYPRE_Solver, HYPRE_ParCSRMatrix, HYPRE_ParVector, HYPRE_ParVector);
+  //! NULL if the solver does not take a preconditioner
+  int (*setPrecond)(HYPRE_Solver, HYPRE_PtrToParSolverFcn, HYPRE_PtrToParSolverFcn, HYPRE_Solver);
+  //! NULL if the solver does not report an iteration count
+  int (*getNumIterations)(HYPRE_Solver, int*);
+  //! NULL if the solver does not report a residual
+  int (*getFinalResidual)(HYPRE_Solver, HYPRE_Real*);
+  //! NULL if the solver has no convergence tolerance
+  int (*setTol)(HYPRE_Solver, HYPRE_Real);
+  //! NULL if the solver has no iteration limit
+  int (*setMaxIter)(HYPRE_Solver, int);
+};
+
+// Some hypre constructors do not take a communicator; these give them all the same signature.
+inline int BoomerAMGCreate(MPI_Comm comm, HYPRE_Solver *solver){ return HYPRE_BoomerAMGCreate(solver);}
+inline int AMSCreate(MPI_Comm comm, HYPRE_Solver *solver){ return HYPRE_AMSCreate(solver);}
+inline int ParCSRHybridCreate(MPI_Comm comm, HYPRE_Solver *solver){ return HYPRE_ParCSRHybridCreate(solver);}
+
+// PCG stops on the preconditioned residual by default; a Solver Tolerance means the 2-norm of the
+// residual, as for the other Krylov solvers.
+inline int ParCSRPCGSetTolTwoNorm(HYPRE_Solver solver, HYPRE_Real tol){
+  HYPRE_ParCSRPCGSetTwoNorm(solver, 1);
+  return HYPRE_ParCSRPCGSetTol(solver, tol);
+}
+
+//! Returns the functions of the given solver, or NULL if it is not a known Hypre_Solver.
+inline const SolverStrategy* GetSolverStrategy(Hypre_Solver type){
+  // Indexed by Hypre_Solver.  Euclid is not documented to support a second setup on the same object,
+  // so it is always recreated.
+  static const SolverStrategy table[] = {
+    {BoomerAMG, true,  true,  true,  &BoomerAMGCreate,             &HYPRE_BoomerAMGDestroy,        &HYPRE_BoomerAMGSetup,
+     &HYPRE_BoomerAMGSolve,        NULL,                           &HYPRE_BoomerAMGGetNumIterations,
+     &HYPRE_BoomerAMGGetFinalRelativeResidualNorm, &HYPRE_BoomerAMGSetTol,       &HYPRE_BoomerAMGSetMaxIter},
+    {ParaSails, false, true,  true,  &HYPRE_ParaSailsCreate,       &HYPRE_ParaSailsDestroy,        &HYPRE_ParaSailsSetup,
+     &HYPRE_ParaSailsSolve,        NULL,                           NULL,
+     NULL,                                          NULL,                         NULL},
+    {Euclid,    false, true,  false, &HYPRE_EuclidCreate,          &HYPRE_EuclidDestroy,           &HYPRE_EuclidSetup,
+     &HYPRE_EuclidSolve,           NULL,                           NULL,
+     NULL,                                          NULL,                         NULL},
+    {AMS,       true,  true,  true,  &AMSCreate,                   &HYPRE_AMSDestroy,              &HYPRE_AMSSetup,
+     &HYPRE_AMSSolve,              NULL,                           &HYPRE_AMSGetNumIterations,
+     &HYPRE_AMSGetFinalRelativeResidualNorm,       &HYPRE_AMSSetTol,             &HYPRE_AMSSetMaxIter},
+    {Hybrid,    true,  false, true,  &ParCSRHybridCreate,          &HYPRE_ParCSRHybridDestroy,     &HYPRE_ParCSRHybridSetup,
+     &HYPRE_ParCSRHybridSolve,     &HYPRE_ParCSRHybridSetPrecond,  &HYPRE_ParCSRHybridGetNumIterations,
+     &HYPRE_ParCSRHybridGetFinalRelativeResidualNorm, &HYPRE_ParCSRHybridSetTol,  &HYPRE_ParCSRHybridSetPCGMaxIter},
+    {PCG,       true,  false, true,  &HYPRE_ParCSRPCGCreate,       &HYPRE_ParCSRPCGDestroy,        &HYPRE_ParCSRPCGSetup,
+     &HYPRE_ParCSRPCGSolve,        &HYPRE_ParCSRPCGSetPrecond,     &HYPRE_ParCSRPCGGetNumIterations,
+     &HYPRE_ParCSRPCGGetFinalRelativeResidualNorm, &ParCSRPCGSetTolTwoNorm,       &HYPRE_ParCSRPCGSetMaxIter},
+    {GMRES,     true,  false, true,  &HYPRE_ParCSRGMRESCreate,     &HYPRE_ParCSRGMRESDestroy,      &HYPRE_ParCSRGMRESSetup,
+     &HYPRE_ParCSRGMRESSolve,      &HYPRE_ParCSRGMRESSetPrecond,   &HYPRE_ParCSRGMRESGetNumIterations,
+     &HYPRE_ParCSRGMRESGetFinalRelativeResidualNorm, &HYPRE_ParCSRGMRESSetTol,   &HYPRE_ParCSRGMRESSetMaxIter},
+    {FlexGMRES, true,  false, true,  &HYPRE_ParCSRFlexGMRESCreate, &HYPRE_ParCSRFlexGMRESDestroy,  &HYPRE_ParCSRFlexGMRESSetup,
+     &HYPRE_ParCSRFlexGMRESSolve,  &HYPRE_ParCSRFlexGMRESSetPrecond, &HYPRE_ParCSRFlexGMRESGetNumIterations,
+     &HYPRE_ParCSRFlexGMRESGetFinalRelativeResidualNorm, &HYPRE_ParCSRFlexGMRESSetTol, &HYPRE_ParCSRFlexGMRESSetMaxIter},
+    {LGMRES,    true,  false, true,  &HYPRE_ParCSRLGMRESCreate,    &HYPRE_ParCSRLGMRESDestroy,     &HYPRE_ParCSRLGMRESSetup,
+     &HYPRE_ParCSRLGMRESSolve,     &HYPRE_ParCSRLGMRESSetPrecond,  &HYPRE_ParCSRLGMRESGetNumIterations,
+     &HYPRE_ParCSRLGMRESGetFinalRelativeResidualNorm, &HYPRE_ParCSRLGMRESSetTol, &HYPRE_ParCSRLGMRESSetMaxIter},
+    {BiCGSTAB,  true,  false, true,  &HYPRE_ParCSRBiCGSTABCreate,  &HYPRE_ParCSRBiCGSTABDestroy,   &HYPRE_ParCSRBiCGSTABSetup,
+     &HYPRE_ParCSRBiCGSTABSolve,   &HYPRE_ParCSRBiCGSTABSetPrecond, &HYPRE_ParCSRBiCGSTABGetNumIterations,
+     &HYPRE_ParCSRBiCGSTABGetFinalRelativeResidualNorm, &HYPRE_ParCSRBiCGSTABSetTol, &HYPRE_ParCSRBiCGSTABSetMaxIter}
+  };
+  const int numStrategies = sizeof(table) / sizeof(table[0]);
+  if(type < 0 || type >= numStrategies || table[type].type != type){
+    return NULL;
+  }
+  return &table[type];
+}
+
+//! Moves the values of a Tpetra vector in and out of a hypre vector around a solve.
+/*! When Scalar is the precision hypre was built with, the hypre vector is pointed at the Tpetra data.
+    Otherwise, e.g. for a single precision hypre inside a double precision solve, the input is converted
+    into the hypre vector's own storage and the result converted back, each in one pass over the data.
+*/
+template<class Scalar, bool samePrecision = std::is_same<Scalar, HYPRE_Complex>::value>
+struct VectorData{
+  //! Make v hold the values of x; returns what finishInput() needs to restore v.
+  static HYPRE_Complex* setInput(hypre_Vector* v, const Scalar* x, size_t n){
+    HYPRE_Complex* saved = hypre_VectorData(v);
+    hypre_VectorData(v) = const_cast<HYPRE_Complex*>(x);
+    return saved;
+  }
+  //! Make the values v receives end up in y; returns what finishOutput() needs to restore v.
+  static HYPRE_Complex* setOutput(hypre_Vector* v, Scalar* y){
+    HYPRE_Complex* saved = hypre_VectorData(v);
+    hypre_VectorData(v) = y;
+    return saved;
+  }
+  static void finishInput(hypre_Vector* v, HYPRE_Complex* saved){ hypre_VectorData(v) = saved;}
+  static void finishOutput(hypre_Vector* v, HYPRE_Complex* saved, Scalar* y, size_t n){ hypre_VectorData(v) = saved;}
+};
+
+template<class Scalar>
+struct VectorData<Scalar, false>{
+  static HYPRE_Complex* setInput(hypre_Vector* v, const Scalar* x, size_t n){
+    HYPRE_Complex* data = hypre_VectorData(v);
+    for(size_t i = 0; i < n; i++) data[i] = static_cast<HYPRE_Complex>(x[i]);
+    return data;
+  }
+  static HYPRE_Complex* setOutput(hypre_Vector* v, Scalar* y){ return hypre_VectorData(v);}
+  static void finishInput(hypre_Vector* v, HYPRE_Complex* saved){}
+  static void finishOutput(hypre_Vector* v, HYPRE_Complex* saved, Scalar* y, size_t n){
+    const HYPRE_Complex* data = hypre_VectorData(v);
+    for(size_t i = 0; i < n; i++) y[i] = static_cast<Scalar>(data[i]);
+  }
+};
+
+//! Matrix values in hypre's precision; no copy is made when they already are.
+inline const HYPRE_Complex* ToHypreValues(const Teuchos::Array<HYPRE_Complex>& values, Teuchos::Array<HYPRE_Complex>& buffer){
+  return values.getRawPtr();
+}
+
+template<class Scalar>
+const HYPRE_Complex* ToHypreValues(const Teuchos::Array<Scalar>& values, Teuchos::Array<HYPRE_Complex>& buffer){
+  buffer.assign(values.begin(), values.end());
+  return buffer.getRawPtr();
+}
+
+//! The n values at x in hypre's precision; no copy is made when they already are.
+inline const HYPRE_Complex* ToHypreValues(const HYPRE_Complex* x, size_t n, Teuchos::Array<HYPRE_Complex>& buffer){
+  return x;
+}
+
+template<class Scalar>
+const HYPRE_Complex* ToHypreValues(const Scalar* x, size_t n, Teuchos::Array<HYPRE_Complex>& buffer){
+  buffer.assign(x, x + n);
+  return buffer.getRawPtr();
+}
+
+//! Where hypre should write the n values meant for y; FromHypreValues() moves them to y if that is not y itself.
+inline HYPRE_Complex* HypreOutputValues(HYPRE_Complex* y, size_t n, Teuchos::Array<HYPRE_Complex>& buffer){
+  return y;
+}
+
+template<class Scalar>
+HYPRE_Complex* HypreOutputValues(Scalar* y, size_t n, Teuchos::Array<HYPRE_Complex>& buffer){
+  buffer.resize(n);
+  return buffer.getRawPtr();
+}
+
+inline void FromHypreValues(const HYPRE_Complex* values, HYPRE_Complex* y, size_t n){}
+
+template<class Scalar>
+void FromHypreValues(const HYPRE_Complex* values, Scalar* y, size_t n){
+  for(size_t i = 0; i < n; i++) y[i] = static_cast<Scalar>(values[i]);
+}
+} // namespace Hypre
+
 //! This class is used to help with passing parameters in the SetParameter() function. Use this class to call Hypre's internal parameters.
 class FunctionParameter{
   public:
@@ -98,14 +267,14 @@ class FunctionParameter{
       int_param1_(param1) {}
 
     //! Single double constructor.
-    FunctionParameter(Hypre::Hypre_Chooser chooser, int (*funct_name)(HYPRE_Solver, double), double param1):
+    FunctionParameter(Hypre::Hypre_Chooser chooser, int (*funct_name)(HYPRE_Solver, HYPRE_Real), HYPRE_Real param1):
       chooser_(chooser),
       option_(1),
       double_func_(funct_name),
       double_param1_(param1) {}
 
     //! Single double, single int constructor.
-    FunctionParameter(Hypre::Hypre_Chooser chooser, int (*funct_name)(HYPRE_Solver, double, int), double param1, int param2):
+    FunctionParameter(Hypre::Hypre_Chooser chooser, int (*funct_name)(HYPRE_Solver, HYPRE_Real, int), HYPRE_Real param1, int param2):
       chooser_(chooser),
       option_(2),
       double_int_func_(funct_name),
@@ -128,13 +297,16 @@ class FunctionParameter{
       int_star_param_(param1) {}
 
     //! Double pointer constructor.
-    FunctionParameter(Hypre::Hypre_Chooser chooser, int (*funct_name)(HYPRE_Solver, double*), double* param1):
+    FunctionParameter(Hypre::Hypre_Chooser chooser, int (*funct_name)(HYPRE_Solver, HYPRE_Real*), HYPRE_Real* param1):
       chooser_(chooser),
       option_(5),
       double_star_func_(funct_name),
       double_star_param_(param1) {}
 
-    //! Only method of this class. Calls the function pointer with the passed in HYPRE_Solver
+    //! Returns whether the function is called on the solver or on the preconditioner.
+    Hypre::Hypre_Chooser getChooser() const { return chooser_; }
+
+    //! Calls the function pointer with the passed in HYPRE_Solver
     int CallFunction(HYPRE_Solver solver, HYPRE_Solver precond){
       if(chooser_ == Hypre::Solver){
         if(option_ == 0){
@@ -171,16 +343,88 @@ class FunctionParameter{
     Hypre::Hypre_Chooser chooser_;
     int option_;
     int (*int_func_)(HYPRE_Solver, int);
-    int (*double_func_)(HYPRE_Solver, double);
-    int (*double_int_func_)(HYPRE_Solver, double, int);
+    int (*double_func_)(HYPRE_Solver, HYPRE_Real);
+    int (*double_int_func_)(HYPRE_Solver, HYPRE_Real, int);
     int (*int_int_func_)(HYPRE_Solver, int, int);
     int (*int_star_func_)(HYPRE_Solver, int*);
-    int (*double_star_func_)(HYPRE_Solver, double*);
+    int (*double_star_func_)(HYPRE_Solver, HYPRE_Real*);
     int int_param1_;
     int int_param2_;
-    double double_param1_;
+    HYPRE_Real double_param1_;
     int *int_star_param_;
-    double *double_star_param_;
+    HYPRE_Real *double_star_param_;
+};
+
+//! This class records the wall-clock time of individual calls to initialize(), compute() or apply().
+/*! Besides the number of calls and their total, minimum, maximum and average time, it keeps a histogram
+    of the call latencies with one bin per decade.  Bin 0 holds calls faster than a microsecond, bin i
+    (0 < i < NumBins-1) holds calls in [10^(i-7), 10^(i-6)) seconds and the last bin holds everything slower.
+*/
+class CallTimeStatistics{
+  public:
+    //! Number of bins in the latency histogram.
+    static const int NumBins = 10;
+
+    //! Constructor.
+    CallTimeStatistics(){ reset(); }
+
+    //! Forget all recorded calls.
+    void reset(){
+      numCalls_ = 0;
+      totalTime_ = 0.0;
+      minTime_ = 0.0;
+      maxTime_ = 0.0;
+      lastTime_ = 0.0;
+      std::fill(bins_, bins_+NumBins, 0);
+    }
+
+    //! Record a call that took the given number of seconds.
+    void addCall(double seconds){
+      if(numCalls_ == 0 || seconds < minTime_) minTime_ = seconds;
+      if(numCalls_ == 0 || seconds > maxTime_) maxTime_ = seconds;
+      numCalls_++;
+      totalTime_ += seconds;
+      lastTime_ = seconds;
+      bins_[getBin(seconds)]++;
+    }
+
+    //! Returns the number of recorded calls.
+    int getNumCalls() const{ return numCalls_;}
+
+    //! Returns the time spent in all recorded calls.
+    double getTotalTime() const{ return totalTime_;}
+
+    //! Returns the time of the fastest call, or 0.0 if there were none.
+    double getMinTime() const{ return minTime_;}
+
+    //! Returns the time of the slowest call, or 0.0 if there were none.
+    double getMaxTime() const{ return maxTime_;}
+
+    //! Returns the average time per call, or 0.0 if there were none.
+    double getAvgTime() const{ return (numCalls_ > 0 ? totalTime_ / numCalls_ : 0.0);}
+
+    //! Returns the time of the most recent call, or 0.0 if there were none.
+    double getLastTime() const{ return lastTime_;}
+
+    //! Returns the number of calls that fell in the given histogram bin.
+    int getBinCount(int bin) const{ return bins_[bin];}
+
+    //! Returns the smallest latency (in seconds) counted in the given histogram bin.
+    static double getBinLowerBound(int bin){ return (bin == 0 ? 0.0 : std::pow(10.0, bin-7));}
+
+  private:
+    static int getBin(double seconds){
+      int bin = 0;
+      while(bin < NumBins-1 && seconds >= getBinLowerBound(bin+1)) bin++;
+      return bin;
+    }
+
+    int numCalls_;
+    double totalTime_;
+    double minTime_;
+    double maxTime_;
+    double lastTime_;
+    int bins_[NumBins];
 };
 
 //! Ifpack2_Hypre: A class for constructing and using an ILU factorization of a given Tpetra::RowMatrix, using the Hypre library by Lawrence Livermore National Laboratories.
@@ -263,6 +507,15 @@ public:
      functs[1] = rcp(new FunctionParameter(Solver, &HYPRE_PCGSetTol, 1e-7)); // conv. tolerance
      list.set("NumFunctions", 2);
      list.set<RCP<FunctionParameter>*>("Functions", functs);
+
+     The most common BoomerAMG settings may instead be given as plain values in a sublist named BoomerAMG.
+     They are applied to BoomerAMG whether it is the solver or the preconditioner, after the Functions.
+     The recognized entries are Coarsen Type (int), Interp Type (int), Strong Threshold (double),
+     Relax Type (int), Aggressive Levels (int), Max Iterations (int), Tolerance (double) and Print Level (int).
+     The tolerance and iteration limit of the solver may likewise be given as Solver Tolerance (double) and
+     Solver Maximum Iterations (int); they are applied after the Functions and before the BoomerAMG sublist.
+     Unlike Functions, such a list can be stored and reused, which is what Ifpack2_HypreTuner produces.
+
      NOTE: SetParameters() must be called to use ApplyInverse(), the solvers will not be created otherwise. An empty list is acceptable to use defaults.
   */
   void setParameters(const Teuchos::ParameterList& parameterlist);
@@ -287,7 +540,7 @@ public:
 
     \return Integer error code, set to 0 if successful.
    */
-    int SetParameter(Hypre::Hypre_Chooser chooser, int (*pt2Func)(HYPRE_Solver, double), double parameter);
+    int SetParameter(Hypre::Hypre_Chooser chooser, int (*pt2Func)(HYPRE_Solver, HYPRE_Real), HYPRE_Real parameter);
 
     //! Set a parameter that takes a double then an int.
     /*!
@@ -299,7 +552,7 @@ public:
 
     \return Integer error code, set to 0 if successful.
    */
-    int SetParameter(Hypre::Hypre_Chooser chooser, int (*pt2Func)(HYPRE_Solver, double, int), double parameter1, int parameter2);
+    int SetParameter(Hypre::Hypre_Chooser chooser, int (*pt2Func)(HYPRE_Solver, HYPRE_Real, int), HYPRE_Real parameter1, int parameter2);
 
     //! Set a parameter that takes two int parameters.
     /*!
@@ -322,7 +575,7 @@ public:
 
     \return Integer error code, set to 0 if successful.
    */
-    int SetParameter(Hypre::Hypre_Chooser chooser, int (*pt2Func)(HYPRE_Solver, double*), double* parameter);
+    int SetParameter(Hypre::Hypre_Chooser chooser, int (*pt2Func)(HYPRE_Solver, HYPRE_Real*), HYPRE_Real* parameter);
 
     //! Set a parameter that takes an int*.
     /*!
@@ -356,7 +609,12 @@ public:
     \return Integer error code, set to 0 if successful.
   */
 
-    int SetParameter(bool UsePreconditioner){ UsePreconditioner_ = UsePreconditioner; return 0;}
+    int SetParameter(bool UsePreconditioner){
+      // A solver that already holds a preconditioner has to be recreated to drop it
+      if(UsePreconditioner_ != UsePreconditioner) RecreateSolvers_ = true;
+      UsePreconditioner_ = UsePreconditioner;
+      return 0;
+    }
 
     //! Choose to solve the problem or apply the preconditioner.
     /*!
@@ -487,6 +745,41 @@ public:
   //! Returns the number of flops in the apply inverse phase.
   virtual double ApplyInverseFlops() const{ return(ApplyInverseFlops_);}
 
+  //! Returns the per-call timings of initialize().
+  const CallTimeStatistics& getInitializeTimeStatistics() const{ return(initializeStats_);}
+
+  //! Returns the per-call timings of compute().
+  const CallTimeStatistics& getComputeTimeStatistics() const{ return(computeStats_);}
+
+  //! Returns the per-call timings of apply().
+  const CallTimeStatistics& getApplyTimeStatistics() const{ return(applyStats_);}
+
+  //! Returns the number of iterations (cycles, for a preconditioner) of the most recent apply(), maximized over the vectors of X.
+  int getNumIterations() const{ return(NumIterations_);}
+
+  //! Returns the final relative residual norm of the most recent apply(), maximized over the vectors of X, or -1.0 if hypre does not provide one.
+  double getFinalRelativeResidualNorm() const{ return(FinalRelResidualNorm_);}
+
+  //! Returns the number of levels in the BoomerAMG hierarchy built by compute(), or 0 if BoomerAMG is not used.
+  int getNumLevels() const{ return(LevelRows_.size());}
+
+  //! Returns the operator complexity of the BoomerAMG hierarchy, or 0.0 if BoomerAMG is not used.
+  double getOperatorComplexity() const{ return(OperatorComplexity_);}
+
+  //! Returns the grid complexity of the BoomerAMG hierarchy, or 0.0 if BoomerAMG is not used.
+  double getGridComplexity() const{ return(GridComplexity_);}
+
+  //! Returns the global number of rows on the coarsest level of the BoomerAMG hierarchy, or 0 if BoomerAMG is not used.
+  Tpetra::global_size_t getCoarseGridSize() const{ return(LevelRows_.empty() ? 0 : (Tpetra::global_size_t) LevelRows_.back());}
+
+  //! Returns a ParameterList with the hierarchy statistics of the last compute() and the convergence of the last apply().
+  /*! The list contains "Number of Iterations", "Final Relative Residual Norm", "Average Convergence Factor",
+      "Number of Levels", "Operator Complexity", "Grid Complexity", "Coarse Grid Size", "Rows Per Level",
+      "Nonzeros Per Level", "Last Compute Time" and "Last Apply Time".  The convergence factor is the
+      geometric mean residual reduction per iteration, or -1.0 when it is unknown.
+  */
+  Teuchos::RCP<const Teuchos::ParameterList> getStatistics() const;
+
 private:
 
   // @}
@@ -531,60 +824,41 @@ private:
   //! Returns the number of local matrix columns.
   int NumMyCols() const {return(A_->NumMyCols());};
 
-  //! Sets the solver type to be the passed in solver type.
+  //! Creates the solver of the given type, unless the solver already created can be reused.
   int SetSolverType(Hypre::Hypre_Solver solver);
 
-  //! Sets the preconditioner type to be the passed in type.
+  //! Creates the preconditioner of the given type, unless the preconditioner already created can be reused.
   int SetPrecondType(Hypre::Hypre_Solver precond);
 
-  //! Create the solver.
-  int CreateSolver();
-
-  //! Create the Preconditioner.
-  int CreatePrecond();
+  //! Returns true if the solver has been created and takes a preconditioner.
+  bool SolverTakesPrecond() const{ return(SolverStrategy_ != NULL && SolverStrategy_->setPrecond != NULL);}
 
   //! Add a function to be called in compute()
   int AddFunToList(Teuchos::RCP<FunctionParameter> NewFun);
 
-  //! Create a BoomerAMG solver.
-  int Hypre_BoomerAMGCreate(MPI_Comm comm, HYPRE_Solver *solver)
-    { return HYPRE_BoomerAMGCreate(solver);}
-
-  //! Create a ParaSails solver.
-  int Hypre_ParaSailsCreate(MPI_Comm comm, HYPRE_Solver *solver)
-    { return HYPRE_ParaSailsCreate(comm, solver);}
-
-  //! Create a Euclid solver.
-  int Hypre_EuclidCreate(MPI_Comm comm, HYPRE_Solver *solver)
-    { return HYPRE_EuclidCreate(comm, solver);}
+  //! Returns true (and the solver object in amg) if BoomerAMG is set up by compute(), either as solver or as preconditioner.
+  bool BoomerAMGInUse(HYPRE_Solver& amg) const;
 
-  //! Create an AMS solver.
-  int Hypre_AMSCreate(MPI_Comm comm, HYPRE_Solver *solver)
-    { return HYPRE_AMSCreate(solver);}
+  //! Record the size of every level of the BoomerAMG hierarchy, if BoomerAMG is in use.
+  void GatherHierarchyStatistics();
 
-  //! Create a Hybrid solver.
-  int Hypre_ParCSRHybridCreate(MPI_Comm comm, HYPRE_Solver *solver)
-    { return HYPRE_ParCSRHybridCreate(solver);}
+  //! Returns the number of nonzeros stored on this process by a hypre ParCSR matrix.
+  static double LocalNonzeros(hypre_ParCSRMatrix* A);
 
-  //! Create a PCG solver.
-  int Hypre_ParCSRPCGCreate(MPI_Comm comm, HYPRE_Solver *solver)
-    { return HYPRE_ParCSRPCGCreate(comm, solver);}
+  //! Estimate the number of flops performed by the setup in compute().
+  double EstimateSetupFlops() const;
 
-  //! Create a GMRES solver.
-  int Hypre_ParCSRGMRESCreate(MPI_Comm comm, HYPRE_Solver *solver)
-    { return HYPRE_ParCSRGMRESCreate(comm, solver);}
+  //! Estimate the number of flops of the most recent solve or preconditioner application on a single vector.
+  double EstimateApplyFlops() const;
 
-  //! Create a FlexGMRES solver.
-  int Hypre_ParCSRFlexGMRESCreate(MPI_Comm comm, HYPRE_Solver *solver)
-    { return HYPRE_ParCSRFlexGMRESCreate(comm, solver);}
+  //! Estimate the number of flops of a single application (one cycle for BoomerAMG) of the given hypre solver.
+  double EstimateCycleFlops(Hypre::Hypre_Solver type) const;
 
-  //! Create a LGMRES solver.
-  int Hypre_ParCSRLGMRESCreate(MPI_Comm comm, HYPRE_Solver *solver)
-    { return HYPRE_ParCSRLGMRESCreate(comm, solver);}
+  //! Returns the number of cycles the preconditioner performed during its most recent application.
+  int GetPrecondNumCycles() const;
 
-  //! Create a BiCGSTAB solver.
-  int Hypre_ParCSRBiCGSTABCreate(MPI_Comm comm, HYPRE_Solver *solver)
-    { return HYPRE_ParCSRBiCGSTABCreate(comm, solver);}
+  //! Fold the iteration count and residual of the vector just solved for into the apply() statistics.
+  void UpdateSolveStatistics(bool firstVector) const;
 
   // @}
   // @{ Internal data
@@ -619,6 +893,26 @@ private:
   double ComputeFlops_;
   //! Contain sthe number of flops for ApplyInverse().
   mutable double ApplyInverseFlops_;
+  //! Per-call timings of initialize().
+  CallTimeStatistics initializeStats_;
+  //! Per-call timings of compute().
+  CallTimeStatistics computeStats_;
+  //! Per-call timings of apply().
+  mutable CallTimeStatistics applyStats_;
+  //! Global number of rows on each level of the BoomerAMG hierarchy, gathered in compute()
+  std::vector<double> LevelRows_;
+  //! Global number of nonzeros on each level of the BoomerAMG hierarchy
+  std::vector<double> LevelNonzeros_;
+  //! Global number of nonzeros in the interpolation operator from each coarse level to the next finer one
+  std::vector<double> LevelInterpNonzeros_;
+  //! Sum of the nonzeros on all levels divided by the nonzeros of the fine matrix
+  double OperatorComplexity_;
+  //! Sum of the rows on all levels divided by the rows of the fine matrix
+  double GridComplexity_;
+  //! Number of iterations of the most recent apply()
+  mutable int NumIterations_;
+  //! Final relative residual norm of the most recent apply()
+  mutable double FinalRelResidualNorm_;
 
   //! The Hypre matrix created in initialize()
   mutable HYPRE_IJMatrix HypreA_;
@@ -638,19 +932,12 @@ private:
   mutable HYPRE_Solver Solver_;
   //! The Hypre Solver if applying preconditioner
   mutable HYPRE_Solver Preconditioner_;
-  //  The following are pointers to functions to use the solver and preconditioner.
-  int (Ifpack2_Hypre::*SolverCreatePtr_)(MPI_Comm, HYPRE_Solver*);
-  int (*SolverDestroyPtr_)(HYPRE_Solver);
-  int (*SolverSetupPtr_)(HYPRE_Solver, HYPRE_ParCSRMatrix, HYPRE_ParVector, HYPRE_ParVector);
-  int (*SolverSolvePtr_)(HYPRE_Solver, HYPRE_ParCSRMatrix, HYPRE_ParVector, HYPRE_ParVector);
-  int (*SolverPrecondPtr_)(HYPRE_Solver, HYPRE_PtrToParSolverFcn, HYPRE_PtrToParSolverFcn, HYPRE_Solver);
-  int (Ifpack2_Hypre::*PrecondCreatePtr_)(MPI_Comm, HYPRE_Solver*);
-  int (*PrecondDestroyPtr_)(HYPRE_Solver);
-  int (*PrecondSetupPtr_)(HYPRE_Solver, HYPRE_ParCSRMatrix, HYPRE_ParVector, HYPRE_ParVector);
-  int (*PrecondSolvePtr_)(HYPRE_Solver, HYPRE_ParCSRMatrix, HYPRE_ParVector, HYPRE_ParVector);
-
-  bool *IsSolverSetup_;
-  bool *IsPrecondSetup_;
+  //! The functions of the solver in Solver_, NULL until it has been created
+  const Hypre::SolverStrategy* SolverStrategy_;
+  //! The functions of the preconditioner in Preconditioner_, NULL until it has been created
+  const Hypre::SolverStrategy* PrecondStrategy_;
+  //! True if the parameters changed since the solver and preconditioner were created, so they must be created anew
+  bool RecreateSolvers_;
   //! Is the system to be solved or apply preconditioner
   Hypre::Hypre_Chooser SolveOrPrec_;
   //! Counter of the number of parameters set
@@ -682,6 +969,13 @@ Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::Ifpack2_Hypre(const Teuch
   applyTime_(0.0),
   ComputeFlops_(0.0),
   ApplyInverseFlops_(0.0),
+  OperatorComplexity_(0.0),
+  GridComplexity_(0.0),
+  NumIterations_(0),
+  FinalRelResidualNorm_(-1.0),
+  SolverStrategy_(NULL),
+  PrecondStrategy_(NULL),
+  RecreateSolvers_(false),
   SolveOrPrec_(Hypre::Solver),
   NumFunsToCall_(0),
   SolverType_(Hypre::PCG),
@@ -691,10 +985,6 @@ Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::Ifpack2_Hypre(const Teuch
   TEUCHOS_TEST_FOR_EXCEPTION(!A_->isFillComplete(),std::invalid_argument,
       "Ifpack2::Hypre: Please call fillComplete and try again.");
 
-  IsSolverSetup_ = new bool[1];
-  IsPrecondSetup_ = new bool[1];
-  IsSolverSetup_[0] = false;
-  IsPrecondSetup_[0] = false;
   MPI_Comm comm = GetMpiComm();
 
   // Check the map
@@ -740,14 +1030,12 @@ void Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::Destroy(){
   }
   HYPRE_IJVectorDestroy(XHypre_);
   HYPRE_IJVectorDestroy(YHypre_);
-  if(IsSolverSetup_[0]){
-    SolverDestroyPtr_(Solver_);
+  if(SolverStrategy_ != NULL){
+    SolverStrategy_->destroy(Solver_);
   }
-  if(IsPrecondSetup_[0]){
-    PrecondDestroyPtr_(Preconditioner_);
+  if(PrecondStrategy_ != NULL){
+    PrecondStrategy_->destroy(Preconditioner_);
   }
-  delete[] IsSolverSetup_;
-  delete[] IsPrecondSetup_;
 } //Destroy()
 
 //==============================================================================
@@ -762,6 +1050,7 @@ void Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::initialize(){
     timer = Teuchos::TimeMonitor::getNewCounter (timerName);
   }
 
+  const double startTime = Teuchos::Time::wallTime();
   { // Start timer here
     Teuchos::TimeMonitor timeMon (*timer);
 
@@ -770,27 +1059,41 @@ void Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::initialize(){
     int iupper = A_->getDomainMap()->getMaxGlobalIndex();
     HYPRE_IJMatrixCreate(comm, ilower, iupper, ilower, iupper, &HypreA_);
     HYPRE_IJMatrixSetObjectType(HypreA_, HYPRE_PARCSR);
-    HYPRE_IJMatrixInitialize(HypreA_);
-    for(size_t i = 0; i < A_->getNodeNumRows(); i++){
-      int numElements = A_->getNumEntriesInLocalRow(i);
-      Teuchos::Array<LocalOrdinal> indices(numElements);
-      Teuchos::Array<Scalar> values(numElements);
-      size_t numEntries;
-      A_->getLocalRowCopy(i, indices(), values(), numEntries);
-      for(size_t j = 0; j < numEntries; j++){
-        indices[j] = A_->getColMap()->getGlobalElement(indices[j]);
-      }
-      int GlobalRow[1];
-      GlobalRow[0] = A_->getRowMap()->getGlobalElement(i);
-      HYPRE_IJMatrixAddToValues(HypreA_, 1, &numElements, GlobalRow, &indices[0], &values[0]);
+
+    // Copy all local rows in one call and hand them to hypre in another
+    const LocalOrdinal numRows = A_->getNodeNumRows();
+    Teuchos::Array<size_t> rowptr;
+    Teuchos::Array<LocalOrdinal> indices;
+    Teuchos::Array<Scalar> values;
+    xSDKTrilinos::getLocalRowsCopy(*A_, static_cast<LocalOrdinal>(0), numRows, rowptr, indices, values);
+
+    Teuchos::ArrayView<const GlobalOrdinal> rowGIDs = A_->getRowMap()->getNodeElementList();
+    Teuchos::ArrayView<const GlobalOrdinal> colGIDs = A_->getColMap()->getNodeElementList();
+    Teuchos::Array<HYPRE_Int> rowSizes(numRows), rows(numRows), globalIndices(indices.size());
+    for(LocalOrdinal i = 0; i < numRows; i++){
+      rowSizes[i] = rowptr[i+1] - rowptr[i];
+      rows[i] = rowGIDs[i];
+    }
+    for(size_t j = 0; j < static_cast<size_t>(indices.size()); j++){
+      globalIndices[j] = colGIDs[indices[j]];
     }
+
+    HYPRE_IJMatrixSetRowSizes(HypreA_, rowSizes.getRawPtr());
+    HYPRE_IJMatrixInitialize(HypreA_);
+    Teuchos::Array<HYPRE_Complex> hypreValues;
+    HYPRE_IJMatrixAddToValues(HypreA_, numRows, rowSizes.getRawPtr(), rows.getRawPtr(), globalIndices.getRawPtr(),
+                              Hypre::ToHypreValues(values, hypreValues));
     HYPRE_IJMatrixAssemble(HypreA_);
     HYPRE_IJMatrixGetObject(HypreA_, (void**)&ParMatrix_);
   } // Stop timer here
 
+  // The named timer is shared by every instance, so keep our own per-call times
+  const double callTime = Teuchos::Time::wallTime() - startTime;
+  initializeStats_.addCall(callTime);
+
   isInitialized_=true;
   numInitialize_++;
-  initializeTime_ = timer->totalElapsedTime();
+  initializeTime_ += callTime;
 } //initialize()
 
 //==============================================================================
@@ -799,6 +1102,8 @@ void Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::setParameters(const
   using Teuchos::RCP;
 
   List_ = list;
+  // Settings from the previous list may have been dropped, and hypre has no way to reset them
+  RecreateSolvers_ = true;
   Hypre::Hypre_Solver solType = List_.get("Solver", Hypre::PCG);
   SolverType_ = solType;
   Hypre::Hypre_Solver precType = List_.get("Preconditioner", Hypre::Euclid);
@@ -816,6 +1121,39 @@ void Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::setParameters(const
       AddFunToList(params[i]);
     }
   }
+  if(List_.isParameter("Solver Tolerance") || List_.isParameter("Solver Maximum Iterations")){
+    const Hypre::SolverStrategy* strategy = Hypre::GetSolverStrategy(SolverType_);
+    if(List_.isParameter("Solver Tolerance")){
+      TEUCHOS_TEST_FOR_EXCEPTION(strategy == NULL || strategy->setTol == NULL, std::invalid_argument,
+          Teuchos::typeName (*this) << "::setParameters(): The chosen Solver has no tolerance.");
+      SetParameter(Hypre::Solver, strategy->setTol, List_.get<double>("Solver Tolerance"));
+    }
+    if(List_.isParameter("Solver Maximum Iterations")){
+      TEUCHOS_TEST_FOR_EXCEPTION(strategy == NULL || strategy->setMaxIter == NULL, std::invalid_argument,
+          Teuchos::typeName (*this) << "::setParameters(): The chosen Solver has no iteration limit.");
+      SetParameter(Hypre::Solver, strategy->setMaxIter, List_.get<int>("Solver Maximum Iterations"));
+    }
+  }
+  if(List_.isSublist("BoomerAMG")){
+    const Teuchos::ParameterList& amgList = List_.sublist("BoomerAMG");
+    Hypre::Hypre_Chooser amgChooser = (SolveOrPrec_ == Hypre::Solver && SolverType_ == Hypre::BoomerAMG) ? Hypre::Solver : Hypre::Prec;
+    if(amgList.isParameter("Coarsen Type"))
+      SetParameter(amgChooser, &HYPRE_BoomerAMGSetCoarsenType, amgList.get<int>("Coarsen Type"));
+    if(amgList.isParameter("Interp Type"))
+      SetParameter(amgChooser, &HYPRE_BoomerAMGSetInterpType, amgList.get<int>("Interp Type"));
+    if(amgList.isParameter("Strong Threshold"))
+      SetParameter(amgChooser, &HYPRE_BoomerAMGSetStrongThreshold, amgList.get<double>("Strong Threshold"));
+    if(amgList.isParameter("Relax Type"))
+      SetParameter(amgChooser, &HYPRE_BoomerAMGSetRelaxType, amgList.get<int>("Relax Type"));
+    if(amgList.isParameter("Aggressive Levels"))
+      SetParameter(amgChooser, &HYPRE_BoomerAMGSetAggNumLevels, amgList.get<int>("Aggressive Levels"));
+    if(amgList.isParameter("Max Iterations"))
+      SetParameter(amgChooser, &HYPRE_BoomerAMGSetMaxIter, amgList.get<int>("Max Iterations"));
+    if(amgList.isParameter("Tolerance"))
+      SetParameter(amgChooser, &HYPRE_BoomerAMGSetTol, amgList.get<double>("Tolerance"));
+    if(amgList.isParameter("Print Level"))
+      SetParameter(amgChooser, &HYPRE_BoomerAMGSetPrintLevel, amgList.get<int>("Print Level"));
+  }
 } //SetParameters()
 
 //==============================================================================
@@ -837,7 +1175,7 @@ int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::SetParameter(Hypre::H
 
 //==============================================================================
 template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
-int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::SetParameter(Hypre::Hypre_Chooser chooser, int (*pt2Func)(HYPRE_Solver, double), double parameter){
+int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::SetParameter(Hypre::Hypre_Chooser chooser, int (*pt2Func)(HYPRE_Solver, HYPRE_Real), HYPRE_Real parameter){
   Teuchos::RCP<FunctionParameter> temp = Teuchos::rcp(new FunctionParameter(chooser, pt2Func, parameter));
   AddFunToList(temp);
   return 0;
@@ -845,7 +1183,7 @@ int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::SetParameter(Hypre::H
 
 //==============================================================================
 template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
-int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::SetParameter(Hypre::Hypre_Chooser chooser, int (*pt2Func)(HYPRE_Solver, double, int), double parameter1, int parameter2){
+int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::SetParameter(Hypre::Hypre_Chooser chooser, int (*pt2Func)(HYPRE_Solver, HYPRE_Real, int), HYPRE_Real parameter1, int parameter2){
   Teuchos::RCP<FunctionParameter> temp = Teuchos::rcp(new FunctionParameter(chooser, pt2Func, parameter1, parameter2));
   AddFunToList(temp);
   return 0;
@@ -861,7 +1199,7 @@ int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::SetParameter(Hypre::H
 
 //==============================================================================
 template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
-int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::SetParameter(Hypre::Hypre_Chooser chooser, int (*pt2Func)(HYPRE_Solver, double*), double* parameter){
+int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::SetParameter(Hypre::Hypre_Chooser chooser, int (*pt2Func)(HYPRE_Solver, HYPRE_Real*), HYPRE_Real* parameter){
   Teuchos::RCP<FunctionParameter> temp = Teuchos::rcp(new FunctionParameter(chooser, pt2Func, parameter));
   AddFunToList(temp);
   return 0;
@@ -900,36 +1238,60 @@ void Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::compute(){
     initialize();
   }
 
+  const double startTime = Teuchos::Time::wallTime();
   { // Start timer here
     Teuchos::TimeMonitor timeMon (*timer);
 
-    SetSolverType(SolverType_);
-    SetPrecondType(PrecondType_);
+    // Only the hypre objects this mode uses are created; any left over from another mode are destroyed
+    if(SolveOrPrec_ == Hypre::Solver){
+      int solverErr = SetSolverType(SolverType_);
+      TEUCHOS_TEST_FOR_EXCEPTION(solverErr != 0, std::invalid_argument,
+          Teuchos::typeName (*this) << "::compute(): The chosen Solver cannot be used as a solver.");
+    } else if(SolverStrategy_ != NULL){
+      SolverStrategy_->destroy(Solver_);
+      SolverStrategy_ = NULL;
+    }
+    if(SolveOrPrec_ == Hypre::Prec || (UsePreconditioner_ && SolverTakesPrecond())){
+      int precondErr = SetPrecondType(PrecondType_);
+      TEUCHOS_TEST_FOR_EXCEPTION(precondErr != 0, std::invalid_argument,
+          Teuchos::typeName (*this) << "::compute(): The chosen Preconditioner cannot be used as a preconditioner.");
+    } else if(PrecondStrategy_ != NULL){
+      PrecondStrategy_->destroy(Preconditioner_);
+      PrecondStrategy_ = NULL;
+    }
+    RecreateSolvers_ = false;
     CallFunctions();
-    if(UsePreconditioner_){
-      if(SolverPrecondPtr_ != NULL){
-        SolverPrecondPtr_(Solver_, PrecondSolvePtr_, PrecondSetupPtr_, Preconditioner_);
-      }
+    if(UsePreconditioner_ && SolverTakesPrecond()){
+      SolverStrategy_->setPrecond(Solver_, PrecondStrategy_->solve, PrecondStrategy_->setup, Preconditioner_);
     }
     if(SolveOrPrec_ == Hypre::Solver){
-      SolverSetupPtr_(Solver_, ParMatrix_, ParX_, ParY_);
-      IsSolverSetup_[0] = true;
+      SolverStrategy_->setup(Solver_, ParMatrix_, ParX_, ParY_);
     } else {
-      PrecondSetupPtr_(Preconditioner_, ParMatrix_, ParX_, ParY_);
-      IsPrecondSetup_[0] = true;
+      PrecondStrategy_->setup(Preconditioner_, ParMatrix_, ParX_, ParY_);
     }
   } // Stop timer here
 
+  const double callTime = Teuchos::Time::wallTime() - startTime;
+  computeStats_.addCall(callTime);
+
+  // The hierarchy statistics need a reduction, so they are gathered outside of the timed region
+  GatherHierarchyStatistics();
+  ComputeFlops_ += EstimateSetupFlops();
+
   isComputed_ = true;
   numCompute_++;
-  computeTime_ = timer->totalElapsedTime();
+  computeTime_ += callTime;
 } //compute()
 
 //==============================================================================
 template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
 int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::CallFunctions() const{
   for(int i = 0; i < NumFunsToCall_; i++){
-    FunsToCall_[i]->CallFunction(Solver_, Preconditioner_);
+    // Skip the settings of a hypre object this mode did not create
+    const bool created = (FunsToCall_[i]->getChooser() == Hypre::Solver ? SolverStrategy_ != NULL : PrecondStrategy_ != NULL);
+    if(created){
+      FunsToCall_[i]->CallFunction(Solver_, Preconditioner_);
+    }
   }
   return 0;
 } //CallFunctions()
@@ -959,40 +1321,46 @@ void Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::apply(const Tpetra::
   TEUCHOS_TEST_FOR_EXCEPTION(!A_->getRangeMap()->isSameAs(*Y.getMap()), std::runtime_error,
       Teuchos::typeName (*this) << "::apply(): Y's map must match A's range map.");
 
+  const double startTime = Teuchos::Time::wallTime();
   { // Start timer here
     Teuchos::TimeMonitor timeMon (*timer);
 
     size_t NumVectors = X.getNumVectors();
     TEUCHOS_TEST_FOR_EXCEPTION(NumVectors != Y.getNumVectors(), std::runtime_error,
          Teuchos::typeName (*this) << "::apply(): X and Y must have the same number of vectors.");
+    const size_t NumRows = X.getLocalLength();
     for(size_t VecNum = 0; VecNum < NumVectors; VecNum++) {
       //Get values for current vector in multivector.
-      Teuchos::ArrayRCP<const double> XValues = X.getData(VecNum);
-      Teuchos::ArrayRCP<double> YValues = Y.getDataNonConst(VecNum);
+      Teuchos::ArrayRCP<const Scalar> XValues = X.getData(VecNum);
+      Teuchos::ArrayRCP<Scalar> YValues = Y.getDataNonConst(VecNum);
 
-      // Temporarily make a pointer to data in Hypre for end
-      double *XTemp = XLocal_->data;
-      // Replace data in Hypre vectors with tpetra values
+      // Hand the Tpetra values to hypre, converting them if hypre uses another precision
       // TODO: This is not ideal, since we should not be modifying X
-      XLocal_->data = const_cast<double*>(XValues.get()); 
-      double *YTemp = YLocal_->data;
-      YLocal_->data = YValues.get();
+      HYPRE_Complex *XTemp = Hypre::VectorData<Scalar>::setInput(XLocal_, XValues.get(), NumRows);
+      HYPRE_Complex *YTemp = Hypre::VectorData<Scalar>::setOutput(YLocal_, YValues.get());
   
       HYPRE_ParVectorSetConstantValues(ParY_, 0.0);
       if(SolveOrPrec_ == Hypre::Solver){
         // Use the solver methods
-        SolverSolvePtr_(Solver_, ParMatrix_, ParX_, ParY_);
+        SolverStrategy_->solve(Solver_, ParMatrix_, ParX_, ParY_);
       } else {
         // Apply the preconditioner
-        PrecondSolvePtr_(Preconditioner_, ParMatrix_, ParX_, ParY_);
+        PrecondStrategy_->solve(Preconditioner_, ParMatrix_, ParX_, ParY_);
       }
-      XLocal_->data = XTemp;
-      YLocal_->data = YTemp;
+      Hypre::VectorData<Scalar>::finishInput(XLocal_, XTemp);
+      Hypre::VectorData<Scalar>::finishOutput(YLocal_, YTemp, YValues.get(), NumRows);
+
+      // The iteration count only describes the vector we just solved for
+      UpdateSolveStatistics(VecNum == 0);
+      ApplyInverseFlops_ += EstimateApplyFlops();
     }
   } // Stop timer here
 
+  const double callTime = Teuchos::Time::wallTime() - startTime;
+  applyStats_.addCall(callTime);
+
   numApply_++;
-  applyTime_ = timer->totalElapsedTime();
+  applyTime_ += callTime;
 } //ApplyInverse()
 
 //==============================================================================
@@ -1028,6 +1396,39 @@ std::ostream& Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::Print(std::
       os << "  " << std::setw(15) << 1.0e-6 * ApplyInverseFlops_ / applyTime_ << endl;
     else
       os << "  " << std::setw(15) << 0.0 << endl;
+    if (LevelNonzeros_.size() > 0) {
+      os << endl;
+      os << "BoomerAMG levels                 = " << LevelNonzeros_.size() << endl;
+      os << "Operator complexity              = " << OperatorComplexity_ << endl;
+      os << "Grid complexity                  = " << GridComplexity_ << endl;
+      os << "Coarse grid size                 = " << getCoarseGridSize() << endl;
+    }
+    if (numApply_ > 0) {
+      os << endl;
+      os << "Iterations in last apply         = " << NumIterations_ << endl;
+      os << "Final relative residual norm     = " << FinalRelResidualNorm_ << endl;
+    }
+    os << endl;
+    os << "Phase           Min Time (s)     Max Time (s)     Avg Time (s)" << endl;
+    os << "-----           ------------     ------------     ------------" << endl;
+    os << "initialize()    " << std::setw(12) << initializeStats_.getMinTime()
+       << "  " << std::setw(15) << initializeStats_.getMaxTime()
+       << "  " << std::setw(15) << initializeStats_.getAvgTime() << endl;
+    os << "compute()       " << std::setw(12) << computeStats_.getMinTime()
+       << "  " << std::setw(15) << computeStats_.getMaxTime()
+       << "  " << std::setw(15) << computeStats_.getAvgTime() << endl;
+    os << "ApplyInverse()  " << std::setw(12) << applyStats_.getMinTime()
+       << "  " << std::setw(15) << applyStats_.getMaxTime()
+       << "  " << std::setw(15) << applyStats_.getAvgTime() << endl;
+    os << endl;
+    os << "Latency at least (s)   initialize()     compute()  ApplyInverse()" << endl;
+    os << "--------------------   ------------     ---------  --------------" << endl;
+    for (int bin = 0; bin < CallTimeStatistics::NumBins; bin++) {
+      os << std::setw(20) << CallTimeStatistics::getBinLowerBound(bin)
+         << "  " << std::setw(13) << initializeStats_.getBinCount(bin)
+         << "  " << std::setw(12) << computeStats_.getBinCount(bin)
+         << "  " << std::setw(14) << applyStats_.getBinCount(bin) << endl;
+    }
     os << "================================================================================" << endl;
     os << endl;
   }
@@ -1049,168 +1450,258 @@ double Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::Condest(const Ifpa
 //==============================================================================
 template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
 int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::SetSolverType(Hypre::Hypre_Solver solver){
-  switch(solver) {
-    case Hypre::BoomerAMG:
-      if(IsSolverSetup_[0]){
-        SolverDestroyPtr_(Solver_);
-        IsSolverSetup_[0] = false;
-      }
-      SolverCreatePtr_ = &Ifpack2_Hypre::Hypre_BoomerAMGCreate;
-      SolverDestroyPtr_ = &HYPRE_BoomerAMGDestroy;
-      SolverSetupPtr_ = &HYPRE_BoomerAMGSetup;
-      SolverPrecondPtr_ = NULL;
-      SolverSolvePtr_ = &HYPRE_BoomerAMGSolve;
-      break;
-    case Hypre::AMS:
-      if(IsSolverSetup_[0]){
-        SolverDestroyPtr_(Solver_);
-        IsSolverSetup_[0] = false;
-      }
-      SolverCreatePtr_ = &Ifpack2_Hypre::Hypre_AMSCreate;
-      SolverDestroyPtr_ = &HYPRE_AMSDestroy;
-      SolverSetupPtr_ = &HYPRE_AMSSetup;
-      SolverSolvePtr_ = &HYPRE_AMSSolve;
-      SolverPrecondPtr_ = NULL;
-      break;
-    case Hypre::Hybrid:
-      if(IsSolverSetup_[0]){
-        SolverDestroyPtr_(Solver_);
-        IsSolverSetup_[0] = false;
-      }
-      SolverCreatePtr_ = &Ifpack2_Hypre::Hypre_ParCSRHybridCreate;
-      SolverDestroyPtr_ = &HYPRE_ParCSRHybridDestroy;
-      SolverSetupPtr_ = &HYPRE_ParCSRHybridSetup;
-      SolverSolvePtr_ = &HYPRE_ParCSRHybridSolve;
-      SolverPrecondPtr_ = &HYPRE_ParCSRHybridSetPrecond;
-      break;
-    case Hypre::PCG:
-      if(IsSolverSetup_[0]){
-        SolverDestroyPtr_(Solver_);
-        IsSolverSetup_[0] = false;
-      }
-      SolverCreatePtr_ = &Ifpack2_Hypre::Hypre_ParCSRPCGCreate;
-      SolverDestroyPtr_ = &HYPRE_ParCSRPCGDestroy;
-      SolverSetupPtr_ = &HYPRE_ParCSRPCGSetup;
-      SolverSolvePtr_ = &HYPRE_ParCSRPCGSolve;
-      SolverPrecondPtr_ = &HYPRE_ParCSRPCGSetPrecond;
-      break;
-    case Hypre::GMRES:
-      if(IsSolverSetup_[0]){
-        SolverDestroyPtr_(Solver_);
-        IsSolverSetup_[0] = false;
-      }
-      SolverCreatePtr_ = &Ifpack2_Hypre::Hypre_ParCSRGMRESCreate;
-      SolverDestroyPtr_ = &HYPRE_ParCSRGMRESDestroy;
-      SolverSetupPtr_ = &HYPRE_ParCSRGMRESSetup;
-      SolverPrecondPtr_ = &HYPRE_ParCSRGMRESSetPrecond;
-      break;
-    case Hypre::FlexGMRES:
-      if(IsSolverSetup_[0]){
-        SolverDestroyPtr_(Solver_);
-        IsSolverSetup_[0] = false;
-      }
-      SolverCreatePtr_ = &Ifpack2_Hypre::Hypre_ParCSRFlexGMRESCreate;
-      SolverDestroyPtr_ = &HYPRE_ParCSRFlexGMRESDestroy;
-      SolverSetupPtr_ = &HYPRE_ParCSRFlexGMRESSetup;
-      SolverSolvePtr_ = &HYPRE_ParCSRFlexGMRESSolve;
-      SolverPrecondPtr_ = &HYPRE_ParCSRFlexGMRESSetPrecond;
-      break;
-    case Hypre::LGMRES:
-      if(IsSolverSetup_[0]){
-        SolverDestroyPtr_(Solver_);
-        IsSolverSetup_[0] = false;
-      }
-      SolverCreatePtr_ = &Ifpack2_Hypre::Hypre_ParCSRLGMRESCreate;
-      SolverDestroyPtr_ = &HYPRE_ParCSRLGMRESDestroy;
-      SolverSetupPtr_ = &HYPRE_ParCSRLGMRESSetup;
-      SolverSolvePtr_ = &HYPRE_ParCSRLGMRESSolve;
-      SolverPrecondPtr_ = &HYPRE_ParCSRLGMRESSetPrecond;
-      break;
-    case Hypre::BiCGSTAB:
-      if(IsSolverSetup_[0]){
-        SolverDestroyPtr_(Solver_);
-        IsSolverSetup_[0] = false;
-      }
-      SolverCreatePtr_ = &Ifpack2_Hypre::Hypre_ParCSRBiCGSTABCreate;
-      SolverDestroyPtr_ = &HYPRE_ParCSRBiCGSTABDestroy;
-      SolverSetupPtr_ = &HYPRE_ParCSRBiCGSTABSetup;
-      SolverSolvePtr_ = &HYPRE_ParCSRBiCGSTABSolve;
-      SolverPrecondPtr_ = &HYPRE_ParCSRBiCGSTABSetPrecond;
-      break;
-    default:
-      return -1;
-    }
-  CreateSolver();
+  const Hypre::SolverStrategy* strategy = Hypre::GetSolverStrategy(solver);
+  if(strategy == NULL || !strategy->isSolver){
+    return -1;
+  }
+  if(strategy == SolverStrategy_ && strategy->canResetup && !RecreateSolvers_){
+    return 0;
+  }
+  if(SolverStrategy_ != NULL){
+    SolverStrategy_->destroy(Solver_);
+    SolverStrategy_ = NULL;
+  }
+  MPI_Comm comm;
+  HYPRE_ParCSRMatrixGetComm(ParMatrix_, &comm);
+  strategy->create(comm, &Solver_);
+  SolverStrategy_ = strategy;
   return 0;
 } //SetSolverType()
 
 //==============================================================================
 template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
-int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::SetPrecondType(Hypre::Hypre_Solver Precond){
-  switch(Precond) {
-    case Hypre::BoomerAMG:
-      if(IsPrecondSetup_[0]){
-        PrecondDestroyPtr_(Preconditioner_);
-        IsPrecondSetup_[0] = false;
-      }
-      PrecondCreatePtr_ = &Ifpack2_Hypre::Hypre_BoomerAMGCreate;
-      PrecondDestroyPtr_ = &HYPRE_BoomerAMGDestroy;
-      PrecondSetupPtr_ = &HYPRE_BoomerAMGSetup;
-      PrecondSolvePtr_ = &HYPRE_BoomerAMGSolve;
-      break;
-    case Hypre::ParaSails:
-      if(IsPrecondSetup_[0]){
-        PrecondDestroyPtr_(Preconditioner_);
-        IsPrecondSetup_[0] = false;
-      }
-      PrecondCreatePtr_ = &Ifpack2_Hypre::Hypre_ParaSailsCreate;
-      PrecondDestroyPtr_ = &HYPRE_ParaSailsDestroy;
-      PrecondSetupPtr_ = &HYPRE_ParaSailsSetup;
-      PrecondSolvePtr_ = &HYPRE_ParaSailsSolve;
-      break;
-    case Hypre::Euclid:
-      if(IsPrecondSetup_[0]){
-        PrecondDestroyPtr_(Preconditioner_);
-        IsPrecondSetup_[0] = false;
-      }
-      PrecondCreatePtr_ = &Ifpack2_Hypre::Hypre_EuclidCreate;
-      PrecondDestroyPtr_ = &HYPRE_EuclidDestroy;
-      PrecondSetupPtr_ = &HYPRE_EuclidSetup;
-      PrecondSolvePtr_ = &HYPRE_EuclidSolve;
-      break;
-    case Hypre::AMS:
-      if(IsPrecondSetup_[0]){
-        PrecondDestroyPtr_(Preconditioner_);
-        IsPrecondSetup_[0] = false;
+int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::SetPrecondType(Hypre::Hypre_Solver precond){
+  const Hypre::SolverStrategy* strategy = Hypre::GetSolverStrategy(precond);
+  if(strategy == NULL || !strategy->isPreconditioner){
+    return -1;
+  }
+  if(strategy == PrecondStrategy_ && strategy->canResetup && !RecreateSolvers_){
+    return 0;
+  }
+  if(PrecondStrategy_ != NULL){
+    PrecondStrategy_->destroy(Preconditioner_);
+    PrecondStrategy_ = NULL;
+  }
+  MPI_Comm comm;
+  HYPRE_ParCSRMatrixGetComm(ParMatrix_, &comm);
+  strategy->create(comm, &Preconditioner_);
+  PrecondStrategy_ = strategy;
+  return 0;
+} //SetPrecondType()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+bool Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::BoomerAMGInUse(HYPRE_Solver& amg) const{
+  if(SolveOrPrec_ == Hypre::Solver && SolverType_ == Hypre::BoomerAMG){
+    amg = Solver_;
+    return true;
+  }
+  bool precondSetup = (SolveOrPrec_ == Hypre::Prec) || (UsePreconditioner_ && SolverTakesPrecond());
+  if(precondSetup && PrecondType_ == Hypre::BoomerAMG){
+    amg = Preconditioner_;
+    return true;
+  }
+  return false;
+} //BoomerAMGInUse()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+double Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::LocalNonzeros(hypre_ParCSRMatrix* A){
+  hypre_CSRMatrix *diag = hypre_ParCSRMatrixDiag(A);
+  hypre_CSRMatrix *offd = hypre_ParCSRMatrixOffd(A);
+  double nnz = hypre_CSRMatrixI(diag)[hypre_CSRMatrixNumRows(diag)];
+  if(offd != NULL && hypre_CSRMatrixI(offd) != NULL){
+    nnz += hypre_CSRMatrixI(offd)[hypre_CSRMatrixNumRows(offd)];
+  }
+  return nnz;
+} //LocalNonzeros()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+void Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::GatherHierarchyStatistics(){
+  LevelRows_.clear();
+  LevelNonzeros_.clear();
+  LevelInterpNonzeros_.clear();
+  OperatorComplexity_ = 0.0;
+  GridComplexity_ = 0.0;
+
+  HYPRE_Solver amg;
+  if(!BoomerAMGInUse(amg)){
+    return;
+  }
+
+  hypre_ParAMGData *amgData = (hypre_ParAMGData*) amg;
+  int numLevels = hypre_ParAMGDataNumLevels(amgData);
+  hypre_ParCSRMatrix **AArray = hypre_ParAMGDataAArray(amgData);
+  hypre_ParCSRMatrix **PArray = hypre_ParAMGDataPArray(amgData);
+  if(numLevels <= 0 || AArray == NULL){
+    return;
+  }
+
+  // Sum the nonzeros of A and P on every level in a single reduction
+  std::vector<double> localNnz(2*numLevels, 0.0), globalNnz(2*numLevels, 0.0);
+  for(int level = 0; level < numLevels; level++){
+    localNnz[level] = LocalNonzeros(AArray[level]);
+    if(level < numLevels-1 && PArray != NULL && PArray[level] != NULL){
+      localNnz[numLevels+level] = LocalNonzeros(PArray[level]);
+    }
+  }
+  Teuchos::reduceAll<int,double>(*Comm(), Teuchos::REDUCE_SUM, 2*numLevels, &localNnz[0], &globalNnz[0]);
+
+  double totalRows = 0.0, totalNnz = 0.0;
+  for(int level = 0; level < numLevels; level++){
+    LevelRows_.push_back(hypre_ParCSRMatrixGlobalNumRows(AArray[level]));
+    LevelNonzeros_.push_back(globalNnz[level]);
+    if(level < numLevels-1){
+      LevelInterpNonzeros_.push_back(globalNnz[numLevels+level]);
+    }
+    totalRows += LevelRows_[level];
+    totalNnz += LevelNonzeros_[level];
+  }
+  if(LevelNonzeros_[0] > 0.0) OperatorComplexity_ = totalNnz / LevelNonzeros_[0];
+  if(LevelRows_[0] > 0.0) GridComplexity_ = totalRows / LevelRows_[0];
+} //GatherHierarchyStatistics()
+
+//==============================================================================
+// The flop counts below are model estimates, not measurements.  A sparse
+// mat-vec costs 2*nnz flops, and the setup of BoomerAMG is dominated by the
+// Galerkin products R*A*P, which cost roughly 4*nnz(A)*nnz(P)/rows(P) per level.
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+double Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::EstimateSetupFlops() const{
+  HYPRE_Solver amg;
+  if(BoomerAMGInUse(amg) && LevelNonzeros_.size() > 0){
+    double flops = 0.0;
+    for(size_t level = 0; level+1 < LevelNonzeros_.size(); level++){
+      // The interpolation operator leaving this level has as many rows as the level itself
+      double interpPerRow = (LevelRows_[level] > 0.0 ? LevelInterpNonzeros_[level] / LevelRows_[level] : 0.0);
+      flops += 4.0 * LevelNonzeros_[level] * interpPerRow;
+    }
+    return flops;
+  }
+
+  // ParaSails and Euclid build an approximate inverse or factorization with roughly the sparsity of A
+  bool precondSetup = (SolveOrPrec_ == Hypre::Prec) || (UsePreconditioner_ && SolverTakesPrecond());
+  if(precondSetup && (PrecondType_ == Hypre::ParaSails || PrecondType_ == Hypre::Euclid)){
+    return 2.0 * A_->getGlobalNumEntries();
+  }
+  return 0.0;
+} //EstimateSetupFlops()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+double Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::EstimateCycleFlops(Hypre::Hypre_Solver type) const{
+  const double nnz = A_->getGlobalNumEntries();
+
+  if(type == Hypre::BoomerAMG && LevelNonzeros_.size() > 0){
+    // Each level does its pre- and post-smoothing sweeps and one residual
+    // computation; restriction and interpolation each touch P once.
+    HYPRE_Solver amg;
+    BoomerAMGInUse(amg);
+    int *numSweeps = hypre_ParAMGDataNumGridSweeps((hypre_ParAMGData*) amg);
+    int sweeps = (numSweeps != NULL ? numSweeps[0] + numSweeps[1] : 2);
+    double flops = 0.0;
+    for(size_t level = 0; level < LevelNonzeros_.size(); level++){
+      flops += 2.0 * LevelNonzeros_[level] * (sweeps + 1);
+      if(level+1 < LevelNonzeros_.size()){
+        flops += 4.0 * LevelInterpNonzeros_[level];
       }
-      PrecondCreatePtr_ = &Ifpack2_Hypre::Hypre_AMSCreate;
-      PrecondDestroyPtr_ = &HYPRE_AMSDestroy;
-      PrecondSetupPtr_ = &HYPRE_AMSSetup;
-      PrecondSolvePtr_ = &HYPRE_AMSSolve;
-      break;
-    default:
-      return -1;
     }
-  CreatePrecond();
-  return 0;
+    return flops;
+  }
 
-} //SetPrecondType()
+  // Without a hierarchy, assume the work of a single mat-vec
+  return 2.0 * nnz;
+} //EstimateCycleFlops()
 
 //==============================================================================
 template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
-int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::CreateSolver(){
-  MPI_Comm comm;
-  HYPRE_ParCSRMatrixGetComm(ParMatrix_, &comm);
-  return (this->*SolverCreatePtr_)(comm, &Solver_);
-} //CreateSolver()
+int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::GetPrecondNumCycles() const{
+  int numCycles = 1;
+  if(PrecondType_ == Hypre::BoomerAMG){
+    HYPRE_BoomerAMGGetNumIterations(Preconditioner_, &numCycles);
+  } else if(PrecondType_ == Hypre::AMS){
+    HYPRE_AMSGetNumIterations(Preconditioner_, &numCycles);
+  }
+  return std::max(numCycles, 1);
+} //GetPrecondNumCycles()
 
 //==============================================================================
 template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
-int Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::CreatePrecond(){
-  MPI_Comm comm;
-  HYPRE_ParCSRMatrixGetComm(ParMatrix_, &comm);
-  return (this->*PrecondCreatePtr_)(comm, &Preconditioner_);
-} //CreatePrecond()
+double Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::EstimateApplyFlops() const{
+  if(SolveOrPrec_ == Hypre::Prec){
+    return GetPrecondNumCycles() * EstimateCycleFlops(PrecondType_);
+  }
+
+  int numIters = 0;
+  if(SolverStrategy_ != NULL && SolverStrategy_->getNumIterations != NULL){
+    SolverStrategy_->getNumIterations(Solver_, &numIters);
+  }
+  if(SolverType_ == Hypre::BoomerAMG || SolverType_ == Hypre::AMS){
+    return numIters * EstimateCycleFlops(SolverType_);
+  }
+
+  // Krylov solvers: mat-vecs, about ten flops per row of vector updates and
+  // inner products, and the preconditioner applications of every iteration
+  const double nnz = A_->getGlobalNumEntries();
+  const double n = A_->getGlobalNumRows();
+  const int opsPerIter = (SolverType_ == Hypre::BiCGSTAB ? 2 : 1);
+  double iterFlops = opsPerIter * 2.0 * nnz + 10.0 * n;
+  if(UsePreconditioner_ && SolverTakesPrecond()){
+    iterFlops += opsPerIter * GetPrecondNumCycles() * EstimateCycleFlops(PrecondType_);
+  }
+  return numIters * iterFlops;
+} //EstimateApplyFlops()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+void Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::UpdateSolveStatistics(bool firstVector) const{
+  int numIters = 0;
+  HYPRE_Real residual = -1.0;
+  if(SolveOrPrec_ == Hypre::Solver){
+    if(SolverStrategy_->getNumIterations != NULL) SolverStrategy_->getNumIterations(Solver_, &numIters);
+    if(SolverStrategy_->getFinalResidual != NULL) SolverStrategy_->getFinalResidual(Solver_, &residual);
+  } else {
+    // ParaSails and Euclid are applied once and do not track a residual
+    numIters = GetPrecondNumCycles();
+    if(PrecondType_ == Hypre::BoomerAMG){
+      HYPRE_BoomerAMGGetFinalRelativeResidualNorm(Preconditioner_, &residual);
+    } else if(PrecondType_ == Hypre::AMS){
+      HYPRE_AMSGetFinalRelativeResidualNorm(Preconditioner_, &residual);
+    }
+  }
+
+  if(firstVector){
+    NumIterations_ = numIters;
+    FinalRelResidualNorm_ = residual;
+  } else {
+    NumIterations_ = std::max(NumIterations_, numIters);
+    FinalRelResidualNorm_ = std::max(FinalRelResidualNorm_, residual);
+  }
+} //UpdateSolveStatistics()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+Teuchos::RCP<const Teuchos::ParameterList> Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node>::getStatistics() const{
+  Teuchos::RCP<Teuchos::ParameterList> stats = Teuchos::parameterList("Ifpack2_Hypre Statistics");
+
+  double convergenceFactor = -1.0;
+  if(NumIterations_ > 0 && FinalRelResidualNorm_ > 0.0){
+    convergenceFactor = std::pow(FinalRelResidualNorm_, 1.0 / NumIterations_);
+  }
+
+  stats->set("Number of Iterations", NumIterations_);
+  stats->set("Final Relative Residual Norm", FinalRelResidualNorm_);
+  stats->set("Average Convergence Factor", convergenceFactor);
+  stats->set("Number of Levels", getNumLevels());
+  stats->set("Operator Complexity", OperatorComplexity_);
+  stats->set("Grid Complexity", GridComplexity_);
+  stats->set("Coarse Grid Size", getCoarseGridSize());
+  stats->set("Rows Per Level", Teuchos::Array<double>(LevelRows_));
+  stats->set("Nonzeros Per Level", Teuchos::Array<double>(LevelNonzeros_));
+  stats->set("Last Compute Time", computeStats_.getLastTime());
+  stats->set("Last Apply Time", applyStats_.getLastTime());
+  return stats;
+} //getStatistics()
 
 } // namespace Ifpack2
 
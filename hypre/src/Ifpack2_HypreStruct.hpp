@@ -0,0 +1,687 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef IFPACK2_HYPRESTRUCT_H
+#define IFPACK2_HYPRESTRUCT_H
+
+#include "Ifpack2_ConfigDefs.hpp"
+
+#include "HYPRE_struct_ls.h"
+#include "HYPRE.h"
+
+#include "Ifpack2_Preconditioner.hpp"
+#include "Tpetra_LocalRowsCopy.hpp"
+
+#include "Teuchos_Array.hpp"
+#include "Teuchos_CommHelpers.hpp"
+#include "Teuchos_DefaultMpiComm.hpp"
+#include "Teuchos_ParameterList.hpp"
+#include "Teuchos_RCP.hpp"
+#include "Teuchos_Time.hpp"
+#include "Teuchos_TimeMonitor.hpp"
+
+#include <iomanip>
+#include <vector>
+
+namespace Ifpack2 {
+
+namespace Hypre {
+//! This enumerated type defines the structured-grid multigrid solvers of hypre that Ifpack2_HypreStruct can apply.
+enum Hypre_StructSolver{
+    PFMG,
+    SMG
+};
+} // namespace Hypre
+
+//! Ifpack2_HypreStruct: A class for applying hypre's structured-grid multigrid solvers to a Tpetra matrix that comes from a structured grid.
+
+/*!
+Class Ifpack2_HypreStruct copies a matrix defined on a logically rectangular nx by ny (by nz) grid into a
+HYPRE_StructMatrix and applies PFMG or SMG to it.  For Poisson-like problems these are considerably faster
+than BoomerAMG on the same matrix, since they exploit the grid instead of rediscovering it.
+
+The grid points must be numbered naturally, with x varying fastest: the point (i,j,k) is global row
+i + nx*(j + ny*k).  Every process must own a single box of the grid, and its local rows must be the points of
+that box in the same order.  The vectors given to apply() are then already laid out the way hypre stores a box,
+so they are handed to hypre in one piece, without any index translation.
+*/
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+class Ifpack2_HypreStruct:
+    public Preconditioner<Scalar, LocalOrdinal, GlobalOrdinal, Node>
+{
+public:
+  typedef Tpetra::RowMatrix<Scalar,LocalOrdinal,GlobalOrdinal,Node> row_matrix_type;
+  typedef Tpetra::MultiVector<Scalar,LocalOrdinal,GlobalOrdinal,Node> multivector_type;
+  typedef Tpetra::Map<LocalOrdinal,GlobalOrdinal,Node> map_type;
+
+  //! Constructor
+  Ifpack2_HypreStruct(const Teuchos::RCP<const row_matrix_type>& A);
+
+  //! Destructor
+  ~Ifpack2_HypreStruct(){ Destroy();}
+
+  //! Set parameters using a Teuchos::ParameterList object.
+  /*! The grid is described by
+       Grid Dimensions (Teuchos::Array<int>)   nx, ny and, for a 3D grid, nz.  Required.
+       Box Lower (Teuchos::Array<int>)         lowest corner of the box owned by this process, inclusive.
+       Box Upper (Teuchos::Array<int>)         highest corner of the box owned by this process, inclusive.
+                                               If the box is not given, it is taken to span the first
+                                               and last local rows, which is right for slabs of whole
+                                               grid lines or planes.
+       Stencil Offsets (Teuchos::Array<int>)   offsets of the stencil entries, Dimension values per
+                                               entry.  Defaults to the 5 (7 in 3D) point stencil.
+      and the solver by
+       Solver (Hypre_StructSolver)             PFMG (default) or SMG.
+       Max Iterations (int)                    default 1, a single V-cycle per apply().
+       Tolerance (double)                      default 0.0.
+       Relax Type (int)                        PFMG only, argument of HYPRE_StructPFMGSetRelaxType, default 1.
+       Num Pre Relax (int)                     default 1.
+       Num Post Relax (int)                    default 1.
+       Print Level (int)                       default 0.
+  */
+  void setParameters(const Teuchos::ParameterList& parameterlist);
+
+  //! Build the hypre grid, stencil and matrix structure, and check that the matrix fits them.
+  void initialize();
+
+  //! Returns \c true if the preconditioner has been successfully initialized.
+  bool isInitialized() const{ return(isInitialized_);}
+
+  //! Copy the matrix values into hypre and set up the solver.
+  void compute();
+
+  //! Returns \c true if the preconditioner has been successfully computed.
+  bool isComputed() const{ return(isComputed_);}
+
+  //! Computes Y = beta*Y + alpha*M^{-1}X, where M^{-1} is the chosen number of cycles of PFMG or SMG.
+  void apply(const multivector_type& X,
+             multivector_type& Y,
+             Teuchos::ETransp mode = Teuchos::NO_TRANS,
+             Scalar alpha = Teuchos::ScalarTraits<Scalar>::one(),
+             Scalar beta = Teuchos::ScalarTraits<Scalar>::zero()) const;
+
+  //! Returns a reference to the map that should be used for domain.
+  Teuchos::RCP<const map_type> getDomainMap() const{ return A_->getDomainMap();}
+
+  //! Returns a reference to the map that should be used for range.
+  Teuchos::RCP<const map_type> getRangeMap() const{ return A_->getRangeMap();}
+
+  //! Returns a reference to the matrix to be preconditioned.
+  Teuchos::RCP<const row_matrix_type> getMatrix() const{ return(A_);}
+
+  //! Returns the Hypre matrix that was created by initialize().
+  const HYPRE_StructMatrix& HypreMatrix()
+  {
+    if(isInitialized() == false)
+      initialize();
+    return(HypreA_);
+  }
+
+  //! Returns the number of calls to initialize().
+  int getNumInitialize() const{ return(numInitialize_);}
+
+  //! Returns the number of calls to compute().
+  int getNumCompute() const{ return(numCompute_);}
+
+  //! Returns the number of calls to apply().
+  int getNumApply() const{ return(numApply_);}
+
+  //! Returns the time spent in initialize().
+  double getInitializeTime() const{ return(initializeTime_);}
+
+  //! Returns the time spent in compute().
+  double getComputeTime() const{ return(computeTime_);}
+
+  //! Returns the time spent in apply().
+  double getApplyTime() const{ return(applyTime_);}
+
+  //! Returns the number of cycles of the most recent apply(), maximized over the vectors of X.
+  int getNumIterations() const{ return(NumIterations_);}
+
+  //! Returns the final relative residual norm of the most recent apply(), maximized over the vectors of X.
+  double getFinalRelativeResidualNorm() const{ return(FinalRelResidualNorm_);}
+
+  //! Prints on stream basic information about \c this object.
+  std::ostream& Print(std::ostream& os) const;
+
+private:
+  //! Copy constructor (should never be used)
+  Ifpack2_HypreStruct(const Ifpack2_HypreStruct& RHS) {}
+
+  //! Returns the MPI communicator of the matrix.
+  MPI_Comm GetMpiComm() const
+    { return *(Teuchos::rcp_dynamic_cast<const Teuchos::MpiComm<int> >(A_->getComm()))->getRawMpiComm(); }
+
+  //! Destroys all hypre objects.
+  void Destroy();
+
+  //! Destroys the solver, if one has been created.
+  void DestroySolver();
+
+  //! Returns the global row of a grid point.
+  GlobalOrdinal GridPointToRow(const int* point) const;
+
+  //! Computes the grid point of a global row.
+  void RowToGridPoint(GlobalOrdinal row, int* point) const;
+
+  //! Throws on every process if any process reports an error.
+  void CheckGlobalError(bool localError, const std::string& message) const;
+
+  //! Pointer to the matrix to be preconditioned
+  Teuchos::RCP<const row_matrix_type> A_;
+  //! Number of grid dimensions, 2 or 3
+  int Dim_;
+  //! nx, ny, nz
+  int GridDims_[3];
+  //! The box owned by this process, inclusive
+  int BoxLower_[3];
+  int BoxUpper_[3];
+  //! Whether the box was given in the parameter list
+  bool BoxGiven_;
+  //! Offsets of the stencil entries, Dim_ per entry
+  Teuchos::Array<int> StencilOffsets_;
+  Hypre::Hypre_StructSolver SolverType_;
+  int MaxIters_;
+  double Tol_;
+  int RelaxType_;
+  int NumPreRelax_;
+  int NumPostRelax_;
+  int PrintLevel_;
+
+  HYPRE_StructGrid Grid_;
+  HYPRE_StructStencil Stencil_;
+  HYPRE_StructMatrix HypreA_;
+  //! Right hand side and solution of the hypre solve
+  HYPRE_StructVector HypreB_;
+  HYPRE_StructVector HypreX_;
+  mutable HYPRE_StructSolver Solver_;
+  bool IsSolverCreated_;
+
+  bool isInitialized_;
+  bool isComputed_;
+  int numInitialize_;
+  int numCompute_;
+  mutable int numApply_;
+  double initializeTime_;
+  double computeTime_;
+  mutable double applyTime_;
+  mutable int NumIterations_;
+  mutable double FinalRelResidualNorm_;
+};
+
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+Ifpack2_HypreStruct<Scalar,LocalOrdinal,GlobalOrdinal,Node>::Ifpack2_HypreStruct(const Teuchos::RCP<const row_matrix_type>& A):
+  A_(A),
+  Dim_(0),
+  BoxGiven_(false),
+  SolverType_(Hypre::PFMG),
+  MaxIters_(1),
+  Tol_(0.0),
+  RelaxType_(1),
+  NumPreRelax_(1),
+  NumPostRelax_(1),
+  PrintLevel_(0),
+  IsSolverCreated_(false),
+  isInitialized_(false),
+  isComputed_(false),
+  numInitialize_(0),
+  numCompute_(0),
+  numApply_(0),
+  initializeTime_(0.0),
+  computeTime_(0.0),
+  applyTime_(0.0),
+  NumIterations_(0),
+  FinalRelResidualNorm_(-1.0)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(!A_->isFillComplete(),std::invalid_argument,
+      "Ifpack2::HypreStruct: Please call fillComplete and try again.");
+
+  // The local rows are the points of the box, so X, Y and A must share one distribution
+  TEUCHOS_TEST_FOR_EXCEPTION(!A_->getDomainMap()->isSameAs(*A_->getRangeMap()) ||
+                             !A_->getDomainMap()->isSameAs(*A_->getRowMap()), std::runtime_error,
+      Teuchos::typeName (*this) << ": A's row, domain and range map must be the same for hypre.");
+
+  for(int d = 0; d < 3; d++){
+    GridDims_[d] = 1;
+    BoxLower_[d] = 0;
+    BoxUpper_[d] = 0;
+  }
+} //Constructor
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+void Ifpack2_HypreStruct<Scalar,LocalOrdinal,GlobalOrdinal,Node>::Destroy(){
+  DestroySolver();
+  if(isInitialized()){
+    HYPRE_StructVectorDestroy(HypreX_);
+    HYPRE_StructVectorDestroy(HypreB_);
+    HYPRE_StructMatrixDestroy(HypreA_);
+    HYPRE_StructStencilDestroy(Stencil_);
+    HYPRE_StructGridDestroy(Grid_);
+  }
+  isInitialized_ = false;
+  isComputed_ = false;
+} //Destroy()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+void Ifpack2_HypreStruct<Scalar,LocalOrdinal,GlobalOrdinal,Node>::DestroySolver(){
+  if(IsSolverCreated_){
+    if(SolverType_ == Hypre::PFMG){
+      HYPRE_StructPFMGDestroy(Solver_);
+    } else {
+      HYPRE_StructSMGDestroy(Solver_);
+    }
+  }
+  IsSolverCreated_ = false;
+} //DestroySolver()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+void Ifpack2_HypreStruct<Scalar,LocalOrdinal,GlobalOrdinal,Node>::setParameters(const Teuchos::ParameterList& list){
+  TEUCHOS_TEST_FOR_EXCEPTION(!list.isParameter("Grid Dimensions"), std::invalid_argument,
+      Teuchos::typeName (*this) << "::setParameters(): The Grid Dimensions are required.");
+  Teuchos::Array<int> gridDims = list.get<Teuchos::Array<int> >("Grid Dimensions");
+  TEUCHOS_TEST_FOR_EXCEPTION(gridDims.size() != 2 && gridDims.size() != 3, std::invalid_argument,
+      Teuchos::typeName (*this) << "::setParameters(): The grid must have 2 or 3 dimensions.");
+
+  // The grid and the stencil are part of the hypre objects, so changing them starts over
+  Destroy();
+
+  Dim_ = gridDims.size();
+  for(int d = 0; d < 3; d++){
+    GridDims_[d] = (d < Dim_ ? gridDims[d] : 1);
+  }
+
+  BoxGiven_ = list.isParameter("Box Lower") || list.isParameter("Box Upper");
+  if(BoxGiven_){
+    Teuchos::Array<int> lower = list.get<Teuchos::Array<int> >("Box Lower");
+    Teuchos::Array<int> upper = list.get<Teuchos::Array<int> >("Box Upper");
+    TEUCHOS_TEST_FOR_EXCEPTION(lower.size() != Dim_ || upper.size() != Dim_, std::invalid_argument,
+        Teuchos::typeName (*this) << "::setParameters(): Box Lower and Box Upper must have one entry per dimension.");
+    for(int d = 0; d < Dim_; d++){
+      BoxLower_[d] = lower[d];
+      BoxUpper_[d] = upper[d];
+    }
+  }
+
+  if(list.isParameter("Stencil Offsets")){
+    StencilOffsets_ = list.get<Teuchos::Array<int> >("Stencil Offsets");
+    TEUCHOS_TEST_FOR_EXCEPTION(StencilOffsets_.size() == 0 || StencilOffsets_.size() % Dim_ != 0, std::invalid_argument,
+        Teuchos::typeName (*this) << "::setParameters(): Stencil Offsets must hold Dimension values per entry.");
+  } else {
+    // The center first, then -1 and +1 in every direction
+    StencilOffsets_.assign((2*Dim_+1)*Dim_, 0);
+    for(int d = 0; d < Dim_; d++){
+      StencilOffsets_[(2*d+1)*Dim_ + d] = -1;
+      StencilOffsets_[(2*d+2)*Dim_ + d] = 1;
+    }
+  }
+
+  SolverType_ = list.get("Solver", Hypre::PFMG);
+  MaxIters_ = list.get("Max Iterations", 1);
+  Tol_ = list.get("Tolerance", 0.0);
+  RelaxType_ = list.get("Relax Type", 1);
+  NumPreRelax_ = list.get("Num Pre Relax", 1);
+  NumPostRelax_ = list.get("Num Post Relax", 1);
+  PrintLevel_ = list.get("Print Level", 0);
+} //setParameters()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+GlobalOrdinal Ifpack2_HypreStruct<Scalar,LocalOrdinal,GlobalOrdinal,Node>::GridPointToRow(const int* point) const{
+  return point[0] + (GlobalOrdinal) GridDims_[0] * (point[1] + (GlobalOrdinal) GridDims_[1] * point[2]);
+} //GridPointToRow()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+void Ifpack2_HypreStruct<Scalar,LocalOrdinal,GlobalOrdinal,Node>::RowToGridPoint(GlobalOrdinal row, int* point) const{
+  point[0] = row % GridDims_[0];
+  row /= GridDims_[0];
+  point[1] = row % GridDims_[1];
+  point[2] = row / GridDims_[1];
+} //RowToGridPoint()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+void Ifpack2_HypreStruct<Scalar,LocalOrdinal,GlobalOrdinal,Node>::CheckGlobalError(bool localError, const std::string& message) const{
+  int localErr = localError ? 1 : 0, globalErr;
+  Teuchos::reduceAll<int,int>(*A_->getComm(), Teuchos::REDUCE_MAX, 1, &localErr, &globalErr);
+  TEUCHOS_TEST_FOR_EXCEPTION(globalErr != 0, std::runtime_error,
+      Teuchos::typeName (*this) << message);
+} //CheckGlobalError()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+void Ifpack2_HypreStruct<Scalar,LocalOrdinal,GlobalOrdinal,Node>::initialize(){
+  const std::string timerName ("Ifpack2::HypreStruct::initialize");
+  Teuchos::RCP<Teuchos::Time> timer = Teuchos::TimeMonitor::lookupCounter (timerName);
+  if (timer.is_null ()) {
+    timer = Teuchos::TimeMonitor::getNewCounter (timerName);
+  }
+
+  TEUCHOS_TEST_FOR_EXCEPTION(Dim_ == 0, std::runtime_error,
+      Teuchos::typeName (*this) << "::initialize(): setParameters() must be called with the Grid Dimensions first.");
+  if(isInitialized()){
+    Destroy();
+  }
+
+  const double startTime = Teuchos::Time::wallTime();
+  { // Start timer here
+    Teuchos::TimeMonitor timeMon (*timer);
+
+    Teuchos::RCP<const map_type> rowMap = A_->getRowMap();
+    const size_t numRows = A_->getNodeNumRows();
+    if(!BoxGiven_){
+      if(numRows > 0){
+        RowToGridPoint(rowMap->getGlobalElement(0), BoxLower_);
+        RowToGridPoint(rowMap->getGlobalElement(numRows-1), BoxUpper_);
+      } else {
+        // An empty box
+        for(int d = 0; d < 3; d++){
+          BoxLower_[d] = 0;
+          BoxUpper_[d] = -1;
+        }
+      }
+    }
+
+    // The local rows have to be the points of the box, in hypre's order
+    size_t boxSize = 1;
+    for(int d = 0; d < 3; d++){
+      boxSize *= (BoxUpper_[d] >= BoxLower_[d] ? BoxUpper_[d] - BoxLower_[d] + 1 : 0);
+    }
+    bool badBox = (boxSize != numRows);
+    if(!badBox){
+      int point[3];
+      LocalOrdinal localRow = 0;
+      for(point[2] = BoxLower_[2]; point[2] <= BoxUpper_[2] && !badBox; point[2]++){
+        for(point[1] = BoxLower_[1]; point[1] <= BoxUpper_[1] && !badBox; point[1]++){
+          for(point[0] = BoxLower_[0]; point[0] <= BoxUpper_[0]; point[0]++, localRow++){
+            if(rowMap->getGlobalElement(localRow) != GridPointToRow(point)){
+              badBox = true;
+              break;
+            }
+          }
+        }
+      }
+    }
+    CheckGlobalError(badBox, "::initialize(): The local rows of some process are not the points of a single box of the grid in natural order.");
+
+    MPI_Comm comm = GetMpiComm();
+    HYPRE_StructGridCreate(comm, Dim_, &Grid_);
+    if(numRows > 0){
+      HYPRE_StructGridSetExtents(Grid_, BoxLower_, BoxUpper_);
+    }
+    HYPRE_StructGridAssemble(Grid_);
+
+    const int numEntries = StencilOffsets_.size() / Dim_;
+    HYPRE_StructStencilCreate(Dim_, numEntries, &Stencil_);
+    for(int e = 0; e < numEntries; e++){
+      HYPRE_StructStencilSetElement(Stencil_, e, &StencilOffsets_[e*Dim_]);
+    }
+
+    HYPRE_StructMatrixCreate(comm, Grid_, Stencil_, &HypreA_);
+    HYPRE_StructMatrixInitialize(HypreA_);
+
+    HYPRE_StructVectorCreate(comm, Grid_, &HypreB_);
+    HYPRE_StructVectorInitialize(HypreB_);
+    HYPRE_StructVectorAssemble(HypreB_);
+    HYPRE_StructVectorCreate(comm, Grid_, &HypreX_);
+    HYPRE_StructVectorInitialize(HypreX_);
+    HYPRE_StructVectorAssemble(HypreX_);
+  } // Stop timer here
+
+  isInitialized_ = true;
+  numInitialize_++;
+  initializeTime_ += Teuchos::Time::wallTime() - startTime;
+} //initialize()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+void Ifpack2_HypreStruct<Scalar,LocalOrdinal,GlobalOrdinal,Node>::compute(){
+  const std::string timerName ("Ifpack2::HypreStruct::compute");
+  Teuchos::RCP<Teuchos::Time> timer = Teuchos::TimeMonitor::lookupCounter (timerName);
+  if (timer.is_null ()) {
+    timer = Teuchos::TimeMonitor::getNewCounter (timerName);
+  }
+
+  if(isInitialized() == false){
+    initialize();
+  }
+
+  const double startTime = Teuchos::Time::wallTime();
+  { // Start timer here
+    Teuchos::TimeMonitor timeMon (*timer);
+
+    // Gather the coefficients of every row by stencil entry; hypre wants the entries of a point next to each other
+    const size_t numRows = A_->getNodeNumRows();
+    const int numEntries = StencilOffsets_.size() / Dim_;
+    std::vector<HYPRE_Complex> values(numRows * numEntries, 0.0);
+    Teuchos::RCP<const map_type> rowMap = A_->getRowMap();
+    Teuchos::RCP<const map_type> colMap = A_->getColMap();
+    Teuchos::Array<size_t> rowptr;
+    Teuchos::Array<LocalOrdinal> indices;
+    Teuchos::Array<Scalar> rowValues;
+    xSDKTrilinos::getLocalRowsCopy(*A_, static_cast<LocalOrdinal>(0), static_cast<LocalOrdinal>(numRows), rowptr, indices, rowValues);
+    bool offStencil = false;
+    for(size_t i = 0; i < numRows; i++){
+      int rowPoint[3], colPoint[3];
+      RowToGridPoint(rowMap->getGlobalElement(i), rowPoint);
+      for(size_t j = rowptr[i]; j < rowptr[i+1]; j++){
+        RowToGridPoint(colMap->getGlobalElement(indices[j]), colPoint);
+        int e = 0;
+        for(; e < numEntries; e++){
+          bool match = true;
+          for(int d = 0; d < Dim_; d++){
+            match = match && (colPoint[d] - rowPoint[d] == StencilOffsets_[e*Dim_+d]);
+          }
+          if(match) break;
+        }
+        if(e < numEntries){
+          values[i*numEntries + e] += static_cast<HYPRE_Complex>(rowValues[j]);
+        } else if(rowValues[j] != Teuchos::ScalarTraits<Scalar>::zero()){
+          offStencil = true;
+        }
+      }
+    }
+    CheckGlobalError(offStencil, "::compute(): The matrix has entries that are not covered by the stencil.");
+
+    if(numRows > 0){
+      std::vector<int> entries(numEntries);
+      for(int e = 0; e < numEntries; e++){
+        entries[e] = e;
+      }
+      HYPRE_StructMatrixSetBoxValues(HypreA_, BoxLower_, BoxUpper_, numEntries, &entries[0], &values[0]);
+    }
+    HYPRE_StructMatrixAssemble(HypreA_);
+
+    DestroySolver();
+    MPI_Comm comm = GetMpiComm();
+    if(SolverType_ == Hypre::PFMG){
+      HYPRE_StructPFMGCreate(comm, &Solver_);
+      HYPRE_StructPFMGSetMaxIter(Solver_, MaxIters_);
+      HYPRE_StructPFMGSetTol(Solver_, Tol_);
+      HYPRE_StructPFMGSetRelaxType(Solver_, RelaxType_);
+      HYPRE_StructPFMGSetNumPreRelax(Solver_, NumPreRelax_);
+      HYPRE_StructPFMGSetNumPostRelax(Solver_, NumPostRelax_);
+      HYPRE_StructPFMGSetPrintLevel(Solver_, PrintLevel_);
+      HYPRE_StructPFMGSetZeroGuess(Solver_);
+      HYPRE_StructPFMGSetup(Solver_, HypreA_, HypreB_, HypreX_);
+    } else {
+      HYPRE_StructSMGCreate(comm, &Solver_);
+      HYPRE_StructSMGSetMaxIter(Solver_, MaxIters_);
+      HYPRE_StructSMGSetTol(Solver_, Tol_);
+      HYPRE_StructSMGSetNumPreRelax(Solver_, NumPreRelax_);
+      HYPRE_StructSMGSetNumPostRelax(Solver_, NumPostRelax_);
+      HYPRE_StructSMGSetPrintLevel(Solver_, PrintLevel_);
+      HYPRE_StructSMGSetZeroGuess(Solver_);
+      HYPRE_StructSMGSetup(Solver_, HypreA_, HypreB_, HypreX_);
+    }
+    IsSolverCreated_ = true;
+  } // Stop timer here
+
+  isComputed_ = true;
+  numCompute_++;
+  computeTime_ += Teuchos::Time::wallTime() - startTime;
+} //compute()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+void Ifpack2_HypreStruct<Scalar,LocalOrdinal,GlobalOrdinal,Node>::apply(const multivector_type& X,
+                         multivector_type& Y,
+                         Teuchos::ETransp mode,
+                         Scalar alpha,
+                         Scalar beta) const
+{
+  const std::string timerName ("Ifpack2::HypreStruct::apply");
+  Teuchos::RCP<Teuchos::Time> timer = Teuchos::TimeMonitor::lookupCounter (timerName);
+  if (timer.is_null ()) {
+    timer = Teuchos::TimeMonitor::getNewCounter (timerName);
+  }
+
+  TEUCHOS_TEST_FOR_EXCEPTION(!isComputed(), std::runtime_error,
+         Teuchos::typeName (*this) << "::apply(): Preconditioner has not been computed.");
+
+  TEUCHOS_TEST_FOR_EXCEPTION(mode != Teuchos::NO_TRANS, std::runtime_error,
+         Teuchos::typeName (*this) << "::apply(): The transpose cannot be applied.");
+
+  TEUCHOS_TEST_FOR_EXCEPTION(!A_->getDomainMap()->isSameAs(*X.getMap()), std::runtime_error,
+      Teuchos::typeName (*this) << "::apply(): X's map must match A's domain map.");
+
+  TEUCHOS_TEST_FOR_EXCEPTION(!A_->getRangeMap()->isSameAs(*Y.getMap()), std::runtime_error,
+      Teuchos::typeName (*this) << "::apply(): Y's map must match A's range map.");
+
+  const size_t NumVectors = X.getNumVectors();
+  TEUCHOS_TEST_FOR_EXCEPTION(NumVectors != Y.getNumVectors(), std::runtime_error,
+       Teuchos::typeName (*this) << "::apply(): X and Y must have the same number of vectors.");
+
+  const double startTime = Teuchos::Time::wallTime();
+  { // Start timer here
+    Teuchos::TimeMonitor timeMon (*timer);
+
+    // hypre writes the result straight into Y unless it has to be scaled and added
+    const bool direct = (alpha == Teuchos::ScalarTraits<Scalar>::one() && beta == Teuchos::ScalarTraits<Scalar>::zero());
+    Teuchos::RCP<multivector_type> Z = direct ? Teuchos::rcpFromRef(Y) : Teuchos::rcp(new multivector_type(Y.getMap(), NumVectors, false));
+    const bool haveBox = (A_->getNodeNumRows() > 0);
+    const size_t numRows = A_->getNodeNumRows();
+    // Only used when Scalar is not the precision hypre was built with
+    Teuchos::Array<HYPRE_Complex> xBuffer, zBuffer;
+
+    for(size_t VecNum = 0; VecNum < NumVectors; VecNum++) {
+      Teuchos::ArrayRCP<const Scalar> XValues = X.getData(VecNum);
+      Teuchos::ArrayRCP<Scalar> ZValues = Z->getDataNonConst(VecNum);
+
+      // The local part of a vector is exactly the box, so it goes to hypre in one piece
+      if(haveBox){
+        const HYPRE_Complex* x = Hypre::ToHypreValues(XValues.get(), numRows, xBuffer);
+        HYPRE_StructVectorSetBoxValues(HypreB_, const_cast<int*>(BoxLower_), const_cast<int*>(BoxUpper_), const_cast<HYPRE_Complex*>(x));
+      }
+      HYPRE_StructVectorAssemble(HypreB_);
+      HYPRE_StructVectorSetConstantValues(HypreX_, 0.0);
+
+      int numIters = 0;
+      HYPRE_Real residual = -1.0;
+      if(SolverType_ == Hypre::PFMG){
+        HYPRE_StructPFMGSolve(Solver_, HypreA_, HypreB_, HypreX_);
+        HYPRE_StructPFMGGetNumIterations(Solver_, &numIters);
+        HYPRE_StructPFMGGetFinalRelativeResidualNorm(Solver_, &residual);
+      } else {
+        HYPRE_StructSMGSolve(Solver_, HypreA_, HypreB_, HypreX_);
+        HYPRE_StructSMGGetNumIterations(Solver_, &numIters);
+        HYPRE_StructSMGGetFinalRelativeResidualNorm(Solver_, &residual);
+      }
+      if(haveBox){
+        HYPRE_Complex* z = Hypre::HypreOutputValues(ZValues.get(), numRows, zBuffer);
+        HYPRE_StructVectorGetBoxValues(HypreX_, const_cast<int*>(BoxLower_), const_cast<int*>(BoxUpper_), z);
+        Hypre::FromHypreValues(z, ZValues.get(), numRows);
+      }
+
+      NumIterations_ = (VecNum == 0 ? numIters : std::max(NumIterations_, numIters));
+      FinalRelResidualNorm_ = (VecNum == 0 ? residual : std::max(FinalRelResidualNorm_, (double)residual));
+    }
+    if(!direct){
+      Y.update(alpha, *Z, beta);
+    }
+  } // Stop timer here
+
+  numApply_++;
+  applyTime_ += Teuchos::Time::wallTime() - startTime;
+} //apply()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+std::ostream& Ifpack2_HypreStruct<Scalar,LocalOrdinal,GlobalOrdinal,Node>::Print(std::ostream& os) const{
+  using std::endl;
+
+  if (!A_->getComm()->getRank()) {
+    os << endl;
+    os << "================================================================================" << endl;
+    os << "Ifpack2_HypreStruct: " << (SolverType_ == Hypre::PFMG ? "PFMG" : "SMG") << endl << endl;
+    os << "Using " << A_->getComm()->getSize() << " processors." << endl;
+    os << "Grid                             = " << GridDims_[0] << " x " << GridDims_[1];
+    if (Dim_ == 3)
+      os << " x " << GridDims_[2];
+    os << endl;
+    os << "Stencil entries                  = " << (Dim_ > 0 ? StencilOffsets_.size() / Dim_ : 0) << endl;
+    os << endl;
+    os << "Phase           # calls   Total Time (s)" << endl;
+    os << "-----           -------   --------------" << endl;
+    os << "initialize()    " << std::setw(5) << numInitialize_ << "  " << std::setw(15) << initializeTime_ << endl;
+    os << "compute()       " << std::setw(5) << numCompute_ << "  " << std::setw(15) << computeTime_ << endl;
+    os << "apply()         " << std::setw(5) << numApply_ << "  " << std::setw(15) << applyTime_ << endl;
+    if (numApply_ > 0) {
+      os << endl;
+      os << "Iterations in last apply         = " << NumIterations_ << endl;
+      os << "Final relative residual norm     = " << FinalRelResidualNorm_ << endl;
+    }
+    os << "================================================================================" << endl;
+    os << endl;
+  }
+  return os;
+} //Print()
+
+} // namespace Ifpack2
+
+#endif /* IFPACK2_HYPRESTRUCT_H */
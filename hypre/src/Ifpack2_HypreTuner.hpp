@@ -0,0 +1,341 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef IFPACK2_HYPRETUNER_H
+#define IFPACK2_HYPRETUNER_H
+
+#include "Ifpack2_Hypre.hpp"
+
+#include "Teuchos_Array.hpp"
+#include "Teuchos_CommHelpers.hpp"
+#include "Teuchos_ParameterList.hpp"
+#include "Teuchos_RCP.hpp"
+#include "Teuchos_Time.hpp"
+
+#include <iomanip>
+#include <vector>
+
+namespace Ifpack2 {
+
+//! One point of the BoomerAMG parameter space searched by Ifpack2_HypreTuner, together with what it cost to solve with it.
+struct HypreTuningCandidate{
+  //! Argument of HYPRE_BoomerAMGSetCoarsenType
+  int coarsenType;
+  //! Argument of HYPRE_BoomerAMGSetInterpType
+  int interpType;
+  //! Argument of HYPRE_BoomerAMGSetStrongThreshold
+  double strongThreshold;
+  //! Argument of HYPRE_BoomerAMGSetRelaxType
+  int relaxType;
+  //! Argument of HYPRE_BoomerAMGSetAggNumLevels
+  int aggressiveLevels;
+  //! Time spent in compute(), maximized over all processes
+  double setupTime;
+  //! Time spent in apply(), maximized over all processes
+  double solveTime;
+  //! Number of iterations of the solve
+  int numIterations;
+  //! Final relative residual norm of the solve
+  double residual;
+  //! Whether the solve reached the requested tolerance
+  bool converged;
+
+  //! Returns the time of the setup plus the time of the solve.
+  double getTimeToSolution() const{ return(setupTime + solveTime);}
+};
+
+//! Ifpack2_HypreTuner: searches BoomerAMG parameters for the fastest setup plus solve on a given matrix.
+
+/*!
+Class Ifpack2_HypreTuner runs compute() and a fixed solve with Ifpack2_Hypre for every combination of
+coarsening type, interpolation type, strong threshold, relaxation type and number of aggressive coarsening
+levels in the given parameter space, and records the time to solution of each.  The search stops early once
+the time budget is used up.  It is meant to be run offline, for instance on a single node with a
+representative matrix of a problem class, and the resulting ParameterList reused by Ifpack2_Hypre in production:
+
+     Ifpack2_HypreTuner<Scalar,LO,GO,Node> tuner(A);
+     tuner.setParameters(space);
+     tuner.tune();
+     Ifpack2_Hypre<Scalar,LO,GO,Node> prec(A);
+     prec.setParameters(*tuner.getBestParameters());
+
+The parameter space is given by the following entries, all optional:
+     Coarsen Types (Teuchos::Array<int>)        default 6, 8, 10 (Falgout, PMIS, HMIS)
+     Interp Types (Teuchos::Array<int>)         default 0, 6 (classical, extended+i)
+     Strong Thresholds (Teuchos::Array<double>) default 0.25, 0.5
+     Relax Types (Teuchos::Array<int>)          default 6 (hybrid symmetric Gauss-Seidel)
+     Aggressive Levels (Teuchos::Array<int>)    default 0, 1
+The solve is controlled by
+     Solver (Hypre_Solver)                      PCG (default) or GMRES preconditioned with one BoomerAMG V-cycle, or BoomerAMG alone
+     Tolerance (double)                         relative residual the solve must reach, default 1e-8
+     Maximum Iterations (int)                   default 200
+     Time Budget (double)                       seconds after which no new candidate is started, default 60
+     Maximum Candidates (int)                   largest number of candidates to try, default -1 (all of them)
+*/
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+class Ifpack2_HypreTuner{
+public:
+  typedef Tpetra::RowMatrix<Scalar,LocalOrdinal,GlobalOrdinal,Node> row_matrix_type;
+
+  //! Constructor
+  Ifpack2_HypreTuner(const Teuchos::RCP<const row_matrix_type>& A);
+
+  //! Set the parameter space and the solve options.
+  void setParameters(const Teuchos::ParameterList& list);
+
+  //! Try the candidates until the space or the budget is exhausted.
+  void tune();
+
+  //! Returns the Ifpack2_Hypre parameters of the candidate with the shortest time to solution.
+  /*! Candidates that did not converge are only chosen if none converged.  The list holds the solver, its
+      tolerance and iteration limit, and the tuned BoomerAMG values, all as plain entries, so it can be saved
+      and given to Ifpack2_Hypre::setParameters to repeat the tuned solve.
+  */
+  Teuchos::RCP<const Teuchos::ParameterList> getBestParameters() const;
+
+  //! Returns every candidate that was tried, in the order in which they were tried.
+  const std::vector<HypreTuningCandidate>& getCandidates() const{ return(Candidates_);}
+
+  //! Returns the index of the best candidate in getCandidates(), or -1 if tune() has not tried any.
+  int getBestCandidate() const{ return(BestCandidate_);}
+
+  //! Prints on stream the results of every candidate.
+  std::ostream& Print(std::ostream& os) const;
+
+private:
+  //! Returns the Ifpack2_Hypre parameters of a candidate; the BoomerAMG sublist is all that differs between candidates.
+  Teuchos::ParameterList CandidateParameters(const HypreTuningCandidate& candidate) const;
+
+  //! Pointer to the matrix being tuned for
+  Teuchos::RCP<const row_matrix_type> A_;
+  Teuchos::Array<int> CoarsenTypes_;
+  Teuchos::Array<int> InterpTypes_;
+  Teuchos::Array<double> StrongThresholds_;
+  Teuchos::Array<int> RelaxTypes_;
+  Teuchos::Array<int> AggressiveLevels_;
+  //! Which hypre solver performs the fixed solve
+  Hypre::Hypre_Solver SolverType_;
+  double Tolerance_;
+  int MaxIters_;
+  double TimeBudget_;
+  int MaxCandidates_;
+  std::vector<HypreTuningCandidate> Candidates_;
+  int BestCandidate_;
+};
+
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+Ifpack2_HypreTuner<Scalar,LocalOrdinal,GlobalOrdinal,Node>::Ifpack2_HypreTuner(const Teuchos::RCP<const row_matrix_type>& A):
+  A_(A),
+  CoarsenTypes_(Teuchos::tuple<int>(6, 8, 10)),
+  InterpTypes_(Teuchos::tuple<int>(0, 6)),
+  StrongThresholds_(Teuchos::tuple<double>(0.25, 0.5)),
+  RelaxTypes_(Teuchos::tuple<int>(6)),
+  AggressiveLevels_(Teuchos::tuple<int>(0, 1)),
+  SolverType_(Hypre::PCG),
+  Tolerance_(1e-8),
+  MaxIters_(200),
+  TimeBudget_(60.0),
+  MaxCandidates_(-1),
+  BestCandidate_(-1)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(A_.is_null(), std::invalid_argument,
+      "Ifpack2::Ifpack2_HypreTuner: The matrix must not be null.");
+} //Constructor
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+void Ifpack2_HypreTuner<Scalar,LocalOrdinal,GlobalOrdinal,Node>::setParameters(const Teuchos::ParameterList& list){
+  CoarsenTypes_ = list.get("Coarsen Types", CoarsenTypes_);
+  InterpTypes_ = list.get("Interp Types", InterpTypes_);
+  StrongThresholds_ = list.get("Strong Thresholds", StrongThresholds_);
+  RelaxTypes_ = list.get("Relax Types", RelaxTypes_);
+  AggressiveLevels_ = list.get("Aggressive Levels", AggressiveLevels_);
+  SolverType_ = list.get("Solver", SolverType_);
+  Tolerance_ = list.get("Tolerance", Tolerance_);
+  MaxIters_ = list.get("Maximum Iterations", MaxIters_);
+  TimeBudget_ = list.get("Time Budget", TimeBudget_);
+  MaxCandidates_ = list.get("Maximum Candidates", MaxCandidates_);
+
+  TEUCHOS_TEST_FOR_EXCEPTION(SolverType_ != Hypre::PCG && SolverType_ != Hypre::GMRES && SolverType_ != Hypre::BoomerAMG,
+      std::invalid_argument, "Ifpack2::Ifpack2_HypreTuner::setParameters: The Solver must be PCG, GMRES or BoomerAMG.");
+} //setParameters()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+Teuchos::ParameterList Ifpack2_HypreTuner<Scalar,LocalOrdinal,GlobalOrdinal,Node>::CandidateParameters(const HypreTuningCandidate& candidate) const{
+  Teuchos::ParameterList list("Ifpack2_Hypre");
+  list.set("SolveOrPrecondition", Hypre::Solver);
+  list.set("Solver", SolverType_);
+  list.set("Solver Tolerance", Tolerance_);
+  list.set("Solver Maximum Iterations", MaxIters_);
+  if(SolverType_ != Hypre::BoomerAMG){
+    list.set("Preconditioner", Hypre::BoomerAMG);
+    list.set("SetPreconditioner", true);
+  }
+
+  Teuchos::ParameterList& amgList = list.sublist("BoomerAMG");
+  amgList.set("Coarsen Type", candidate.coarsenType);
+  amgList.set("Interp Type", candidate.interpType);
+  amgList.set("Strong Threshold", candidate.strongThreshold);
+  amgList.set("Relax Type", candidate.relaxType);
+  amgList.set("Aggressive Levels", candidate.aggressiveLevels);
+  amgList.set("Print Level", 0);
+  if(SolverType_ != Hypre::BoomerAMG){
+    // One V-cycle per application of the preconditioner
+    amgList.set("Max Iterations", 1);
+    amgList.set("Tolerance", 0.0);
+  }
+  return list;
+} //CandidateParameters()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+void Ifpack2_HypreTuner<Scalar,LocalOrdinal,GlobalOrdinal,Node>::tune(){
+  typedef Tpetra::MultiVector<Scalar,LocalOrdinal,GlobalOrdinal,Node> MV;
+
+  Candidates_.clear();
+  BestCandidate_ = -1;
+
+  // Every candidate solves the same system, whose solution is all ones
+  MV X(A_->getDomainMap(), 1);
+  MV B(A_->getRangeMap(), 1);
+  X.putScalar(Teuchos::ScalarTraits<Scalar>::one());
+  A_->apply(X, B);
+
+  // The matrix is copied to hypre once and reused by every candidate
+  Ifpack2_Hypre<Scalar,LocalOrdinal,GlobalOrdinal,Node> prec(A_);
+  prec.initialize();
+
+  const double startTime = Teuchos::Time::wallTime();
+  for(int c = 0; c < CoarsenTypes_.size(); c++){
+  for(int i = 0; i < InterpTypes_.size(); i++){
+  for(int t = 0; t < StrongThresholds_.size(); t++){
+  for(int r = 0; r < RelaxTypes_.size(); r++){
+  for(int a = 0; a < AggressiveLevels_.size(); a++){
+    // Every process has to agree on when to stop, so the budget is checked against the slowest one
+    double localElapsed = Teuchos::Time::wallTime() - startTime, elapsed;
+    Teuchos::reduceAll<int,double>(*A_->getComm(), Teuchos::REDUCE_MAX, 1, &localElapsed, &elapsed);
+    if(elapsed >= TimeBudget_ || (MaxCandidates_ >= 0 && (int)Candidates_.size() >= MaxCandidates_)){
+      return;
+    }
+
+    HypreTuningCandidate candidate;
+    candidate.coarsenType = CoarsenTypes_[c];
+    candidate.interpType = InterpTypes_[i];
+    candidate.strongThreshold = StrongThresholds_[t];
+    candidate.relaxType = RelaxTypes_[r];
+    candidate.aggressiveLevels = AggressiveLevels_[a];
+
+    // The same list getBestParameters() returns, so the best solve can be repeated exactly
+    prec.setParameters(CandidateParameters(candidate));
+    prec.compute();
+    X.putScalar(Teuchos::ScalarTraits<Scalar>::zero());
+    prec.apply(B, X);
+
+    double localTimes[2], times[2];
+    localTimes[0] = prec.getComputeTimeStatistics().getLastTime();
+    localTimes[1] = prec.getApplyTimeStatistics().getLastTime();
+    Teuchos::reduceAll<int,double>(*A_->getComm(), Teuchos::REDUCE_MAX, 2, localTimes, times);
+    candidate.setupTime = times[0];
+    candidate.solveTime = times[1];
+    candidate.numIterations = prec.getNumIterations();
+    candidate.residual = prec.getFinalRelativeResidualNorm();
+    candidate.converged = (candidate.residual >= 0.0 && candidate.residual <= Tolerance_);
+
+    // A converged candidate always beats one that did not converge
+    if(BestCandidate_ < 0){
+      BestCandidate_ = 0;
+    } else {
+      const HypreTuningCandidate& best = Candidates_[BestCandidate_];
+      if((candidate.converged && !best.converged) ||
+         (candidate.converged == best.converged && candidate.getTimeToSolution() < best.getTimeToSolution())){
+        BestCandidate_ = Candidates_.size();
+      }
+    }
+    Candidates_.push_back(candidate);
+  }}}}}
+} //tune()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+Teuchos::RCP<const Teuchos::ParameterList> Ifpack2_HypreTuner<Scalar,LocalOrdinal,GlobalOrdinal,Node>::getBestParameters() const{
+  TEUCHOS_TEST_FOR_EXCEPTION(BestCandidate_ < 0, std::runtime_error,
+      "Ifpack2::Ifpack2_HypreTuner::getBestParameters: tune() has not tried any candidate.");
+  return Teuchos::rcp(new Teuchos::ParameterList(CandidateParameters(Candidates_[BestCandidate_])));
+} //getBestParameters()
+
+//==============================================================================
+template<class Scalar, class LocalOrdinal, class GlobalOrdinal, class Node>
+std::ostream& Ifpack2_HypreTuner<Scalar,LocalOrdinal,GlobalOrdinal,Node>::Print(std::ostream& os) const{
+  using std::endl;
+
+  if (!A_->getComm()->getRank()) {
+    os << endl;
+    os << "================================================================================" << endl;
+    os << "Ifpack2_HypreTuner: " << Candidates_.size() << " candidates" << endl << endl;
+    os << "Coarsen  Interp  Threshold  Relax  Aggr   Setup (s)   Solve (s)  Iters    Residual" << endl;
+    os << "-------  ------  ---------  -----  ----   ---------   ---------  -----    --------" << endl;
+    for (size_t i = 0; i < Candidates_.size(); i++) {
+      const HypreTuningCandidate& cand = Candidates_[i];
+      os << std::setw(7) << cand.coarsenType
+         << "  " << std::setw(6) << cand.interpType
+         << "  " << std::setw(9) << cand.strongThreshold
+         << "  " << std::setw(5) << cand.relaxType
+         << "  " << std::setw(4) << cand.aggressiveLevels
+         << "  " << std::setw(10) << cand.setupTime
+         << "  " << std::setw(10) << cand.solveTime
+         << "  " << std::setw(5) << cand.numIterations
+         << "  " << std::setw(10) << cand.residual
+         << ((int)i == BestCandidate_ ? "  <- best" : (cand.converged ? "" : "  (not converged)")) << endl;
+    }
+    os << "================================================================================" << endl;
+    os << endl;
+  }
+  return os;
+} //Print()
+
+} // namespace Ifpack2
+
+#endif /* IFPACK2_HYPRETUNER_H */
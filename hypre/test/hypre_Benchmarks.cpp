@@ -0,0 +1,240 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+//
+// This driver times Ifpack2_Hypre on the 2D or 3D Laplace operator and
+// writes the results as JSON, so that performance regressions show up
+// next to the unit tests.
+//
+#include "Ifpack2_Hypre.hpp"
+
+#include "Teuchos_CommandLineProcessor.hpp"
+#include "Teuchos_ParameterList.hpp"
+#include "Teuchos_StandardCatchMacros.hpp"
+#include "Teuchos_Time.hpp"
+
+#include "Tpetra_CrsMatrix.hpp"
+#include "Tpetra_DefaultPlatform.hpp"
+#include "Tpetra_MultiVector.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The times of the repetitions of one benchmark, each the slowest over all processes
+struct BenchmarkResult {
+  std::string name;
+  std::vector<double> seconds;
+};
+
+template<class Body>
+double timeOnce(const Teuchos::Comm<int>& comm, Body body)
+{
+  comm.barrier();
+  const double start = Teuchos::Time::wallTime();
+  body();
+  double local = Teuchos::Time::wallTime() - start, global;
+  Teuchos::reduceAll(comm, Teuchos::REDUCE_MAX, 1, &local, &global);
+  return global;
+}
+
+void writeJSON(std::ostream& out, const std::string& problem, int numProcs, long long numRows,
+               const std::vector<BenchmarkResult>& results)
+{
+  out << "{\n  \"benchmark\": \"HypreBenchmarks\",\n"
+      << "  \"problem\": \"" << problem << "\",\n"
+      << "  \"num_procs\": " << numProcs << ",\n"
+      << "  \"num_rows\": " << numRows << ",\n"
+      << "  \"results\": [\n";
+  for(size_t i = 0; i < results.size(); i++) {
+    const std::vector<double>& t = results[i].seconds;
+    double sum = 0;
+    for(size_t j = 0; j < t.size(); j++) sum += t[j];
+    out << "    {\"name\": \"" << results[i].name << "\", \"repetitions\": " << t.size()
+        << ", \"min_seconds\": " << *std::min_element(t.begin(), t.end())
+        << ", \"mean_seconds\": " << sum / t.size()
+        << ", \"max_seconds\": " << *std::max_element(t.begin(), t.end()) << "}"
+        << (i+1 < results.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+}
+
+// Creates the 5-point (nz == 1) or 7-point Laplace operator on an nx by ny by nz grid
+template<class Matrix>
+Teuchos::RCP<Matrix> createLaplacian(int nx, int ny, int nz, const Teuchos::RCP<const Teuchos::Comm<int> >& comm)
+{
+  typedef typename Matrix::scalar_type        Scalar;
+  typedef typename Matrix::global_ordinal_type GO;
+  typedef typename Matrix::map_type           Map;
+
+  Teuchos::RCP<const Map> map = Teuchos::rcp(new Map(nx*ny*nz,0,comm));
+  Teuchos::RCP<Matrix> A = Teuchos::rcp(new Matrix(map,7));
+  Teuchos::Array<GO> cols(7);
+  Teuchos::Array<Scalar> vals(7);
+  for(GO row = map->getMinGlobalIndex(); row <= map->getMaxGlobalIndex(); row++) {
+    const GO i = row % nx, j = (row / nx) % ny, k = row / (nx*ny);
+    size_t n = 0;
+    if(k > 0)    { cols[n] = row - nx*ny; vals[n++] = -1.0; }
+    if(j > 0)    { cols[n] = row - nx;    vals[n++] = -1.0; }
+    if(i > 0)    { cols[n] = row - 1;     vals[n++] = -1.0; }
+    cols[n] = row; vals[n++] = (nz > 1 ? 6.0 : 4.0);
+    if(i < nx-1) { cols[n] = row + 1;     vals[n++] = -1.0; }
+    if(j < ny-1) { cols[n] = row + nx;    vals[n++] = -1.0; }
+    if(k < nz-1) { cols[n] = row + nx*ny; vals[n++] = -1.0; }
+    A->insertGlobalValues(row,cols(0,n),vals(0,n));
+  }
+  A->fillComplete();
+  return A;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  typedef Tpetra::CrsMatrix<>::scalar_type          Scalar;
+  typedef Tpetra::CrsMatrix<>::local_ordinal_type   LO;
+  typedef Tpetra::CrsMatrix<>::global_ordinal_type  GO;
+  typedef Tpetra::CrsMatrix<>::node_type            Node;
+  typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node>      CrsMatrix;
+  typedef Tpetra::MultiVector<Scalar,LO,GO,Node>    MV;
+  typedef Ifpack2::Ifpack2_Hypre<Scalar,LO,GO,Node> Hypre;
+
+  using Teuchos::ParameterList;
+  using Teuchos::RCP;
+  using Teuchos::rcp;
+
+  Teuchos::oblackholestream blackhole;
+  Teuchos::GlobalMPISession mpiSession(&argc,&argv,&blackhole);
+  RCP<const Teuchos::Comm<int> > comm = Tpetra::DefaultPlatform::getDefaultPlatform().getComm();
+
+  //
+  // Get parameters from command-line processor
+  //
+  int nx = 100, ny = -1, nz = 1;
+  int repetitions = 5;
+  int solverIters = 10;
+  std::string jsonFile("HypreBenchmarks.json");
+  Teuchos::CommandLineProcessor cmdp(false,true);
+  cmdp.setOption("nx",&nx,"Number of grid points in x direction.");
+  cmdp.setOption("ny",&ny,"Number of grid points in y direction (default nx).");
+  cmdp.setOption("nz",&nz,"Number of grid points in z direction; 1 gives the 2D Laplacian.");
+  cmdp.setOption("repetitions",&repetitions,"Number of timed repetitions of each benchmark.");
+  cmdp.setOption("solver-iters",&solverIters,"Number of PCG iterations of each solve.");
+  cmdp.setOption("json",&jsonFile,"File the results are written to.");
+  if(cmdp.parse(argc,argv) != Teuchos::CommandLineProcessor::PARSE_SUCCESSFUL) {
+    return -1;
+  }
+  if(ny < 0) ny = nx;
+
+  bool success = false;
+  try {
+    RCP<CrsMatrix> A = createLaplacian<CrsMatrix>(nx,ny,nz,comm);
+    MV X(A->getDomainMap(),1), B(A->getRangeMap(),1,false);
+    B.randomize();
+
+    //
+    // One V-cycle of BoomerAMG as a preconditioner, and PCG preconditioned by it as a solver
+    //
+    ParameterList amgList;
+    amgList.set("SolveOrPrecondition", Ifpack2::Hypre::Prec);
+    amgList.set("Preconditioner", Ifpack2::Hypre::BoomerAMG);
+    amgList.sublist("BoomerAMG").set("Max Iterations", 1);
+    amgList.sublist("BoomerAMG").set("Tolerance", 0.0);
+
+    ParameterList pcgList(amgList);
+    pcgList.set("SolveOrPrecondition", Ifpack2::Hypre::Solver);
+    pcgList.set("Solver", Ifpack2::Hypre::PCG);
+    pcgList.set("SetPreconditioner", true);
+    RCP<Ifpack2::FunctionParameter> functs[2];
+    functs[0] = rcp(new Ifpack2::FunctionParameter(Ifpack2::Hypre::Solver, &HYPRE_PCGSetMaxIter, solverIters));
+    functs[1] = rcp(new Ifpack2::FunctionParameter(Ifpack2::Hypre::Solver, &HYPRE_PCGSetTol, 0.0));
+    pcgList.set("NumFunctions", 2);
+    pcgList.set<RCP<Ifpack2::FunctionParameter>*>("Functions", functs);
+
+    const std::string labels[2] = {"BoomerAMG", "PCG+BoomerAMG"};
+    const ParameterList* lists[2] = {&amgList, &pcgList};
+    std::vector<BenchmarkResult> results;
+    for(int config = 0; config < 2; config++) {
+      BenchmarkResult init, compute, apply;
+      init.name = "Ifpack2_Hypre::initialize/" + labels[config];
+      compute.name = "Ifpack2_Hypre::compute/" + labels[config];
+      apply.name = "Ifpack2_Hypre::apply/" + labels[config];
+
+      // The first repetition warms up
+      for(int rep = 0; rep <= repetitions; rep++) {
+        Hypre prec(A);
+        prec.setParameters(*lists[config]);
+        const double initTime = timeOnce(*comm, [&]() { prec.initialize(); });
+        const double computeTime = timeOnce(*comm, [&]() { prec.compute(); });
+        const double applyTime = timeOnce(*comm, [&]() { prec.apply(B,X); });
+        if(rep == 0) continue;
+        init.seconds.push_back(initTime);
+        compute.seconds.push_back(computeTime);
+        apply.seconds.push_back(applyTime);
+      }
+      results.push_back(init);
+      results.push_back(compute);
+      results.push_back(apply);
+    }
+
+    //
+    // Report the results
+    //
+    std::ostringstream problem;
+    problem << (nz > 1 ? "Laplace3D " : "Laplace2D ") << nx << "x" << ny;
+    if(nz > 1) problem << "x" << nz;
+    if(comm->getRank() == 0) {
+      std::ofstream out(jsonFile.c_str());
+      writeJSON(out,problem.str(),comm->getSize(),(long long)nx*ny*nz,results);
+      writeJSON(std::cout,problem.str(),comm->getSize(),(long long)nx*ny*nz,results);
+    }
+    success = true;
+  }
+  TEUCHOS_STANDARD_CATCH_STATEMENTS(true, std::cerr, success);
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -43,6 +43,8 @@
 
 #include "Ifpack2_ETIHelperMacros.h"
 #include "Ifpack2_Hypre.hpp"
+#include "Ifpack2_HypreStruct.hpp"
+#include "Ifpack2_HypreTuner.hpp"
 #include "Teuchos_Array.hpp"
 #include "Teuchos_Comm.hpp"
 #include "Teuchos_OrdinalTraits.hpp"
@@ -121,6 +123,62 @@ bool EquivalentVectors(const Tpetra::MultiVector<Scalar,LO,GO,Node> &X,
 }
 
 
+// Creates the 2D Laplace operator on an nx by nx grid with a contiguous row distribution,
+// uniform unless the number of local rows is given
+template<class Node>
+RCP<Tpetra::CrsMatrix<Scalar,LO,GO,Node> > CreateLaplace2D(const int nx, const RCP<const Comm<int> > &comm,
+                                                            const size_t numLocalRows = Teuchos::OrdinalTraits<size_t>::invalid())
+{
+  typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node>      Matrix;
+  typedef Tpetra::Map<LO,GO,Node>                   Map;
+
+  RCP<Map> map;
+  if(numLocalRows == Teuchos::OrdinalTraits<size_t>::invalid())
+    map = rcp(new Map(nx*nx,0,comm));
+  else
+    map = rcp(new Map(nx*nx,numLocalRows,0,comm));
+  RCP<Matrix> matrix = rcp(new Matrix(map,5));
+  for(LO i = 0; i<nx; i++)
+  {
+    for(LO j = 0; j<nx; j++)
+    {
+      GO row = i*nx+j;
+      if(!map->isNodeGlobalElement(row))
+        continue;
+
+      Array<GO> indices;
+      Array<Scalar> values;
+
+      if(i > 0)
+      {
+        indices.push_back(row - nx);
+        values.push_back(-1.0);
+      }
+      if(i < nx-1)
+      {
+        indices.push_back(row + nx);
+        values.push_back(-1.0);
+      }
+      indices.push_back(row);
+      values.push_back(4.0);
+      if(j > 0)
+      {
+        indices.push_back(row-1);
+        values.push_back(-1.0);
+      }
+      if(j < nx-1)
+      {
+        indices.push_back(row+1);
+        values.push_back(-1.0);
+      }
+      matrix->insertGlobalValues(row,indices,values);
+    }
+  }
+  matrix->fillComplete();
+  return matrix;
+}
+
+
 // Tests hypre interface's ability to initialize correctly
 TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( Ifpack_Hypre, Construct, Node ) {
   typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node>      Matrix;
@@ -549,6 +607,281 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( Ifpack_Hypre, NonContiguousRowMap, Node ) {
   TEST_EQUALITY(EquivalentVectors(X, B, tol*10*pow(10.0,numProcs)), true);
 }
 
+// Tests that compute() and apply() record per-call timings and estimate their flops
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( Ifpack_Hypre, FlopAccounting, Node ){
+  typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node>      Matrix;
+  typedef Tpetra::MultiVector<Scalar,LO,GO,Node>    MV;
+  typedef Ifpack2::Ifpack2_Hypre<Scalar,LO,GO,Node> Hypre;
+
+  // get a comm
+  RCP<const Comm<int> > comm =
+        Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+  RCP<Matrix> matrix = CreateLaplace2D<Node>(10, comm);
+
+  //
+  // Use BoomerAMG as a solver so the flops come from the hierarchy
+  //
+  Teuchos::ParameterList list("Preconditioner List");
+  RCP<FunctionParameter> functs[3];
+  functs[0] = rcp(new FunctionParameter(Solver, &HYPRE_BoomerAMGSetPrintLevel, 0));
+  functs[1] = rcp(new FunctionParameter(Solver, &HYPRE_BoomerAMGSetMaxIter, 5));
+  functs[2] = rcp(new FunctionParameter(Solver, &HYPRE_BoomerAMGSetTol, 0.0));
+  list.set("Solver", Ifpack2::Hypre::BoomerAMG);
+  list.set("SolveOrPrecondition", Solver);
+  list.set("NumFunctions", 3);
+  list.set<RCP<FunctionParameter>*>("Functions", functs);
+
+  Hypre preconditioner(matrix);
+  preconditioner.setParameters(list);
+  preconditioner.compute();
+  TEST_EQUALITY(preconditioner.getComputeTimeStatistics().getNumCalls(), 1);
+  TEST_EQUALITY(preconditioner.ComputeFlops() > 0.0, true);
+
+  MV X(preconditioner.getDomainMap(), 1);
+  MV B(preconditioner.getRangeMap(), 1);
+  B.randomize();
+  preconditioner.apply(B,X);
+  const double flopsAfterOneApply = preconditioner.ApplyInverseFlops();
+  TEST_EQUALITY(flopsAfterOneApply > 0.0, true);
+  preconditioner.apply(B,X);
+
+  // Five cycles per apply, so the second apply should cost as much as the first
+  TEST_FLOATING_EQUALITY(preconditioner.ApplyInverseFlops(), 2*flopsAfterOneApply, 1e-12);
+
+  const Ifpack2::CallTimeStatistics &stats = preconditioner.getApplyTimeStatistics();
+  TEST_EQUALITY(stats.getNumCalls(), 2);
+  TEST_EQUALITY(stats.getMinTime() <= stats.getAvgTime(), true);
+  TEST_EQUALITY(stats.getAvgTime() <= stats.getMaxTime(), true);
+  TEST_FLOATING_EQUALITY(stats.getTotalTime(), preconditioner.getApplyTime(), 1e-12);
+
+  int binnedCalls = 0;
+  for(int bin = 0; bin < Ifpack2::CallTimeStatistics::NumBins; bin++)
+    binnedCalls += stats.getBinCount(bin);
+  TEST_EQUALITY(binnedCalls, 2);
+}
+
+// Tests that the convergence of apply() and the BoomerAMG hierarchy are reported
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( Ifpack_Hypre, Statistics, Node ){
+  typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node>      Matrix;
+  typedef Tpetra::MultiVector<Scalar,LO,GO,Node>    MV;
+  typedef Ifpack2::Ifpack2_Hypre<Scalar,LO,GO,Node> Hypre;
+  const double tol = 1e-8;
+
+  // get a comm
+  RCP<const Comm<int> > comm =
+        Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+  RCP<Matrix> matrix = CreateLaplace2D<Node>(20, comm);
+
+  //
+  // PCG preconditioned with one BoomerAMG V-cycle
+  //
+  Teuchos::ParameterList list("Preconditioner List");
+  RCP<FunctionParameter> functs[6];
+  functs[0] = rcp(new FunctionParameter(Solver, &HYPRE_PCGSetMaxIter, 100));
+  functs[1] = rcp(new FunctionParameter(Solver, &HYPRE_PCGSetTol, tol));
+  functs[2] = rcp(new FunctionParameter(Solver, &HYPRE_PCGSetTwoNorm, 1));
+  functs[3] = rcp(new FunctionParameter(Prec, &HYPRE_BoomerAMGSetPrintLevel, 0));
+  functs[4] = rcp(new FunctionParameter(Prec, &HYPRE_BoomerAMGSetTol, 0.0));
+  functs[5] = rcp(new FunctionParameter(Prec, &HYPRE_BoomerAMGSetMaxIter, 1));
+  list.set("Solver", Ifpack2::Hypre::PCG);
+  list.set("Preconditioner", Ifpack2::Hypre::BoomerAMG);
+  list.set("SolveOrPrecondition", Solver);
+  list.set("SetPreconditioner", true);
+  list.set("NumFunctions", 6);
+  list.set<RCP<FunctionParameter>*>("Functions", functs);
+
+  Hypre preconditioner(matrix);
+  preconditioner.setParameters(list);
+  preconditioner.compute();
+
+  TEST_EQUALITY(preconditioner.getNumLevels() > 1, true);
+  TEST_EQUALITY(preconditioner.getOperatorComplexity() >= 1.0, true);
+  TEST_EQUALITY(preconditioner.getGridComplexity() >= 1.0, true);
+  TEST_EQUALITY(preconditioner.getCoarseGridSize() < matrix->getGlobalNumRows(), true);
+
+  MV X(preconditioner.getDomainMap(), 2);
+  MV B(preconditioner.getRangeMap(), 2);
+  B.randomize();
+  preconditioner.apply(B,X);
+
+  TEST_EQUALITY(preconditioner.getNumIterations() > 0, true);
+  TEST_EQUALITY(preconditioner.getFinalRelativeResidualNorm() >= 0.0, true);
+  TEST_EQUALITY(preconditioner.getFinalRelativeResidualNorm() <= tol, true);
+
+  RCP<const Teuchos::ParameterList> stats = preconditioner.getStatistics();
+  TEST_EQUALITY(stats->get<int>("Number of Iterations"), preconditioner.getNumIterations());
+  TEST_EQUALITY(stats->get<int>("Number of Levels"), preconditioner.getNumLevels());
+  TEST_EQUALITY((int)stats->get<Array<double> >("Rows Per Level").size(), preconditioner.getNumLevels());
+  TEST_EQUALITY(stats->get<double>("Average Convergence Factor") < 1.0, true);
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( Ifpack_Hypre, RecomputeAndChangeSolver, Node ){
+  typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node>      Matrix;
+  typedef Tpetra::MultiVector<Scalar,LO,GO,Node>    MV;
+  typedef Ifpack2::Ifpack2_Hypre<Scalar,LO,GO,Node> Hypre;
+  const double tol = 1e-8;
+
+  // get a comm
+  RCP<const Comm<int> > comm =
+        Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+  RCP<Matrix> matrix = CreateLaplace2D<Node>(20, comm);
+
+  //
+  // GMRES preconditioned with one BoomerAMG V-cycle
+  //
+  Teuchos::ParameterList list("Preconditioner List");
+  RCP<FunctionParameter> functs[5];
+  functs[0] = rcp(new FunctionParameter(Solver, &HYPRE_ParCSRGMRESSetMaxIter, 100));
+  functs[1] = rcp(new FunctionParameter(Solver, &HYPRE_ParCSRGMRESSetTol, tol));
+  functs[2] = rcp(new FunctionParameter(Prec, &HYPRE_BoomerAMGSetPrintLevel, 0));
+  functs[3] = rcp(new FunctionParameter(Prec, &HYPRE_BoomerAMGSetTol, 0.0));
+  functs[4] = rcp(new FunctionParameter(Prec, &HYPRE_BoomerAMGSetMaxIter, 1));
+  list.set("Solver", Ifpack2::Hypre::GMRES);
+  list.set("Preconditioner", Ifpack2::Hypre::BoomerAMG);
+  list.set("SolveOrPrecondition", Solver);
+  list.set("SetPreconditioner", true);
+  list.set("NumFunctions", 5);
+  list.set<RCP<FunctionParameter>*>("Functions", functs);
+
+  Hypre preconditioner(matrix);
+  preconditioner.setParameters(list);
+
+  MV X(preconditioner.getDomainMap(), 1);
+  MV B(preconditioner.getRangeMap(), 1);
+  B.randomize();
+
+  // The second compute reuses the hypre solver objects of the first
+  for(int i = 0; i < 2; i++){
+    preconditioner.compute();
+    X.putScalar(0.0);
+    preconditioner.apply(B,X);
+    TEST_EQUALITY(preconditioner.getNumIterations() > 0, true);
+    TEST_EQUALITY(preconditioner.getFinalRelativeResidualNorm() <= tol, true);
+  }
+
+  // Changing the solver type recreates the solver
+  functs[0] = rcp(new FunctionParameter(Solver, &HYPRE_ParCSRBiCGSTABSetMaxIter, 100));
+  functs[1] = rcp(new FunctionParameter(Solver, &HYPRE_ParCSRBiCGSTABSetTol, tol));
+  list.set("Solver", Ifpack2::Hypre::BiCGSTAB);
+  preconditioner.setParameters(list);
+  preconditioner.compute();
+  X.putScalar(0.0);
+  preconditioner.apply(B,X);
+  TEST_EQUALITY(preconditioner.getNumIterations() > 0, true);
+  TEST_EQUALITY(preconditioner.getFinalRelativeResidualNorm() <= tol, true);
+
+  // A type that cannot be used as a solver is rejected
+  list.set("Solver", Ifpack2::Hypre::Euclid);
+  list.set("NumFunctions", 0);
+  preconditioner.setParameters(list);
+  TEST_THROW(preconditioner.compute(), std::invalid_argument);
+
+  // As a preconditioner only BoomerAMG is created, so the solver type does not matter
+  list.set("SolveOrPrecondition", Prec);
+  preconditioner.setParameters(list);
+  preconditioner.compute();
+  X.putScalar(0.0);
+  preconditioner.apply(B,X);
+  TEST_EQUALITY(preconditioner.getNumIterations() > 0, true);
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( Ifpack_Hypre, Tuner, Node ){
+  typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node>           Matrix;
+  typedef Tpetra::MultiVector<Scalar,LO,GO,Node>         MV;
+  typedef Ifpack2::Ifpack2_Hypre<Scalar,LO,GO,Node>      Hypre;
+  typedef Ifpack2::Ifpack2_HypreTuner<Scalar,LO,GO,Node> Tuner;
+  const double tol = 1e-8;
+
+  // get a comm
+  RCP<const Comm<int> > comm =
+        Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+  RCP<Matrix> matrix = CreateLaplace2D<Node>(20, comm);
+
+  // Two candidates, solved with GMRES so that the solver and its settings have to be carried over
+  Teuchos::ParameterList space;
+  space.set("Coarsen Types", Teuchos::tuple<int>(8, 10));
+  space.set("Interp Types", Teuchos::tuple<int>(6));
+  space.set("Strong Thresholds", Teuchos::tuple<double>(0.25));
+  space.set("Aggressive Levels", Teuchos::tuple<int>(0));
+  space.set("Solver", Ifpack2::Hypre::GMRES);
+  space.set("Tolerance", tol);
+  space.set("Maximum Iterations", 100);
+
+  Tuner tuner(matrix);
+  TEST_THROW(tuner.getBestParameters(), std::runtime_error);
+  tuner.setParameters(space);
+  tuner.tune();
+  TEST_EQUALITY(tuner.getCandidates().size(), (size_t)2);
+  TEST_EQUALITY(tuner.getBestCandidate() >= 0, true);
+  const Ifpack2::HypreTuningCandidate& best = tuner.getCandidates()[tuner.getBestCandidate()];
+  TEST_EQUALITY(best.converged, true);
+
+  RCP<const Teuchos::ParameterList> bestList = tuner.getBestParameters();
+  TEST_EQUALITY(bestList->get<Ifpack2::Hypre::Hypre_Solver>("Solver"), Ifpack2::Hypre::GMRES);
+  TEST_EQUALITY(bestList->get<double>("Solver Tolerance"), tol);
+  TEST_EQUALITY(bestList->get<int>("Solver Maximum Iterations"), 100);
+  TEST_EQUALITY(bestList->sublist("BoomerAMG").get<int>("Coarsen Type"), best.coarsenType);
+  TEST_EQUALITY(bestList->isParameter("Functions"), false);
+
+  // The list alone repeats the tuned solve, on the system the tuner solved
+  MV X(matrix->getDomainMap(), 1), B(matrix->getRangeMap(), 1);
+  X.putScalar(1.0);
+  matrix->apply(X, B);
+  X.putScalar(0.0);
+  Hypre preconditioner(matrix);
+  preconditioner.setParameters(*bestList);
+  preconditioner.compute();
+  preconditioner.apply(B, X);
+  TEST_EQUALITY(preconditioner.getNumIterations(), best.numIterations);
+  TEST_EQUALITY(preconditioner.getFinalRelativeResidualNorm() <= tol, true);
+
+  // Solvers without a tolerance reject one
+  Teuchos::ParameterList list(*bestList);
+  list.set("Solver", Ifpack2::Hypre::Euclid);
+  TEST_THROW(preconditioner.setParameters(list), std::invalid_argument);
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( Ifpack_Hypre, StructPFMG, Node ){
+  typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node>            Matrix;
+  typedef Tpetra::MultiVector<Scalar,LO,GO,Node>          MV;
+  typedef Ifpack2::Ifpack2_HypreStruct<Scalar,LO,GO,Node> HypreStruct;
+  const int nx = 24;
+  const double tol = 1e-8;
+
+  // get a comm
+  RCP<const Comm<int> > comm =
+        Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+
+  // Every process owns a slab of whole grid lines, which is a box
+  const int rank = comm->getRank(), size = comm->getSize();
+  const int firstLine = (rank * nx) / size, lastLine = ((rank+1) * nx) / size;
+  RCP<Matrix> matrix = CreateLaplace2D<Node>(nx, comm, (lastLine - firstLine) * nx);
+
+  MV trueX(matrix->getDomainMap(), 2);
+  MV B(matrix->getRangeMap(), 2);
+  trueX.randomize();
+  matrix->apply(trueX, B);
+
+  for(int solver = Ifpack2::Hypre::PFMG; solver <= Ifpack2::Hypre::SMG; solver++){
+    Teuchos::ParameterList list("Preconditioner List");
+    list.set("Grid Dimensions", Array<int>(Teuchos::tuple<int>(nx, nx)));
+    list.set("Solver", (Ifpack2::Hypre::Hypre_StructSolver) solver);
+    list.set("Max Iterations", 50);
+    list.set("Tolerance", tol);
+
+    HypreStruct preconditioner(matrix);
+    preconditioner.setParameters(list);
+    preconditioner.compute();
+
+    MV X(matrix->getDomainMap(), 2);
+    preconditioner.apply(B, X);
+
+    TEST_EQUALITY(preconditioner.getNumIterations() > 0, true);
+    TEST_EQUALITY(preconditioner.getFinalRelativeResidualNorm() <= tol, true);
+    TEST_EQUALITY(EquivalentVectors(X, trueX, 1e-5), true);
+  }
+}
+
 // Define typedefs that make the Tpetra macros work.
 IFPACK2_ETI_MANGLING_TYPEDEFS()
 
@@ -559,7 +892,12 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( Ifpack_Hypre, ParameterList, NT ) \
 TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( Ifpack_Hypre, Ifpack, NT ) \
 TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( Ifpack_Hypre, DiagonalMatrixInOrder, NT ) \
 TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( Ifpack_Hypre, DiagonalMatrixOutOfOrder, NT ) \
-TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( Ifpack_Hypre, NonContiguousRowMap, NT )
+TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( Ifpack_Hypre, NonContiguousRowMap, NT ) \
+TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( Ifpack_Hypre, FlopAccounting, NT ) \
+TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( Ifpack_Hypre, Statistics, NT ) \
+TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( Ifpack_Hypre, RecomputeAndChangeSolver, NT ) \
+TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( Ifpack_Hypre, Tuner, NT ) \
+TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( Ifpack_Hypre, StructPFMG, NT )
 
 // Ifpack2's ETI will instantiate the unit test for all enabled type
 // combinations.
@@ -59,6 +59,7 @@
 #include "petscksp.h"
 #include "Tpetra_ConfigDefs.hpp"
 #include "Tpetra_PETScAIJMatrix.hpp"
+#include "Tpetra_PETScPC.hpp"
 #include "Tpetra_Vector.hpp"
 #include "Tpetra_Map.hpp"
 #include "BelosPseudoBlockCGSolMgr.hpp"
@@ -83,8 +84,6 @@
   typedef Belos::LinearProblem<Scalar,MV,OP>                               LP;
   typedef Belos::PseudoBlockCGSolMgr<Scalar,MV,OP>                         SolMgr;
 
-PetscErrorCode ShellApplyML(PC pc,Vec x,Vec y);
-
 int main(int argc,char **args)
 {
   Vec                   x,b;            /* approx solution, RHS  */
@@ -234,9 +233,7 @@ int main(int argc,char **args)
   // Wrap the ML preconditioner as a PETSc shell preconditioner.
   //
   ierr = KSPGetPC(ksp,&pc);CHKERRQ(ierr);
-  ierr = PCSetType(pc,PCSHELL);CHKERRQ(ierr);
-  ierr = PCShellSetApply(pc,ShellApplyML);CHKERRQ(ierr);
-  ierr = PCShellSetContext(pc,(void*)Prec.get());CHKERRQ(ierr);
+  ierr = xSDKTrilinos::createPETScPCFromTpetraOperator<Scalar,LO,GO,Node>(pc,Prec);CHKERRQ(ierr);
   ierr = PCShellSetName(pc,"MueLu AMG");CHKERRQ(ierr); 
 
   //
@@ -274,51 +271,6 @@ int main(int argc,char **args)
   return EXIT_SUCCESS;
 } /*main*/
 
-/* ***************************************************************** */
-
-PetscErrorCode ShellApplyML(PC pc,Vec x,Vec y)
-{
-  PetscErrorCode  ierr;
-  MueLuOp *mlp = 0;
-  void* ctx;
-
-  ierr = PCShellGetContext(pc,&ctx); CHKERRQ(ierr);  
-  mlp = (MueLuOp*)ctx;
-
-  /* Wrap x and y as Tpetra_Vectors. */
-  PetscInt length;
-  ierr = VecGetLocalSize(x,&length);CHKERRQ(ierr);
-  const PetscScalar *xvals;
-  PetscScalar *yvals;
-
-  ierr = VecGetArrayRead(x,&xvals);CHKERRQ(ierr);
-  ierr = VecGetArray(y,&yvals);CHKERRQ(ierr);
-
-  ArrayView<const PetscScalar> xView(xvals,length);
-  ArrayView<PetscScalar> yView(yvals,length);
-
-  Vector tpetraX(mlp->getDomainMap(),xView);
-  Vector tpetraY(mlp->getDomainMap(),yView);
-
-  /* Apply ML. */
-  mlp->apply(tpetraX,tpetraY);
-
-  /* Rip the data out of tpetra vectors */
-  Teuchos::ArrayRCP<const Scalar> tpetraXData = tpetraX.getData();
-  Teuchos::ArrayRCP<const Scalar> tpetraYData = tpetraY.getData();
-
-  for(int i=0; i< tpetraYData.size(); i++)
-  {
-    yvals[i] = tpetraYData[i];
-  }
-  
-  /* Clean up and return. */
-  ierr = VecRestoreArrayRead(x,&xvals);CHKERRQ(ierr);
-  ierr = VecRestoreArray(y,&yvals);CHKERRQ(ierr);
-
-  return 0;
-} /*ShellApplyML*/
-
 /*--- Trilinos example metadata
 Categories: iterative solvers, preconditioners, external interfaces
 Topics: Solve a linear system
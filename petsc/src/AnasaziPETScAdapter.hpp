@@ -0,0 +1,178 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef ANASAZI_PETSC_ADAPTER_HPP
+#define ANASAZI_PETSC_ADAPTER_HPP
+
+/*! \file AnasaziPETScAdapter.hpp
+    \brief Lets Anasazi eigensolvers run directly on PETSc Vecs and Mats.
+*/
+
+#include "xSDKTrilinos_config.hpp"
+#include "BelosPETScAdapter.hpp"
+
+#include "AnasaziConfigDefs.hpp"
+#include "AnasaziMultiVecTraits.hpp"
+#include "AnasaziOperatorTraits.hpp"
+#include "AnasaziTypes.hpp"
+#ifdef HAVE_ANASAZI_TSQR
+#  include "AnasaziStubTsqrAdapter.hpp"
+#endif // HAVE_ANASAZI_TSQR
+
+namespace Anasazi {
+
+/*! \brief Specialization of MultiVecTraits for Belos::PETScMultiVec.
+
+  The multivector is the one the Belos adapter uses, so Belos and Anasazi can share PETSc data.
+  Block orthogonalization, MvTransMv followed by MvTimesMatAddMv, is one local GEMM and one
+  reduction each when the columns are contiguous, as they are in every multivector Anasazi clones.
+  Anasazi solvers such as LOBPCG or BlockKrylovSchur run with Belos::PETScMultiVec and Mat.
+*/
+template<>
+class MultiVecTraits<PetscScalar, Belos::PETScMultiVec> {
+private:
+  typedef Belos::PETScMultiVec MV;
+  typedef Teuchos::SerialDenseMatrix<int,PetscScalar> dense_matrix_type;
+  typedef Teuchos::ScalarTraits<PetscScalar>::magnitudeType magnitude_type;
+
+  static std::vector<int> range(const Teuchos::Range1D& index)
+  {
+    std::vector<int> ind(index.size());
+    for(int j=0; j < index.size(); j++) ind[j] = index.lbound() + j;
+    return ind;
+  }
+
+public:
+  static Teuchos::RCP<MV> Clone(const MV& mv, const int numvecs)
+  { return Teuchos::rcp(mv.clone(numvecs)); }
+
+  static Teuchos::RCP<MV> CloneCopy(const MV& mv)
+  { return CloneCopy(mv, range(Teuchos::Range1D(0, mv.getNumVectors()-1))); }
+
+  static Teuchos::RCP<MV> CloneCopy(const MV& mv, const std::vector<int>& index)
+  { return Teuchos::rcp(mv.cloneCopy(index)); }
+
+  static Teuchos::RCP<MV> CloneCopy(const MV& mv, const Teuchos::Range1D& index)
+  { return CloneCopy(mv, range(index)); }
+
+  static Teuchos::RCP<MV> CloneViewNonConst(MV& mv, const std::vector<int>& index)
+  { return Teuchos::rcp(mv.cloneView(index)); }
+
+  static Teuchos::RCP<MV> CloneViewNonConst(MV& mv, const Teuchos::Range1D& index)
+  { return CloneViewNonConst(mv, range(index)); }
+
+  static Teuchos::RCP<const MV> CloneView(const MV& mv, const std::vector<int>& index)
+  { return Teuchos::rcp(mv.cloneView(index)); }
+
+  static Teuchos::RCP<const MV> CloneView(const MV& mv, const Teuchos::Range1D& index)
+  { return CloneView(mv, range(index)); }
+
+  static ptrdiff_t GetGlobalLength(const MV& mv)
+  { return mv.getGlobalLength(); }
+
+  static int GetNumberVecs(const MV& mv)
+  { return mv.getNumVectors(); }
+
+  static bool HasConstantStride(const MV& mv)
+  { return mv.isConstantStride(); }
+
+  static void MvTimesMatAddMv(PetscScalar alpha, const MV& A, const dense_matrix_type& B, PetscScalar beta, MV& mv)
+  { mv.timesMatAddMv(alpha, A, B, beta); }
+
+  static void MvAddMv(PetscScalar alpha, const MV& A, PetscScalar beta, const MV& B, MV& mv)
+  { mv.addMv(alpha, A, beta, B); }
+
+  static void MvScale(MV& mv, PetscScalar alpha)
+  { mv.scale(std::vector<PetscScalar>(1, alpha)); }
+
+  static void MvScale(MV& mv, const std::vector<PetscScalar>& alphas)
+  { mv.scale(alphas); }
+
+  static void MvTransMv(PetscScalar alpha, const MV& A, const MV& mv, dense_matrix_type& B)
+  { mv.transMv(alpha, A, B); }
+
+  static void MvDot(const MV& mv, const MV& A, std::vector<PetscScalar>& b)
+  { mv.dot(A, b); }
+
+  static void MvNorm(const MV& mv, std::vector<magnitude_type>& normvec)
+  { mv.norm(normvec, Belos::TwoNorm); }
+
+  static void SetBlock(const MV& A, const std::vector<int>& index, MV& mv)
+  { mv.setBlock(A, index); }
+
+  static void SetBlock(const MV& A, const Teuchos::Range1D& index, MV& mv)
+  { mv.setBlock(A, range(index)); }
+
+  static void Assign(const MV& A, MV& mv)
+  { mv.setBlock(A, range(Teuchos::Range1D(0, A.getNumVectors()-1))); }
+
+  static void MvRandom(MV& mv)
+  { mv.random(); }
+
+  static void MvInit(MV& mv, PetscScalar alpha = Teuchos::ScalarTraits<PetscScalar>::zero())
+  { mv.init(alpha); }
+
+  static void MvPrint(const MV& mv, std::ostream& os)
+  { mv.print(os); }
+
+#ifdef HAVE_ANASAZI_TSQR
+  typedef Anasazi::details::StubTsqrAdapter<MV> tsqr_adaptor_type;
+#endif // HAVE_ANASAZI_TSQR
+};
+
+
+
+/*! \brief Specialization of OperatorTraits for PETSc matrices applied to Belos::PETScMultiVec.
+
+  Any Mat can be used, including shell and matrix-free ones.
+*/
+template<>
+class OperatorTraits<PetscScalar, Belos::PETScMultiVec, Mat> {
+public:
+  static void Apply(const Mat& Op, const Belos::PETScMultiVec& x, Belos::PETScMultiVec& y)
+  { Belos::OperatorTraits<PetscScalar, Belos::PETScMultiVec, Mat>::Apply(Op, x, y); }
+};
+
+} // namespace Anasazi
+
+#endif // ANASAZI_PETSC_ADAPTER_HPP
@@ -0,0 +1,710 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef BELOS_PETSC_ADAPTER_HPP
+#define BELOS_PETSC_ADAPTER_HPP
+
+/*! \file BelosPETScAdapter.hpp
+    \brief Lets Belos solvers run directly on PETSc Vecs and Mats.
+*/
+
+#include "xSDKTrilinos_config.hpp"
+
+#include "BelosConfigDefs.hpp"
+#include "BelosMultiVecTraits.hpp"
+#include "BelosOperatorTraits.hpp"
+#include "BelosTypes.hpp"
+#ifdef HAVE_BELOS_TSQR
+#  include "BelosStubTsqrAdapter.hpp"
+#endif // HAVE_BELOS_TSQR
+
+#include "Teuchos_Assert.hpp"
+#include "Teuchos_BLAS.hpp"
+#include "Teuchos_RCP.hpp"
+#include "Teuchos_Range1D.hpp"
+#include "Teuchos_SerialDenseMatrix.hpp"
+
+//Petsc headers.
+#include "petscmat.h"
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace Belos {
+
+/*! \class Belos::PETScMultiVec
+  \brief A multivector whose columns are PETSc Vecs, for use with Belos::MultiVecTraits.
+
+  The columns may be existing Vecs, e.g. a PETSc right-hand side and solution, or are allocated by
+  clone() one after another in a single array.  In the latter case the block operations Belos uses to
+  orthogonalize and update its bases, MvTransMv and MvTimesMatAddMv, are one local GEMM each, and
+  the inner products of all columns share one reduction.  Views share the Vecs of the multivector
+  they were taken from.
+*/
+class PETScMultiVec {
+public:
+  typedef PetscScalar scalar_type;
+  typedef Teuchos::ScalarTraits<PetscScalar>::magnitudeType magnitude_type;
+  typedef Teuchos::SerialDenseMatrix<int,PetscScalar> dense_matrix_type;
+
+  //! @name Constructors/Destructor
+  //@{
+
+  //! Wrap a single Vec; the multivector keeps a reference to it.
+  explicit PETScMultiVec(Vec v) { setColumns(std::vector<Vec>(1,v)); };
+
+  //! Wrap the given Vecs as the columns; the multivector keeps references to them.
+  explicit PETScMultiVec(const std::vector<Vec>& vecs) { setColumns(vecs); };
+
+  //! Allocate numVecs columns with the layout of v, stored one after another in one array.
+  PETScMultiVec(Vec v, int numVecs);
+
+  //! Destructor
+  ~PETScMultiVec();
+  //@}
+
+  //! @name Attribute methods
+  //@{
+
+  //! The number of columns.
+  int getNumVectors() const { return vecs_.size(); };
+
+  //! Column j.
+  Vec getVec(int j) const { return vecs_[j]; };
+
+  //! The global number of rows.
+  PetscInt getGlobalLength() const;
+
+  //! Whether the columns are stored one after another, with the local length as stride.
+  bool isConstantStride() const;
+  //@}
+
+  //! @name Belos::MultiVecTraits operations
+  //@{
+
+  //! A new multivector with numVecs columns of the same layout.
+  PETScMultiVec* clone(int numVecs) const { return new PETScMultiVec(vecs_[0], numVecs); };
+
+  //! A new multivector holding a copy of the given columns.
+  PETScMultiVec* cloneCopy(const std::vector<int>& index) const;
+
+  //! A multivector sharing the given columns.
+  PETScMultiVec* cloneView(const std::vector<int>& index) const;
+
+  //! this = beta*this + alpha*A*B
+  void timesMatAddMv(PetscScalar alpha, const PETScMultiVec& A, const dense_matrix_type& B, PetscScalar beta);
+
+  //! this = alpha*A + beta*B
+  void addMv(PetscScalar alpha, const PETScMultiVec& A, PetscScalar beta, const PETScMultiVec& B);
+
+  //! Scale column j by alphas[j], or every column by alphas[0] if there is only one.
+  void scale(const std::vector<PetscScalar>& alphas);
+
+  //! B = alpha*A^H*this
+  void transMv(PetscScalar alpha, const PETScMultiVec& A, dense_matrix_type& B) const;
+
+  //! b[j] = A_j^H*this_j
+  void dot(const PETScMultiVec& A, std::vector<PetscScalar>& b) const;
+
+  //! The norms of the columns.
+  void norm(std::vector<magnitude_type>& normvec, NormType type) const;
+
+  //! Copy the columns of A into the columns index of this.
+  void setBlock(const PETScMultiVec& A, const std::vector<int>& index);
+
+  //! Fill the columns with random values.
+  void random();
+
+  //! Set every entry to alpha.
+  void init(PetscScalar alpha);
+
+  //! Print the local entries of every column.
+  void print(std::ostream& os) const;
+  //@}
+
+private:
+  //! Copy constructor (not accessible to users).
+  PETScMultiVec(const PETScMultiVec &);
+
+  void setColumns(const std::vector<Vec>& vecs);
+
+  //! The local arrays of the columns, from VecGetArrayRead.
+  PetscErrorCode getArrays(std::vector<const PetscScalar*>& arrays) const;
+  PetscErrorCode restoreArrays(std::vector<const PetscScalar*>& arrays) const;
+
+  //! The local arrays of the columns, from VecGetArray, so that VecRestoreArray marks the columns changed.
+  PetscErrorCode getArrays(std::vector<PetscScalar*>& arrays);
+  PetscErrorCode restoreArrays(std::vector<PetscScalar*>& arrays);
+
+  //! Whether arrays are one after another with the local length as stride.
+  template<class T>
+  bool isConstantStride(const std::vector<T*>& arrays) const;
+
+  //! Whether any column of other is also a column of this multivector.
+  bool sharesVecs(const PETScMultiVec& other) const;
+
+  PetscInt getLocalLength() const;
+
+  std::vector<Vec> vecs_;
+};
+
+
+
+inline PETScMultiVec::PETScMultiVec(Vec v, int numVecs)
+{
+  PetscErrorCode ierr;
+  MPI_Comm comm;
+  PetscInt localLength, globalLength;
+  ierr = PetscObjectGetComm((PetscObject)v,&comm); CHKERRV(ierr);
+  ierr = VecGetLocalSize(v,&localLength); CHKERRV(ierr);
+  ierr = VecGetSize(v,&globalLength); CHKERRV(ierr);
+
+  // The columns view one Vec holding all of them, which they keep alive between them
+  Vec storage;
+  PetscScalar* data;
+  ierr = VecCreateMPI(comm,localLength*numVecs,PETSC_DETERMINE,&storage); CHKERRV(ierr);
+  ierr = VecGetArray(storage,&data); CHKERRV(ierr);
+  vecs_.resize(numVecs);
+  for(int j=0; j < numVecs; j++) {
+    ierr = VecCreateMPIWithArray(comm,1,localLength,globalLength,data+j*localLength,&vecs_[j]); CHKERRV(ierr);
+    ierr = PetscObjectCompose((PetscObject)vecs_[j],"xSDKTrilinos_PETScMultiVecStorage",(PetscObject)storage); CHKERRV(ierr);
+  }
+  ierr = VecRestoreArray(storage,&data); CHKERRV(ierr);
+  ierr = VecDestroy(&storage); CHKERRV(ierr);
+}
+
+
+
+inline PETScMultiVec::~PETScMultiVec()
+{
+  // Multivectors may outlive PetscFinalize, after which there is nothing left to free
+  PetscBool finalized = PETSC_TRUE;
+  PetscFinalized(&finalized);
+  if(finalized)
+    return;
+
+  for(size_t j=0; j < vecs_.size(); j++)
+    VecDestroy(&vecs_[j]);
+}
+
+
+
+inline void PETScMultiVec::setColumns(const std::vector<Vec>& vecs)
+{
+  PetscErrorCode ierr;
+  vecs_ = vecs;
+  for(size_t j=0; j < vecs_.size(); j++) {
+    ierr = PetscObjectReference((PetscObject)vecs_[j]); CHKERRV(ierr);
+  }
+}
+
+
+
+inline PetscInt PETScMultiVec::getGlobalLength() const
+{
+  PetscErrorCode ierr;
+  PetscInt n;
+  ierr = VecGetSize(vecs_[0],&n); CHKERRQ(ierr);
+  return n;
+}
+
+
+
+inline PetscInt PETScMultiVec::getLocalLength() const
+{
+  PetscErrorCode ierr;
+  PetscInt n;
+  ierr = VecGetLocalSize(vecs_[0],&n); CHKERRQ(ierr);
+  return n;
+}
+
+
+
+inline PetscErrorCode PETScMultiVec::getArrays(std::vector<const PetscScalar*>& arrays) const
+{
+  PetscErrorCode ierr;
+  arrays.resize(vecs_.size());
+  for(size_t j=0; j < vecs_.size(); j++) {
+    ierr = VecGetArrayRead(vecs_[j],&arrays[j]); CHKERRQ(ierr);
+  }
+  return 0;
+}
+
+
+
+inline PetscErrorCode PETScMultiVec::restoreArrays(std::vector<const PetscScalar*>& arrays) const
+{
+  PetscErrorCode ierr;
+  for(size_t j=0; j < vecs_.size(); j++) {
+    ierr = VecRestoreArrayRead(vecs_[j],&arrays[j]); CHKERRQ(ierr);
+  }
+  return 0;
+}
+
+
+
+inline PetscErrorCode PETScMultiVec::getArrays(std::vector<PetscScalar*>& arrays)
+{
+  PetscErrorCode ierr;
+  arrays.resize(vecs_.size());
+  for(size_t j=0; j < vecs_.size(); j++) {
+    ierr = VecGetArray(vecs_[j],&arrays[j]); CHKERRQ(ierr);
+  }
+  return 0;
+}
+
+
+
+inline PetscErrorCode PETScMultiVec::restoreArrays(std::vector<PetscScalar*>& arrays)
+{
+  PetscErrorCode ierr;
+  for(size_t j=0; j < vecs_.size(); j++) {
+    ierr = VecRestoreArray(vecs_[j],&arrays[j]); CHKERRQ(ierr);
+  }
+  return 0;
+}
+
+
+
+template<class T>
+bool PETScMultiVec::isConstantStride(const std::vector<T*>& arrays) const
+{
+  if(arrays.size() < 2)
+    return true;
+  const PetscInt n = getLocalLength();
+  for(size_t j=1; j < arrays.size(); j++)
+    if(arrays[j] != arrays[0] + j*n) return false;
+  return true;
+}
+
+
+
+inline bool PETScMultiVec::isConstantStride() const
+{
+  std::vector<const PetscScalar*> arrays;
+  getArrays(arrays);
+  const bool result = isConstantStride(arrays);
+  restoreArrays(arrays);
+  return result;
+}
+
+
+
+inline bool PETScMultiVec::sharesVecs(const PETScMultiVec& other) const
+{
+  for(size_t j=0; j < other.vecs_.size(); j++)
+    if(std::find(vecs_.begin(), vecs_.end(), other.vecs_[j]) != vecs_.end()) return true;
+  return false;
+}
+
+
+
+inline PETScMultiVec* PETScMultiVec::cloneCopy(const std::vector<int>& index) const
+{
+  PetscErrorCode ierr;
+  PETScMultiVec* copy = new PETScMultiVec(vecs_[0], index.size());
+  for(size_t j=0; j < index.size(); j++) {
+    ierr = VecCopy(vecs_[index[j]],copy->vecs_[j]); CHKERRCONTINUE(ierr);
+  }
+  return copy;
+}
+
+
+
+inline PETScMultiVec* PETScMultiVec::cloneView(const std::vector<int>& index) const
+{
+  std::vector<Vec> columns(index.size());
+  for(size_t j=0; j < index.size(); j++)
+    columns[j] = vecs_[index[j]];
+  return new PETScMultiVec(columns);
+}
+
+
+
+//! this = beta*this + alpha*A*B
+inline void PETScMultiVec::timesMatAddMv(PetscScalar alpha, const PETScMultiVec& A, const dense_matrix_type& B, PetscScalar beta)
+{
+  PetscErrorCode ierr;
+  if(getNumVectors() == 0)
+    return;
+  const PetscInt n = getLocalLength();
+  const int numA = A.getNumVectors(), numVecs = getNumVectors();
+
+  // A shared column would be read while it is updated, and PETSc does not allow
+  // VecGetArrayRead and VecGetArray on the same Vec at once, so update from a copy of A
+  if(sharesVecs(A)) {
+    std::vector<int> index(numA);
+    for(int i=0; i < numA; i++)
+      index[i] = i;
+    Teuchos::RCP<const PETScMultiVec> copyOfA = Teuchos::rcp(A.cloneCopy(index));
+    timesMatAddMv(alpha, *copyOfA, B, beta);
+    return;
+  }
+
+  std::vector<const PetscScalar*> a;
+  std::vector<PetscScalar*> c;
+
+  // One GEMM if both blocks are stored one column after another
+  ierr = A.getArrays(a); CHKERRV(ierr);
+  ierr = getArrays(c); CHKERRV(ierr);
+  const bool gemm = A.isConstantStride(a) && isConstantStride(c)
+                    && (a[0] + n*numA <= c[0] || c[0] + n*numVecs <= a[0]);
+  if(gemm && n > 0) {
+    Teuchos::BLAS<int,PetscScalar> blas;
+    blas.GEMM(Teuchos::NO_TRANS, Teuchos::NO_TRANS, n, numVecs, numA, alpha, a[0], n,
+              B.values(), B.stride(), beta, c[0], n);
+  }
+  ierr = restoreArrays(c); CHKERRV(ierr);
+  ierr = A.restoreArrays(a); CHKERRV(ierr);
+  if(gemm)
+    return;
+
+  // Otherwise one VecMAXPY per column
+  std::vector<PetscScalar> coeffs(numA);
+  for(int j=0; j < numVecs; j++) {
+    if(beta == Teuchos::ScalarTraits<PetscScalar>::zero()) {
+      ierr = VecSet(vecs_[j],0.0); CHKERRV(ierr);
+    }
+    else if(beta != Teuchos::ScalarTraits<PetscScalar>::one()) {
+      ierr = VecScale(vecs_[j],beta); CHKERRV(ierr);
+    }
+    for(int i=0; i < numA; i++)
+      coeffs[i] = alpha*B(i,j);
+    ierr = VecMAXPY(vecs_[j],numA,coeffs.data(),const_cast<Vec*>(A.vecs_.data())); CHKERRV(ierr);
+  }
+}
+
+
+
+//! this = alpha*A + beta*B
+inline void PETScMultiVec::addMv(PetscScalar alpha, const PETScMultiVec& A, PetscScalar beta, const PETScMultiVec& B)
+{
+  PetscErrorCode ierr;
+  for(int j=0; j < getNumVectors(); j++) {
+    Vec y = vecs_[j], a = A.vecs_[j], b = B.vecs_[j];
+    // PETSc refuses to update a Vec that is also an input
+    if(y == a && y == b) {
+      ierr = VecScale(y,alpha+beta); CHKERRV(ierr);
+    }
+    else if(y == a) {
+      ierr = VecAXPBY(y,beta,alpha,b); CHKERRV(ierr);
+    }
+    else if(y == b) {
+      ierr = VecAXPBY(y,alpha,beta,a); CHKERRV(ierr);
+    }
+    else {
+      ierr = VecAXPBYPCZ(y,alpha,beta,0.0,a,b); CHKERRV(ierr);
+    }
+  }
+}
+
+
+
+//! Scale column j by alphas[j], or every column by alphas[0] if there is only one.
+inline void PETScMultiVec::scale(const std::vector<PetscScalar>& alphas)
+{
+  PetscErrorCode ierr;
+  for(int j=0; j < getNumVectors(); j++) {
+    ierr = VecScale(vecs_[j],alphas.size() == 1 ? alphas[0] : alphas[j]); CHKERRV(ierr);
+  }
+}
+
+
+
+//! B = alpha*A^H*this
+inline void PETScMultiVec::transMv(PetscScalar alpha, const PETScMultiVec& A, dense_matrix_type& B) const
+{
+  PetscErrorCode ierr;
+  if(getNumVectors() == 0 || A.getNumVectors() == 0)
+    return;
+  const PetscInt n = getLocalLength();
+  const int numA = A.getNumVectors(), numVecs = getNumVectors();
+  Teuchos::BLAS<int,PetscScalar> blas;
+  std::vector<const PetscScalar*> a, c;
+
+  // The local products, one GEMM if both blocks are stored one column after another
+  dense_matrix_type local(numA, numVecs);
+  ierr = A.getArrays(a); CHKERRV(ierr);
+  ierr = getArrays(c); CHKERRV(ierr);
+  if(n > 0) {
+    if(A.isConstantStride(a) && isConstantStride(c)) {
+      blas.GEMM(Teuchos::CONJ_TRANS, Teuchos::NO_TRANS, numA, numVecs, n, alpha, a[0], n,
+                c[0], n, 0.0, local.values(), local.stride());
+    }
+    else {
+      for(int j=0; j < numVecs; j++)
+        for(int i=0; i < numA; i++)
+          blas.GEMM(Teuchos::CONJ_TRANS, Teuchos::NO_TRANS, 1, 1, n, alpha, a[i], n, c[j], n, 0.0, &local(i,j), 1);
+    }
+  }
+  ierr = restoreArrays(c); CHKERRV(ierr);
+  ierr = A.restoreArrays(a); CHKERRV(ierr);
+
+  // One reduction for the whole block
+  MPI_Comm comm;
+  ierr = PetscObjectGetComm((PetscObject)vecs_[0],&comm); CHKERRV(ierr);
+  ierr = MPI_Allreduce(MPI_IN_PLACE,local.values(),numA*numVecs,MPIU_SCALAR,MPIU_SUM,comm); CHKERRV(ierr);
+  for(int j=0; j < numVecs; j++)
+    for(int i=0; i < numA; i++)
+      B(i,j) = local(i,j);
+}
+
+
+
+//! b[j] = A_j^H*this_j
+inline void PETScMultiVec::dot(const PETScMultiVec& A, std::vector<PetscScalar>& b) const
+{
+  // The split phase reductions of all columns are sent together
+  PetscErrorCode ierr;
+  for(int j=0; j < getNumVectors(); j++) {
+    ierr = VecDotBegin(vecs_[j],A.vecs_[j],&b[j]); CHKERRV(ierr);
+  }
+  for(int j=0; j < getNumVectors(); j++) {
+    ierr = VecDotEnd(vecs_[j],A.vecs_[j],&b[j]); CHKERRV(ierr);
+  }
+}
+
+
+
+//! The norms of the columns.
+inline void PETScMultiVec::norm(std::vector<magnitude_type>& normvec, NormType type) const
+{
+  PetscErrorCode ierr;
+  const ::NormType petscType = (type == OneNorm ? NORM_1 : (type == InfNorm ? NORM_INFINITY : NORM_2));
+  for(int j=0; j < getNumVectors(); j++) {
+    ierr = VecNormBegin(vecs_[j],petscType,&normvec[j]); CHKERRV(ierr);
+  }
+  for(int j=0; j < getNumVectors(); j++) {
+    ierr = VecNormEnd(vecs_[j],petscType,&normvec[j]); CHKERRV(ierr);
+  }
+}
+
+
+
+//! Copy the columns of A into the columns index of this.
+inline void PETScMultiVec::setBlock(const PETScMultiVec& A, const std::vector<int>& index)
+{
+  PetscErrorCode ierr;
+  for(size_t j=0; j < index.size(); j++) {
+    if(A.vecs_[j] == vecs_[index[j]]) continue;
+    ierr = VecCopy(A.vecs_[j],vecs_[index[j]]); CHKERRV(ierr);
+  }
+}
+
+
+
+//! Fill the columns with random values.
+inline void PETScMultiVec::random()
+{
+  PetscErrorCode ierr;
+  for(int j=0; j < getNumVectors(); j++) {
+    ierr = VecSetRandom(vecs_[j],NULL); CHKERRV(ierr);
+  }
+}
+
+
+
+//! Set every entry to alpha.
+inline void PETScMultiVec::init(PetscScalar alpha)
+{
+  PetscErrorCode ierr;
+  for(int j=0; j < getNumVectors(); j++) {
+    ierr = VecSet(vecs_[j],alpha); CHKERRV(ierr);
+  }
+}
+
+
+
+//! Print the local entries of every column.
+inline void PETScMultiVec::print(std::ostream& os) const
+{
+  std::vector<const PetscScalar*> arrays;
+  getArrays(arrays);
+  const PetscInt n = getLocalLength();
+  for(PetscInt i=0; i < n; i++) {
+    for(int j=0; j < getNumVectors(); j++)
+      os << arrays[j][i] << " ";
+    os << std::endl;
+  }
+  restoreArrays(arrays);
+}
+
+
+
+/*! \brief Specialization of MultiVecTraits for Belos::PETScMultiVec.
+
+  Belos solvers run on PETSc Vecs with this specialization and OperatorTraits for Mat below, e.g.
+  Belos::BlockGmresSolMgr<PetscScalar,PETScMultiVec,Mat>, without copying into Trilinos vectors.
+*/
+template<>
+class MultiVecTraits<PetscScalar, PETScMultiVec> {
+private:
+  typedef PETScMultiVec MV;
+  typedef Teuchos::SerialDenseMatrix<int,PetscScalar> dense_matrix_type;
+  typedef Teuchos::ScalarTraits<PetscScalar>::magnitudeType magnitude_type;
+
+  static std::vector<int> range(const Teuchos::Range1D& index)
+  {
+    std::vector<int> ind(index.size());
+    for(int j=0; j < index.size(); j++) ind[j] = index.lbound() + j;
+    return ind;
+  }
+
+public:
+  static Teuchos::RCP<MV> Clone(const MV& mv, const int numvecs)
+  { return Teuchos::rcp(mv.clone(numvecs)); }
+
+  static Teuchos::RCP<MV> CloneCopy(const MV& mv)
+  { return CloneCopy(mv, range(Teuchos::Range1D(0, mv.getNumVectors()-1))); }
+
+  static Teuchos::RCP<MV> CloneCopy(const MV& mv, const std::vector<int>& index)
+  { return Teuchos::rcp(mv.cloneCopy(index)); }
+
+  static Teuchos::RCP<MV> CloneCopy(const MV& mv, const Teuchos::Range1D& index)
+  { return CloneCopy(mv, range(index)); }
+
+  static Teuchos::RCP<MV> CloneViewNonConst(MV& mv, const std::vector<int>& index)
+  { return Teuchos::rcp(mv.cloneView(index)); }
+
+  static Teuchos::RCP<MV> CloneViewNonConst(MV& mv, const Teuchos::Range1D& index)
+  { return CloneViewNonConst(mv, range(index)); }
+
+  static Teuchos::RCP<const MV> CloneView(const MV& mv, const std::vector<int>& index)
+  { return Teuchos::rcp(mv.cloneView(index)); }
+
+  static Teuchos::RCP<const MV> CloneView(const MV& mv, const Teuchos::Range1D& index)
+  { return CloneView(mv, range(index)); }
+
+  static ptrdiff_t GetGlobalLength(const MV& mv)
+  { return mv.getGlobalLength(); }
+
+  static int GetNumberVecs(const MV& mv)
+  { return mv.getNumVectors(); }
+
+  static bool HasConstantStride(const MV& mv)
+  { return mv.isConstantStride(); }
+
+  static void MvTimesMatAddMv(const PetscScalar alpha, const MV& A, const dense_matrix_type& B, const PetscScalar beta, MV& mv)
+  { mv.timesMatAddMv(alpha, A, B, beta); }
+
+  static void MvAddMv(const PetscScalar alpha, const MV& A, const PetscScalar beta, const MV& B, MV& mv)
+  { mv.addMv(alpha, A, beta, B); }
+
+  static void MvScale(MV& mv, const PetscScalar alpha)
+  { mv.scale(std::vector<PetscScalar>(1, alpha)); }
+
+  static void MvScale(MV& mv, const std::vector<PetscScalar>& alphas)
+  { mv.scale(alphas); }
+
+  static void MvTransMv(const PetscScalar alpha, const MV& A, const MV& mv, dense_matrix_type& B)
+  { mv.transMv(alpha, A, B); }
+
+  static void MvDot(const MV& mv, const MV& A, std::vector<PetscScalar>& b)
+  { mv.dot(A, b); }
+
+  static void MvNorm(const MV& mv, std::vector<magnitude_type>& normvec, NormType type = TwoNorm)
+  { mv.norm(normvec, type); }
+
+  static void SetBlock(const MV& A, const std::vector<int>& index, MV& mv)
+  { mv.setBlock(A, index); }
+
+  static void SetBlock(const MV& A, const Teuchos::Range1D& index, MV& mv)
+  { mv.setBlock(A, range(index)); }
+
+  static void Assign(const MV& A, MV& mv)
+  { mv.setBlock(A, range(Teuchos::Range1D(0, A.getNumVectors()-1))); }
+
+  static void MvRandom(MV& mv)
+  { mv.random(); }
+
+  static void MvInit(MV& mv, const PetscScalar alpha = Teuchos::ScalarTraits<PetscScalar>::zero())
+  { mv.init(alpha); }
+
+  static void MvPrint(const MV& mv, std::ostream& os)
+  { mv.print(os); }
+
+#ifdef HAVE_BELOS_TSQR
+  typedef Belos::details::StubTsqrAdapter<MV> tsqr_adaptor_type;
+#endif
+};
+
+
+
+/*! \brief Specialization of OperatorTraits for PETSc matrices applied to Belos::PETScMultiVec.
+
+  Any Mat can be used, including shell and matrix-free ones; each column is applied with MatMult.
+*/
+template<>
+class OperatorTraits<PetscScalar, PETScMultiVec, Mat> {
+public:
+  static void Apply(const Mat& Op, const PETScMultiVec& x, PETScMultiVec& y, ETrans trans = NOTRANS)
+  {
+    PetscErrorCode ierr;
+    for(int j=0; j < x.getNumVectors(); j++) {
+      if(trans == NOTRANS) {
+        ierr = MatMult(Op,x.getVec(j),y.getVec(j)); CHKERRV(ierr);
+      }
+      else if(trans == TRANS) {
+        ierr = MatMultTranspose(Op,x.getVec(j),y.getVec(j)); CHKERRV(ierr);
+      }
+      else {
+        ierr = MatMultHermitianTranspose(Op,x.getVec(j),y.getVec(j)); CHKERRV(ierr);
+      }
+    }
+  }
+
+  static bool HasApplyTranspose(const Mat& Op)
+  {
+    PetscErrorCode ierr;
+    PetscBool has;
+    ierr = MatHasOperation(Op,MATOP_MULT_TRANSPOSE,&has);
+    TEUCHOS_TEST_FOR_EXCEPTION(ierr != 0, std::runtime_error,
+           "Belos::OperatorTraits<PetscScalar,PETScMultiVec,Mat>::HasApplyTranspose(): PETSc error " << ierr << ".");
+    return has;
+  }
+};
+
+} // namespace Belos
+
+#endif // BELOS_PETSC_ADAPTER_HPP
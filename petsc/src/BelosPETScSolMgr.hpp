@@ -704,7 +704,10 @@ ReturnType PETScSolMgr<ScalarType,MV,OP>::solve()
     ierr = PCDestroy(&petscPrec); CHKERRCONTINUE(ierr);
   }
   
-  PetscFinalize();
+  // Only finalize PETSc if we were the ones who initialized it
+  if(!isInitialized) {
+    PetscFinalize();
+  }
 
   } // end timing
 
@@ -0,0 +1,384 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef _TPETRA_PETSCAIJEQUILIBRATION_H_
+#define _TPETRA_PETSCAIJEQUILIBRATION_H_
+
+#include "Tpetra_ConfigDefs.hpp"
+#include "Tpetra_MultiVector.hpp"
+#include "Tpetra_PETScAIJMatrix.hpp"
+#include "Tpetra_Vector.hpp"
+#include "Teuchos_CommHelpers.hpp"
+#include "Teuchos_ParameterList.hpp"
+//Petsc headers.
+#include <petscmat.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+
+namespace Tpetra {
+
+//! PETScAIJEquilibration: Row and column scaling of a PETScAIJMatrix, applied to the PETSc matrix in place.
+
+/*! compute() replaces A by R*A*C for diagonal R and C, chosen so that the largest entry of every row
+    and column of R*A*C is close to one, and keeps R and C.  A solution y of the scaled system
+    R*A*C*y = R*b gives the solution x = C*y of the original one; scaleRHS(), unscaleSolution(),
+    scaleSolution() and unscaleResidual() convert between the two.
+
+    Parameters:
+    - "Equilibration: type": "Ruiz" (default), which repeatedly divides each row and column by the
+      square root of its largest entry, or "max-norm", which divides each row by its largest entry
+      and then each column by its largest entry, as LAPACK's xGEEQU does.
+    - "Equilibration: max iterations" (int, default 10): the most Ruiz iterations.
+    - "Equilibration: tolerance" (double, default 0.1): Ruiz stops once every row and column maximum
+      is within this distance of one.
+
+    Each Ruiz iteration makes one pass over the AIJ arrays to find the row and column maxima together,
+    and one MatDiagonalScale to scale the rows and columns together.
+*/
+template<class Scalar = Details::DefaultTypes::scalar_type,
+         class LO = Details::DefaultTypes::local_ordinal_type,
+         class GO = Details::DefaultTypes::global_ordinal_type,
+         class Node = Details::DefaultTypes::node_type>
+class PETScAIJEquilibration
+{
+public:
+  typedef PETScAIJMatrix<Scalar,LO,GO,Node> matrix_type;
+  typedef Vector<Scalar,LO,GO,Node> vector_type;
+  typedef MultiVector<Scalar,LO,GO,Node> MV;
+  typedef typename Teuchos::ScalarTraits<Scalar>::magnitudeType magnitude_type;
+
+  //! @name Constructor/Destructor Methods
+  //@{
+
+  //! Constructor; the matrix is not changed until compute() is called.
+  PETScAIJEquilibration(const Teuchos::RCP<matrix_type>& A);
+
+  //! Destructor
+  virtual ~PETScAIJEquilibration() {};
+
+  //@}
+
+  //! Set the parameters described in the class documentation.
+  void setParameters(const Teuchos::ParameterList& params);
+
+  //! Compute the scaling and apply it to the matrix, A = R*A*C.
+  /*! Calling compute() again scales the current matrix further and accumulates the factors. */
+  void compute();
+
+  //! Undo the scaling of the matrix, A = inv(R)*A*inv(C), and reset the factors to one.
+  void unscaleMatrix();
+
+  //! Whether compute() has been called since the last unscaleMatrix().
+  bool isComputed() const { return isComputed_; };
+
+  //! The number of passes that compute() made over the matrix.
+  int getNumIterations() const { return numIters_; };
+
+  //! The row scaling R, distributed by the range Map.
+  Teuchos::RCP<const vector_type> getRowScaling() const { return rowScale_; };
+
+  //! The column scaling C, distributed by the domain Map.
+  Teuchos::RCP<const vector_type> getColumnScaling() const { return colScale_; };
+
+  //! @name Conversions between the original and the scaled system
+  //@{
+
+  //! B = R*B, the right-hand side of the scaled system.
+  void scaleRHS(MV& B) const { B.elementWiseMultiply(Teuchos::ScalarTraits<Scalar>::one(), *rowScale_, B, Teuchos::ScalarTraits<Scalar>::zero()); };
+
+  //! X = C*X, the solution of the original system from that of the scaled one.
+  void unscaleSolution(MV& X) const { X.elementWiseMultiply(Teuchos::ScalarTraits<Scalar>::one(), *colScale_, X, Teuchos::ScalarTraits<Scalar>::zero()); };
+
+  //! X = inv(C)*X, e.g. an initial guess for the scaled system.
+  void scaleSolution(MV& X) const { X.elementWiseMultiply(Teuchos::ScalarTraits<Scalar>::one(), *colScaleInv_, X, Teuchos::ScalarTraits<Scalar>::zero()); };
+
+  //! R = inv(R)*R, the residual of the original system from that of the scaled one.
+  void unscaleResidual(MV& R) const { R.elementWiseMultiply(Teuchos::ScalarTraits<Scalar>::one(), *rowScaleInv_, R, Teuchos::ScalarTraits<Scalar>::zero()); };
+
+  //@}
+
+private:
+  //! The largest magnitude in each row of A, and in each column of diag(rowWeights)*A (or A if rowWeights is NULL).
+  PetscErrorCode computeMaxima(const vector_type* rowWeights, vector_type& rowMax, vector_type& colMax) const;
+
+  //! Replace each maximum m by pow(m,-exponent), or one if m is zero, and return the largest |1-m|.
+  magnitude_type maximaToScaling(vector_type& maxima, magnitude_type exponent) const;
+
+  //! Scale the matrix by left and right and accumulate them into the factors.
+  void applyScaling(const vector_type& left, const vector_type& right);
+
+  Teuchos::RCP<matrix_type> A_;
+  std::string type_;
+  int maxIters_;
+  magnitude_type tol_;
+  int numIters_;
+  bool isComputed_;
+  Teuchos::RCP<vector_type> rowScale_, colScale_, rowScaleInv_, colScaleInv_;
+};
+
+
+
+//! Constructor
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+PETScAIJEquilibration<Scalar,LO,GO,Node>::PETScAIJEquilibration(const Teuchos::RCP<matrix_type>& A)
+  : A_(A), type_("Ruiz"), maxIters_(10), tol_(0.1), numIters_(0), isComputed_(false)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(A.is_null(), std::invalid_argument,
+         Teuchos::typeName (*this) << "::PETScAIJEquilibration(): The matrix may not be null.");
+
+  rowScale_ = Teuchos::rcp(new vector_type(A_->getRangeMap(), false));
+  colScale_ = Teuchos::rcp(new vector_type(A_->getDomainMap(), false));
+  rowScaleInv_ = Teuchos::rcp(new vector_type(A_->getRangeMap(), false));
+  colScaleInv_ = Teuchos::rcp(new vector_type(A_->getDomainMap(), false));
+  rowScale_->putScalar(Teuchos::ScalarTraits<Scalar>::one());
+  colScale_->putScalar(Teuchos::ScalarTraits<Scalar>::one());
+  rowScaleInv_->putScalar(Teuchos::ScalarTraits<Scalar>::one());
+  colScaleInv_->putScalar(Teuchos::ScalarTraits<Scalar>::one());
+}
+
+
+
+//! Set the parameters described in the class documentation.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+void PETScAIJEquilibration<Scalar,LO,GO,Node>::setParameters(const Teuchos::ParameterList& params)
+{
+  type_ = params.get<std::string>("Equilibration: type", type_);
+  maxIters_ = params.get<int>("Equilibration: max iterations", maxIters_);
+  tol_ = params.get<double>("Equilibration: tolerance", tol_);
+
+  TEUCHOS_TEST_FOR_EXCEPTION(type_ != "Ruiz" && type_ != "max-norm", std::invalid_argument,
+         Teuchos::typeName (*this) << "::setParameters(): Unknown equilibration type \"" << type_
+         << "\"; valid types are \"Ruiz\" and \"max-norm\".");
+}
+
+
+
+//! Compute the scaling and apply it to the matrix, A = R*A*C.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+void PETScAIJEquilibration<Scalar,LO,GO,Node>::compute()
+{
+  PetscErrorCode ierr;
+  vector_type rowMax(A_->getRangeMap(), false), colMax(A_->getDomainMap(), false);
+  numIters_ = 0;
+
+  if(type_ == "max-norm")
+  {
+    // Rows first, then the columns of the row-scaled matrix, without changing the matrix in between
+    vector_type rowScaling(A_->getRangeMap(), false);
+    ierr = computeMaxima(NULL, rowScaling, colMax);CHKERRV(ierr);
+    maximaToScaling(rowScaling, 1);
+    ierr = computeMaxima(&rowScaling, rowMax, colMax);CHKERRV(ierr);
+    maximaToScaling(colMax, 1);
+    applyScaling(rowScaling, colMax);
+    numIters_ = 2;
+  }
+  else
+  {
+    for(; numIters_ < maxIters_; numIters_++)
+    {
+      ierr = computeMaxima(NULL, rowMax, colMax);CHKERRV(ierr);
+      const magnitude_type deviation = std::max(maximaToScaling(rowMax, 0.5), maximaToScaling(colMax, 0.5));
+      if(deviation <= tol_)
+        break;
+      applyScaling(rowMax, colMax);
+    }
+  }
+
+  isComputed_ = true;
+}
+
+
+
+//! Undo the scaling of the matrix, A = inv(R)*A*inv(C), and reset the factors to one.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+void PETScAIJEquilibration<Scalar,LO,GO,Node>::unscaleMatrix()
+{
+  A_->scale(*rowScaleInv_, *colScaleInv_);
+  rowScale_->putScalar(Teuchos::ScalarTraits<Scalar>::one());
+  colScale_->putScalar(Teuchos::ScalarTraits<Scalar>::one());
+  rowScaleInv_->putScalar(Teuchos::ScalarTraits<Scalar>::one());
+  colScaleInv_->putScalar(Teuchos::ScalarTraits<Scalar>::one());
+  isComputed_ = false;
+}
+
+
+
+//! Scale the matrix by left and right and accumulate them into the factors.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+void PETScAIJEquilibration<Scalar,LO,GO,Node>::applyScaling(const vector_type& left, const vector_type& right)
+{
+  const Scalar one = Teuchos::ScalarTraits<Scalar>::one(), zero = Teuchos::ScalarTraits<Scalar>::zero();
+
+  A_->scale(left, right);
+  rowScale_->elementWiseMultiply(one, left, *rowScale_, zero);
+  colScale_->elementWiseMultiply(one, right, *colScale_, zero);
+  rowScaleInv_->reciprocal(*rowScale_);
+  colScaleInv_->reciprocal(*colScale_);
+}
+
+
+
+//! Replace each maximum m by pow(m,-exponent), or one if m is zero, and return the largest |1-m|.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+typename PETScAIJEquilibration<Scalar,LO,GO,Node>::magnitude_type
+PETScAIJEquilibration<Scalar,LO,GO,Node>::maximaToScaling(vector_type& maxima, magnitude_type exponent) const
+{
+  typedef Teuchos::ScalarTraits<magnitude_type> STM;
+
+  magnitude_type localDeviation = STM::zero(), deviation;
+  {
+    Teuchos::ArrayRCP<Scalar> m = maxima.get1dViewNonConst();
+    for(LO i = 0; i < m.size(); i++)
+    {
+      const magnitude_type mi = Teuchos::ScalarTraits<Scalar>::magnitude(m[i]);
+      if(mi == STM::zero())
+      {
+        m[i] = Teuchos::ScalarTraits<Scalar>::one();
+        continue;
+      }
+      localDeviation = std::max(localDeviation, STM::magnitude(STM::one() - mi));
+      m[i] = std::pow(mi, -exponent);
+    }
+  }
+  Teuchos::reduceAll(*maxima.getMap()->getComm(), Teuchos::REDUCE_MAX, localDeviation, Teuchos::outArg(deviation));
+  return deviation;
+}
+
+
+
+//! The largest magnitude in each row of A, and in each column of diag(rowWeights)*A.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode PETScAIJEquilibration<Scalar,LO,GO,Node>::computeMaxima(const vector_type* rowWeights, vector_type& rowMax, vector_type& colMax) const
+{
+  typedef Teuchos::ScalarTraits<Scalar> ST;
+
+  PetscErrorCode ierr;
+  Mat A = A_->getPETScMat(), blocks[2] = {NULL, NULL};
+  PetscBool isMPIAIJ, isSeqAIJ;
+  ierr = PetscObjectTypeCompare((PetscObject)A,MATMPIAIJ,&isMPIAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)A,MATSEQAIJ,&isSeqAIJ);CHKERRQ(ierr);
+  if(isMPIAIJ) {
+    ierr = MatMPIAIJGetSeqAIJ(A,&blocks[0],&blocks[1],NULL);CHKERRQ(ierr);
+  }
+  else if(isSeqAIJ) {
+    blocks[0] = A;
+  }
+
+  // The column Map holds the diagonal block's columns, then the off-diagonal block's
+  vector_type colMaxLocal(A_->getColMap());
+  const PetscInt numDiagCols = A_->getDomainMap()->getNodeNumElements();
+  {
+    Teuchos::ArrayRCP<Scalar> rmax = rowMax.get1dViewNonConst();
+    Teuchos::ArrayRCP<Scalar> cmax = colMaxLocal.get1dViewNonConst();
+    Teuchos::ArrayRCP<const Scalar> weights;
+    if(rowWeights != NULL) weights = rowWeights->get1dView();
+    std::fill(rmax.begin(), rmax.end(), ST::zero());
+
+    // Other matrices, e.g. BAIJ, are read one row at a time
+    if(blocks[0] == NULL)
+    {
+      const size_t maxEntries = A_->getNodeMaxNumRowEntries();
+      Teuchos::Array<LO> indices(maxEntries);
+      Teuchos::Array<Scalar> values(maxEntries);
+      for(LO i = 0; i < rmax.size(); i++)
+      {
+        size_t numEntries;
+        A_->getLocalRowCopy(i, indices(), values(), numEntries);
+        const PetscReal w = (rowWeights != NULL ? ST::magnitude(weights[i]) : 1);
+        PetscReal rowLargest = 0;
+        for(size_t k = 0; k < numEntries; k++)
+        {
+          const PetscReal v = ST::magnitude(values[k]);
+          rowLargest = std::max(rowLargest, v);
+          if(w*v > ST::magnitude(cmax[indices[k]])) cmax[indices[k]] = w*v;
+        }
+        rmax[i] = rowLargest;
+      }
+    }
+
+    // One pass over each block finds the row and column maxima together
+    for(int b = 0; b < 2 && blocks[b] != NULL; b++)
+    {
+      PetscInt n;
+      const PetscInt *ia, *ja;
+      const PetscScalar *aa;
+      PetscBool done;
+      const PetscInt colOffset = (b == 0 ? 0 : numDiagCols);
+      ierr = MatGetRowIJ(blocks[b],0,PETSC_FALSE,PETSC_FALSE,&n,&ia,&ja,&done);CHKERRQ(ierr);
+      ierr = xSDKTrilinos::Details::PETScSeqAIJGetArrayRead(blocks[b],&aa);CHKERRQ(ierr);
+      for(PetscInt i = 0; i < n; i++)
+      {
+        const PetscReal w = (rowWeights != NULL ? ST::magnitude(weights[i]) : 1);
+        PetscReal rowLargest = ST::magnitude(rmax[i]);
+        for(PetscInt k = ia[i]; k < ia[i+1]; k++)
+        {
+          const PetscReal v = PetscAbsScalar(aa[k]);
+          const PetscInt j = colOffset + ja[k];
+          rowLargest = std::max(rowLargest, v);
+          if(w*v > ST::magnitude(cmax[j])) cmax[j] = w*v;
+        }
+        rmax[i] = rowLargest;
+      }
+      ierr = xSDKTrilinos::Details::PETScSeqAIJRestoreArrayRead(blocks[b],&aa);CHKERRQ(ierr);
+      ierr = MatRestoreRowIJ(blocks[b],0,PETSC_FALSE,PETSC_FALSE,&n,&ia,&ja,&done);CHKERRQ(ierr);
+    }
+  }
+
+  // Combine the column maxima of the processes sharing a column
+  colMax.putScalar(ST::zero());
+  colMax.doExport(colMaxLocal, *A_->getDomainExporter(), Tpetra::ABSMAX);
+  return 0;
+}
+
+} // namespace Tpetra
+
+#endif // _TPETRA_PETSCAIJEQUILIBRATION_H_
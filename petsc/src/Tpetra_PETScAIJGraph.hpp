@@ -60,11 +60,47 @@
 #include "Teuchos_DefaultSerialComm.hpp"
 #endif
 #include "Teuchos_RCP.hpp"
+#include <Kokkos_Core.hpp>
 //Petsc headers.
 #include "petscmat.h"
+#include <petscversion.h>
+#include <algorithm>
 #include <type_traits>
 
 
+namespace xSDKTrilinos {
+
+namespace Details {
+
+//! Gets the values of a SeqAIJ matrix for reading only.
+/*! Since PETSc 3.12 restoring the array from MatSeqAIJGetArray marks the matrix as changed, which
+    would invalidate everything cached against its object state.  Older versions have no read-only
+    variant, and no state increase either.
+*/
+inline PetscErrorCode PETScSeqAIJGetArrayRead(Mat A, const PetscScalar** array)
+{
+#if PETSC_VERSION_GE(3,12,0)
+  return MatSeqAIJGetArrayRead(A,array);
+#else
+  return MatSeqAIJGetArray(A,const_cast<PetscScalar**>(array));
+#endif
+}
+
+//! Restores the values obtained with PETScSeqAIJGetArrayRead.
+inline PetscErrorCode PETScSeqAIJRestoreArrayRead(Mat A, const PetscScalar** array)
+{
+#if PETSC_VERSION_GE(3,12,0)
+  return MatSeqAIJRestoreArrayRead(A,array);
+#else
+  return MatSeqAIJRestoreArray(A,const_cast<PetscScalar**>(array));
+#endif
+}
+
+} // namespace Details
+
+} // namespace xSDKTrilinos
+
+
 namespace Tpetra {
 
 //! Tpetra_PETScAIJMatrix: A class for constructing and using real-valued sparse compressed row matrices.
@@ -72,8 +108,8 @@ namespace Tpetra {
 /*! The Tpetra_PETScAIJMatrix is a wrapper class for PETSc sequential or parallel AIJ matrices.  It is
     derived from the Tpetra_RowMatrix class, and so provides PETSc users access to Trilinos preconditioners.
     This class is lightweight, i.e., there are no deep copies of matrix data.  Whenever possible, class
-    methods utilize callbacks to native PETSc functions.  Currently, only sequential and parallel point AIJ
-    PETSc matrix types are supported.
+    methods utilize callbacks to native PETSc functions.  Sequential and parallel AIJ and BAIJ matrices
+    are supported; the rows of a BAIJ matrix are its point rows.
 */    
 
 template<class LO = Details::DefaultTypes::local_ordinal_type, 
@@ -127,6 +163,9 @@ public:
   //! This graph's Export object.
   Teuchos::RCP<const Export<LO,GO,Node> > getExporter() const { return exporter_; };
 
+  //! An Export from the column Map to the domain Map, to combine per-column contributions of all processes.
+  Teuchos::RCP<const Export<LO,GO,Node> > getDomainExporter() const { return domainExporter_; };
+
   //! The global number of rows of this matrix. 
   global_size_t getGlobalNumRows() const { return numGlobalRows_; };
 
@@ -184,6 +223,12 @@ public:
   //! Whether fillComplete() has been called. 
   bool isFillComplete() const;
 
+  //! The block size of a BAIJ matrix, or the (usually one) block size of an AIJ matrix.
+  PetscInt getBlockSize() const { return blockSize_; };
+
+  //! Whether the matrix is stored as AIJ, so that its CSR arrays can be read directly.
+  bool isAIJ() const { return isAIJ_; };
+
   //@}
 
   //! @name Extraction methods
@@ -195,13 +240,59 @@ public:
   //! Get a copy of the given local row's entries. 
   void getLocalRowCopy(LO localRow, const Teuchos::ArrayView<LO> &indices, size_t &numIndices) const;
 
+  //! Copy the column Map indices of the given local row and, if values is not NULL, its values.
+  /*! The diagonal block's columns come first in the column Map and the off-diagonal block's follow
+      in the order of garray, so both blocks' local indices translate by a fixed offset.  The entries
+      are read straight from the two blocks, in PETSc's global column order, without allocating.
+  */
+  template<class Scalar>
+  void getLocalRowEntries(LO localRow, const Teuchos::ArrayView<LO> &indices, Scalar * values, size_t maxEntries, size_t &numEntries) const;
+
+  //! The offsets of the local rows [rowBegin,rowEnd) in a CSR copy of them; rowptr has rowEnd-rowBegin+1 entries.
+  void getLocalRowPtrs(LO rowBegin, LO rowEnd, const Teuchos::ArrayView<size_t> &rowptr) const;
+
+  //! Copy the local rows [rowBegin,rowEnd) as getLocalRowEntries() would, into CSR arrays laid out by getLocalRowPtrs().
+  /*! The rows are read from the CSR arrays of the two blocks and split across the host threads. */
+  template<class Scalar>
+  void getLocalRowsEntries(LO rowBegin, LO rowEnd, const Teuchos::ArrayView<const size_t> &rowptr, const Teuchos::ArrayView<LO> &indices, Scalar * values) const;
+
   //@}*/
 
 private:
+  //! The block CSR arrays of the diagonal and off-diagonal SeqBAIJ blocks of a BAIJ matrix; the off-diagonal ones are NULL without that block.
+  struct BlockArrays {
+    const PetscInt *di, *dj, *oi, *oj;
+    PetscScalar *da, *oa;
+  };
+
+  //! Get the block CSR arrays of a BAIJ matrix, and its values if withValues is true.
+  PetscErrorCode getBlockArrays(BlockArrays &arrays, bool withValues) const;
+
+  //! Give back the arrays of getBlockArrays().
+  PetscErrorCode restoreBlockArrays(BlockArrays &arrays, bool withValues) const;
+
+  //! Copy one point row of a BAIJ matrix, read from the block CSR arrays, into column Map indices and values.
+  template<class Scalar>
+  void getBlockMatrixRowEntries(LO localRow, const Teuchos::ArrayView<LO> &indices, Scalar * values, size_t maxEntries, size_t &numEntries) const;
+
+  //! Merge point row r of one block row of the two blocks into column Map indices and values, in PETSc's global column order.
+  /*! dvals and ovals point to the first block of the block row; PETSc stores each block column by column. */
+  template<class Scalar>
+  void mergeBlockRow(PetscInt r, PetscInt nd, const PetscInt * dcols, const PetscScalar * dvals,
+                     PetscInt no, const PetscInt * ocols, const PetscScalar * ovals,
+                     LO * indices, Scalar * values) const;
+
+  //! Merge one row of the two blocks into column Map indices and values, in PETSc's global column order.
+  template<class Scalar>
+  void mergeLocalRow(PetscInt nd, const PetscInt * dcols, const PetscScalar * dvals,
+                     PetscInt no, const PetscInt * ocols, const PetscScalar * ovals,
+                     LO * indices, Scalar * values) const;
+
   Mat PETScMat_;   // PETSc matrix
   Teuchos::RCP<Comm> comm_; // Teuchos communicator
   Teuchos::RCP<Import<LO,GO,Node> > importer_;
   Teuchos::RCP<Export<LO,GO,Node> > exporter_;
+  Teuchos::RCP<const Export<LO,GO,Node> > domainExporter_;
 
   LO numLocalRows_;
   size_t numLocalCols_;
@@ -210,6 +301,17 @@ private:
   Teuchos::RCP<const Map<LO,GO,Node> > rowMap_, colMap_;
   global_size_t nnzGlobal_;
   size_t nnzLocal_;
+
+  //! The diagonal and off-diagonal blocks of an MPIAIJ or MPIBAIJ matrix, or the sequential matrix and NULL
+  Mat diagBlock_, offDiagBlock_;
+  //! The global columns of the off-diagonal block, which follow the diagonal block in the column Map
+  const PetscInt * garray_;
+  PetscInt numDiagCols_;
+
+  PetscInt blockSize_;
+  bool isAIJ_;
+  //! The off-process point columns of an MPIBAIJ matrix, expanded from its block column map, which garray_ points to
+  Teuchos::Array<PetscInt> ghostCols_;
 };
 
 
@@ -218,7 +320,7 @@ private:
 //==============================================================================
 template<class LO, class GO, class Node>
 PETScAIJGraph<LO,GO,Node>::PETScAIJGraph(Mat PETScMat)
-  : PETScMat_(PETScMat)
+  : PETScMat_(PETScMat), diagBlock_(PETScMat), offDiagBlock_(NULL), garray_(NULL), blockSize_(1), isAIJ_(true)
 {
   PetscErrorCode ierr;
   MatType type;
@@ -235,13 +337,15 @@ PETScAIJGraph<LO,GO,Node>::PETScAIJGraph(Mat PETScMat)
 #endif
 
   // Figure out what kind of matrix it is
-  // We currently support both sequential and parallel AIJ format
+  // We support sequential and parallel AIJ and BAIJ formats.  SBAIJ only stores the upper
+  // triangle, and its point rows cannot be completed without communication.
   ierr = MatGetType(PETScMat, &type); CHKERRV(ierr);
-
-  // Test whether the matrix type is valid
-#ifdef HAVE_TPETRA_DEBUG
-  TEUCHOS_TEST_FOR_EXCEPT(strcmp(type,MATSEQAIJ) != 0 && strcmp(type,MATMPIAIJ) != 0)
-#endif
+  isAIJ_ = (strcmp(type,MATSEQAIJ) == 0 || strcmp(type,MATMPIAIJ) == 0);
+  const bool isBAIJ = (strcmp(type,MATSEQBAIJ) == 0 || strcmp(type,MATMPIBAIJ) == 0);
+  TEUCHOS_TEST_FOR_EXCEPTION(!isAIJ_ && !isBAIJ, std::invalid_argument,
+         Teuchos::typeName (*this) << "::PETScAIJGraph(): PETSc matrices of type " << type << " are not supported; "
+         "use SeqAIJ, MPIAIJ, SeqBAIJ or MPIBAIJ, e.g. through MatConvert.");
+  ierr = MatGetBlockSize(PETScMat, &blockSize_); CHKERRV(ierr);
 
   // Get the row and column ownership
   // NOTE: This only works for certain parallel layouts
@@ -267,14 +371,31 @@ PETScAIJGraph<LO,GO,Node>::PETScAIJGraph(Mat PETScMat)
   if(strcmp(type,MATMPIAIJ) == 0)
   {
     Mat OffDiagonal;
-    ierr = MatMPIAIJGetSeqAIJ(PETScMat,NULL,&OffDiagonal,&garray); CHKERRV(ierr);
+    ierr = MatMPIAIJGetSeqAIJ(PETScMat,&diagBlock_,&OffDiagonal,&garray); CHKERRV(ierr);
     ierr = MatGetSize(OffDiagonal,NULL,&PETScCols); CHKERRV(ierr);
+    offDiagBlock_ = OffDiagonal;
+    garray_ = garray;
+  }
+  else if(strcmp(type,MATMPIBAIJ) == 0)
+  {
+    // The off-diagonal block has the sorted global block columns of colmap; each one is blockSize_ point columns
+    Mat OffDiagonal;
+    const PetscInt * colmap;
+    ierr = MatMPIBAIJGetSeqBAIJ(PETScMat,&diagBlock_,&OffDiagonal,&colmap); CHKERRV(ierr);
+    ierr = MatGetSize(OffDiagonal,NULL,&PETScCols); CHKERRV(ierr);
+    offDiagBlock_ = OffDiagonal;
+    ghostCols_.resize(PETScCols);
+    for(PetscInt b = 0; b < PETScCols/blockSize_; b++)
+      for(PetscInt c = 0; c < blockSize_; c++)
+        ghostCols_[b*blockSize_+c] = colmap[b]*blockSize_ + c;
+    garray = garray_ = ghostCols_.getRawPtr();
   }
   else
   {
     PETScCols=0;
   }
   numLocalCols_ = PETScLocalCols+PETScCols;
+  numDiagCols_ = PETScLocalCols;
 
 //  for(size_t i=0; i<10; i++) std::cerr << "garray[" << i << "] = " << garray[i] << std::endl;
 
@@ -295,6 +416,12 @@ PETScAIJGraph<LO,GO,Node>::PETScAIJGraph(Mat PETScMat)
 
   // Create the exporter
   exporter_ = rcp(new Export<LO,GO,Node>(colMap_, rowMap_));
+
+  // Create the exporter to the domain Map, which is the same one while the domain Map is the row Map
+  if(getDomainMap().get() == rowMap_.get())
+    domainExporter_ = exporter_;
+  else
+    domainExporter_ = rcp(new Export<LO,GO,Node>(colMap_, getDomainMap()));
 }
 
 
@@ -402,7 +529,6 @@ void PETScAIJGraph<LO,GO,Node>::getGlobalRowCopy(GO globalRow, const Teuchos::Ar
   numIndices = ncols;
 
   // Copy it to a Trilinos Array
-  Teuchos::Array<LO> tpCols(ncols);
   for(LO i=0; i<ncols; i++)
   {
     indices[i] = cols[i];
@@ -417,13 +543,310 @@ void PETScAIJGraph<LO,GO,Node>::getGlobalRowCopy(GO globalRow, const Teuchos::Ar
 template<class LO, class GO, class Node>
 void PETScAIJGraph<LO,GO,Node>::getLocalRowCopy(LO localRow, const Teuchos::ArrayView<LO> &indices, size_t &numIndices) const
 {
-  GO globalRow = localRow + rowMap_->getMinGlobalIndex();
-  
-  getGlobalRowCopy(globalRow, indices, numIndices);
+  getLocalRowEntries<PetscScalar>(localRow, indices, NULL, indices.size(), numIndices);
 } //ExtractMyRowCopy()
 
 
 
+//! Copy the column Map indices of the given local row and, if values is not NULL, its values.
+//==============================================================================
+template<class LO, class GO, class Node>
+template<class Scalar>
+void PETScAIJGraph<LO,GO,Node>::getLocalRowEntries(LO localRow, const Teuchos::ArrayView<LO> &indices, Scalar * values, size_t maxEntries, size_t &numEntries) const
+{
+  PetscErrorCode ierr;
+  PetscInt nd, no = 0;
+  const PetscInt *dcols, *ocols = NULL;
+  const PetscScalar *dvals = NULL, *ovals = NULL;
+
+  TEUCHOS_TEST_FOR_EXCEPTION(localRow < 0 || localRow >= numLocalRows_, std::runtime_error,
+         Teuchos::typeName (*this) << "::getLocalRowCopy(): Requested row is not owned by this process.");
+
+  if(!isAIJ_) {
+    getBlockMatrixRowEntries(localRow, indices, values, maxEntries, numEntries);
+    return;
+  }
+
+  // Rows of a SeqAIJ block are views of its CSR arrays
+  ierr = MatGetRow(diagBlock_,localRow,&nd,&dcols,values ? &dvals : NULL); CHKERRV(ierr);
+  if(offDiagBlock_ != NULL) {
+    ierr = MatGetRow(offDiagBlock_,localRow,&no,&ocols,values ? &ovals : NULL); CHKERRV(ierr);
+  }
+  numEntries = nd + no;
+
+  if(numEntries <= maxEntries && numEntries <= (size_t)indices.size()) {
+    mergeLocalRow(nd, dcols, dvals, no, ocols, ovals, indices.getRawPtr(), values);
+  }
+
+  ierr = MatRestoreRow(diagBlock_,localRow,&nd,&dcols,values ? &dvals : NULL); CHKERRV(ierr);
+  if(offDiagBlock_ != NULL) {
+    ierr = MatRestoreRow(offDiagBlock_,localRow,&no,&ocols,values ? &ovals : NULL); CHKERRV(ierr);
+  }
+
+  TEUCHOS_TEST_FOR_EXCEPTION(numEntries > maxEntries || numEntries > (size_t)indices.size(), std::runtime_error,
+         Teuchos::typeName (*this) << "::getLocalRowCopy(): ArrayViews are not large enough to store the requested data.");
+}
+
+
+
+//! Get the block CSR arrays of a BAIJ matrix, and its values if withValues is true.
+//==============================================================================
+template<class LO, class GO, class Node>
+PetscErrorCode PETScAIJGraph<LO,GO,Node>::getBlockArrays(BlockArrays &arrays, bool withValues) const
+{
+  PetscErrorCode ierr;
+  PetscInt n;
+  PetscBool done;
+
+  arrays.oi = arrays.oj = NULL;
+  arrays.da = arrays.oa = NULL;
+  ierr = MatGetRowIJ(diagBlock_,0,PETSC_FALSE,PETSC_TRUE,&n,&arrays.di,&arrays.dj,&done); CHKERRQ(ierr);
+  if(withValues) {
+    ierr = MatSeqBAIJGetArray(diagBlock_,&arrays.da); CHKERRQ(ierr);
+  }
+  if(offDiagBlock_ != NULL) {
+    ierr = MatGetRowIJ(offDiagBlock_,0,PETSC_FALSE,PETSC_TRUE,&n,&arrays.oi,&arrays.oj,&done); CHKERRQ(ierr);
+    if(withValues) {
+      ierr = MatSeqBAIJGetArray(offDiagBlock_,&arrays.oa); CHKERRQ(ierr);
+    }
+  }
+  return 0;
+}
+
+
+
+//! Give back the arrays of getBlockArrays().
+//==============================================================================
+template<class LO, class GO, class Node>
+PetscErrorCode PETScAIJGraph<LO,GO,Node>::restoreBlockArrays(BlockArrays &arrays, bool withValues) const
+{
+  PetscErrorCode ierr;
+  PetscInt n;
+  PetscBool done;
+
+  ierr = MatRestoreRowIJ(diagBlock_,0,PETSC_FALSE,PETSC_TRUE,&n,&arrays.di,&arrays.dj,&done); CHKERRQ(ierr);
+  if(withValues) {
+    ierr = MatSeqBAIJRestoreArray(diagBlock_,&arrays.da); CHKERRQ(ierr);
+  }
+  if(offDiagBlock_ != NULL) {
+    ierr = MatRestoreRowIJ(offDiagBlock_,0,PETSC_FALSE,PETSC_TRUE,&n,&arrays.oi,&arrays.oj,&done); CHKERRQ(ierr);
+    if(withValues) {
+      ierr = MatSeqBAIJRestoreArray(offDiagBlock_,&arrays.oa); CHKERRQ(ierr);
+    }
+  }
+  return 0;
+}
+
+
+
+//! Copy one point row of a BAIJ matrix, read from the block CSR arrays, into column Map indices and values.
+//==============================================================================
+template<class LO, class GO, class Node>
+template<class Scalar>
+void PETScAIJGraph<LO,GO,Node>::getBlockMatrixRowEntries(LO localRow, const Teuchos::ArrayView<LO> &indices, Scalar * values, size_t maxEntries, size_t &numEntries) const
+{
+  PetscErrorCode ierr;
+  BlockArrays arrays;
+  const PetscInt bs = blockSize_, bs2 = blockSize_*blockSize_;
+  const PetscInt br = localRow/bs;
+
+  ierr = getBlockArrays(arrays, values != NULL); CHKERRV(ierr);
+  const PetscInt nd = arrays.di[br+1]-arrays.di[br];
+  const PetscInt no = arrays.oi ? arrays.oi[br+1]-arrays.oi[br] : 0;
+  numEntries = (nd + no)*bs;
+  if(numEntries <= maxEntries && numEntries <= (size_t)indices.size()) {
+    mergeBlockRow(localRow%bs, nd, arrays.dj+arrays.di[br], values ? arrays.da+bs2*arrays.di[br] : NULL,
+                  no, arrays.oi ? arrays.oj+arrays.oi[br] : NULL, arrays.oa ? arrays.oa+bs2*arrays.oi[br] : NULL,
+                  indices.getRawPtr(), values);
+  }
+  ierr = restoreBlockArrays(arrays, values != NULL); CHKERRV(ierr);
+
+  TEUCHOS_TEST_FOR_EXCEPTION(numEntries > maxEntries || numEntries > (size_t)indices.size(), std::runtime_error,
+         Teuchos::typeName (*this) << "::getLocalRowCopy(): ArrayViews are not large enough to store the requested data.");
+}
+
+
+
+//! Merge point row r of one block row of the two blocks into column Map indices and values, in PETSc's global column order.
+//==============================================================================
+template<class LO, class GO, class Node>
+template<class Scalar>
+void PETScAIJGraph<LO,GO,Node>::mergeBlockRow(PetscInt r, PetscInt nd, const PetscInt * dcols, const PetscScalar * dvals,
+                                              PetscInt no, const PetscInt * ocols, const PetscScalar * ovals,
+                                              LO * indices, Scalar * values) const
+{
+  // The off-diagonal blocks left of the diagonal block come first
+  const PetscInt bs = blockSize_, bs2 = blockSize_*blockSize_;
+  const PetscInt colStart = rowMap_->getMinGlobalIndex();
+  size_t pos = 0;
+  PetscInt k = 0;
+  for(; k < no && garray_[ocols[k]*bs] < colStart; k++) {
+    for(PetscInt c = 0; c < bs; c++, pos++) {
+      indices[pos] = numDiagCols_ + ocols[k]*bs + c;
+      if(values) values[pos] = ovals[k*bs2 + c*bs + r];
+    }
+  }
+  for(PetscInt j = 0; j < nd; j++) {
+    for(PetscInt c = 0; c < bs; c++, pos++) {
+      indices[pos] = dcols[j]*bs + c;
+      if(values) values[pos] = dvals[j*bs2 + c*bs + r];
+    }
+  }
+  for(; k < no; k++) {
+    for(PetscInt c = 0; c < bs; c++, pos++) {
+      indices[pos] = numDiagCols_ + ocols[k]*bs + c;
+      if(values) values[pos] = ovals[k*bs2 + c*bs + r];
+    }
+  }
+}
+
+
+
+//! Merge one row of the two blocks into column Map indices and values, in PETSc's global column order.
+//==============================================================================
+template<class LO, class GO, class Node>
+template<class Scalar>
+void PETScAIJGraph<LO,GO,Node>::mergeLocalRow(PetscInt nd, const PetscInt * dcols, const PetscScalar * dvals,
+                                              PetscInt no, const PetscInt * ocols, const PetscScalar * ovals,
+                                              LO * indices, Scalar * values) const
+{
+  // The off-diagonal columns left of the diagonal block come first
+  const PetscInt colStart = rowMap_->getMinGlobalIndex();
+  size_t pos = 0;
+  PetscInt k = 0;
+  for(; k < no && garray_[ocols[k]] < colStart; k++, pos++) {
+    indices[pos] = numDiagCols_ + ocols[k];
+    if(values) values[pos] = ovals[k];
+  }
+  for(PetscInt j = 0; j < nd; j++, pos++) {
+    indices[pos] = dcols[j];
+    if(values) values[pos] = dvals[j];
+  }
+  for(; k < no; k++, pos++) {
+    indices[pos] = numDiagCols_ + ocols[k];
+    if(values) values[pos] = ovals[k];
+  }
+}
+
+
+
+//! The offsets of the local rows [rowBegin,rowEnd) in a CSR copy of them.
+//==============================================================================
+template<class LO, class GO, class Node>
+void PETScAIJGraph<LO,GO,Node>::getLocalRowPtrs(LO rowBegin, LO rowEnd, const Teuchos::ArrayView<size_t> &rowptr) const
+{
+  PetscErrorCode ierr;
+  PetscInt n;
+  const PetscInt *di, *dj, *oi = NULL, *oj;
+  PetscBool done;
+
+  TEUCHOS_TEST_FOR_EXCEPTION(rowBegin < 0 || rowEnd < rowBegin || rowEnd > numLocalRows_ || rowptr.size() < rowEnd-rowBegin+1,
+         std::runtime_error, Teuchos::typeName (*this) << "::getLocalRowPtrs(): Invalid row range or rowptr too small.");
+
+  // Every point row of a BAIJ block row has all the point columns of its blocks
+  if(!isAIJ_) {
+    BlockArrays arrays;
+    ierr = getBlockArrays(arrays, false); CHKERRV(ierr);
+    rowptr[0] = 0;
+    for(LO r = rowBegin; r < rowEnd; r++) {
+      const PetscInt br = r/blockSize_;
+      const size_t numBlocks = (arrays.di[br+1]-arrays.di[br]) + (arrays.oi ? arrays.oi[br+1]-arrays.oi[br] : 0);
+      rowptr[r-rowBegin+1] = rowptr[r-rowBegin] + numBlocks*blockSize_;
+    }
+    ierr = restoreBlockArrays(arrays, false); CHKERRV(ierr);
+    return;
+  }
+
+  ierr = MatGetRowIJ(diagBlock_,0,PETSC_FALSE,PETSC_FALSE,&n,&di,&dj,&done); CHKERRV(ierr);
+  if(offDiagBlock_ != NULL) {
+    ierr = MatGetRowIJ(offDiagBlock_,0,PETSC_FALSE,PETSC_FALSE,&n,&oi,&oj,&done); CHKERRV(ierr);
+  }
+
+  rowptr[0] = 0;
+  for(LO r = rowBegin; r < rowEnd; r++) {
+    rowptr[r-rowBegin+1] = rowptr[r-rowBegin] + (di[r+1]-di[r]) + (oi ? oi[r+1]-oi[r] : 0);
+  }
+
+  ierr = MatRestoreRowIJ(diagBlock_,0,PETSC_FALSE,PETSC_FALSE,&n,&di,&dj,&done); CHKERRV(ierr);
+  if(offDiagBlock_ != NULL) {
+    ierr = MatRestoreRowIJ(offDiagBlock_,0,PETSC_FALSE,PETSC_FALSE,&n,&oi,&oj,&done); CHKERRV(ierr);
+  }
+}
+
+
+
+//! Copy the local rows [rowBegin,rowEnd) into CSR arrays laid out by getLocalRowPtrs().
+//==============================================================================
+template<class LO, class GO, class Node>
+template<class Scalar>
+void PETScAIJGraph<LO,GO,Node>::getLocalRowsEntries(LO rowBegin, LO rowEnd, const Teuchos::ArrayView<const size_t> &rowptr, const Teuchos::ArrayView<LO> &indices, Scalar * values) const
+{
+  typedef Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace, LO> policy_type;
+
+  PetscErrorCode ierr;
+  PetscInt n;
+  const PetscInt *di, *dj, *oi = NULL, *oj = NULL;
+  const PetscScalar *da = NULL, *oa = NULL;
+  PetscBool done;
+
+  TEUCHOS_TEST_FOR_EXCEPTION(rowBegin < 0 || rowEnd < rowBegin || rowEnd > numLocalRows_ || rowptr.size() < rowEnd-rowBegin+1,
+         std::runtime_error, Teuchos::typeName (*this) << "::getLocalRowsCopy(): Invalid row range or rowptr too small.");
+  TEUCHOS_TEST_FOR_EXCEPTION((size_t)indices.size() < rowptr[rowEnd-rowBegin], std::runtime_error,
+         Teuchos::typeName (*this) << "::getLocalRowsCopy(): ArrayViews are not large enough to store the requested data.");
+
+  // BAIJ rows are read from the block CSR arrays in the same way
+  if(!isAIJ_) {
+    BlockArrays arrays;
+    ierr = getBlockArrays(arrays, values != NULL); CHKERRV(ierr);
+    const PetscInt bs = blockSize_, bs2 = blockSize_*blockSize_;
+    LO* const cols = indices.getRawPtr();
+    const size_t* const ptr = rowptr.getRawPtr();
+    Kokkos::parallel_for(policy_type(rowBegin, rowEnd), [=] (const LO r) {
+      const PetscInt br = r/bs;
+      const size_t pos = ptr[r-rowBegin];
+      mergeBlockRow(r%bs, arrays.di[br+1]-arrays.di[br], arrays.dj+arrays.di[br], arrays.da ? arrays.da+bs2*arrays.di[br] : NULL,
+                    arrays.oi ? arrays.oi[br+1]-arrays.oi[br] : 0, arrays.oi ? arrays.oj+arrays.oi[br] : NULL,
+                    arrays.oa ? arrays.oa+bs2*arrays.oi[br] : NULL, cols+pos, values ? values+pos : NULL);
+    });
+    ierr = restoreBlockArrays(arrays, values != NULL); CHKERRV(ierr);
+    return;
+  }
+
+  // MatGetRow may only have one row active at a time, so the threads read the CSR arrays themselves
+  ierr = MatGetRowIJ(diagBlock_,0,PETSC_FALSE,PETSC_FALSE,&n,&di,&dj,&done); CHKERRV(ierr);
+  if(values) {
+    ierr = xSDKTrilinos::Details::PETScSeqAIJGetArrayRead(diagBlock_,&da); CHKERRV(ierr);
+  }
+  if(offDiagBlock_ != NULL) {
+    ierr = MatGetRowIJ(offDiagBlock_,0,PETSC_FALSE,PETSC_FALSE,&n,&oi,&oj,&done); CHKERRV(ierr);
+    if(values) {
+      ierr = xSDKTrilinos::Details::PETScSeqAIJGetArrayRead(offDiagBlock_,&oa); CHKERRV(ierr);
+    }
+  }
+
+  LO* const cols = indices.getRawPtr();
+  const size_t* const ptr = rowptr.getRawPtr();
+  Kokkos::parallel_for(policy_type(rowBegin, rowEnd), [=] (const LO r) {
+    const size_t pos = ptr[r-rowBegin];
+    mergeLocalRow(di[r+1]-di[r], dj+di[r], values ? da+di[r] : NULL,
+                  oi ? oi[r+1]-oi[r] : 0, oi ? oj+oi[r] : NULL, oa ? oa+oi[r] : NULL,
+                  cols+pos, values ? values+pos : NULL);
+  });
+
+  ierr = MatRestoreRowIJ(diagBlock_,0,PETSC_FALSE,PETSC_FALSE,&n,&di,&dj,&done); CHKERRV(ierr);
+  if(values) {
+    ierr = xSDKTrilinos::Details::PETScSeqAIJRestoreArrayRead(diagBlock_,&da); CHKERRV(ierr);
+  }
+  if(offDiagBlock_ != NULL) {
+    ierr = MatRestoreRowIJ(offDiagBlock_,0,PETSC_FALSE,PETSC_FALSE,&n,&oi,&oj,&done); CHKERRV(ierr);
+    if(values) {
+      ierr = xSDKTrilinos::Details::PETScSeqAIJRestoreArrayRead(offDiagBlock_,&oa); CHKERRV(ierr);
+    }
+  }
+}
+
+
+
 //! Whether fillComplete() has been called. 
 //==============================================================================
 template<class LO, class GO, class Node>
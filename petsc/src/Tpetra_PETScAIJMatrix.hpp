@@ -55,7 +55,11 @@
 
 #include "Tpetra_ConfigDefs.hpp"
 #include "Tpetra_CrsMatrix.hpp"
+#include "Tpetra_Experimental_BlockCrsMatrix.hpp"
+#include "Tpetra_LocalRowsCopy.hpp"
 #include "Tpetra_PETScAIJGraph.hpp"
+#include "Tpetra_PETScVector.hpp"
+#include "Tpetra_Util.hpp"
 #ifdef HAVE_MPI
 #include "Teuchos_DefaultMpiComm.hpp"
 #else
@@ -63,16 +67,76 @@
 #endif
 //Petsc headers.
 #include <petscmat.h>
+#include <petscversion.h>
+#include <algorithm>
+#include <cmath>
 #include <type_traits>
+#include <vector>
 
 
 namespace xSDKTrilinos {
 
+namespace Details {
+
+//! Fallback for deepCopyPETScAIJMatrixToTpetraCrsMatrix: copy any PETSc matrix one row at a time.
+template<class Scalar, class LO, class GO, class Node>
+Teuchos::RCP<Tpetra::CrsMatrix<Scalar,LO,GO,Node> >
+deepCopyPETScMatrixToTpetraCrsMatrixByRow(const Mat& A, const Teuchos::RCP<const Tpetra::Map<LO,GO,Node> >& map)
+{
+  using Teuchos::RCP;
+  typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node>      CrsMatrix;
+
+  PetscErrorCode ierr;
+  PetscInt numLocalRows = map->getNodeNumElements();
+  PetscInt numLocalCols;
+
+  // Create an array containing the number of entries in each row
+  GO minLocalIndex = map->getMinGlobalIndex();
+  Teuchos::ArrayRCP<size_t> ncolsPerRow(numLocalRows);
+  for(int i=0; i < numLocalRows; i++)
+  {
+    ierr = MatGetRow(A,minLocalIndex+i,&numLocalCols,NULL,NULL); CHKERRCONTINUE(ierr);
+    ncolsPerRow[i] = numLocalCols;
+    ierr = MatRestoreRow(A,minLocalIndex+i,&numLocalCols,NULL,NULL); CHKERRCONTINUE(ierr);
+  }
+
+  // Create the matrix and set its values
+  RCP<CrsMatrix> TrilinosMat = rcp(new CrsMatrix(map,ncolsPerRow,Tpetra::StaticProfile));
+  const PetscInt * cols;
+  const PetscScalar * vals;
+  // Scalar need not be PetscScalar, e.g. for a single precision copy of a double precision matrix
+  Teuchos::Array<Scalar> valsToInsert;
+  for(int i=0; i < numLocalRows; i++)
+  {
+    ierr = MatGetRow(A,i+minLocalIndex,&numLocalCols,&cols,&vals); CHKERRCONTINUE(ierr);
+    Teuchos::ArrayView<const GO> colsToInsert(cols,numLocalCols);
+    valsToInsert.assign(vals,vals+numLocalCols);
+    TrilinosMat->insertGlobalValues(minLocalIndex+i,colsToInsert,valsToInsert());
+    ierr = MatRestoreRow(A,minLocalIndex+i,&numLocalCols,&cols,&vals); CHKERRCONTINUE(ierr);
+  }
+
+  // Let the matrix know you're done changing it
+  TrilinosMat->fillComplete();
+
+  return TrilinosMat;
+}
+
+} // namespace Details
+
+//! Copy a PETSc matrix into a new Tpetra::CrsMatrix with the same row distribution.
+/*! SeqAIJ and MPIAIJ matrices are copied in a single pass over their CSR arrays.  The column Map
+    is built directly from PETSc's ownership range and garray, so no sorting or communication
+    is needed to fill the matrix.  Other matrix types are copied row by row through MatGetRow.
+
+    The values are converted to Scalar, so a float copy of a double precision PETSc matrix can be
+    used to build a single precision preconditioner; see Tpetra::MixedPrecisionOperator.
+*/
 template<class Scalar, class LO, class GO, class Node>
 Teuchos::RCP<Tpetra::CrsMatrix<Scalar,LO,GO,Node> > deepCopyPETScAIJMatrixToTpetraCrsMatrix(const Mat& A)
 {
   using Teuchos::RCP;
   typedef Tpetra::Map<LO,GO,Node>                   Map;
+  typedef Tpetra::Import<LO,GO,Node>                Import;
   typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node>      CrsMatrix;
 
   PetscErrorCode ierr;
@@ -94,34 +158,222 @@ Teuchos::RCP<Tpetra::CrsMatrix<Scalar,LO,GO,Node> > deepCopyPETScAIJMatrixToTpet
   PetscInt numGlobalRows, numGlobalCols;
   ierr = MatGetSize(A,&numGlobalRows,&numGlobalCols); CHKERRCONTINUE(ierr);
 
-  // Create a Tpetra map reflecting this distribution
-  RCP<Map> map = rcp(new Map(numGlobalRows,numLocalRows,0,TrilinosComm));
+  // Create Tpetra maps reflecting this distribution
+  RCP<const Map> rowMap = rcp(new Map(numGlobalRows,numLocalRows,0,TrilinosComm));
+  RCP<const Map> domainMap = rcp(new Map(numGlobalCols,numLocalCols,0,TrilinosComm));
+
+  // Split the matrix into its diagonal and off-diagonal blocks.
+  // Only AIJ matrices expose their CSR arrays; anything else goes through MatGetRow.
+  PetscBool isSeqAIJ, isMPIAIJ;
+  ierr = PetscObjectTypeCompare((PetscObject)A,MATSEQAIJ,&isSeqAIJ); CHKERRCONTINUE(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)A,MATMPIAIJ,&isMPIAIJ); CHKERRCONTINUE(ierr);
+  if(!isSeqAIJ && !isMPIAIJ)
+    return Details::deepCopyPETScMatrixToTpetraCrsMatrixByRow<Scalar,LO,GO,Node>(A,rowMap);
+
+  Mat Ad = A, Ao = NULL;
+  const PetscInt * garray = NULL;
+  PetscInt numOffDiagCols = 0;
+  if(isMPIAIJ)
+  {
+    ierr = MatMPIAIJGetSeqAIJ(A,&Ad,&Ao,&garray); CHKERRCONTINUE(ierr);
+    ierr = MatGetSize(Ao,NULL,&numOffDiagCols); CHKERRCONTINUE(ierr);
+  }
 
-  // Create an array containing the number of entries in each row
-  LO minLocalIndex = map->getMinGlobalIndex();
-  Teuchos::ArrayRCP<size_t> ncolsPerRow(numLocalRows);
-  for(int i=0; i < numLocalRows; i++)
+  const PetscInt *dia, *dja, *oia = NULL, *oja = NULL;
+  const PetscScalar *dvals, *ovals = NULL;
+  PetscInt n;
+  PetscBool done;
+  ierr = MatGetRowIJ(Ad,0,PETSC_FALSE,PETSC_FALSE,&n,&dia,&dja,&done); CHKERRCONTINUE(ierr);
+  if(!done)
+    return Details::deepCopyPETScMatrixToTpetraCrsMatrixByRow<Scalar,LO,GO,Node>(A,rowMap);
+  if(Ao != NULL)
   {
-    ierr = MatGetRow(A,minLocalIndex+i,&numLocalCols,NULL,NULL); CHKERRCONTINUE(ierr);
-    ncolsPerRow[i] = numLocalCols;
-    ierr = MatRestoreRow(A,minLocalIndex+i,&numLocalCols,NULL,NULL); CHKERRCONTINUE(ierr);
+    ierr = MatGetRowIJ(Ao,0,PETSC_FALSE,PETSC_FALSE,&n,&oia,&oja,&done); CHKERRCONTINUE(ierr);
+    if(!done)
+    {
+      ierr = MatRestoreRowIJ(Ad,0,PETSC_FALSE,PETSC_FALSE,&n,&dia,&dja,&done); CHKERRCONTINUE(ierr);
+      return Details::deepCopyPETScMatrixToTpetraCrsMatrixByRow<Scalar,LO,GO,Node>(A,rowMap);
+    }
+    ierr = Details::PETScSeqAIJGetArrayRead(Ao,&ovals); CHKERRCONTINUE(ierr);
+  }
+  ierr = Details::PETScSeqAIJGetArrayRead(Ad,&dvals); CHKERRCONTINUE(ierr);
+
+  // The column Map holds the locally owned columns followed by garray.
+  // Both blocks keep their rows sorted, so the merged rows are sorted by local index.
+  PetscInt colStart;
+  ierr = MatGetOwnershipRangeColumn(A,&colStart,NULL); CHKERRCONTINUE(ierr);
+  Teuchos::Array<GO> colGIDs(numLocalCols+numOffDiagCols);
+  for(PetscInt j=0; j < numLocalCols; j++) colGIDs[j] = colStart + j;
+  for(PetscInt j=0; j < numOffDiagCols; j++) colGIDs[numLocalCols+j] = garray[j];
+  RCP<const Map> colMap = rcp(new Map(Teuchos::OrdinalTraits<Tpetra::global_size_t>::invalid(),colGIDs(),0,TrilinosComm));
+
+  // Merge the two blocks into one local CSR structure
+  const size_t nnz = dia[numLocalRows] + (Ao != NULL ? oia[numLocalRows] : 0);
+  Teuchos::ArrayRCP<size_t> rowPtrs(numLocalRows+1);
+  Teuchos::ArrayRCP<LO> colInds(nnz);
+  Teuchos::ArrayRCP<Scalar> vals(nnz);
+  size_t pos = 0;
+  for(PetscInt i=0; i < numLocalRows; i++)
+  {
+    rowPtrs[i] = pos;
+    for(PetscInt k=dia[i]; k < dia[i+1]; k++, pos++)
+    {
+      colInds[pos] = dja[k];
+      vals[pos] = static_cast<Scalar>(dvals[k]);
+    }
+    if(Ao == NULL) continue;
+    for(PetscInt k=oia[i]; k < oia[i+1]; k++, pos++)
+    {
+      colInds[pos] = numLocalCols + oja[k];
+      vals[pos] = static_cast<Scalar>(ovals[k]);
+    }
   }
+  rowPtrs[numLocalRows] = pos;
 
-  // Create the matrix and set its values
-  RCP<CrsMatrix> TrilinosMat = rcp(new CrsMatrix(map,ncolsPerRow,Tpetra::StaticProfile));
-  const PetscInt * cols;
-  const PetscScalar * vals;
-  for(int i=0; i < numLocalRows; i++)
+  ierr = Details::PETScSeqAIJRestoreArrayRead(Ad,&dvals); CHKERRCONTINUE(ierr);
+  ierr = MatRestoreRowIJ(Ad,0,PETSC_FALSE,PETSC_FALSE,&n,&dia,&dja,&done); CHKERRCONTINUE(ierr);
+  if(Ao != NULL)
   {
-    ierr = MatGetRow(A,i+minLocalIndex,&numLocalCols,&cols,&vals); CHKERRCONTINUE(ierr);
-    Teuchos::ArrayView<const LO> colsToInsert(cols,numLocalCols);
-    Teuchos::ArrayView<const Scalar> valsToInsert(vals,numLocalCols);
-    TrilinosMat->insertGlobalValues(minLocalIndex+i,colsToInsert,valsToInsert);
-    ierr = MatRestoreRow(A,minLocalIndex+i,&numLocalCols,&cols,&vals); CHKERRCONTINUE(ierr);
+    ierr = Details::PETScSeqAIJRestoreArrayRead(Ao,&ovals); CHKERRCONTINUE(ierr);
+    ierr = MatRestoreRowIJ(Ao,0,PETSC_FALSE,PETSC_FALSE,&n,&oia,&oja,&done); CHKERRCONTINUE(ierr);
   }
 
-  // Let the matrix know you're done changing it
-  TrilinosMat->fillComplete();
+  // Hand the arrays to Tpetra; the structure is already local, sorted and merged
+  RCP<CrsMatrix> TrilinosMat = rcp(new CrsMatrix(rowMap,colMap,0));
+  TrilinosMat->setAllValues(rowPtrs,colInds,vals);
+  RCP<const Import> importer;
+  if(!domainMap->isSameAs(*colMap))
+    importer = rcp(new Import(domainMap,colMap));
+  TrilinosMat->expertStaticFillComplete(domainMap,rowMap,importer);
+
+  return TrilinosMat;
+}
+
+//! Copy a PETSc BAIJ matrix into a new Tpetra::Experimental::BlockCrsMatrix with the same block size and row distribution.
+/*! The block graph and the blocks are read in one pass over the block CSR arrays of the SeqBAIJ
+    diagonal and off-diagonal blocks, so the matrix is never expanded into point rows.  As for
+    deepCopyPETScAIJMatrixToTpetraCrsMatrix, the block column Map holds the owned block columns
+    followed by MPIBAIJ's sorted colmap.  Other matrix types, e.g. AIJ matrices with a block size,
+    are converted to BAIJ with MatConvert first.
+*/
+template<class Scalar, class LO, class GO, class Node>
+Teuchos::RCP<Tpetra::Experimental::BlockCrsMatrix<Scalar,LO,GO,Node> > deepCopyPETScBAIJMatrixToTpetraBlockCrsMatrix(const Mat& A)
+{
+  using Teuchos::RCP;
+  typedef Tpetra::Map<LO,GO,Node>                                Map;
+  typedef Tpetra::Import<LO,GO,Node>                             Import;
+  typedef Tpetra::CrsGraph<LO,GO,Node>                           CrsGraph;
+  typedef Tpetra::Experimental::BlockCrsMatrix<Scalar,LO,GO,Node> BlockCrsMatrix;
+
+  PetscErrorCode ierr;
+
+  PetscBool isSeqBAIJ, isMPIBAIJ;
+  ierr = PetscObjectTypeCompare((PetscObject)A,MATSEQBAIJ,&isSeqBAIJ); CHKERRCONTINUE(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)A,MATMPIBAIJ,&isMPIBAIJ); CHKERRCONTINUE(ierr);
+  if(!isSeqBAIJ && !isMPIBAIJ)
+  {
+    Mat B;
+    ierr = MatConvert(A,MATBAIJ,MAT_INITIAL_MATRIX,&B); CHKERRCONTINUE(ierr);
+    RCP<BlockCrsMatrix> TrilinosMat = deepCopyPETScBAIJMatrixToTpetraBlockCrsMatrix<Scalar,LO,GO,Node>(B);
+    ierr = MatDestroy(&B); CHKERRCONTINUE(ierr);
+    return TrilinosMat;
+  }
+
+  // Get the communicator
+  RCP< Teuchos::Comm<int> > TrilinosComm;
+#ifdef HAVE_MPI
+  MPI_Comm PETScComm;
+  PetscObjectGetComm( (PetscObject)A, &PETScComm);
+  TrilinosComm = rcp(new Teuchos::MpiComm<int>(PETScComm));
+#else
+  TrilinosComm = rcp(new Teuchos::SerialComm<int>());
+#endif
+
+  // The block rows and block columns owned by this process
+  PetscInt bs, numLocalRows, numLocalCols, numGlobalRows, numGlobalCols, colStart;
+  ierr = MatGetBlockSize(A,&bs); CHKERRCONTINUE(ierr);
+  ierr = MatGetLocalSize(A,&numLocalRows,&numLocalCols); CHKERRCONTINUE(ierr);
+  ierr = MatGetSize(A,&numGlobalRows,&numGlobalCols); CHKERRCONTINUE(ierr);
+  ierr = MatGetOwnershipRangeColumn(A,&colStart,NULL); CHKERRCONTINUE(ierr);
+  const PetscInt numLocalBlockRows = numLocalRows/bs, numLocalBlockCols = numLocalCols/bs, bs2 = bs*bs;
+  RCP<const Map> blockRowMap = rcp(new Map(numGlobalRows/bs,numLocalBlockRows,0,TrilinosComm));
+  RCP<const Map> blockDomainMap = rcp(new Map(numGlobalCols/bs,numLocalBlockCols,0,TrilinosComm));
+
+  // The diagonal and off-diagonal SeqBAIJ blocks, and the global block columns of the latter
+  Mat Ad = A, Ao = NULL;
+  const PetscInt * colmap = NULL;
+  PetscInt numOffDiagBlockCols = 0;
+  if(isMPIBAIJ)
+  {
+    ierr = MatMPIBAIJGetSeqBAIJ(A,&Ad,&Ao,&colmap); CHKERRCONTINUE(ierr);
+    ierr = MatGetSize(Ao,NULL,&numOffDiagBlockCols); CHKERRCONTINUE(ierr);
+    numOffDiagBlockCols /= bs;
+  }
+
+  const PetscInt *dia, *dja, *oia = NULL, *oja = NULL;
+  PetscScalar *dvals, *ovals = NULL;
+  PetscInt n;
+  PetscBool done;
+  ierr = MatGetRowIJ(Ad,0,PETSC_FALSE,PETSC_TRUE,&n,&dia,&dja,&done); CHKERRCONTINUE(ierr);
+  ierr = MatSeqBAIJGetArray(Ad,&dvals); CHKERRCONTINUE(ierr);
+  if(Ao != NULL)
+  {
+    ierr = MatGetRowIJ(Ao,0,PETSC_FALSE,PETSC_TRUE,&n,&oia,&oja,&done); CHKERRCONTINUE(ierr);
+    ierr = MatSeqBAIJGetArray(Ao,&ovals); CHKERRCONTINUE(ierr);
+  }
+
+  // The block column Map holds the locally owned block columns followed by colmap,
+  // so the merged block rows are sorted by local index
+  Teuchos::Array<GO> colGIDs(numLocalBlockCols+numOffDiagBlockCols);
+  for(PetscInt j=0; j < numLocalBlockCols; j++) colGIDs[j] = colStart/bs + j;
+  for(PetscInt j=0; j < numOffDiagBlockCols; j++) colGIDs[numLocalBlockCols+j] = colmap[j];
+  RCP<const Map> blockColMap = rcp(new Map(Teuchos::OrdinalTraits<Tpetra::global_size_t>::invalid(),colGIDs(),0,TrilinosComm));
+
+  const size_t numBlocks = dia[numLocalBlockRows] + (Ao != NULL ? oia[numLocalBlockRows] : 0);
+  Teuchos::ArrayRCP<size_t> rowPtrs(numLocalBlockRows+1);
+  Teuchos::ArrayRCP<LO> colInds(numBlocks);
+  size_t pos = 0;
+  for(PetscInt i=0; i < numLocalBlockRows; i++)
+  {
+    rowPtrs[i] = pos;
+    for(PetscInt k=dia[i]; k < dia[i+1]; k++) colInds[pos++] = dja[k];
+    if(Ao == NULL) continue;
+    for(PetscInt k=oia[i]; k < oia[i+1]; k++) colInds[pos++] = numLocalBlockCols + oja[k];
+  }
+  rowPtrs[numLocalBlockRows] = pos;
+
+  RCP<CrsGraph> graph = rcp(new CrsGraph(blockRowMap,blockColMap,rowPtrs,colInds));
+  RCP<const Import> importer;
+  if(!blockDomainMap->isSameAs(*blockColMap))
+    importer = rcp(new Import(blockDomainMap,blockColMap));
+  graph->expertStaticFillComplete(blockDomainMap,blockRowMap,importer);
+
+  // PETSc stores each block column by column and BlockCrsMatrix row by row
+  RCP<BlockCrsMatrix> TrilinosMat = rcp(new BlockCrsMatrix(*graph,bs));
+  Teuchos::Array<Scalar> blockVals;
+  auto copyBlocks = [bs,bs2] (const PetscScalar* blocks, PetscInt first, PetscInt last, Scalar* v) {
+    for(PetscInt k=first; k < last; k++, v += bs2)
+      for(PetscInt r=0; r < bs; r++)
+        for(PetscInt c=0; c < bs; c++)
+          v[r*bs + c] = static_cast<Scalar>(blocks[k*bs2 + c*bs + r]);
+  };
+  for(PetscInt i=0; i < numLocalBlockRows; i++)
+  {
+    const LO numRowBlocks = rowPtrs[i+1] - rowPtrs[i];
+    blockVals.resize(numRowBlocks*bs2);
+    copyBlocks(dvals, dia[i], dia[i+1], blockVals.getRawPtr());
+    if(Ao != NULL)
+      copyBlocks(ovals, oia[i], oia[i+1], blockVals.getRawPtr() + (dia[i+1]-dia[i])*bs2);
+    TrilinosMat->replaceLocalValues(i,colInds.getRawPtr()+rowPtrs[i],blockVals.getRawPtr(),numRowBlocks);
+  }
+
+  ierr = MatSeqBAIJRestoreArray(Ad,&dvals); CHKERRCONTINUE(ierr);
+  ierr = MatRestoreRowIJ(Ad,0,PETSC_FALSE,PETSC_TRUE,&n,&dia,&dja,&done); CHKERRCONTINUE(ierr);
+  if(Ao != NULL)
+  {
+    ierr = MatSeqBAIJRestoreArray(Ao,&ovals); CHKERRCONTINUE(ierr);
+    ierr = MatRestoreRowIJ(Ao,0,PETSC_FALSE,PETSC_TRUE,&n,&oia,&oja,&done); CHKERRCONTINUE(ierr);
+  }
 
   return TrilinosMat;
 }
@@ -129,15 +381,14 @@ Teuchos::RCP<Tpetra::CrsMatrix<Scalar,LO,GO,Node> > deepCopyPETScAIJMatrixToTpet
 template<class Scalar, class LO, class GO, class Node>
 Teuchos::RCP<Tpetra::Vector<Scalar,LO,GO,Node> > deepCopyPETScVecToTpetraVector(const Vec& v)
 {
-  using Teuchos::ArrayView;
   using Teuchos::RCP;
   using Teuchos::rcp;
   typedef Tpetra::Vector<Scalar,LO,GO,Node>         Vector;
   typedef Tpetra::Map<LO,GO,Node>                   Map;
 
   PetscErrorCode ierr;
-  PetscScalar *vals, *valscopy;
-  PetscInt length, numLocalRows, numGlobalRows;
+  const PetscScalar *vals;
+  PetscInt numLocalRows, numGlobalRows;
 
   // Get information about the distribution from PETSc
   // Note that this is only valid for a block row distribution
@@ -157,13 +408,15 @@ Teuchos::RCP<Tpetra::Vector<Scalar,LO,GO,Node> > deepCopyPETScVecToTpetraVector(
   // Create a Tpetra map reflecting this distribution
   RCP<Map> map = rcp(new Map(numGlobalRows,numLocalRows,0,TrilinosComm));
 
-  ierr = VecGetArray(v,&vals); CHKERRCONTINUE(ierr);
-  ierr = VecGetLocalSize(v,&length); CHKERRCONTINUE(ierr);
-  valscopy = (PetscScalar*) malloc(length*sizeof(PetscScalar));
-  memcpy(valscopy,vals,length*sizeof(PetscScalar));
-  ierr = VecRestoreArray(v,&vals); CHKERRCONTINUE(ierr);
-  ArrayView<PetscScalar> epuView(valscopy,length);
-  RCP<Vector> tpvec = rcp(new Vector(map,epuView));
+  // Copy the entries one at a time, since Scalar need not be PetscScalar
+  RCP<Vector> tpvec = rcp(new Vector(map,false));
+  ierr = VecGetArrayRead(v,&vals); CHKERRCONTINUE(ierr);
+  {
+    Teuchos::ArrayRCP<Scalar> data = tpvec->getDataNonConst();
+    for(PetscInt i=0; i < numLocalRows; i++)
+      data[i] = static_cast<Scalar>(vals[i]);
+  }
+  ierr = VecRestoreArrayRead(v,&vals); CHKERRCONTINUE(ierr);
 
   return tpvec;
 }
@@ -176,7 +429,6 @@ Vec* deepCopyTpetraVectorToPETScVec(Teuchos::RCP<const Tpetra::Vector<Scalar,LO,
   PetscInt              localSize;
   PetscInt              globalSize;
   PetscScalar*          petscData;
-  const PetscScalar*    tpetraData;
 
   localSize = v->getLocalLength();
   globalSize = v->getGlobalLength();
@@ -188,14 +440,344 @@ Vec* deepCopyTpetraVectorToPETScVec(Teuchos::RCP<const Tpetra::Vector<Scalar,LO,
 
   ierr = VecGetArray(*petscVec, &petscData); CHKERRCONTINUE(ierr);
 
-  tpetraData = v->getData().get();
-  for(PetscInt i=0; i<localSize; i++) petscData[i] = tpetraData[i];
+  Teuchos::ArrayRCP<const Scalar> tpetraData = v->getData();
+  std::copy(tpetraData.begin(),tpetraData.end(),petscData);
 
   ierr = VecRestoreArray(*petscVec,&petscData); CHKERRCONTINUE(ierr);
 
   return petscVec;
 }
 
+namespace Details {
+
+//! The arrays behind a PETSc matrix created by createPETScMatFromTpetraCrsMatrix.
+/*! PETSc does not copy the split arrays, and compacts the off-diagonal column indices in place,
+    so they are owned by a container composed with the matrix and released when it is destroyed.
+*/
+template<class Scalar, class LO, class GO, class Node>
+struct PETScSplitArrays {
+  //! Keeps the Tpetra values alive when the diagonal block aliases them
+  Teuchos::RCP<const Tpetra::CrsMatrix<Scalar,LO,GO,Node> > source;
+  Teuchos::Array<PetscInt> di, dj, oi, oj;
+  Teuchos::Array<PetscScalar> da, oa;
+};
+
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode destroyPETScSplitArrays(void* ctx)
+{
+  delete static_cast<PETScSplitArrays<Scalar,LO,GO,Node>*>(ctx);
+  return 0;
+}
+
+} // namespace Details
+
+//! Create a PETSc MPIAIJ matrix with the same entries and distribution as a fill-complete Tpetra::CrsMatrix.
+/*! The local rows of A are split into PETSc's diagonal and off-diagonal blocks in a single pass and
+    handed to MatCreateMPIAIJWithSplitArrays.  The row Map must equal the range Map, and the domain
+    Map must be contiguous.  If aliasValues is true, the diagonal block uses A's value array directly,
+    so later changes to the values of A are seen by B; call PetscObjectStateIncrease on B after
+    changing them so that PETSc knows to set up its preconditioners again.  This is only possible
+    if no process has off-process columns, A's storage is packed on the host, and Scalar is
+    PetscScalar; otherwise an error is returned.  The caller must destroy B with MatDestroy.
+*/
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode createPETScMatFromTpetraCrsMatrix(const Teuchos::RCP<const Tpetra::CrsMatrix<Scalar,LO,GO,Node> >& A, Mat* B, bool aliasValues = false)
+{
+  typedef Tpetra::Map<LO,GO,Node>                                Map;
+  typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node>                   CrsMatrix;
+  typedef typename CrsMatrix::local_matrix_type::memory_space    memory_space;
+  typedef Details::PETScSplitArrays<Scalar,LO,GO,Node>           SplitArrays;
+
+  PetscErrorCode ierr;
+
+#ifdef HAVE_MPI
+  MPI_Comm comm = *(Teuchos::rcp_dynamic_cast<const Teuchos::MpiComm<int> >(A->getComm())->getRawMpiComm());
+#else
+  MPI_Comm comm = PETSC_COMM_SELF;
+#endif
+
+  if(!A->isFillComplete())
+    SETERRQ(comm,PETSC_ERR_ARG_WRONGSTATE,"The Tpetra::CrsMatrix must be fill complete");
+  Teuchos::RCP<const Map> rowMap = A->getRowMap();
+  Teuchos::RCP<const Map> colMap = A->getColMap();
+  Teuchos::RCP<const Map> domainMap = A->getDomainMap();
+  if(!domainMap->isContiguous() || !rowMap->isContiguous() || !rowMap->isSameAs(*A->getRangeMap()))
+    SETERRQ(comm,PETSC_ERR_SUP,"PETSc needs contiguous row and domain maps, and equal row and range maps");
+
+  const PetscInt numLocalRows = rowMap->getNodeNumElements();
+  const PetscInt numLocalCols = domainMap->getNodeNumElements();
+  const PetscInt numColMapCols = colMap->getNodeNumElements();
+  const GO colStart = domainMap->getMinGlobalIndex();
+
+  // Where each column of the column Map goes: a local index into the diagonal block, or -1 and a global index
+  Teuchos::Array<PetscInt> diagCol(numColMapCols), globalCol(numColMapCols);
+  bool isIdentity = true;
+  for(PetscInt c=0; c < numColMapCols; c++)
+  {
+    const GO gid = colMap->getGlobalElement(c);
+    globalCol[c] = gid;
+    diagCol[c] = domainMap->isNodeGlobalElement(gid) ? (PetscInt)(gid - colStart) : -1;
+    isIdentity = isIdentity && diagCol[c] == c;
+  }
+
+  SplitArrays* arrays = new SplitArrays;
+  const bool canAlias = aliasValues && isIdentity && A->isStorageOptimized()
+                     && std::is_same<Scalar,PetscScalar>::value
+                     && std::is_same<memory_space,Kokkos::HostSpace>::value;
+  if(aliasValues)
+  {
+    int localOk = canAlias ? 1 : 0, globalOk;
+    Teuchos::reduceAll(*A->getComm(),Teuchos::REDUCE_MIN,1,&localOk,&globalOk);
+    if(!globalOk)
+    {
+      delete arrays;
+      SETERRQ(comm,PETSC_ERR_SUP,"The values of this Tpetra::CrsMatrix cannot be aliased by a PETSc matrix");
+    }
+    arrays->source = A;
+  }
+
+  // Split each row into the two blocks; PETSc wants the columns of each row sorted
+  const size_t nnz = A->getNodeNumEntries();
+  arrays->di.resize(numLocalRows+1);
+  arrays->oi.resize(numLocalRows+1);
+  arrays->dj.reserve(nnz);
+  arrays->oj.reserve(canAlias ? 1 : nnz);
+  if(!canAlias)
+  {
+    arrays->da.reserve(nnz);
+    arrays->oa.reserve(nnz);
+  }
+  Teuchos::ArrayView<const LO> inds;
+  Teuchos::ArrayView<const Scalar> vals;
+  arrays->di[0] = arrays->oi[0] = 0;
+  for(PetscInt i=0; i < numLocalRows; i++)
+  {
+    A->getLocalRowView(i,inds,vals);
+    const size_t dStart = arrays->dj.size(), oStart = arrays->oj.size();
+    for(size_t k=0; k < (size_t)inds.size(); k++)
+    {
+      const PetscInt c = diagCol[inds[k]];
+      if(c >= 0)
+      {
+        arrays->dj.push_back(c);
+        if(!canAlias) arrays->da.push_back(vals[k]);
+      }
+      else
+      {
+        arrays->oj.push_back(globalCol[inds[k]]);
+        arrays->oa.push_back(vals[k]);
+      }
+    }
+    if(!canAlias)
+    {
+      Tpetra::sort2(arrays->dj.begin()+dStart,arrays->dj.end(),arrays->da.begin()+dStart);
+      Tpetra::sort2(arrays->oj.begin()+oStart,arrays->oj.end(),arrays->oa.begin()+oStart);
+    }
+    arrays->di[i+1] = arrays->dj.size();
+    arrays->oi[i+1] = arrays->oj.size();
+  }
+
+  // PETSc may dereference the arrays even when they are empty
+  if(arrays->oj.empty())
+  {
+    arrays->oj.push_back(0);
+    arrays->oa.push_back(0);
+  }
+  if(arrays->dj.empty())
+  {
+    arrays->dj.push_back(0);
+    arrays->da.push_back(0);
+  }
+
+  PetscScalar* da = arrays->da.getRawPtr();
+  if(canAlias && nnz > 0)
+    da = reinterpret_cast<PetscScalar*>(A->getLocalMatrix().values.ptr_on_device());
+
+  ierr = MatCreateMPIAIJWithSplitArrays(comm,numLocalRows,numLocalCols,rowMap->getGlobalNumElements(),
+                                        domainMap->getGlobalNumElements(),arrays->di.getRawPtr(),
+                                        arrays->dj.getRawPtr(),da,arrays->oi.getRawPtr(),
+                                        arrays->oj.getRawPtr(),arrays->oa.getRawPtr(),B);
+  if(ierr)
+  {
+    delete arrays;
+    CHKERRQ(ierr);
+  }
+
+  // Tie the lifetime of the arrays to the PETSc matrix.  Until the container's destroy routine is
+  // set the arrays are still ours; on an error B, which points into them, is destroyed first.
+  PetscContainer container = NULL;
+  bool containerOwnsArrays = false;
+  ierr = PetscContainerCreate(comm,&container);
+  if(!ierr) ierr = PetscContainerSetPointer(container,arrays);
+  if(!ierr) ierr = PetscContainerSetUserDestroy(container,Details::destroyPETScSplitArrays<Scalar,LO,GO,Node>);
+  if(!ierr) containerOwnsArrays = true;
+  if(!ierr) ierr = PetscObjectCompose((PetscObject)*B,"xSDKTrilinos_SplitArrays",(PetscObject)container);
+  if(ierr)
+  {
+    MatDestroy(B);
+    PetscContainerDestroy(&container);
+    if(!containerOwnsArrays)
+      delete arrays;
+    CHKERRQ(ierr);
+  }
+  ierr = PetscContainerDestroy(&container);CHKERRQ(ierr);
+
+  return 0;
+}
+
+namespace Details {
+
+//! Work space of PETScAIJMatrix::apply() for multivectors, shared by copies of the matrix.
+/*! All columns of X are exchanged by one VecScatter, which is rebuilt when the number of
+    vectors or the nonzero structure of the matrix changes.  The column-sized Vecs have no
+    storage of their own; they are placed over one column at a time.
+*/
+struct PETScAIJApplyWorkspace {
+  PetscInt numVecs;
+  PetscObjectState nonzeroState;
+  Vec packedX;        // the columns of X one after another, as one parallel Vec
+  Vec ghosts;         // the off-process entries of X needed by this process, column by column
+  VecScatter scatter; // from packedX to ghosts
+  Vec work;           // the diagonal block times X, column by column
+  Vec xCol, yCol, wCol, gCol;
+
+  PETScAIJApplyWorkspace()
+    : numVecs(0), nonzeroState(0), packedX(NULL), ghosts(NULL), scatter(NULL), work(NULL),
+      xCol(NULL), yCol(NULL), wCol(NULL), gCol(NULL) {}
+
+  ~PETScAIJApplyWorkspace()
+  {
+    // Matrices may outlive PetscFinalize, after which there is nothing left to free
+    PetscBool finalized = PETSC_TRUE;
+    PetscFinalized(&finalized);
+    if(!finalized)
+      destroy();
+  }
+
+  PetscErrorCode destroy()
+  {
+    PetscErrorCode ierr;
+    ierr = VecScatterDestroy(&scatter);CHKERRQ(ierr);
+    ierr = VecDestroy(&packedX);CHKERRQ(ierr);
+    ierr = VecDestroy(&ghosts);CHKERRQ(ierr);
+    ierr = VecDestroy(&work);CHKERRQ(ierr);
+    ierr = VecDestroy(&xCol);CHKERRQ(ierr);
+    ierr = VecDestroy(&yCol);CHKERRQ(ierr);
+    ierr = VecDestroy(&wCol);CHKERRQ(ierr);
+    ierr = VecDestroy(&gCol);CHKERRQ(ierr);
+    numVecs = 0;
+    return 0;
+  }
+
+  //! Build the scatter and work Vecs for k vectors, unless they are already up to date.
+  PetscErrorCode setUp(Mat A, PetscInt k)
+  {
+    PetscErrorCode ierr;
+    PetscObjectState state;
+    ierr = MatGetNonzeroState(A,&state);CHKERRQ(ierr);
+    if(k == numVecs && state == nonzeroState)
+      return 0;
+    ierr = destroy();CHKERRQ(ierr);
+
+    Mat Ad, Ao;
+    const PetscInt *garray, *ranges;
+    PetscInt m, n, numGhosts;
+    PetscMPIInt numProcs;
+    MPI_Comm comm;
+    ierr = MatMPIAIJGetSeqAIJ(A,&Ad,&Ao,&garray);CHKERRQ(ierr);
+    ierr = MatGetLocalSize(A,&m,&n);CHKERRQ(ierr);
+    ierr = MatGetSize(Ao,NULL,&numGhosts);CHKERRQ(ierr);
+    ierr = MatGetOwnershipRangesColumn(A,&ranges);CHKERRQ(ierr);
+    ierr = PetscObjectGetComm((PetscObject)A,&comm);CHKERRQ(ierr);
+    ierr = MPI_Comm_size(comm,&numProcs);CHKERRQ(ierr);
+
+    // Process p stores its n_p entries of each column one after another, starting at ranges[p]*k
+    PetscInt *from;
+    ierr = PetscMalloc1(numGhosts*k,&from);CHKERRQ(ierr);
+    for(PetscInt g=0; g < numGhosts; g++)
+    {
+      const PetscInt p = std::upper_bound(ranges,ranges+numProcs+1,garray[g]) - ranges - 1;
+      const PetscInt np = ranges[p+1] - ranges[p];
+      for(PetscInt c=0; c < k; c++)
+        from[c*numGhosts+g] = ranges[p]*k + c*np + (garray[g] - ranges[p]);
+    }
+    IS isFrom, isTo;
+    ierr = ISCreateGeneral(PETSC_COMM_SELF,numGhosts*k,from,PETSC_OWN_POINTER,&isFrom);CHKERRQ(ierr);
+    ierr = ISCreateStride(PETSC_COMM_SELF,numGhosts*k,0,1,&isTo);CHKERRQ(ierr);
+
+    ierr = VecCreateMPIWithArray(comm,1,n*k,PETSC_DECIDE,NULL,&packedX);CHKERRQ(ierr);
+    ierr = VecCreateSeq(PETSC_COMM_SELF,numGhosts*k,&ghosts);CHKERRQ(ierr);
+    ierr = VecScatterCreate(packedX,isFrom,ghosts,isTo,&scatter);CHKERRQ(ierr);
+    ierr = ISDestroy(&isFrom);CHKERRQ(ierr);
+    ierr = ISDestroy(&isTo);CHKERRQ(ierr);
+
+    ierr = VecCreateSeq(PETSC_COMM_SELF,m*k,&work);CHKERRQ(ierr);
+    ierr = VecCreateSeqWithArray(PETSC_COMM_SELF,1,n,NULL,&xCol);CHKERRQ(ierr);
+    ierr = VecCreateSeqWithArray(PETSC_COMM_SELF,1,m,NULL,&yCol);CHKERRQ(ierr);
+    ierr = VecCreateSeqWithArray(PETSC_COMM_SELF,1,m,NULL,&wCol);CHKERRQ(ierr);
+    ierr = VecCreateSeqWithArray(PETSC_COMM_SELF,1,numGhosts,NULL,&gCol);CHKERRQ(ierr);
+
+    numVecs = k;
+    nonzeroState = state;
+    return 0;
+  }
+};
+
+//! A SELL-C-sigma copy of a matrix for PETScAIJMatrix::apply, converted again only when the matrix changes.
+struct PETScSELLShadow {
+  Mat sell;
+  PetscObjectState state;
+
+  PETScSELLShadow() : sell(NULL), state(0) {}
+
+  ~PETScSELLShadow()
+  {
+    // Matrices may outlive PetscFinalize, after which there is nothing left to free
+    PetscBool finalized = PETSC_TRUE;
+    PetscFinalized(&finalized);
+    if(!finalized)
+      MatDestroy(&sell);
+  }
+
+  //! Convert A to SELL, unless it is unchanged since the last conversion, and return the copy.
+  PetscErrorCode update(Mat A, Mat* B)
+  {
+#if PETSC_VERSION_GE(3,11,0)
+    PetscErrorCode ierr;
+    PetscObjectState current;
+    ierr = PetscObjectStateGet((PetscObject)A,&current);CHKERRQ(ierr);
+    if(sell == NULL || current != state)
+    {
+      ierr = MatDestroy(&sell);CHKERRQ(ierr);
+      ierr = MatConvert(A,MATSELL,MAT_INITIAL_MATRIX,&sell);CHKERRQ(ierr);
+      state = current;
+    }
+    *B = sell;
+    return 0;
+#else
+    SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"MATSELL requires PETSc 3.11 or later");
+#endif
+  }
+};
+
+//! y = op(A)*x
+inline PetscErrorCode PETScMultWithMode(Mat A, Teuchos::ETransp mode, Vec x, Vec y)
+{
+  PetscErrorCode ierr;
+  if(mode == Teuchos::NO_TRANS) {
+    ierr = MatMult(A,x,y);CHKERRQ(ierr);
+  }
+  else if(mode == Teuchos::TRANS) {
+    ierr = MatMultTranspose(A,x,y);CHKERRQ(ierr);
+  }
+  else { // mode == Teuchos::CONJ_TRANS
+    ierr = MatMultHermitianTranspose(A,x,y);CHKERRQ(ierr);
+  }
+  return 0;
+}
+
+} // namespace Details
+
 } // end namespace xSDKTrilinos
 
 
@@ -206,8 +788,10 @@ namespace Tpetra {
 /*! The PETScAIJMatrix is a wrapper class for PETSc sequential or parallel AIJ matrices.  It is
     derived from the Tpetra_RowMatrix class, and so provides PETSc users access to Trilinos preconditioners.
     This class is lightweight, i.e., there are no deep copies of matrix data.  Whenever possible, class
-    methods utilize callbacks to native PETSc functions.  Currently, only sequential and parallel point AIJ
-    PETSc matrix types are supported.
+    methods utilize callbacks to native PETSc functions.  Sequential and parallel AIJ and BAIJ matrices
+    are supported.  A BAIJ matrix is seen through its point rows, while apply() uses PETSc's block
+    kernels; xSDKTrilinos::deepCopyPETScBAIJMatrixToTpetraBlockCrsMatrix() copies it into a
+    Tpetra::Experimental::BlockCrsMatrix for block preconditioners.
 */    
 
 template<class Scalar = Details::DefaultTypes::scalar_type, 
@@ -215,7 +799,8 @@ template<class Scalar = Details::DefaultTypes::scalar_type,
          class GO = Details::DefaultTypes::global_ordinal_type, 
          class Node = Details::DefaultTypes::node_type>
 class PETScAIJMatrix : 
-  virtual public RowMatrix<Scalar,LO,GO,Node> 
+  virtual public RowMatrix<Scalar,LO,GO,Node>,
+  public LocalRowsCopyable<Scalar,LO,GO,Node>
 {
 private:
   typedef Teuchos::Comm<int>                   Comm;
@@ -235,13 +820,30 @@ public:
   /*! Creates a PETScAIJMatrix object by encapsulating an existing PETSc matrix.
     
     \param In
-           Amat - A completely constructed PETSc SEQAIJ or MPIAIJ matrix.
+           Amat - A completely constructed PETSc SEQAIJ, MPIAIJ, SEQBAIJ or MPIBAIJ matrix.  Other types throw std::invalid_argument.
   */
   PETScAIJMatrix(Mat Amat);
 
   //! PETScAIJMatrix Destructor
   ~PETScAIJMatrix() {};
   //@}
+
+  //! The wrapped PETSc matrix.
+  Mat getPETScMat() const { return Amat_; };
+
+  //! The block size of the PETSc matrix; one for point AIJ matrices.
+  PetscInt getBlockSize() const { return graph_->getBlockSize(); };
+
+  //! Whether apply() multiplies with a SELL-C-sigma copy of an AIJ matrix.
+  /*! PETSc's SELL kernels vectorize the multiply with AVX2 or AVX-512, which AIJ's do not.  The copy
+      is made by the first apply() and again only after the matrix changes; rows, the diagonal,
+      norms and scaling are still served from the AIJ matrix.  Transposed applies always use AIJ.
+      Requires PETSc 3.11 or later, and is ignored for BAIJ matrices.
+  */
+  void setApplyWithSELL(bool useSELL);
+
+  //! Whether apply() multiplies with a SELL copy; see setApplyWithSELL().
+  bool getApplyWithSELL() const { return useSELL_; };
   
   //! @name Extraction methods
   //@{ 
@@ -252,7 +854,7 @@ public:
     //! The current number of entries on the calling process in the specified local row.
     size_t getNumEntriesInLocalRow(LO localRow) const { return graph_->getNumEntriesInLocalRow(localRow); };
 
-    //! Get a copy of the given local row's entries. 
+    //! Get a copy of the given local row's entries, with column Map indices.  No memory is allocated.
     void getLocalRowCopy(LO LocalRow, const Teuchos::ArrayView<LO> & Indices, const Teuchos::ArrayView<Scalar> & Values, size_t & NumEntries) const;
 
     //! Get a copy of the given global row's entries. 
@@ -266,6 +868,23 @@ public:
 
     //! Get a copy of the diagonal entries, distributed by the row Map. 
     void getLocalDiagCopy(Vector<Scalar,LO,GO,Node> & diag) const;
+
+    //! The diagonal entries, distributed by the row Map.
+    /*! The diagonal is kept between calls, and only read from PETSc again once the matrix has changed
+        according to its PETSc object state.  Repeated smoother setups on an unchanged matrix are free.
+    */
+    Teuchos::RCP<const Vector<Scalar,LO,GO,Node> > getDiagonal() const;
+
+    //! The reciprocals of the diagonal entries, cached like getDiagonal(); zero entries stay zero, as in VecReciprocal.
+    Teuchos::RCP<const Vector<Scalar,LO,GO,Node> > getInverseDiagonal() const;
+
+    //! The offsets of the local rows [rowBegin,rowEnd) in a CSR copy of them.
+    void getLocalRowPtrs(LO rowBegin, LO rowEnd, const Teuchos::ArrayView<size_t> & rowptr) const { graph_->getLocalRowPtrs(rowBegin, rowEnd, rowptr); };
+
+    //! Copy the local rows [rowBegin,rowEnd), with column Map indices, into CSR arrays laid out by getLocalRowPtrs().
+    /*! The rows are read directly from PETSc's CSR arrays, split across the host threads. */
+    void getLocalRowsCopy(LO rowBegin, LO rowEnd, const Teuchos::ArrayView<const size_t> & rowptr,
+                          const Teuchos::ArrayView<LO> & cols, const Teuchos::ArrayView<Scalar> & vals) const;
     //@}
 
     //! @name Computational methods
@@ -285,6 +904,9 @@ public:
     //! Scale the RowMatrix on the right with the given Vector x.
     void rightScale(const Vector<Scalar,LO,GO,Node> & x);
 
+    //! Scale the matrix on both sides in one pass over its entries, A = diag(left)*A*diag(right).
+    void scale(const Vector<Scalar,LO,GO,Node> & left, const Vector<Scalar,LO,GO,Node> & right);
+
   //@}
 
   //! @name Matrix Properties Query Methods
@@ -315,8 +937,17 @@ public:
   //@{ 
 
     //! The Frobenius norm of the matrix.
+    /*! The Frobenius, one and infinity norms are computed together in one pass over the matrix, and kept
+        until the matrix changes according to its PETSc object state, so repeated queries are free.
+    */
     mag_type getFrobeniusNorm() const;
 
+    //! The one norm of the matrix, the largest column sum of absolute values; cached like getFrobeniusNorm().
+    mag_type getOneNorm() const;
+
+    //! The infinity norm of the matrix, the largest row sum of absolute values; cached like getFrobeniusNorm().
+    mag_type getInfNorm() const;
+
     //! The index base for global indices in this matrix.
     GO getIndexBase() const { return getRowMap()->getIndexBase(); };
 
@@ -359,6 +990,9 @@ public:
     //! The RowGraph associated with this matrix.
     Teuchos::RCP<const RowGraph<LO,GO,Node> > getGraph() const { return graph_; };
 
+    //! An Export from the column Map to the domain Map, to combine per-column contributions of all processes.
+    Teuchos::RCP<const Export<LO,GO,Node> > getDomainExporter() const { return graph_->getDomainExporter(); };
+
     //! The communicator over which this matrix is distributed. 
     Teuchos::RCP<const Teuchos::Comm<int> > getComm() const { return graph_->getComm(); };
 
@@ -381,9 +1015,38 @@ public:
 
  private:
 
+    //! Computes Y = beta*Y + alpha*A*X for an MPIAIJ matrix, overlapping the ghost exchange of all columns with the diagonal block.
+    PetscErrorCode applyOverlapped(const MV & X, MV & Y, Scalar alpha, Scalar beta) const;
+
+    //! Computes Y = beta*Y + alpha*op(A)*X one column at a time, where A is Amat_ or its SELL copy.
+    PetscErrorCode applyByColumn(Mat A, const MV & X, MV & Y, Teuchos::ETransp mode, Scalar alpha, Scalar beta) const;
+
+    //! Read the diagonal and its inverse from PETSc, unless the matrix is unchanged since they were last read.
+    PetscErrorCode updateDiagonal() const;
+
+    //! Compute the Frobenius, one and infinity norms in one pass, unless the matrix is unchanged since they were last computed.
+    PetscErrorCode updateNorms() const;
+
+    //! A = diag(left)*A*diag(right) through MatDiagonalScale; either side may be NULL.
+    PetscErrorCode diagonalScale(const Vector<Scalar,LO,GO,Node> * left, const Vector<Scalar,LO,GO,Node> * right);
+
     Mat Amat_; // general PETSc matrix type
 
     Teuchos::RCP<Graph> graph_;
+
+    Teuchos::RCP<xSDKTrilinos::Details::PETScAIJApplyWorkspace> workspace_;
+
+    bool useSELL_;
+    Teuchos::RCP<xSDKTrilinos::Details::PETScSELLShadow> sell_;
+
+    //! The diagonal and its inverse, valid while the object state of Amat_ equals diagState_
+    mutable Teuchos::RCP<Vector<Scalar,LO,GO,Node> > diag_, invDiag_;
+    mutable PetscObjectState diagState_;
+
+    //! The Frobenius, one and infinity norms, valid while haveNorms_ and the object state of Amat_ equals normState_
+    mutable mag_type frobeniusNorm_, oneNorm_, infNorm_;
+    mutable bool haveNorms_;
+    mutable PetscObjectState normState_;
     
  //! Copy constructor (not accessible to users).
   //FIXME we need a copy ctor
@@ -393,25 +1056,53 @@ public:
 //==============================================================================
 template<class Scalar, class LO, class GO, class Node>
 PETScAIJMatrix<Scalar,LO,GO,Node>::PETScAIJMatrix(Mat Amat)
-  : Amat_(Amat)
+  : Amat_(Amat), useSELL_(false), diagState_(0), frobeniusNorm_(0), oneNorm_(0), infNorm_(0), haveNorms_(false), normState_(0)
 {
   graph_ = Teuchos::rcp(new PETScAIJGraph<LO,GO,Node>(Amat));
+  workspace_ = Teuchos::rcp(new xSDKTrilinos::Details::PETScAIJApplyWorkspace());
+  sell_ = Teuchos::rcp(new xSDKTrilinos::Details::PETScSELLShadow());
 } //PETScAIJMatrix(Mat Amat)
 
 
 
+//! Whether apply() multiplies with a SELL-C-sigma copy of an AIJ matrix.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+void PETScAIJMatrix<Scalar,LO,GO,Node>::setApplyWithSELL(bool useSELL)
+{
+#if !PETSC_VERSION_GE(3,11,0)
+  TEUCHOS_TEST_FOR_EXCEPTION(useSELL, std::runtime_error,
+         Teuchos::typeName (*this) << "::setApplyWithSELL(): MATSELL requires PETSc 3.11 or later.");
+#endif
+  useSELL_ = useSELL && graph_->isAIJ();
+}
+
+
+
 //! Get a copy of the given local row's entries. 
 //==============================================================================
 template<class Scalar, class LO, class GO, class Node>
 void PETScAIJMatrix<Scalar,LO,GO,Node>::getLocalRowCopy(LO LocalRow, const Teuchos::ArrayView<LO> & Indices, const Teuchos::ArrayView<Scalar> & Values, size_t & NumEntries) const
 {
-  GO globalRow = LocalRow + getDomainMap()->getMinGlobalIndex();
-  
-  getGlobalRowCopy(globalRow, Indices, Values, NumEntries);
+  graph_->getLocalRowEntries(LocalRow, Indices, Values.getRawPtr(), Values.size(), NumEntries);
 } //ExtractMyRowCopy()
 
 
 
+//! Copy the local rows [rowBegin,rowEnd), with column Map indices, into CSR arrays laid out by getLocalRowPtrs().
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+void PETScAIJMatrix<Scalar,LO,GO,Node>::getLocalRowsCopy(LO rowBegin, LO rowEnd, const Teuchos::ArrayView<const size_t> & rowptr,
+                                                         const Teuchos::ArrayView<LO> & cols, const Teuchos::ArrayView<Scalar> & vals) const
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(rowptr.size() > 0 && (size_t)vals.size() < rowptr[rowptr.size()-1], std::runtime_error,
+         Teuchos::typeName (*this) << "::getLocalRowsCopy(): ArrayViews are not large enough to store the requested data.");
+
+  graph_->getLocalRowsEntries(rowBegin, rowEnd, rowptr, cols, vals.getRawPtr());
+}
+
+
+
 //! Get a copy of the given global row's entries. 
 //==============================================================================
 template<class Scalar, class LO, class GO, class Node>
@@ -436,8 +1127,6 @@ void PETScAIJMatrix<Scalar,LO,GO,Node>::getGlobalRowCopy(GO GlobalRow, const Teu
   NumEntries = ncols;
 
   // Copy it to a Trilinos Array
-  Teuchos::Array<LO> tpCols(ncols);
-  Teuchos::Array<Scalar> tpVals(ncols);
   for(LO i=0; i<ncols; i++)
   {
     Indices[i] = cols[i];
@@ -454,96 +1143,244 @@ template<class Scalar, class LO, class GO, class Node>
 void PETScAIJMatrix<Scalar,LO,GO,Node>::getLocalDiagCopy(Vector<Scalar,LO,GO,Node> & diag) const
 {
   PetscErrorCode ierr;
-  Vec v;
-  PetscScalar * diagonal;
+  ierr = updateDiagonal();CHKERRV(ierr);
+  Tpetra::deep_copy(diag, *diag_);
+}
+
 
-  size_t nlocal = getDomainMap()->getNodeNumElements();
 
-  // Get PETSc's diagonal
-  ierr = MatCreateVecs(Amat_,&v,NULL);CHKERRV(ierr);
-  ierr = MatGetDiagonal(Amat_,v);CHKERRV(ierr);
-  ierr = VecGetArray(v,&diagonal);CHKERRV(ierr);
+//! The diagonal entries, distributed by the row Map.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+Teuchos::RCP<const Vector<Scalar,LO,GO,Node> > PETScAIJMatrix<Scalar,LO,GO,Node>::getDiagonal() const
+{
+  PetscErrorCode ierr = updateDiagonal();
+  TEUCHOS_TEST_FOR_EXCEPTION(ierr != 0, std::runtime_error,
+         Teuchos::typeName (*this) << "::getDiagonal(): PETSc error " << ierr << ".");
+  return diag_;
+}
+
+
+
+//! The reciprocals of the diagonal entries.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+Teuchos::RCP<const Vector<Scalar,LO,GO,Node> > PETScAIJMatrix<Scalar,LO,GO,Node>::getInverseDiagonal() const
+{
+  PetscErrorCode ierr = updateDiagonal();
+  TEUCHOS_TEST_FOR_EXCEPTION(ierr != 0, std::runtime_error,
+         Teuchos::typeName (*this) << "::getInverseDiagonal(): PETSc error " << ierr << ".");
+  return invDiag_;
+}
+
 
-  // Copy it to a Trilinos Vector
-  for(size_t i=0; i<nlocal; i++)
+
+//! Read the diagonal and its inverse from PETSc, unless the matrix is unchanged since they were last read.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode PETScAIJMatrix<Scalar,LO,GO,Node>::updateDiagonal() const
+{
+  using Teuchos::ArrayRCP;
+
+  PetscErrorCode ierr;
+  PetscObjectState state;
+  ierr = PetscObjectStateGet((PetscObject)Amat_,&state);CHKERRQ(ierr);
+  if(!diag_.is_null() && state == diagState_)
+    return 0;
+
+  if(diag_.is_null())
   {
-    diag.replaceLocalValue(i,diagonal[i]);
+    diag_ = Teuchos::rcp(new Vector<Scalar,LO,GO,Node>(getRowMap(), false));
+    invDiag_ = Teuchos::rcp(new Vector<Scalar,LO,GO,Node>(getRowMap(), false));
   }
 
-  ierr = VecDestroy(&v);CHKERRV(ierr);
+  // PETSc writes straight into the Tpetra vectors through Vecs wrapping their storage
+  MPI_Comm comm;
+  PetscMPIInt numProcs;
+  ierr = PetscObjectGetComm((PetscObject)Amat_,&comm);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&numProcs);CHKERRQ(ierr);
+  const PetscInt m = getRowMap()->getNodeNumElements();
+  {
+    ArrayRCP<Scalar> diagData = diag_->get1dViewNonConst();
+    ArrayRCP<Scalar> invDiagData = invDiag_->get1dViewNonConst();
+    Vec d, dinv;
+    if(numProcs > 1)
+    {
+      ierr = VecCreateMPIWithArray(comm,1,m,PETSC_DECIDE,diagData.getRawPtr(),&d);CHKERRQ(ierr);
+      ierr = VecCreateMPIWithArray(comm,1,m,PETSC_DECIDE,invDiagData.getRawPtr(),&dinv);CHKERRQ(ierr);
+    }
+    else
+    {
+      ierr = VecCreateSeqWithArray(PETSC_COMM_SELF,1,m,diagData.getRawPtr(),&d);CHKERRQ(ierr);
+      ierr = VecCreateSeqWithArray(PETSC_COMM_SELF,1,m,invDiagData.getRawPtr(),&dinv);CHKERRQ(ierr);
+    }
+    ierr = MatGetDiagonal(Amat_,d);CHKERRQ(ierr);
+    ierr = VecCopy(d,dinv);CHKERRQ(ierr);
+    ierr = VecReciprocal(dinv);CHKERRQ(ierr);
+    ierr = VecDestroy(&d);CHKERRQ(ierr);
+    ierr = VecDestroy(&dinv);CHKERRQ(ierr);
+  }
+
+  diagState_ = state;
+  return 0;
 }
 
 
 
 //! Computes the operator-multivector application.
+/*! PETSc's MatMult already overlaps the diagonal block with the ghost exchange for one vector.
+    For several vectors and an MPIAIJ matrix, the ghost entries of all columns are exchanged at
+    once while the diagonal block is applied to each column, and the off-diagonal block is added
+    when the exchange completes.  X is never modified.
+*/
 //==============================================================================
 template<class Scalar, class LO, class GO, class Node>
 void PETScAIJMatrix<Scalar,LO,GO,Node>::apply(const MV & X, MV & Y, Teuchos::ETransp mode, Scalar alpha, Scalar beta) const
 {
-  using Teuchos::ArrayRCP;
-
   TEUCHOS_TEST_FOR_EXCEPTION(!isFillComplete(), std::runtime_error,
          Teuchos::typeName (*this) << "::apply(): underlying matrix is not fill-complete.");
   TEUCHOS_TEST_FOR_EXCEPTION(X.getNumVectors () != Y.getNumVectors (), std::runtime_error,
          Teuchos::typeName (*this) << "::apply(X,Y): X and Y must have the same number of vectors.");
 
-  int numVectors = X.getNumVectors();
+  PetscErrorCode ierr;
+  PetscBool isMPIAIJ;
+  ierr = PetscObjectTypeCompare((PetscObject)Amat_,MATMPIAIJ,&isMPIAIJ);CHKERRV(ierr);
+
+  if(mode == Teuchos::NO_TRANS && useSELL_) {
+    Mat sell;
+    ierr = sell_->update(Amat_,&sell);CHKERRV(ierr);
+    ierr = applyByColumn(sell,X,Y,mode,alpha,beta);CHKERRV(ierr);
+  }
+  else if(mode == Teuchos::NO_TRANS && isMPIAIJ && X.getNumVectors() > 1) {
+    ierr = applyOverlapped(X,Y,alpha,beta);CHKERRV(ierr);
+  }
+  else {
+    ierr = applyByColumn(Amat_,X,Y,mode,alpha,beta);CHKERRV(ierr);
+  }
+}
+
+
+
+//! Computes Y = beta*Y + alpha*A*X for an MPIAIJ matrix, overlapping the ghost exchange of all columns with the diagonal block.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode PETScAIJMatrix<Scalar,LO,GO,Node>::applyOverlapped(const MV & X, MV & Y, Scalar alpha, Scalar beta) const
+{
+  using Teuchos::ArrayRCP;
+  using Teuchos::RCP;
+
+  PetscErrorCode ierr;
+  xSDKTrilinos::Details::PETScAIJApplyWorkspace& ws = *workspace_;
+  const PetscInt numVectors = X.getNumVectors();
+
+  // The scatter expects the columns of X one after another
+  RCP<const MV> Xpacked = Teuchos::rcpFromRef(X);
+  if(!X.isConstantStride() || X.getStride() != X.getLocalLength())
+    Xpacked = Teuchos::rcp(new MV(X, Teuchos::Copy));
+
+  ierr = ws.setUp(Amat_,numVectors);CHKERRQ(ierr);
+  Mat Ad, Ao;
+  ierr = MatMPIAIJGetSeqAIJ(Amat_,&Ad,&Ao,NULL);CHKERRQ(ierr);
+
+  ArrayRCP<const Scalar> xData = Xpacked->get1dView();
+  ArrayRCP< ArrayRCP<Scalar> > yView = Y.get2dViewNonConst();
+  PetscScalar* x = const_cast<PetscScalar*>(xData.getRawPtr());
+  const size_t numRows = Y.getLocalLength();
+  const size_t numCols = Xpacked->getLocalLength();
+  PetscInt numGhosts;
+  ierr = MatGetSize(Ao,NULL,&numGhosts);CHKERRQ(ierr);
+
+  // The cached Vecs give the placed arrays back even if a PETSc call fails
+  xSDKTrilinos::Details::PETScPlacedArray packedX, xCol, wCol, gCol, yCol;
+
+  // Start the exchange of the ghost entries of every column
+  ierr = packedX.place(ws.packedX,x);CHKERRQ(ierr);
+  ierr = VecScatterBegin(ws.scatter,ws.packedX,ws.ghosts,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+
+  // Apply the diagonal block while the messages are in flight
+  PetscScalar* work;
+  ierr = VecGetArray(ws.work,&work);CHKERRQ(ierr);
+  for(PetscInt c=0; c < numVectors; c++)
+  {
+    ierr = xCol.place(ws.xCol,x+c*numCols);CHKERRQ(ierr);
+    ierr = wCol.place(ws.wCol,work+c*numRows);CHKERRQ(ierr);
+    ierr = MatMult(Ad,ws.xCol,ws.wCol);CHKERRQ(ierr);
+    ierr = xCol.reset();CHKERRQ(ierr);
+    ierr = wCol.reset();CHKERRQ(ierr);
+  }
+
+  ierr = VecScatterEnd(ws.scatter,ws.packedX,ws.ghosts,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = packedX.reset();CHKERRQ(ierr);
+
+  // Add the off-diagonal block and combine with Y
+  const PetscScalar* ghosts;
+  ierr = VecGetArrayRead(ws.ghosts,&ghosts);CHKERRQ(ierr);
+  for(PetscInt c=0; c < numVectors; c++)
+  {
+    ierr = wCol.place(ws.wCol,work+c*numRows);CHKERRQ(ierr);
+    ierr = gCol.place(ws.gCol,ghosts+c*numGhosts);CHKERRQ(ierr);
+    ierr = yCol.place(ws.yCol,yView[c].getRawPtr());CHKERRQ(ierr);
+    ierr = MatMultAdd(Ao,ws.gCol,ws.wCol,ws.wCol);CHKERRQ(ierr);
+    ierr = VecAXPBY(ws.yCol,alpha,beta,ws.wCol);CHKERRQ(ierr);
+    ierr = wCol.reset();CHKERRQ(ierr);
+    ierr = gCol.reset();CHKERRQ(ierr);
+    ierr = yCol.reset();CHKERRQ(ierr);
+  }
+  ierr = VecRestoreArrayRead(ws.ghosts,&ghosts);CHKERRQ(ierr);
+  ierr = VecRestoreArray(ws.work,&work);CHKERRQ(ierr);
+
+  return 0;
+}
+
+
+
+//! Computes Y = beta*Y + alpha*op(A)*X one column at a time, where A is Amat_ or its SELL copy.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode PETScAIJMatrix<Scalar,LO,GO,Node>::applyByColumn(Mat A, const MV & X, MV & Y, Teuchos::ETransp mode, Scalar alpha, Scalar beta) const
+{
+  using Teuchos::ArrayRCP;
+
+  PetscErrorCode ierr;
+  const size_t numVectors = X.getNumVectors();
 
   ArrayRCP< ArrayRCP<const Scalar> > xView = X.get2dView();
   ArrayRCP< ArrayRCP<Scalar> > yView = Y.get2dViewNonConst();
 
-  double *vals=0;
-  int length;
-  Vec petscX, petscY;
-  int ierr;
-  for(int i=0; i < numVectors; i++)
+  Vec petscX, petscY, work = NULL;
+  for(size_t i=0; i < numVectors; i++)
   {
+    PetscScalar* x = const_cast<PetscScalar*>(xView[i].get());
 #   ifdef HAVE_MPI
-    ierr=VecCreateMPIWithArray(getRawMpiComm(*getComm()),1, X.getLocalLength(),X.getGlobalLength(),xView[i].get(),&petscX);CHKERRV(ierr);
-    ierr=VecCreateMPIWithArray(getRawMpiComm(*getComm()),1, Y.getLocalLength(),Y.getGlobalLength(),yView[i].get(),&petscY);CHKERRV(ierr);
-#   else //FIXME  untested
-    ierr=VecCreateSeqWithArray(getRawMpiComm(*getComm()),1, X.getLocalLength(),X.getGlobalLength(),xView[i].get(),&petscX);CHKERRV(ierr);
-    ierr=VecCreateSeqWithArray(getRawMpiComm(*getComm()),1, Y.getLocalLength(),Y.getGlobalLength(),yView[i].get(),&petscY);CHKERRV(ierr);
+    ierr=VecCreateMPIWithArray(getRawMpiComm(*getComm()),1, X.getLocalLength(),X.getGlobalLength(),x,&petscX);CHKERRQ(ierr);
+    ierr=VecCreateMPIWithArray(getRawMpiComm(*getComm()),1, Y.getLocalLength(),Y.getGlobalLength(),yView[i].get(),&petscY);CHKERRQ(ierr);
+#   else
+    ierr=VecCreateSeqWithArray(PETSC_COMM_SELF,1, X.getLocalLength(),x,&petscX);CHKERRQ(ierr);
+    ierr=VecCreateSeqWithArray(PETSC_COMM_SELF,1, Y.getLocalLength(),yView[i].get(),&petscY);CHKERRQ(ierr);
 #   endif
 
-    if(alpha != Teuchos::ScalarTraits<Scalar>::one()) {
-      ierr=VecScale(petscX,alpha);CHKERRV(ierr);
-    }
-
     if(beta == Teuchos::ScalarTraits<Scalar>::zero())
     {
-      if(mode == Teuchos::NO_TRANS) {
-        ierr = MatMult(Amat_,petscX,petscY);CHKERRV(ierr);
-      }
-      else if(mode == Teuchos::TRANS) {
-        ierr = MatMultTranspose(Amat_,petscX,petscY);CHKERRV(ierr);
-      }
-      else { // mode == Teuchos::CONJ_TRANS 
-        ierr = MatMultHermitianTranspose(Amat_,petscX,petscY);CHKERRV(ierr);
+      ierr = xSDKTrilinos::Details::PETScMultWithMode(A,mode,petscX,petscY);CHKERRQ(ierr);
+      if(alpha != Teuchos::ScalarTraits<Scalar>::one()) {
+        ierr = VecScale(petscY,alpha);CHKERRQ(ierr);
       }
     }
     else
     {
-      ierr=VecScale(petscY,beta);CHKERRV(ierr);
-
-      if(mode == Teuchos::NO_TRANS) {
-        ierr = MatMultAdd(Amat_,petscX,petscY,petscY);CHKERRV(ierr);
-      }
-      else if(mode == Teuchos::TRANS) {
-        ierr = MatMultTransposeAdd(Amat_,petscX,petscY,petscY);CHKERRV(ierr);
-      }
-      else { // mode == Teuchos::CONJ_TRANS 
-        ierr = MatMultHermitianTransposeAdd(Amat_,petscX,petscY,petscY);CHKERRV(ierr);
+      if(work == NULL) {
+        ierr = VecDuplicate(petscY,&work);CHKERRQ(ierr);
       }
+      ierr = xSDKTrilinos::Details::PETScMultWithMode(A,mode,petscX,work);CHKERRQ(ierr);
+      ierr = VecAXPBY(petscY,alpha,beta,work);CHKERRQ(ierr);
     }
 
-    ierr = VecGetArray(petscY,&vals);CHKERRV(ierr);
-    ierr = VecGetLocalSize(petscY,&length);CHKERRV(ierr);
-    for (int j=0; j<length; j++) yView[i][j] = vals[j];
-    ierr = VecRestoreArray(petscY,&vals);CHKERRV(ierr);
+    ierr = VecDestroy(&petscX);CHKERRQ(ierr);
+    ierr = VecDestroy(&petscY);CHKERRQ(ierr);
   }
+  ierr = VecDestroy(&work);CHKERRQ(ierr);
 
-  VecDestroy(&petscX); VecDestroy(&petscY);
+  return 0;
 }
 
 
@@ -554,44 +1391,63 @@ template<class Scalar, class LO, class GO, class Node>
 void PETScAIJMatrix<Scalar,LO,GO,Node>::leftScale(const Vector<Scalar,LO,GO,Node> & x)
 {
   PetscErrorCode ierr;
-  Vec petscX;
+  ierr = diagonalScale(&x,NULL);CHKERRV(ierr);
+}
 
-  // Get the data from x
-  Teuchos::ArrayRCP<const Scalar> xView = x.get1dView();
 
-  // Copy x to petscX
-#   ifdef HAVE_MPI
-    ierr=VecCreateMPIWithArray(getRawMpiComm(*getComm()),1, x.getLocalLength(),x.getGlobalLength(),xView.get(),&petscX);CHKERRV(ierr);
-#   else //FIXME  untested
-    ierr=VecCreateSeqWithArray(getRawMpiComm(*getComm()),1, x.getLocalLength(),x.getGlobalLength(),xView.get(),&petscX);CHKERRV(ierr);
-#   endif
 
-  // Scale the matrix
-  ierr = MatDiagonalScale(Amat_,petscX,NULL);CHKERRV(ierr);
+//! Scale the RowMatrix on the right with the given Vector x.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+void PETScAIJMatrix<Scalar,LO,GO,Node>::rightScale(const Vector<Scalar,LO,GO,Node> & x)
+{
+  PetscErrorCode ierr;
+  ierr = diagonalScale(NULL,&x);CHKERRV(ierr);
 }
 
 
 
-//! Scale the RowMatrix on the right with the given Vector x.
+//! Scale the matrix on both sides at once, A = diag(left)*A*diag(right).
 //==============================================================================
 template<class Scalar, class LO, class GO, class Node>
-void PETScAIJMatrix<Scalar,LO,GO,Node>::rightScale(const Vector<Scalar,LO,GO,Node> & x)
+void PETScAIJMatrix<Scalar,LO,GO,Node>::scale(const Vector<Scalar,LO,GO,Node> & left, const Vector<Scalar,LO,GO,Node> & right)
 {
   PetscErrorCode ierr;
-  Vec petscX;
+  ierr = diagonalScale(&left,&right);CHKERRV(ierr);
+}
 
-  // Get the data from x
-  Teuchos::ArrayRCP<const Scalar> xView = x.get1dView();
 
-  // Copy x to petscX
-#   ifdef HAVE_MPI
-    ierr=VecCreateMPIWithArray(getRawMpiComm(*getComm()),1, x.getLocalLength(),x.getGlobalLength(),xView.get(),&petscX);CHKERRV(ierr);
-#   else //FIXME  untested
-    ierr=VecCreateSeqWithArray(getRawMpiComm(*getComm()),1, x.getLocalLength(),x.getGlobalLength(),xView.get(),&petscX);CHKERRV(ierr);
-#   endif
 
-  // Scale the matrix
-  ierr = MatDiagonalScale(Amat_,NULL,petscX);CHKERRV(ierr);
+//! A = diag(left)*A*diag(right) through MatDiagonalScale; either side may be NULL.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode PETScAIJMatrix<Scalar,LO,GO,Node>::diagonalScale(const Vector<Scalar,LO,GO,Node> * left, const Vector<Scalar,LO,GO,Node> * right)
+{
+  PetscErrorCode ierr;
+  MPI_Comm comm;
+  Vec petscLeft = NULL, petscRight = NULL;
+  Teuchos::ArrayRCP<const Scalar> leftView, rightView;
+
+  // MatDiagonalScale only reads the Vecs, so they can view the Tpetra data
+  ierr = PetscObjectGetComm((PetscObject)Amat_,&comm);CHKERRQ(ierr);
+  if(left != NULL)
+  {
+    leftView = left->get1dView();
+    ierr = VecCreateMPIWithArray(comm,1,left->getLocalLength(),left->getGlobalLength(),
+                                 const_cast<PetscScalar*>(leftView.getRawPtr()),&petscLeft);CHKERRQ(ierr);
+  }
+  if(right != NULL)
+  {
+    rightView = right->get1dView();
+    ierr = VecCreateMPIWithArray(comm,1,right->getLocalLength(),right->getGlobalLength(),
+                                 const_cast<PetscScalar*>(rightView.getRawPtr()),&petscRight);CHKERRQ(ierr);
+  }
+
+  ierr = MatDiagonalScale(Amat_,petscLeft,petscRight);CHKERRQ(ierr);
+
+  ierr = VecDestroy(&petscLeft);CHKERRQ(ierr);
+  ierr = VecDestroy(&petscRight);CHKERRQ(ierr);
+  return 0;
 }
 
 
@@ -600,11 +1456,130 @@ void PETScAIJMatrix<Scalar,LO,GO,Node>::rightScale(const Vector<Scalar,LO,GO,Nod
 //==============================================================================
 template<class Scalar, class LO, class GO, class Node>
 typename PETScAIJMatrix<Scalar,LO,GO,Node>::mag_type PETScAIJMatrix<Scalar,LO,GO,Node>::getFrobeniusNorm() const
+{
+  PetscErrorCode ierr = updateNorms();
+  TEUCHOS_TEST_FOR_EXCEPTION(ierr != 0, std::runtime_error,
+         Teuchos::typeName (*this) << "::getFrobeniusNorm(): PETSc error " << ierr << ".");
+  return frobeniusNorm_;
+}
+
+
+
+//! The one norm of the matrix.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+typename PETScAIJMatrix<Scalar,LO,GO,Node>::mag_type PETScAIJMatrix<Scalar,LO,GO,Node>::getOneNorm() const
+{
+  PetscErrorCode ierr = updateNorms();
+  TEUCHOS_TEST_FOR_EXCEPTION(ierr != 0, std::runtime_error,
+         Teuchos::typeName (*this) << "::getOneNorm(): PETSc error " << ierr << ".");
+  return oneNorm_;
+}
+
+
+
+//! The infinity norm of the matrix.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+typename PETScAIJMatrix<Scalar,LO,GO,Node>::mag_type PETScAIJMatrix<Scalar,LO,GO,Node>::getInfNorm() const
+{
+  PetscErrorCode ierr = updateNorms();
+  TEUCHOS_TEST_FOR_EXCEPTION(ierr != 0, std::runtime_error,
+         Teuchos::typeName (*this) << "::getInfNorm(): PETSc error " << ierr << ".");
+  return infNorm_;
+}
+
+
+
+//! Compute the Frobenius, one and infinity norms in one pass, unless the matrix is unchanged since they were last computed.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode PETScAIJMatrix<Scalar,LO,GO,Node>::updateNorms() const
 {
   PetscErrorCode ierr;
-  PetscReal nrm;
-  ierr = MatNorm(Amat_,NORM_FROBENIUS,&nrm);CHKERRQ(ierr);
-  return nrm;
+  PetscObjectState state;
+  ierr = PetscObjectStateGet((PetscObject)Amat_,&state);CHKERRQ(ierr);
+  if(haveNorms_ && state == normState_)
+    return 0;
+
+  // The single pass below reads AIJ arrays; PETSc's own block kernels compute each norm of a BAIJ matrix
+  if(!graph_->isAIJ())
+  {
+    PetscReal frobenius, one, inf;
+    ierr = MatNorm(Amat_,NORM_FROBENIUS,&frobenius);CHKERRQ(ierr);
+    ierr = MatNorm(Amat_,NORM_1,&one);CHKERRQ(ierr);
+    ierr = MatNorm(Amat_,NORM_INFINITY,&inf);CHKERRQ(ierr);
+    frobeniusNorm_ = frobenius;
+    oneNorm_ = one;
+    infNorm_ = inf;
+    haveNorms_ = true;
+    normState_ = state;
+    return 0;
+  }
+
+  Mat blocks[2] = {NULL, NULL};
+  PetscBool isMPIAIJ;
+  ierr = PetscObjectTypeCompare((PetscObject)Amat_,MATMPIAIJ,&isMPIAIJ);CHKERRQ(ierr);
+  if(isMPIAIJ) {
+    ierr = MatMPIAIJGetSeqAIJ(Amat_,&blocks[0],&blocks[1],NULL);CHKERRQ(ierr);
+  }
+  else {
+    blocks[0] = Amat_;
+  }
+
+  // One pass over the diagonal and off-diagonal blocks finds the sum of squares, the row sums and
+  // the column sums; the column Map holds the diagonal block's columns, then the off-diagonal block's
+  Vector<Scalar,LO,GO,Node> colSumsLocal(getColMap()), colSums(getDomainMap(), false);
+  const PetscInt numDiagCols = getDomainMap()->getNodeNumElements();
+  const PetscInt numRows = getRowMap()->getNodeNumElements();
+  PetscReal localSquares = 0, localMaxRowSum = 0;
+  {
+    Teuchos::ArrayRCP<Scalar> colSumsData = colSumsLocal.get1dViewNonConst();
+    std::vector<PetscReal> rowSums(numRows, 0);
+    for(int b = 0; b < 2 && blocks[b] != NULL; b++)
+    {
+      PetscInt n;
+      const PetscInt *ia, *ja;
+      const PetscScalar *aa;
+      PetscBool done;
+      const PetscInt colOffset = (b == 0 ? 0 : numDiagCols);
+      ierr = MatGetRowIJ(blocks[b],0,PETSC_FALSE,PETSC_FALSE,&n,&ia,&ja,&done);CHKERRQ(ierr);
+      ierr = xSDKTrilinos::Details::PETScSeqAIJGetArrayRead(blocks[b],&aa);CHKERRQ(ierr);
+      for(PetscInt i = 0; i < n; i++)
+      {
+        for(PetscInt k = ia[i]; k < ia[i+1]; k++)
+        {
+          const PetscReal v = PetscAbsScalar(aa[k]);
+          localSquares += v*v;
+          rowSums[i] += v;
+          colSumsData[colOffset + ja[k]] += v;
+        }
+      }
+      ierr = xSDKTrilinos::Details::PETScSeqAIJRestoreArrayRead(blocks[b],&aa);CHKERRQ(ierr);
+      ierr = MatRestoreRowIJ(blocks[b],0,PETSC_FALSE,PETSC_FALSE,&n,&ia,&ja,&done);CHKERRQ(ierr);
+    }
+    for(PetscInt i = 0; i < numRows; i++)
+      localMaxRowSum = std::max(localMaxRowSum, rowSums[i]);
+  }
+
+  // Add up the column sums of the processes sharing a column
+  colSums.putScalar(Teuchos::ScalarTraits<Scalar>::zero());
+  colSums.doExport(colSumsLocal, *getDomainExporter(), Tpetra::ADD);
+  PetscReal localMax[2] = {localMaxRowSum, 0}, globalMax[2], squares;
+  {
+    Teuchos::ArrayRCP<const Scalar> colSumsData = colSums.get1dView();
+    for(LO j = 0; j < colSumsData.size(); j++)
+      localMax[1] = std::max(localMax[1], (PetscReal)Teuchos::ScalarTraits<Scalar>::real(colSumsData[j]));
+  }
+  Teuchos::reduceAll(*getComm(), Teuchos::REDUCE_MAX, 2, localMax, globalMax);
+  Teuchos::reduceAll(*getComm(), Teuchos::REDUCE_SUM, localSquares, Teuchos::outArg(squares));
+
+  frobeniusNorm_ = std::sqrt(squares);
+  infNorm_ = globalMax[0];
+  oneNorm_ = globalMax[1];
+  haveNorms_ = true;
+  normState_ = state;
+  return 0;
 }
 
 
@@ -0,0 +1,342 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef _TPETRA_PETSCMATRIXLOADER_H_
+#define _TPETRA_PETSCMATRIXLOADER_H_
+
+#include "Tpetra_PETScAIJMatrix.hpp"
+//Petsc headers.
+#include <petscmat.h>
+#include <petscviewer.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace xSDKTrilinos {
+
+namespace Details {
+
+//! One entry of a MatrixMarket file, with 0-based indices.
+struct MatrixMarketEntry {
+  PetscInt row, col;
+  PetscScalar val;
+};
+
+//! Reads the header of a coordinate MatrixMarket file and the entries of the lines that start in this process' share of its bytes.
+/*! Symmetric, skew-symmetric and Hermitian files are expanded, so entries holds both triangles.
+*/
+inline PetscErrorCode readMatrixMarketChunk(MPI_Comm comm, const std::string& filename, PetscInt* numRows,
+                                            PetscInt* numCols, std::vector<MatrixMarketEntry>& entries)
+{
+  PetscErrorCode ierr;
+  PetscMPIInt rank, size;
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+
+  std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+  if(!in)
+    SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_OPEN,"Cannot open %s",filename.c_str());
+
+  // The banner, e.g. "%%MatrixMarket matrix coordinate real general"
+  std::string line, tag, object, format, field, symmetry;
+  std::getline(in,line);
+  std::transform(line.begin(),line.end(),line.begin(),::tolower);
+  std::istringstream banner(line);
+  banner >> tag >> object >> format >> field >> symmetry;
+  if(tag != "%%matrixmarket" || object != "matrix" || format != "coordinate")
+    SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"%s is not a coordinate MatrixMarket matrix",filename.c_str());
+  const bool isPattern = (field == "pattern");
+  const bool isComplex = (field == "complex");
+#if !defined(PETSC_USE_COMPLEX)
+  if(isComplex)
+    SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Complex MatrixMarket files need a complex build of PETSc");
+#endif
+  if(!isPattern && !isComplex && field != "real" && field != "integer" && field != "double")
+    SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Unknown MatrixMarket field %s",field.c_str());
+  const bool isSymmetric = (symmetry == "symmetric");
+  const bool isSkew = (symmetry == "skew-symmetric");
+  const bool isHermitian = (symmetry == "hermitian");
+  if(!isSymmetric && !isSkew && !isHermitian && symmetry != "general")
+    SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Unknown MatrixMarket symmetry %s",symmetry.c_str());
+
+  // Skip the comments; the size line follows them
+  while(std::getline(in,line) && (line.empty() || line[0] == '%'));
+  long long M, N, nnz;
+  if(sscanf(line.c_str(),"%lld %lld %lld",&M,&N,&nnz) != 3)
+    SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Missing size line in %s",filename.c_str());
+  *numRows = M;
+  *numCols = N;
+
+  // Split the remaining bytes evenly.  A process owns every line that starts in its range,
+  // so it skips the line it lands in unless that line starts exactly at its first byte.
+  const std::streamoff dataStart = in.tellg();
+  in.seekg(0,std::ios::end);
+  const std::streamoff length = (std::streamoff)in.tellg() - dataStart;
+  const std::streamoff begin = dataStart + length*rank/size;
+  const std::streamoff end = dataStart + length*(rank+1)/size;
+  in.clear();
+  in.seekg(begin > dataStart ? begin-1 : begin);
+  if(begin > dataStart) std::getline(in,line);
+
+  entries.clear();
+  entries.reserve(((isSymmetric || isSkew || isHermitian) ? 2 : 1)*nnz/size);
+  for(;;)
+  {
+    const std::streamoff pos = in.tellg();
+    if(pos < 0 || pos >= end || !std::getline(in,line)) break;
+    const char* p = line.c_str();
+    char* next;
+    MatrixMarketEntry entry;
+    entry.row = strtoll(p,&next,10) - 1;
+    if(next == p || line[0] == '%') continue;
+    p = next;
+    entry.col = strtoll(p,&next,10) - 1;
+    p = next;
+    if(entry.row < 0 || entry.row >= M || entry.col < 0 || entry.col >= N)
+      SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Entry out of range in %s",filename.c_str());
+    if(isPattern) {
+      entry.val = 1.0;
+    }
+    else {
+      PetscReal re = strtod(p,&next);
+#if defined(PETSC_USE_COMPLEX)
+      PetscReal im = isComplex ? strtod(next,&next) : 0.0;
+      entry.val = re + PETSC_i*im;
+#else
+      entry.val = re;
+#endif
+    }
+    entries.push_back(entry);
+
+    // Mirror the stored triangle
+    if(entry.row != entry.col && (isSymmetric || isSkew || isHermitian)) {
+      MatrixMarketEntry mirror;
+      mirror.row = entry.col;
+      mirror.col = entry.row;
+      mirror.val = isSkew ? -entry.val : (isHermitian ? PetscConj(entry.val) : entry.val);
+      entries.push_back(mirror);
+    }
+  }
+  return 0;
+}
+
+//! Assembles a PETSc AIJ matrix from a MatrixMarket file that every process reads a share of.
+inline PetscErrorCode loadMatrixMarketFile(MPI_Comm comm, const std::string& filename, Mat* A)
+{
+  PetscErrorCode ierr;
+  PetscMPIInt size;
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+
+  PetscInt M, N;
+  std::vector<MatrixMarketEntry> entries;
+  ierr = readMatrixMarketChunk(comm,filename,&M,&N,entries);CHKERRQ(ierr);
+
+  // Use PETSc's default block row distribution for rows and columns
+  PetscInt m = PETSC_DECIDE, n = PETSC_DECIDE;
+  ierr = PetscSplitOwnership(comm,&m,&M);CHKERRQ(ierr);
+  ierr = PetscSplitOwnership(comm,&n,&N);CHKERRQ(ierr);
+  std::vector<PetscInt> rowRanges(size+1,0), colRanges(size+1,0);
+  ierr = MPI_Allgather(&m,1,MPIU_INT,&rowRanges[1],1,MPIU_INT,comm);CHKERRQ(ierr);
+  ierr = MPI_Allgather(&n,1,MPIU_INT,&colRanges[1],1,MPIU_INT,comm);CHKERRQ(ierr);
+  for(PetscMPIInt p=0; p < size; p++) {
+    rowRanges[p+1] += rowRanges[p];
+    colRanges[p+1] += colRanges[p];
+  }
+
+  // Count the entries of each row in the diagonal and off-diagonal blocks.  The entries
+  // may belong to any process, so the counts are summed into distributed vectors.
+  Vec dnzVec, onzVec;
+  ierr = VecCreateMPI(comm,m,M,&dnzVec);CHKERRQ(ierr);
+  ierr = VecDuplicate(dnzVec,&onzVec);CHKERRQ(ierr);
+  std::vector<PetscInt> dRows, oRows;
+  dRows.reserve(entries.size());
+  oRows.reserve(entries.size());
+  for(size_t k=0; k < entries.size(); k++) {
+    const PetscInt owner = std::upper_bound(rowRanges.begin(),rowRanges.end(),entries[k].row) - rowRanges.begin() - 1;
+    if(entries[k].col >= colRanges[owner] && entries[k].col < colRanges[owner+1])
+      dRows.push_back(entries[k].row);
+    else
+      oRows.push_back(entries[k].row);
+  }
+  std::vector<PetscScalar> ones(std::max(dRows.size(),oRows.size()),1.0);
+  ierr = VecSetValues(dnzVec,dRows.size(),dRows.empty() ? NULL : &dRows[0],ones.empty() ? NULL : &ones[0],ADD_VALUES);CHKERRQ(ierr);
+  ierr = VecSetValues(onzVec,oRows.size(),oRows.empty() ? NULL : &oRows[0],ones.empty() ? NULL : &ones[0],ADD_VALUES);CHKERRQ(ierr);
+  std::vector<PetscInt>().swap(dRows);
+  std::vector<PetscInt>().swap(oRows);
+  ierr = VecAssemblyBegin(dnzVec);CHKERRQ(ierr);
+  ierr = VecAssemblyBegin(onzVec);CHKERRQ(ierr);
+  ierr = VecAssemblyEnd(dnzVec);CHKERRQ(ierr);
+  ierr = VecAssemblyEnd(onzVec);CHKERRQ(ierr);
+
+  // Duplicate entries may push a count past the width of its block
+  const PetscScalar *dCounts, *oCounts;
+  std::vector<PetscInt> dnz(m), onz(m);
+  ierr = VecGetArrayRead(dnzVec,&dCounts);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(onzVec,&oCounts);CHKERRQ(ierr);
+  for(PetscInt i=0; i < m; i++) {
+    dnz[i] = std::min((PetscInt)PetscRealPart(dCounts[i]),n);
+    onz[i] = std::min((PetscInt)PetscRealPart(oCounts[i]),N-n);
+  }
+  ierr = VecRestoreArrayRead(dnzVec,&dCounts);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(onzVec,&oCounts);CHKERRQ(ierr);
+  ierr = VecDestroy(&dnzVec);CHKERRQ(ierr);
+  ierr = VecDestroy(&onzVec);CHKERRQ(ierr);
+
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m,n,M,N);CHKERRQ(ierr);
+  ierr = MatSetType(*A,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(*A,0,m > 0 ? &dnz[0] : NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(*A,0,m > 0 ? &dnz[0] : NULL,0,m > 0 ? &onz[0] : NULL);CHKERRQ(ierr);
+
+  // Entries owned by other processes are stashed and sent during assembly
+  for(size_t k=0; k < entries.size(); k++) {
+    ierr = MatSetValues(*A,1,&entries[k].row,1,&entries[k].col,&entries[k].val,ADD_VALUES);CHKERRQ(ierr);
+  }
+  std::vector<MatrixMarketEntry>().swap(entries);
+  ierr = MatAssemblyBegin(*A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(*A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  return 0;
+}
+
+//! Loads a PETSc AIJ matrix from a PETSc binary file, with MPI-IO if PETSc has it.
+inline PetscErrorCode loadPETScBinaryFile(MPI_Comm comm, const std::string& filename, Mat* A)
+{
+  PetscErrorCode ierr;
+  PetscViewer viewer;
+  ierr = PetscViewerCreate(comm,&viewer);CHKERRQ(ierr);
+  ierr = PetscViewerSetType(viewer,PETSCVIEWERBINARY);CHKERRQ(ierr);
+  ierr = PetscViewerFileSetMode(viewer,FILE_MODE_READ);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_MPIIO)
+  ierr = PetscViewerBinarySetUseMPIIO(viewer,PETSC_TRUE);CHKERRQ(ierr);
+#endif
+  ierr = PetscViewerFileSetName(viewer,filename.c_str());CHKERRQ(ierr);
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetType(*A,MATAIJ);CHKERRQ(ierr);
+  ierr = MatLoad(*A,viewer);CHKERRQ(ierr);
+  ierr = PetscViewerDestroy(&viewer);CHKERRQ(ierr);
+  return 0;
+}
+
+//! Deallocator of a PETScAIJMatrix that owns the PETSc matrix it wraps.
+template<class Matrix>
+class PETScMatDealloc {
+public:
+  typedef Matrix ptr_t;
+
+  PETScMatDealloc(Mat A) : A_(A) {}
+
+  void free(Matrix* ptr)
+  {
+    PetscErrorCode ierr;
+    delete ptr;
+    ierr = MatDestroy(&A_); CHKERRCONTINUE(ierr);
+  }
+
+private:
+  Mat A_;
+};
+
+} // namespace Details
+
+//! Load a sparse matrix from a file into a new PETSc AIJ matrix, with every process reading part of the file.
+/*! Coordinate MatrixMarket files are recognized by their banner.  Every process parses the lines
+    that start in its share of the file's bytes, and the entries are sent to their owners while the
+    matrix is assembled; the rows and columns get PETSc's default distribution.  Any other file is
+    read with MatLoad as a PETSc binary file.  The caller must destroy A with MatDestroy.
+*/
+inline PetscErrorCode loadPETScMatrix(MPI_Comm comm, const std::string& filename, Mat* A)
+{
+  PetscErrorCode ierr;
+  char banner[15] = {0};
+  std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+  if(!in)
+    SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_OPEN,"Cannot open %s",filename.c_str());
+  in.read(banner,14);
+  in.close();
+
+  if(std::string(banner) == "%%MatrixMarket") {
+    ierr = Details::loadMatrixMarketFile(comm,filename,A);CHKERRQ(ierr);
+  }
+  else {
+    ierr = Details::loadPETScBinaryFile(comm,filename,A);CHKERRQ(ierr);
+  }
+  return 0;
+}
+
+//! Load a sparse matrix from a file with loadPETScMatrix and wrap it in a PETScAIJMatrix, which destroys it when it is no longer used.
+template<class Scalar, class LO, class GO, class Node>
+Teuchos::RCP<Tpetra::PETScAIJMatrix<Scalar,LO,GO,Node> > loadPETScAIJMatrix(MPI_Comm comm, const std::string& filename)
+{
+  typedef Tpetra::PETScAIJMatrix<Scalar,LO,GO,Node> Matrix;
+
+  Mat A;
+  PetscErrorCode ierr = loadPETScMatrix(comm,filename,&A); CHKERRCONTINUE(ierr);
+  TEUCHOS_TEST_FOR_EXCEPTION(ierr != 0, std::runtime_error,
+      "xSDKTrilinos::loadPETScAIJMatrix: Could not load " << filename << ".");
+
+  return Teuchos::rcpWithDealloc(new Matrix(A),Details::PETScMatDealloc<Matrix>(A),true);
+}
+
+//! Load a sparse matrix from a file with loadPETScMatrix and copy it into a Tpetra::CrsMatrix.
+template<class Scalar, class LO, class GO, class Node>
+Teuchos::RCP<Tpetra::CrsMatrix<Scalar,LO,GO,Node> > loadTpetraCrsMatrix(MPI_Comm comm, const std::string& filename)
+{
+  Mat A;
+  PetscErrorCode ierr = loadPETScMatrix(comm,filename,&A); CHKERRCONTINUE(ierr);
+  TEUCHOS_TEST_FOR_EXCEPTION(ierr != 0, std::runtime_error,
+      "xSDKTrilinos::loadTpetraCrsMatrix: Could not load " << filename << ".");
+
+  Teuchos::RCP<Tpetra::CrsMatrix<Scalar,LO,GO,Node> > B = deepCopyPETScAIJMatrixToTpetraCrsMatrix<Scalar,LO,GO,Node>(A);
+  ierr = MatDestroy(&A); CHKERRCONTINUE(ierr);
+  return B;
+}
+
+} // namespace xSDKTrilinos
+
+#endif // _TPETRA_PETSCMATRIXLOADER_H_
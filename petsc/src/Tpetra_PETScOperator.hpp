@@ -0,0 +1,261 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef _TPETRA_PETSCOPERATOR_H_
+#define _TPETRA_PETSCOPERATOR_H_
+
+#include "Tpetra_ConfigDefs.hpp"
+#include "Tpetra_MultiVector.hpp"
+#include "Tpetra_Operator.hpp"
+#include "Tpetra_PETScAIJMatrix.hpp"
+#ifdef HAVE_MPI
+#include "Teuchos_DefaultMpiComm.hpp"
+#else
+#include "Teuchos_DefaultSerialComm.hpp"
+#endif
+//Petsc headers.
+#include <petscmat.h>
+
+
+namespace Tpetra {
+
+//! PETScOperator: A Tpetra::Operator that applies any PETSc matrix through MatMult.
+
+/*! Unlike PETScAIJMatrix, this class does not give access to the entries of the matrix, so it can wrap
+    any Mat, including shell, MATIS and matrix-free (MFFD) matrices, and hand it to Belos or Anasazi.
+    The columns of X and Y are placed in Vecs that are created once and reused, so apply() copies
+    nothing and allocates nothing after the first call.  The operator keeps a reference to the Mat.
+*/
+template<class Scalar = Details::DefaultTypes::scalar_type,
+         class LO = Details::DefaultTypes::local_ordinal_type,
+         class GO = Details::DefaultTypes::global_ordinal_type,
+         class Node = Details::DefaultTypes::node_type>
+class PETScOperator :
+  virtual public Operator<Scalar,LO,GO,Node>
+{
+private:
+  typedef MultiVector<Scalar,LO,GO,Node> MV;
+
+public:
+  typedef Scalar scalar_type;
+  typedef LO local_ordinal_type;
+  typedef GO global_ordinal_type;
+  typedef Node node_type;
+
+  //! @name Constructor/Destructor Methods
+  //@{
+
+  //! Constructor; the domain and range Maps follow the column and row layouts of A.
+  PETScOperator(Mat A);
+
+  //! Destructor
+  virtual ~PETScOperator();
+
+  //@}
+
+  //! The Map associated with the domain of this operator, which must be compatible with X.getMap().
+  Teuchos::RCP<const Map<LO,GO,Node> > getDomainMap() const { return domainMap_; };
+
+  //! The Map associated with the range of this operator, which must be compatible with Y.getMap().
+  Teuchos::RCP<const Map<LO,GO,Node> > getRangeMap() const { return rangeMap_; };
+
+  //! Computes Y = beta*Y + alpha*op(A)*X, one column at a time through MatMult or MatMultTranspose.
+  void apply(const MV & X, MV & Y, Teuchos::ETransp mode = Teuchos::NO_TRANS,
+             Scalar alpha = Teuchos::ScalarTraits<Scalar>::one(),
+             Scalar beta = Teuchos::ScalarTraits<Scalar>::zero()) const;
+
+  //! Whether the PETSc matrix implements MatMultTranspose.
+  bool hasTransposeApply() const;
+
+  //! The wrapped PETSc matrix.
+  Mat getPETScMat() const { return A_; };
+
+private:
+  //! Copy constructor (not accessible to users).
+  PETScOperator(const PETScOperator &);
+
+  //! Computes Y = beta*Y + alpha*op(A)*X with the pooled Vecs.
+  PetscErrorCode applyByColumn(const MV & X, MV & Y, Teuchos::ETransp mode, Scalar alpha, Scalar beta) const;
+
+  Mat A_;
+  Teuchos::RCP<const Map<LO,GO,Node> > domainMap_, rangeMap_;
+
+  //! Vecs without storage of their own, which the columns of X and Y are placed in
+  mutable Vec domainVec_, rangeVec_;
+  //! op(A)*x when beta is nonzero, of the range or, for transposes, the domain layout
+  mutable Vec rangeWork_, domainWork_;
+};
+
+
+
+//! Constructor
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+PETScOperator<Scalar,LO,GO,Node>::PETScOperator(Mat A)
+  : A_(A), domainVec_(NULL), rangeVec_(NULL), rangeWork_(NULL), domainWork_(NULL)
+{
+  PetscErrorCode ierr;
+  PetscInt numLocalRows, numLocalCols, numGlobalRows, numGlobalCols;
+
+  // Wrap the communicator in a Teuchos Comm
+  MPI_Comm comm;
+  ierr = PetscObjectGetComm((PetscObject)A,&comm); CHKERRV(ierr);
+  Teuchos::RCP<const Teuchos::Comm<int> > TrilinosComm;
+#ifdef HAVE_MPI
+  TrilinosComm = Teuchos::rcp(new Teuchos::MpiComm<int>(comm));
+#else
+  TrilinosComm = Teuchos::rcp(new Teuchos::SerialComm<int>());
+#endif
+
+  // Matrix-free operators only know their layout
+  ierr = MatGetLocalSize(A,&numLocalRows,&numLocalCols); CHKERRV(ierr);
+  ierr = MatGetSize(A,&numGlobalRows,&numGlobalCols); CHKERRV(ierr);
+  rangeMap_ = Teuchos::rcp(new Map<LO,GO,Node>(numGlobalRows,numLocalRows,0,TrilinosComm));
+  domainMap_ = Teuchos::rcp(new Map<LO,GO,Node>(numGlobalCols,numLocalCols,0,TrilinosComm));
+
+  ierr = VecCreateMPIWithArray(comm,1,numLocalCols,numGlobalCols,NULL,&domainVec_); CHKERRV(ierr);
+  ierr = VecCreateMPIWithArray(comm,1,numLocalRows,numGlobalRows,NULL,&rangeVec_); CHKERRV(ierr);
+
+  ierr = PetscObjectReference((PetscObject)A); CHKERRV(ierr);
+}
+
+
+
+//! Destructor
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+PETScOperator<Scalar,LO,GO,Node>::~PETScOperator()
+{
+  // Operators may outlive PetscFinalize, after which there is nothing left to free
+  PetscBool finalized = PETSC_TRUE;
+  PetscFinalized(&finalized);
+  if(finalized)
+    return;
+
+  VecDestroy(&domainVec_);
+  VecDestroy(&rangeVec_);
+  VecDestroy(&rangeWork_);
+  VecDestroy(&domainWork_);
+  MatDestroy(&A_);
+}
+
+
+
+//! Whether the PETSc matrix implements MatMultTranspose.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+bool PETScOperator<Scalar,LO,GO,Node>::hasTransposeApply() const
+{
+  PetscErrorCode ierr;
+  PetscBool has;
+  ierr = MatHasOperation(A_,MATOP_MULT_TRANSPOSE,&has);
+  TEUCHOS_TEST_FOR_EXCEPTION(ierr != 0, std::runtime_error,
+         Teuchos::typeName (*this) << "::hasTransposeApply(): PETSc error " << ierr << ".");
+  return has;
+}
+
+
+
+//! Computes Y = beta*Y + alpha*op(A)*X, one column at a time through MatMult or MatMultTranspose.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+void PETScOperator<Scalar,LO,GO,Node>::apply(const MV & X, MV & Y, Teuchos::ETransp mode, Scalar alpha, Scalar beta) const
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(X.getNumVectors () != Y.getNumVectors (), std::runtime_error,
+         Teuchos::typeName (*this) << "::apply(X,Y): X and Y must have the same number of vectors.");
+
+  PetscErrorCode ierr = applyByColumn(X,Y,mode,alpha,beta);
+  TEUCHOS_TEST_FOR_EXCEPTION(ierr != 0, std::runtime_error,
+         Teuchos::typeName (*this) << "::apply(): PETSc error " << ierr << ".");
+}
+
+
+
+//! Computes Y = beta*Y + alpha*op(A)*X with the pooled Vecs.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode PETScOperator<Scalar,LO,GO,Node>::applyByColumn(const MV & X, MV & Y, Teuchos::ETransp mode, Scalar alpha, Scalar beta) const
+{
+  using Teuchos::ArrayRCP;
+
+  PetscErrorCode ierr;
+  const size_t numVectors = X.getNumVectors();
+  Vec x = (mode == Teuchos::NO_TRANS ? domainVec_ : rangeVec_);
+  Vec y = (mode == Teuchos::NO_TRANS ? rangeVec_ : domainVec_);
+  Vec& work = (mode == Teuchos::NO_TRANS ? rangeWork_ : domainWork_);
+  if(beta != Teuchos::ScalarTraits<Scalar>::zero() && work == NULL) {
+    ierr = VecDuplicate(y,&work);CHKERRQ(ierr);
+  }
+
+  ArrayRCP< ArrayRCP<const Scalar> > xView = X.get2dView();
+  ArrayRCP< ArrayRCP<Scalar> > yView = Y.get2dViewNonConst();
+  for(size_t i=0; i < numVectors; i++)
+  {
+    // The pooled Vecs give the placed arrays back even if a PETSc call fails
+    xSDKTrilinos::Details::PETScPlacedArray placedX, placedY;
+    ierr = placedX.place(x,xView[i].get());CHKERRQ(ierr);
+    ierr = placedY.place(y,yView[i].get());CHKERRQ(ierr);
+
+    if(beta == Teuchos::ScalarTraits<Scalar>::zero())
+    {
+      ierr = xSDKTrilinos::Details::PETScMultWithMode(A_,mode,x,y);CHKERRQ(ierr);
+      if(alpha != Teuchos::ScalarTraits<Scalar>::one()) {
+        ierr = VecScale(y,alpha);CHKERRQ(ierr);
+      }
+    }
+    else
+    {
+      ierr = xSDKTrilinos::Details::PETScMultWithMode(A_,mode,x,work);CHKERRQ(ierr);
+      ierr = VecAXPBY(y,alpha,beta,work);CHKERRQ(ierr);
+    }
+
+    ierr = placedX.reset();CHKERRQ(ierr);
+    ierr = placedY.reset();CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
+} // namespace Tpetra
+
+#endif // _TPETRA_PETSCOPERATOR_H_
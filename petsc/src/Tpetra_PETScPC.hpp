@@ -0,0 +1,261 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef _TPETRA_PETSCPC_H_
+#define _TPETRA_PETSCPC_H_
+
+#include "Tpetra_ConfigDefs.hpp"
+#include "Tpetra_MultiVector.hpp"
+#include "Tpetra_Operator.hpp"
+#include "Tpetra_PETScVector.hpp"
+//Petsc headers.
+#include <petscpc.h>
+#include <petscversion.h>
+#include <algorithm>
+#include <type_traits>
+
+
+namespace xSDKTrilinos {
+
+namespace Details {
+
+//! The context of a PCSHELL created by createPETScPCFromTpetraOperator.
+template<class Scalar, class LO, class GO, class Node>
+class PETScShellPCContext {
+public:
+  typedef Tpetra::Operator<Scalar,LO,GO,Node>    OP;
+  typedef Tpetra::MultiVector<Scalar,LO,GO,Node> MV;
+  typedef Tpetra::Map<LO,GO,Node>                Map;
+
+  PETScShellPCContext(const Teuchos::RCP<const OP>& op) : op_(op) {}
+
+  //! Computes Y = op(X) for numVecs column-major vectors of xRows and yRows local rows, with leading dimensions ldx and ldy.
+  void apply(const PetscScalar* x, PetscInt xRows, PetscInt ldx, PetscScalar* y, PetscInt yRows, PetscInt ldy,
+             PetscInt numVecs, Teuchos::ETransp mode);
+
+  const Teuchos::RCP<const OP>& getOperator() const { return op_; }
+
+private:
+  //! Returns a scratch multivector of map with at least numVecs columns, reallocating it only if needed.
+  Teuchos::RCP<MV> getScratch(Teuchos::RCP<MV>& scratch, const Teuchos::RCP<const Map>& map, PetscInt numVecs);
+
+  Teuchos::RCP<const OP> op_;
+  //! Used in place of the PETSc storage when it cannot be viewed directly
+  Teuchos::RCP<MV> scratchX_, scratchY_;
+};
+
+template<class Scalar, class LO, class GO, class Node>
+Teuchos::RCP<typename PETScShellPCContext<Scalar,LO,GO,Node>::MV>
+PETScShellPCContext<Scalar,LO,GO,Node>::getScratch(Teuchos::RCP<MV>& scratch, const Teuchos::RCP<const Map>& map, PetscInt numVecs)
+{
+  if(scratch.is_null() || (PetscInt) scratch->getNumVectors() < numVecs || !scratch->getMap()->isSameAs(*map)) {
+    scratch = Teuchos::rcp(new MV(map, numVecs, false));
+  }
+  if((PetscInt) scratch->getNumVectors() == numVecs)
+    return scratch;
+  return scratch->subViewNonConst(Teuchos::Range1D(0, numVecs-1));
+}
+
+template<class Scalar, class LO, class GO, class Node>
+void PETScShellPCContext<Scalar,LO,GO,Node>::apply(const PetscScalar* x, PetscInt xRows, PetscInt ldx, PetscScalar* y, PetscInt yRows, PetscInt ldy,
+                                                   PetscInt numVecs, Teuchos::ETransp mode)
+{
+  typedef PETScArrayWrapper<MV, PETScArrayIsViewable<MV>::value> Wrapper;
+
+  Teuchos::RCP<const Map> xMap = (mode == Teuchos::NO_TRANS ? op_->getDomainMap() : op_->getRangeMap());
+  Teuchos::RCP<const Map> yMap = (mode == Teuchos::NO_TRANS ? op_->getRangeMap() : op_->getDomainMap());
+  const PetscInt xLength = xMap->getNodeNumElements();
+  const PetscInt yLength = yMap->getNodeNumElements();
+  TEUCHOS_TEST_FOR_EXCEPTION(xRows != xLength || yRows != yLength, std::invalid_argument,
+      "xSDKTrilinos::createPETScPCFromTpetraOperator: The local sizes of the PETSc vectors do not match the maps of the operator.");
+
+  // View the PETSc storage directly when the vectors are packed; the operator promises not to modify x
+  Teuchos::RCP<MV> tpetraX, tpetraY;
+  if(ldx == xLength && ldy == yLength) {
+    tpetraX = Teuchos::rcp(Wrapper::wrap(xMap, const_cast<PetscScalar*>(x), numVecs));
+    tpetraY = Teuchos::rcp(Wrapper::wrap(yMap, y, numVecs));
+  }
+  if(!tpetraX.is_null() && !tpetraY.is_null()) {
+    op_->apply(*tpetraX, *tpetraY, mode);
+    return;
+  }
+
+  // Otherwise go through vectors that are kept from one application to the next
+  tpetraX = getScratch(scratchX_, xMap, numVecs);
+  tpetraY = getScratch(scratchY_, yMap, numVecs);
+  for(PetscInt j = 0; j < numVecs; j++) {
+    Teuchos::ArrayRCP<Scalar> xData = tpetraX->getDataNonConst(j);
+    std::copy(x + j*ldx, x + j*ldx + xLength, xData.get());
+  }
+  op_->apply(*tpetraX, *tpetraY, mode);
+  for(PetscInt j = 0; j < numVecs; j++) {
+    Teuchos::ArrayRCP<const Scalar> yData = tpetraY->getData(j);
+    std::copy(yData.get(), yData.get() + yLength, y + j*ldy);
+  }
+}
+
+//! Applies the operator of a PCSHELL created by createPETScPCFromTpetraOperator, or its transpose.
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode applyPETScShellPC(PC pc, Vec x, Vec y, Teuchos::ETransp mode)
+{
+  PetscErrorCode ierr;
+  void* ctx;
+  ierr = PCShellGetContext(pc, &ctx);CHKERRQ(ierr);
+  PETScShellPCContext<Scalar,LO,GO,Node>* context = static_cast<PETScShellPCContext<Scalar,LO,GO,Node>*>(ctx);
+
+  const PetscScalar* xData;
+  PetscScalar* yData;
+  PetscInt xLength, yLength;
+  ierr = VecGetLocalSize(x, &xLength);CHKERRQ(ierr);
+  ierr = VecGetLocalSize(y, &yLength);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(x, &xData);CHKERRQ(ierr);
+  ierr = VecGetArray(y, &yData);CHKERRQ(ierr);
+
+  // Exceptions must not escape into PETSc
+  bool success = true;
+  try {
+    context->apply(xData, xLength, xLength, yData, yLength, yLength, 1, mode);
+  }
+  catch(std::exception& e) {
+    ierr = PetscPrintf(PETSC_COMM_SELF, "%s\n", e.what());CHKERRQ(ierr);
+    success = false;
+  }
+
+  ierr = VecRestoreArrayRead(x, &xData);CHKERRQ(ierr);
+  ierr = VecRestoreArray(y, &yData);CHKERRQ(ierr);
+  if(!success) {
+    SETERRQ(PETSC_COMM_SELF, PETSC_ERR_LIB, "The Tpetra::Operator threw an exception");
+  }
+  return 0;
+}
+
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode applyPETScShellPCNoTrans(PC pc, Vec x, Vec y)
+{ return applyPETScShellPC<Scalar,LO,GO,Node>(pc, x, y, Teuchos::NO_TRANS); }
+
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode applyPETScShellPCTrans(PC pc, Vec x, Vec y)
+{ return applyPETScShellPC<Scalar,LO,GO,Node>(pc, x, y, Teuchos::TRANS); }
+
+#if PETSC_VERSION_GE(3,15,0)
+//! Applies the operator of a PCSHELL created by createPETScPCFromTpetraOperator to the columns of a dense matrix.
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode matApplyPETScShellPC(PC pc, Mat X, Mat Y)
+{
+  PetscErrorCode ierr;
+  void* ctx;
+  ierr = PCShellGetContext(pc, &ctx);CHKERRQ(ierr);
+  PETScShellPCContext<Scalar,LO,GO,Node>* context = static_cast<PETScShellPCContext<Scalar,LO,GO,Node>*>(ctx);
+
+  const PetscScalar* xData;
+  PetscScalar* yData;
+  PetscInt numVecs, xRows, yRows, ldx, ldy;
+  ierr = MatGetSize(X, NULL, &numVecs);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(X, &xRows, NULL);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(Y, &yRows, NULL);CHKERRQ(ierr);
+  ierr = MatDenseGetLDA(X, &ldx);CHKERRQ(ierr);
+  ierr = MatDenseGetLDA(Y, &ldy);CHKERRQ(ierr);
+  ierr = MatDenseGetArrayRead(X, &xData);CHKERRQ(ierr);
+  ierr = MatDenseGetArrayWrite(Y, &yData);CHKERRQ(ierr);
+
+  bool success = true;
+  try {
+    context->apply(xData, xRows, ldx, yData, yRows, ldy, numVecs, Teuchos::NO_TRANS);
+  }
+  catch(std::exception& e) {
+    ierr = PetscPrintf(PETSC_COMM_SELF, "%s\n", e.what());CHKERRQ(ierr);
+    success = false;
+  }
+
+  ierr = MatDenseRestoreArrayRead(X, &xData);CHKERRQ(ierr);
+  ierr = MatDenseRestoreArrayWrite(Y, &yData);CHKERRQ(ierr);
+  if(!success) {
+    SETERRQ(PETSC_COMM_SELF, PETSC_ERR_LIB, "The Tpetra::Operator threw an exception");
+  }
+  return 0;
+}
+#endif
+
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode destroyPETScShellPC(PC pc)
+{
+  PetscErrorCode ierr;
+  void* ctx;
+  ierr = PCShellGetContext(pc, &ctx);CHKERRQ(ierr);
+  delete static_cast<PETScShellPCContext<Scalar,LO,GO,Node>*>(ctx);
+  return 0;
+}
+
+} // namespace Details
+
+//! Turns pc into a PCSHELL that applies a Tpetra::Operator, such as a MueLu or Ifpack2 preconditioner.
+/*! The PETSc vectors are viewed as Tpetra vectors without copying whenever the Node stores its data in
+    host memory; otherwise they are copied through Tpetra vectors that are allocated once and reused.
+    PCApplyTranspose is supported if op->hasTransposeApply(), and with PETSc 3.15 or newer PCMatApply
+    applies op to all columns of a dense matrix at once.  The PC keeps a reference to op until it is
+    destroyed or its type is changed.  The local sizes of the PETSc vectors must match the distribution
+    of op's domain and range maps.
+*/
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode createPETScPCFromTpetraOperator(PC pc, const Teuchos::RCP<const Tpetra::Operator<Scalar,LO,GO,Node> >& op)
+{
+  PetscErrorCode ierr;
+  typedef Details::PETScShellPCContext<Scalar,LO,GO,Node> Context;
+
+  ierr = PCSetType(pc, PCSHELL);CHKERRQ(ierr);
+  ierr = PCShellSetContext(pc, new Context(op));CHKERRQ(ierr);
+  ierr = PCShellSetDestroy(pc, Details::destroyPETScShellPC<Scalar,LO,GO,Node>);CHKERRQ(ierr);
+  ierr = PCShellSetApply(pc, Details::applyPETScShellPCNoTrans<Scalar,LO,GO,Node>);CHKERRQ(ierr);
+  if(op->hasTransposeApply()) {
+    ierr = PCShellSetApplyTranspose(pc, Details::applyPETScShellPCTrans<Scalar,LO,GO,Node>);CHKERRQ(ierr);
+  }
+#if PETSC_VERSION_GE(3,15,0)
+  ierr = PCShellSetMatApply(pc, Details::matApplyPETScShellPC<Scalar,LO,GO,Node>);CHKERRQ(ierr);
+#endif
+  ierr = PCShellSetName(pc, op->description().c_str());CHKERRQ(ierr);
+  return 0;
+}
+
+} // namespace xSDKTrilinos
+
+#endif // _TPETRA_PETSCPC_H_
@@ -0,0 +1,269 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef _TPETRA_PETSCVECTOR_H_
+#define _TPETRA_PETSCVECTOR_H_
+
+#include "Tpetra_ConfigDefs.hpp"
+#include "Tpetra_Vector.hpp"
+#ifdef HAVE_MPI
+#include "Teuchos_DefaultMpiComm.hpp"
+#else
+#include "Teuchos_DefaultSerialComm.hpp"
+#endif
+//Petsc headers.
+#include <petscvec.h>
+#include <algorithm>
+#include <type_traits>
+
+
+namespace xSDKTrilinos {
+
+namespace Details {
+
+//! Whether PETSc storage can be used as the storage of MV without copying.
+/*! The Node has to keep its data in host memory, and MV has to hold PetscScalars; any other Scalar
+    would reinterpret the PETSc entries as the wrong type.
+*/
+template<class MV>
+struct PETScArrayIsViewable {
+  typedef typename MV::dual_view_type::t_dev::memory_space memory_space;
+  static const bool value = std::is_same<memory_space, Kokkos::HostSpace>::value &&
+                            std::is_same<typename MV::scalar_type, PetscScalar>::value;
+};
+
+//! Wraps raw host storage as a Tpetra::MultiVector without copying, when PETScArrayIsViewable<MV>::value.
+/*! Returns NULL if the storage cannot be wrapped.
+*/
+template<class MV, bool isHostMemory>
+struct PETScArrayWrapper {
+  static MV* wrap(const Teuchos::RCP<const typename MV::map_type>& map, PetscScalar* data, PetscInt numVecs)
+  { return NULL; }
+};
+
+template<class MV>
+struct PETScArrayWrapper<MV,true> {
+  static MV* wrap(const Teuchos::RCP<const typename MV::map_type>& map, PetscScalar* data, PetscInt numVecs)
+  {
+    typedef typename MV::dual_view_type dual_view_type;
+    typedef typename MV::impl_scalar_type IST;
+    typedef Kokkos::View<IST**, Kokkos::LayoutLeft, typename dual_view_type::t_dev::device_type, Kokkos::MemoryUnmanaged> unmanaged_view_type;
+
+    unmanaged_view_type view(reinterpret_cast<IST*>(data), map->getNodeNumElements(), numVecs);
+    dual_view_type dualView(view, view);
+    return new MV(map, dualView);
+  }
+};
+
+//! Deallocator of a Tpetra::Vector created by viewPETScVecAsTpetraVector.
+/*! Gives the array back to the PETSc Vec and releases the reference to it.  If the vector could
+    not view the array directly, its entries are copied back first.
+*/
+template<class Vector>
+class PETScVecArrayDealloc {
+public:
+  typedef Vector ptr_t;
+
+  PETScVecArrayDealloc(Vec v, PetscScalar* array, bool copyBack)
+    : v_(v), array_(array), copyBack_(copyBack) {}
+
+  void free(Vector* ptr)
+  {
+    // Views may outlive PetscFinalize, after which the Vec must not be touched
+    PetscBool finalized = PETSC_TRUE;
+    PetscFinalized(&finalized);
+    if(finalized) {
+      delete ptr;
+      return;
+    }
+
+    PetscErrorCode ierr;
+    if(copyBack_) {
+      Teuchos::ArrayRCP<const typename Vector::scalar_type> data = ptr->getData();
+      std::copy(data.begin(), data.end(), array_);
+    }
+    delete ptr;
+    ierr = VecRestoreArray(v_, &array_); CHKERRCONTINUE(ierr);
+    ierr = VecDestroy(&v_); CHKERRCONTINUE(ierr);
+  }
+
+private:
+  Vec v_;
+  PetscScalar* array_;
+  bool copyBack_;
+};
+
+//! Keeps a Tpetra::Vector and its host view alive for as long as a PETSc Vec created by viewTpetraVectorAsPETScVec.
+template<class Vector>
+struct TpetraVectorArrayHolder {
+  Teuchos::RCP<Vector> vector;
+  Teuchos::ArrayRCP<typename Vector::scalar_type> data;
+};
+
+template<class Vector>
+PetscErrorCode destroyTpetraVectorArrayHolder(void* ctx)
+{
+  delete static_cast<TpetraVectorArrayHolder<Vector>*>(ctx);
+  return 0;
+}
+
+//! An array placed in a Vec with VecPlaceArray, reset when this goes out of scope.
+/*! Vecs reused across calls must not keep a caller's array when a PETSc error returns early,
+    or every later VecPlaceArray on them fails.
+*/
+class PETScPlacedArray {
+public:
+  PETScPlacedArray() : v_(NULL) {}
+  ~PETScPlacedArray() { reset(); }
+
+  PetscErrorCode place(Vec v, const PetscScalar* array)
+  {
+    PetscErrorCode ierr = VecPlaceArray(v,const_cast<PetscScalar*>(array));CHKERRQ(ierr);
+    v_ = v;
+    return 0;
+  }
+
+  PetscErrorCode reset()
+  {
+    if(v_ == NULL)
+      return 0;
+    Vec v = v_;
+    v_ = NULL;
+    return VecResetArray(v);
+  }
+
+private:
+  PETScPlacedArray(const PETScPlacedArray&);
+  PETScPlacedArray& operator=(const PETScPlacedArray&);
+
+  Vec v_;
+};
+
+} // namespace Details
+
+//! Create a Tpetra::Vector whose storage is the local array of a PETSc Vec.
+/*! The Vec's array is held with VecGetArray until the returned vector is destroyed, so v must
+    not be used through PETSc in the meantime; the vector also keeps a reference to v.  If the
+    Node does not keep its data in host memory, the entries are copied in, and copied back
+    when the returned vector is destroyed.  Scalar must be PetscScalar.
+*/
+template<class Scalar, class LO, class GO, class Node>
+Teuchos::RCP<Tpetra::Vector<Scalar,LO,GO,Node> > viewPETScVecAsTpetraVector(Vec v)
+{
+  using Teuchos::RCP;
+  using Teuchos::rcp;
+  typedef Tpetra::Vector<Scalar,LO,GO,Node>                     Vector;
+  typedef Tpetra::Map<LO,GO,Node>                               Map;
+  typedef Details::PETScArrayWrapper<Vector, Details::PETScArrayIsViewable<Vector>::value> Wrapper;
+  static_assert(std::is_same<Scalar,PetscScalar>::value,
+                "xSDKTrilinos::viewPETScVecAsTpetraVector: Scalar must be PetscScalar.");
+
+  PetscErrorCode ierr;
+  PetscScalar *vals;
+  PetscInt numLocalRows, numGlobalRows;
+
+  // Get information about the distribution from PETSc
+  ierr = VecGetLocalSize(v,&numLocalRows); CHKERRCONTINUE(ierr);
+  ierr = VecGetSize(v,&numGlobalRows); CHKERRCONTINUE(ierr);
+
+  // Get the communicator
+  RCP< Teuchos::Comm<int> > TrilinosComm;
+#ifdef HAVE_MPI
+  MPI_Comm PETScComm;
+  PetscObjectGetComm( (PetscObject)v, &PETScComm);
+  TrilinosComm = rcp(new Teuchos::MpiComm<int>(PETScComm));
+#else
+  TrilinosComm = rcp(new Teuchos::SerialComm<int>());
+#endif
+
+  RCP<const Map> map = rcp(new Map(numGlobalRows,numLocalRows,0,TrilinosComm));
+
+  ierr = PetscObjectReference((PetscObject)v); CHKERRCONTINUE(ierr);
+  ierr = VecGetArray(v,&vals); CHKERRCONTINUE(ierr);
+  Vector* tpvec = Wrapper::wrap(map,vals,1);
+  const bool copyBack = (tpvec == NULL);
+  if(copyBack)
+    tpvec = new Vector(map,Teuchos::ArrayView<const Scalar>(vals,numLocalRows));
+
+  return Teuchos::rcpWithDealloc(tpvec,Details::PETScVecArrayDealloc<Vector>(v,vals,copyBack),true);
+}
+
+//! Create a PETSc Vec whose array is the local storage of a Tpetra::Vector.
+/*! The Vec keeps a reference to v and a host view of its data until it is destroyed with VecDestroy.
+    Tpetra must not change the vector's storage in the meantime.  Scalar must be PetscScalar.
+*/
+template<class Scalar, class LO, class GO, class Node>
+PetscErrorCode viewTpetraVectorAsPETScVec(const Teuchos::RCP<Tpetra::Vector<Scalar,LO,GO,Node> >& v, Vec* petscVec)
+{
+  typedef Tpetra::Vector<Scalar,LO,GO,Node> Vector;
+  typedef Details::TpetraVectorArrayHolder<Vector> Holder;
+  static_assert(std::is_same<Scalar,PetscScalar>::value,
+                "xSDKTrilinos::viewTpetraVectorAsPETScVec: Scalar must be PetscScalar.");
+
+  PetscErrorCode ierr;
+
+#ifdef HAVE_MPI
+  MPI_Comm comm = *(Teuchos::rcp_dynamic_cast<const Teuchos::MpiComm<int> >(v->getMap()->getComm())->getRawMpiComm());
+#else
+  MPI_Comm comm = PETSC_COMM_SELF;
+#endif
+
+  Holder* holder = new Holder;
+  holder->vector = v;
+  holder->data = v->getDataNonConst();
+  ierr = VecCreateMPIWithArray(comm,1,v->getLocalLength(),v->getGlobalLength(),holder->data.getRawPtr(),petscVec);CHKERRQ(ierr);
+
+  // Tie the lifetime of the Tpetra vector to the PETSc one
+  PetscContainer container;
+  ierr = PetscContainerCreate(comm,&container);CHKERRQ(ierr);
+  ierr = PetscContainerSetPointer(container,holder);CHKERRQ(ierr);
+  ierr = PetscContainerSetUserDestroy(container,Details::destroyTpetraVectorArrayHolder<Vector>);CHKERRQ(ierr);
+  ierr = PetscObjectCompose((PetscObject)*petscVec,"xSDKTrilinos_TpetraVector",(PetscObject)container);CHKERRQ(ierr);
+  ierr = PetscContainerDestroy(&container);CHKERRQ(ierr);
+
+  return 0;
+}
+
+} // namespace xSDKTrilinos
+
+#endif // _TPETRA_PETSCVECTOR_H_
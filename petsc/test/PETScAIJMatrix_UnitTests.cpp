@@ -44,8 +44,26 @@
 #include <Teuchos_CommHelpers.hpp>
 #include "Teuchos_UnitTestHarness.hpp"
 
+#include <algorithm>
+#include <cmath>
+
+#include <BelosBlockGmresSolMgr.hpp>
+#include <BelosMVOPTester.hpp>
+#include <BelosPETScAdapter.hpp>
+#ifdef HAVE_XSDKTRILINOS_ANASAZI
+#  include <AnasaziBasicEigenproblem.hpp>
+#  include <AnasaziBasicOutputManager.hpp>
+#  include <AnasaziBlockKrylovSchurSolMgr.hpp>
+#  include <AnasaziMVOPTester.hpp>
+#  include <AnasaziPETScAdapter.hpp>
+#endif
+
 #include <Tpetra_ConfigDefs.hpp>
+#include <Tpetra_PETScAIJEquilibration.hpp>
 #include <Tpetra_PETScAIJMatrix.hpp>
+#include <Tpetra_PETScMatrixLoader.hpp>
+#include <Tpetra_PETScOperator.hpp>
+#include <Tpetra_PETScPC.hpp>
 #include <Tpetra_MultiVector.hpp>
 #include "Tpetra_DefaultPlatform.hpp"
 #include "Tpetra_ETIHelperMacros.h"
@@ -172,6 +190,31 @@ inline void tupleToArray(Array<T> &arr, const tuple &tup)
     TEST_EQUALITY( matrix.getGlobalMaxNumRowEntries(), STGMAX ); \
   }
 
+// y = D*x for a shell matrix, where D = diag(1,2,...,N)
+PetscErrorCode diagonalShellMult(Mat A, Vec x, Vec y)
+{
+  PetscErrorCode ierr;
+  PetscInt start, end;
+  const PetscScalar * xa;
+  PetscScalar * ya;
+  ierr = VecGetOwnershipRange(x,&start,&end);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(x,&xa);CHKERRQ(ierr);
+  ierr = VecGetArray(y,&ya);CHKERRQ(ierr);
+  for (PetscInt i=start; i<end; i++) ya[i-start] = (1.0 + i)*xa[i-start];
+  ierr = VecRestoreArray(y,&ya);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(x,&xa);CHKERRQ(ierr);
+  return 0;
+}
+
+// F(x) = 3*x, whose matrix-free Jacobian is 3*I
+PetscErrorCode tripleFunction(void* ctx, Vec x, Vec f)
+{
+  PetscErrorCode ierr;
+  ierr = VecCopy(x,f);CHKERRQ(ierr);
+  ierr = VecScale(f,3.0);CHKERRQ(ierr);
+  return 0;
+}
+
 
   //
   // UNIT TESTS
@@ -813,10 +856,1237 @@ inline void tupleToArray(Array<T> &arr, const tuple &tup)
   }
 
 
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( PETScAIJMatrix, ShellPC, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef int LO;
+    typedef Operator<Scalar,LO,GO,Node> OP;
+    typedef ScalarTraits<Scalar> ST;
+    typedef typename ST::magnitudeType Mag;
+    const PetscInt THREE = 3;
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // Create a nonsymmetric bidiagonal matrix, three rows per proc
+    Mat A;
+    PetscInt Istart, Iend, Ii, J, N;
+    PetscScalar v;
+    ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRV(ierr);
+    ierr = MatSetSizes(A,THREE,THREE,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRV(ierr);
+    ierr = MatSetType(A, MATAIJ);CHKERRV(ierr);
+    ierr = MatMPIAIJSetPreallocation(A,2,NULL,1,NULL);CHKERRV(ierr);
+    ierr = MatSeqAIJSetPreallocation(A,2,NULL);CHKERRV(ierr);
+    ierr = MatSetUp(A);CHKERRV(ierr);
+    ierr = MatGetSize(A,&N,NULL);CHKERRV(ierr);
+    ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRV(ierr);
+    for (Ii=Istart; Ii<Iend; Ii++) {
+      v = 2.0; ierr = MatSetValues(A,1,&Ii,1,&Ii,&v,INSERT_VALUES);CHKERRV(ierr);
+      if (Ii < N-1) {J = Ii + 1; v = -1.0; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+    }
+    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+
+    // A PC that applies the Tpetra copy of A must act like A
+    RCP<const OP> tpetraA = xSDKTrilinos::deepCopyPETScAIJMatrixToTpetraCrsMatrix<Scalar,LO,GO,Node>(A);
+    PC pc;
+    ierr = PCCreate(PETSC_COMM_WORLD,&pc);CHKERRV(ierr);
+    ierr = PCSetOperators(pc,A,A);CHKERRV(ierr);
+    ierr = xSDKTrilinos::createPETScPCFromTpetraOperator<Scalar,LO,GO,Node>(pc,tpetraA);CHKERRV(ierr);
+    ierr = PCSetUp(pc);CHKERRV(ierr);
+
+    Vec x, y, z;
+    PetscRandom rctx;
+    PetscReal norm;
+    ierr = MatCreateVecs(A,&x,&y);CHKERRV(ierr);
+    ierr = VecDuplicate(y,&z);CHKERRV(ierr);
+    ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rctx);CHKERRV(ierr);
+    ierr = VecSetRandom(x,rctx);CHKERRV(ierr);
+
+    ierr = PCApply(pc,x,y);CHKERRV(ierr);
+    ierr = MatMult(A,x,z);CHKERRV(ierr);
+    ierr = VecAXPY(z,-1.0,y);CHKERRV(ierr);
+    ierr = VecNorm(z,NORM_2,&norm);CHKERRV(ierr);
+    TEST_COMPARE(norm, <=, 100.0*testingTol<Mag>());
+
+    ierr = PCApplyTranspose(pc,x,y);CHKERRV(ierr);
+    ierr = MatMultTranspose(A,x,z);CHKERRV(ierr);
+    ierr = VecAXPY(z,-1.0,y);CHKERRV(ierr);
+    ierr = VecNorm(z,NORM_2,&norm);CHKERRV(ierr);
+    TEST_COMPARE(norm, <=, 100.0*testingTol<Mag>());
+
+    // Applying the PC again reuses its vectors
+    ierr = PCApply(pc,x,y);CHKERRV(ierr);
+    ierr = MatMult(A,x,z);CHKERRV(ierr);
+    ierr = VecAXPY(z,-1.0,y);CHKERRV(ierr);
+    ierr = VecNorm(z,NORM_2,&norm);CHKERRV(ierr);
+    TEST_COMPARE(norm, <=, 100.0*testingTol<Mag>());
+
+    ierr = PetscRandomDestroy(&rctx);CHKERRV(ierr);
+    ierr = VecDestroy(&x);CHKERRV(ierr);
+    ierr = VecDestroy(&y);CHKERRV(ierr);
+    ierr = VecDestroy(&z);CHKERRV(ierr);
+    ierr = PCDestroy(&pc);CHKERRV(ierr);
+    ierr = MatDestroy(&A);CHKERRV(ierr);
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+
+
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( PETScAIJMatrix, DeepCopy, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef int LO;
+    typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node> CRS;
+    const PetscInt THREE = 3;
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // Create a tridiagonal matrix with off-process couplings, three rows per proc
+    Mat A;
+    PetscInt Istart, Iend, Ii, J, N;
+    PetscScalar v;
+    ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRV(ierr);
+    ierr = MatSetSizes(A,THREE,THREE,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRV(ierr);
+    ierr = MatSetType(A, MATAIJ);CHKERRV(ierr);
+    ierr = MatMPIAIJSetPreallocation(A,3,NULL,2,NULL);CHKERRV(ierr);
+    ierr = MatSeqAIJSetPreallocation(A,3,NULL);CHKERRV(ierr);
+    ierr = MatSetUp(A);CHKERRV(ierr);
+    ierr = MatGetSize(A,&N,NULL);CHKERRV(ierr);
+    ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRV(ierr);
+    for (Ii=Istart; Ii<Iend; Ii++) {
+      v = 2.0 + Ii; ierr = MatSetValues(A,1,&Ii,1,&Ii,&v,INSERT_VALUES);CHKERRV(ierr);
+      if (Ii > 0)   {J = Ii - 1; v = -1.0; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+      if (Ii < N-1) {J = Ii + 1; v = -0.5; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+    }
+    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+
+    RCP<CRS> tpetraA = xSDKTrilinos::deepCopyPETScAIJMatrixToTpetraCrsMatrix<Scalar,LO,GO,Node>(A);
+    TEST_EQUALITY_CONST( tpetraA->isFillComplete(), true );
+    TEST_EQUALITY( tpetraA->getGlobalNumRows(), (global_size_t)N );
+    TEST_EQUALITY( tpetraA->getGlobalNumEntries(), (global_size_t)(3*N-2) );
+    TEST_EQUALITY_CONST( tpetraA->getDomainMap()->isSameAs(*tpetraA->getRangeMap()), true );
+
+    // Every row must match the PETSc row entry for entry
+    Array<GO> inds(THREE);
+    Array<Scalar> vals(THREE);
+    size_t nnz;
+    const PetscInt * cols;
+    const PetscScalar * pvals;
+    PetscInt ncols;
+    for (Ii=Istart; Ii<Iend; Ii++) {
+      tpetraA->getGlobalRowCopy(Ii,inds(),vals(),nnz);
+      ierr = MatGetRow(A,Ii,&ncols,&cols,&pvals);CHKERRV(ierr);
+      TEST_EQUALITY( nnz, (size_t)ncols );
+      for (PetscInt k=0; k<ncols; k++) {
+        size_t pos = 0;
+        while (pos < nnz && inds[pos] != cols[k]) pos++;
+        TEST_INEQUALITY( pos, nnz );
+        if (pos < nnz) {
+          TEST_EQUALITY( vals[pos], pvals[k] );
+        }
+      }
+      ierr = MatRestoreRow(A,Ii,&ncols,&cols,&pvals);CHKERRV(ierr);
+    }
+
+#ifdef HAVE_TPETRA_INST_FLOAT
+    // A single precision copy, as used for a mixed precision preconditioner; the values are exact in float
+    RCP<Tpetra::CrsMatrix<float,LO,GO,Node> > floatA = xSDKTrilinos::deepCopyPETScAIJMatrixToTpetraCrsMatrix<float,LO,GO,Node>(A);
+    TEST_EQUALITY( floatA->getGlobalNumEntries(), (global_size_t)(3*N-2) );
+    Array<float> floatVals(THREE);
+    for (Ii=Istart; Ii<Iend; Ii++) {
+      tpetraA->getGlobalRowCopy(Ii,inds(),vals(),nnz);
+      Array<GO> floatInds(THREE);
+      size_t floatNnz;
+      floatA->getGlobalRowCopy(Ii,floatInds(),floatVals(),floatNnz);
+      TEST_EQUALITY( floatNnz, nnz );
+      for (size_t k=0; k<floatNnz && k<nnz; k++) {
+        TEST_EQUALITY( floatInds[k], inds[k] );
+        TEST_EQUALITY( static_cast<Scalar>(floatVals[k]), vals[k] );
+      }
+    }
+
+    // Vectors are converted the same way
+    Vec x;
+    ierr = MatCreateVecs(A,&x,NULL);CHKERRV(ierr);
+    ierr = VecSet(x,2.5);CHKERRV(ierr);
+    RCP<Tpetra::Vector<float,LO,GO,Node> > floatX = xSDKTrilinos::deepCopyPETScVecToTpetraVector<float,LO,GO,Node>(x);
+    {
+      ArrayRCP<const float> floatXData = floatX->getData();
+      TEST_EQUALITY( (PetscInt)floatXData.size(), Iend-Istart );
+      for (ArrayRCP<const float>::size_type k=0; k<floatXData.size(); k++) {
+        TEST_EQUALITY( floatXData[k], 2.5f );
+      }
+    }
+    floatX = Teuchos::null;
+    ierr = VecDestroy(&x);CHKERRV(ierr);
+#endif
+
+    ierr = MatDestroy(&A);CHKERRV(ierr);
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+
+
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( PETScAIJMatrix, CreatePETScMat, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef int LO;
+    typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node> CRS;
+    const global_size_t INVALID = OrdinalTraits<global_size_t>::invalid();
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // Assemble a tridiagonal Tpetra matrix with off-process couplings
+    RCP<const Comm<int> > comm = Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+    RCP<Node> node = Tpetra::DefaultPlatform::getDefaultPlatform ().getNode ();
+    const size_t numLocal = 4;
+    RCP<const Map<LO,GO,Node> > map = createContigMapWithNode<LO,GO>(INVALID,numLocal,comm,node);
+    const GO N = map->getGlobalNumElements();
+    RCP<CRS> tpetraA = rcp(new CRS(map,3,StaticProfile));
+    for (GO Ii=map->getMinGlobalIndex(); Ii<=map->getMaxGlobalIndex(); Ii++) {
+      tpetraA->insertGlobalValues(Ii,tuple<GO>(Ii),tuple<Scalar>(2.0+Ii));
+      if (Ii > 0)   tpetraA->insertGlobalValues(Ii,tuple<GO>(Ii-1),tuple<Scalar>(-1.0));
+      if (Ii < N-1) tpetraA->insertGlobalValues(Ii,tuple<GO>(Ii+1),tuple<Scalar>(-0.5));
+    }
+    tpetraA->fillComplete();
+
+    Mat A;
+    ierr = xSDKTrilinos::createPETScMatFromTpetraCrsMatrix<Scalar,LO,GO,Node>(tpetraA,&A);CHKERRV(ierr);
+
+    // Every PETSc row must match the Tpetra row entry for entry
+    Array<GO> inds(3);
+    Array<Scalar> vals(3);
+    size_t nnz;
+    const PetscInt * cols;
+    const PetscScalar * pvals;
+    PetscInt ncols;
+    for (GO Ii=map->getMinGlobalIndex(); Ii<=map->getMaxGlobalIndex(); Ii++) {
+      tpetraA->getGlobalRowCopy(Ii,inds(),vals(),nnz);
+      ierr = MatGetRow(A,Ii,&ncols,&cols,&pvals);CHKERRV(ierr);
+      TEST_EQUALITY( (size_t)ncols, nnz );
+      for (PetscInt k=0; k<ncols; k++) {
+        size_t pos = 0;
+        while (pos < nnz && inds[pos] != cols[k]) pos++;
+        TEST_INEQUALITY( pos, nnz );
+        if (pos < nnz) {
+          TEST_EQUALITY( vals[pos], pvals[k] );
+        }
+      }
+      ierr = MatRestoreRow(A,Ii,&ncols,&cols,&pvals);CHKERRV(ierr);
+    }
+    ierr = MatDestroy(&A);CHKERRV(ierr);
+
+    // On one process nothing is off-process, so the values can be shared
+    if (comm->getSize() == 1) {
+      ierr = xSDKTrilinos::createPETScMatFromTpetraCrsMatrix<Scalar,LO,GO,Node>(tpetraA,&A,true);CHKERRV(ierr);
+      const GO row = 1;
+      ierr = MatGetRow(A,row,&ncols,&cols,&pvals);CHKERRV(ierr);
+      TEST_EQUALITY_CONST( ncols, 3 );
+      TEST_EQUALITY( pvals[1], 3.0 );
+      ierr = MatRestoreRow(A,row,&ncols,&cols,&pvals);CHKERRV(ierr);
+      ierr = MatDestroy(&A);CHKERRV(ierr);
+    }
+
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+
+
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( PETScAIJMatrix, VectorViews, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef int LO;
+    typedef Vector<Scalar,LO,GO,Node> VEC;
+    const global_size_t INVALID = OrdinalTraits<global_size_t>::invalid();
+    const PetscInt numLocal = 5;
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // Changes made through a Tpetra view must show up in the PETSc Vec
+    Vec x;
+    PetscScalar *xData;
+    ierr = VecCreateMPI(PETSC_COMM_WORLD,numLocal,PETSC_DETERMINE,&x);CHKERRV(ierr);
+    ierr = VecSet(x,1.0);CHKERRV(ierr);
+    {
+      RCP<VEC> xView = xSDKTrilinos::viewPETScVecAsTpetraVector<Scalar,LO,GO,Node>(x);
+      TEST_EQUALITY( xView->getLocalLength(), (size_t)numLocal );
+      xView->scale(3.0);
+    }
+    ierr = VecGetArray(x,&xData);CHKERRV(ierr);
+    for (PetscInt i=0; i<numLocal; i++) {
+      TEST_EQUALITY_CONST( xData[i], 3.0 );
+    }
+    ierr = VecRestoreArray(x,&xData);CHKERRV(ierr);
+    ierr = VecDestroy(&x);CHKERRV(ierr);
+
+    // Changes made through a PETSc view must show up in the Tpetra Vector
+    RCP<const Comm<int> > comm = Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+    RCP<Node> node = Tpetra::DefaultPlatform::getDefaultPlatform ().getNode ();
+    RCP<const Map<LO,GO,Node> > map = createContigMapWithNode<LO,GO>(INVALID,numLocal,comm,node);
+    RCP<VEC> y = rcp(new VEC(map));
+    y->putScalar(2.0);
+    Vec yView;
+    ierr = xSDKTrilinos::viewTpetraVectorAsPETScVec<Scalar,LO,GO,Node>(y,&yView);CHKERRV(ierr);
+    ierr = VecScale(yView,-1.0);CHKERRV(ierr);
+    ierr = VecDestroy(&yView);CHKERRV(ierr);
+    ArrayRCP<const Scalar> yData = y->getData();
+    for (PetscInt i=0; i<numLocal; i++) {
+      TEST_EQUALITY_CONST( yData[i], -2.0 );
+    }
+
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+
+
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( PETScAIJMatrix, LoadMatrix, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef int LO;
+    typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node> CRS;
+    const std::string mmFile = "PETScLoaderTest.mtx", binFile = "PETScLoaderTest.bin";
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // Write the lower triangle of a symmetric tridiagonal matrix
+    RCP<const Comm<int> > comm = Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+    const GO N = 4*comm->getSize()+1;
+    if (comm->getRank() == 0) {
+      std::ofstream out(mmFile.c_str());
+      out << "%%MatrixMarket matrix coordinate real symmetric\n% comment\n";
+      out << N << " " << N << " " << 2*N-1 << "\n";
+      for (GO i=1; i<=N; i++) {
+        out << i << " " << i << " " << 2.0 << "\n";
+        if (i < N) out << i+1 << " " << i << " " << -1.0 << "\n";
+      }
+    }
+    comm->barrier();
+
+    RCP<CRS> A = xSDKTrilinos::loadTpetraCrsMatrix<Scalar,LO,GO,Node>(PETSC_COMM_WORLD,mmFile);
+    TEST_EQUALITY( A->getGlobalNumRows(), (global_size_t)N );
+    TEST_EQUALITY( A->getGlobalNumEntries(), (global_size_t)(3*N-2) );
+    Array<GO> inds(3);
+    Array<Scalar> vals(3);
+    size_t nnz;
+    RCP<const Map<LO,GO,Node> > rowMap = A->getRowMap();
+    for (GO Ii=rowMap->getMinGlobalIndex(); Ii<=rowMap->getMaxGlobalIndex(); Ii++) {
+      A->getGlobalRowCopy(Ii,inds(),vals(),nnz);
+      for (size_t k=0; k<nnz; k++) {
+        TEST_EQUALITY( vals[k], inds[k] == Ii ? 2.0 : -1.0 );
+      }
+    }
+
+    // A PETSc binary copy of the matrix must load the same way
+    Mat PA, PB;
+    PetscViewer viewer;
+    PetscBool equal;
+    ierr = xSDKTrilinos::loadPETScMatrix(PETSC_COMM_WORLD,mmFile,&PA);CHKERRV(ierr);
+    ierr = PetscViewerBinaryOpen(PETSC_COMM_WORLD,binFile.c_str(),FILE_MODE_WRITE,&viewer);CHKERRV(ierr);
+    ierr = MatView(PA,viewer);CHKERRV(ierr);
+    ierr = PetscViewerDestroy(&viewer);CHKERRV(ierr);
+    ierr = xSDKTrilinos::loadPETScMatrix(PETSC_COMM_WORLD,binFile,&PB);CHKERRV(ierr);
+    ierr = MatEqual(PA,PB,&equal);CHKERRV(ierr);
+    TEST_EQUALITY_CONST( equal, PETSC_TRUE );
+    ierr = MatDestroy(&PA);CHKERRV(ierr);
+    ierr = MatDestroy(&PB);CHKERRV(ierr);
+
+    RCP<PETScAIJMatrix<Scalar,LO,GO,Node> > W = xSDKTrilinos::loadPETScAIJMatrix<Scalar,LO,GO,Node>(PETSC_COMM_WORLD,binFile);
+    TEST_EQUALITY( W->getGlobalNumEntries(), (global_size_t)(3*N-2) );
+    W = null;
+
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+
+
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( PETScAIJMatrix, MultiVectorApply, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef int LO;
+    typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node> CRS;
+    typedef MultiVector<Scalar,LO,GO,Node> MV;
+    typedef ScalarTraits<Scalar> ST;
+    typedef typename ST::magnitudeType Mag;
+    const PetscInt THREE = 3;
+    const size_t NUMVECS = 4;
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // Couplings at distance 1 and 4, so that ghosts come from more than one process
+    Mat A;
+    PetscInt Istart, Iend, Ii, J, N;
+    PetscScalar v;
+    ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRV(ierr);
+    ierr = MatSetSizes(A,THREE,THREE,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRV(ierr);
+    ierr = MatSetType(A, MATAIJ);CHKERRV(ierr);
+    ierr = MatMPIAIJSetPreallocation(A,5,NULL,4,NULL);CHKERRV(ierr);
+    ierr = MatSeqAIJSetPreallocation(A,5,NULL);CHKERRV(ierr);
+    ierr = MatSetUp(A);CHKERRV(ierr);
+    ierr = MatGetSize(A,&N,NULL);CHKERRV(ierr);
+    ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRV(ierr);
+    for (Ii=Istart; Ii<Iend; Ii++) {
+      v = 4.0 + Ii; ierr = MatSetValues(A,1,&Ii,1,&Ii,&v,INSERT_VALUES);CHKERRV(ierr);
+      if (Ii > 0)   {J = Ii - 1; v = -1.0;  ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+      if (Ii < N-1) {J = Ii + 1; v = -0.5;  ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+      if (Ii > 3)   {J = Ii - 4; v = -0.25; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+      if (Ii < N-4) {J = Ii + 4; v = 0.125; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+    }
+    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+
+    {
+      PETScAIJMatrix<Scalar,LO,GO,Node> wrapped(A);
+      RCP<CRS> reference = xSDKTrilinos::deepCopyPETScAIJMatrixToTpetraCrsMatrix<Scalar,LO,GO,Node>(A);
+
+      MV X(wrapped.getDomainMap(),NUMVECS), Y(wrapped.getRangeMap(),NUMVECS);
+      X.randomize();
+      Y.randomize();
+      MV Xorig(X, Teuchos::Copy), Yref(Y, Teuchos::Copy);
+      const Scalar alpha = 2.0, beta = -0.5;
+
+      Array<Mag> norms(NUMVECS), refNorms(NUMVECS);
+      for (int pass=0; pass<2; pass++) {
+        // The second pass reuses the cached scatter
+        wrapped.apply(X,Y,NO_TRANS,alpha,beta);
+        reference->apply(X,Yref,NO_TRANS,alpha,beta);
+        Yref.norm2(refNorms());
+        Yref.update(-ST::one(),Y,ST::one());
+        Yref.norm2(norms());
+        for (size_t c=0; c<NUMVECS; c++) {
+          TEST_COMPARE( norms[c], <=, 100*ST::eps()*refNorms[c] );
+        }
+        Tpetra::deep_copy(Yref,Y);
+      }
+
+      // X is left alone
+      Xorig.update(-ST::one(),X,ST::one());
+      Xorig.norm2(norms());
+      for (size_t c=0; c<NUMVECS; c++) {
+        TEST_EQUALITY_CONST( norms[c], ST::zero() );
+      }
+
+      // Fewer, non-contiguous columns and beta = 0
+      Array<size_t> cols = tuple<size_t>(0,3);
+      RCP<const MV> Xsub = X.subView(cols());
+      MV Z(wrapped.getRangeMap(),2), Zref(wrapped.getRangeMap(),2);
+      Z.putScalar(ST::nan());
+      wrapped.apply(*Xsub,Z,NO_TRANS,alpha,ST::zero());
+      reference->apply(*Xsub,Zref,NO_TRANS,alpha,ST::zero());
+      Array<Mag> subNorms(2), subRefNorms(2);
+      Zref.norm2(subRefNorms());
+      Zref.update(-ST::one(),Z,ST::one());
+      Zref.norm2(subNorms());
+      TEST_COMPARE( subNorms[0], <=, 100*ST::eps()*subRefNorms[0] );
+      TEST_COMPARE( subNorms[1], <=, 100*ST::eps()*subRefNorms[1] );
+    }
+
+    ierr = MatDestroy(&A);CHKERRV(ierr);
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( PETScAIJMatrix, LocalRowCopy, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef int LO;
+    typedef Tpetra::Map<LO,GO,Node> MAP;
+    const PetscInt THREE = 3;
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // Couplings at distance 1 and 4, so that rows have ghosts on both sides of the diagonal block
+    Mat A;
+    PetscInt Istart, Iend, Ii, J, N;
+    PetscScalar v;
+    ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRV(ierr);
+    ierr = MatSetSizes(A,THREE,THREE,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRV(ierr);
+    ierr = MatSetType(A, MATAIJ);CHKERRV(ierr);
+    ierr = MatMPIAIJSetPreallocation(A,5,NULL,4,NULL);CHKERRV(ierr);
+    ierr = MatSeqAIJSetPreallocation(A,5,NULL);CHKERRV(ierr);
+    ierr = MatSetUp(A);CHKERRV(ierr);
+    ierr = MatGetSize(A,&N,NULL);CHKERRV(ierr);
+    ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRV(ierr);
+    for (Ii=Istart; Ii<Iend; Ii++) {
+      v = 4.0 + Ii; ierr = MatSetValues(A,1,&Ii,1,&Ii,&v,INSERT_VALUES);CHKERRV(ierr);
+      if (Ii > 0)   {J = Ii - 1; v = -1.0;  ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+      if (Ii < N-1) {J = Ii + 1; v = -0.5;  ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+      if (Ii > 3)   {J = Ii - 4; v = -0.25; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+      if (Ii < N-4) {J = Ii + 4; v = 0.125; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+    }
+    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+
+    PETScAIJMatrix<Scalar,LO,GO,Node> tpetraA(A);
+    RCP<const MAP> colMap = tpetraA.getColMap();
+    RCP<const MAP> rowMap = tpetraA.getRowMap();
+
+    // Local rows hold column Map indices of the same entries, in the same order, as the global rows
+    const size_t MAXNNZ = 5;
+    Array<LO> linds(MAXNNZ), graphInds(MAXNNZ);
+    Array<GO> globalInds(MAXNNZ);
+    Array<Scalar> lvals(MAXNNZ), gvals(MAXNNZ);
+    size_t lnnz, gnnz, graphNnz;
+    for (LO lrow=0; lrow < (LO)rowMap->getNodeNumElements(); lrow++) {
+      tpetraA.getLocalRowCopy(lrow,linds(),lvals(),lnnz);
+      tpetraA.getGlobalRowCopy(rowMap->getGlobalElement(lrow),globalInds(),gvals(),gnnz);
+      tpetraA.getGraph()->getLocalRowCopy(lrow,graphInds(),graphNnz);
+      TEST_EQUALITY( lnnz, gnnz );
+      TEST_EQUALITY( graphNnz, gnnz );
+      for (size_t k=0; k<lnnz && k<gnnz; k++) {
+        TEST_COMPARE( linds[k], <, (LO)colMap->getNodeNumElements() );
+        TEST_EQUALITY( colMap->getGlobalElement(linds[k]), globalInds[k] );
+        TEST_EQUALITY( lvals[k], gvals[k] );
+        TEST_EQUALITY( graphInds[k], linds[k] );
+      }
+    }
+
+    // Too small a buffer is an error
+    if (rowMap->getNodeNumElements() > 0) {
+      TEST_THROW( tpetraA.getLocalRowCopy(0,linds(0,1),lvals(0,1),lnnz), std::runtime_error );
+    }
+
+    // Batched copies of a range of rows match the rows, both from PETSc and through the RowMatrix fallback
+    RCP<Tpetra::CrsMatrix<Scalar,LO,GO,Node> > crsA = xSDKTrilinos::deepCopyPETScAIJMatrixToTpetraCrsMatrix<Scalar,LO,GO,Node>(A);
+    const LO numRows = rowMap->getNodeNumElements();
+    const LO rowBegin = numRows > 1 ? 1 : 0;
+    Array<size_t> rowptr, crsRowptr;
+    Array<LO> cols, crsCols;
+    Array<Scalar> vals, crsVals;
+    xSDKTrilinos::getLocalRowsCopy<Scalar,LO,GO,Node>(tpetraA,rowBegin,numRows,rowptr,cols,vals);
+    xSDKTrilinos::getLocalRowsCopy<Scalar,LO,GO,Node>(*crsA,rowBegin,numRows,crsRowptr,crsCols,crsVals);
+    TEST_EQUALITY( rowptr.size(), numRows-rowBegin+1 );
+    TEST_COMPARE_ARRAYS( rowptr, crsRowptr );
+    for (LO lrow=rowBegin; lrow < numRows; lrow++) {
+      tpetraA.getLocalRowCopy(lrow,linds(),lvals(),lnnz);
+      TEST_EQUALITY( rowptr[lrow-rowBegin+1]-rowptr[lrow-rowBegin], lnnz );
+      for (size_t k=0; k<lnnz; k++) {
+        const size_t pos = rowptr[lrow-rowBegin]+k;
+        TEST_EQUALITY( cols[pos], linds[k] );
+        TEST_EQUALITY( vals[pos], lvals[k] );
+      }
+      // The CrsMatrix may order its row differently
+      for (size_t pos=crsRowptr[lrow-rowBegin]; pos<crsRowptr[lrow-rowBegin+1]; pos++) {
+        const GO gcol = crsA->getColMap()->getGlobalElement(crsCols[pos]);
+        size_t k = 0;
+        while (k < lnnz && colMap->getGlobalElement(linds[k]) != gcol) k++;
+        TEST_INEQUALITY( k, lnnz );
+        if (k < lnnz) {
+          TEST_EQUALITY( crsVals[pos], lvals[k] );
+        }
+      }
+    }
+
+    ierr = MatDestroy(&A);CHKERRV(ierr);
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( PETScAIJMatrix, DiagonalCache, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef int LO;
+    typedef Tpetra::Vector<Scalar,LO,GO,Node> VEC;
+    const PetscInt THREE = 3;
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // A tridiagonal matrix whose diagonal is 2+i, except for a zero in the last row
+    Mat A;
+    PetscInt Istart, Iend, Ii, J, N;
+    PetscScalar v;
+    ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRV(ierr);
+    ierr = MatSetSizes(A,THREE,THREE,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRV(ierr);
+    ierr = MatSetType(A, MATAIJ);CHKERRV(ierr);
+    ierr = MatMPIAIJSetPreallocation(A,3,NULL,2,NULL);CHKERRV(ierr);
+    ierr = MatSeqAIJSetPreallocation(A,3,NULL);CHKERRV(ierr);
+    ierr = MatSetUp(A);CHKERRV(ierr);
+    ierr = MatGetSize(A,&N,NULL);CHKERRV(ierr);
+    ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRV(ierr);
+    for (Ii=Istart; Ii<Iend; Ii++) {
+      v = (Ii < N-1) ? 2.0 + Ii : 0.0; ierr = MatSetValues(A,1,&Ii,1,&Ii,&v,INSERT_VALUES);CHKERRV(ierr);
+      if (Ii > 0)   {J = Ii - 1; v = -1.0; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+      if (Ii < N-1) {J = Ii + 1; v = -1.0; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+    }
+    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+
+    PETScAIJMatrix<Scalar,LO,GO,Node> tpetraA(A);
+    PetscObjectState stateBefore, stateAfter;
+    ierr = PetscObjectStateGet((PetscObject)A,&stateBefore);CHKERRV(ierr);
+    VEC diag(tpetraA.getRowMap());
+    tpetraA.getLocalDiagCopy(diag);
+    RCP<const VEC> cached = tpetraA.getDiagonal();
+    RCP<const VEC> inverse = tpetraA.getInverseDiagonal();
+    {
+      ArrayRCP<const Scalar> d = diag.get1dView(), c = cached->get1dView(), inv = inverse->get1dView();
+      for (Ii=Istart; Ii<Iend; Ii++) {
+        const Scalar expected = (Ii < N-1) ? 2.0 + Ii : 0.0;
+        TEST_EQUALITY( d[Ii-Istart], expected );
+        TEST_EQUALITY( c[Ii-Istart], expected );
+        if (expected != 0.0) {
+          TEST_FLOATING_EQUALITY( inv[Ii-Istart], 1.0/expected, 1e-14 );
+        }
+        else {
+          TEST_EQUALITY( inv[Ii-Istart], 0.0 );
+        }
+      }
+    }
+
+    // Reading the diagonal leaves the matrix unchanged, so it keeps its cached diagonal
+    ierr = PetscObjectStateGet((PetscObject)A,&stateAfter);CHKERRV(ierr);
+    TEST_EQUALITY( stateAfter, stateBefore );
+    TEST_EQUALITY( tpetraA.getDiagonal().get(), cached.get() );
+
+    // Changing the matrix refreshes it
+    ierr = MatShift(A,1.0);CHKERRV(ierr);
+    tpetraA.getLocalDiagCopy(diag);
+    {
+      ArrayRCP<const Scalar> d = diag.get1dView(), inv = tpetraA.getInverseDiagonal()->get1dView();
+      for (Ii=Istart; Ii<Iend; Ii++) {
+        const Scalar expected = (Ii < N-1) ? 3.0 + Ii : 1.0;
+        TEST_EQUALITY( d[Ii-Istart], expected );
+        TEST_FLOATING_EQUALITY( inv[Ii-Istart], 1.0/expected, 1e-14 );
+      }
+    }
+
+    ierr = MatDestroy(&A);CHKERRV(ierr);
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( PETScAIJMatrix, Equilibration, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef int LO;
+    typedef Tpetra::MultiVector<Scalar,LO,GO,Node> MV;
+    typedef Tpetra::PETScAIJEquilibration<Scalar,LO,GO,Node> EQ;
+    const PetscInt THREE = 3;
+    const PetscReal tol = 1e-2;
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // A tridiagonal matrix whose rows are scaled by powers of ten
+    Mat A;
+    PetscInt Istart, Iend, Ii, J, N;
+    PetscScalar v;
+    ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRV(ierr);
+    ierr = MatSetSizes(A,THREE,THREE,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRV(ierr);
+    ierr = MatSetType(A, MATAIJ);CHKERRV(ierr);
+    ierr = MatMPIAIJSetPreallocation(A,3,NULL,2,NULL);CHKERRV(ierr);
+    ierr = MatSeqAIJSetPreallocation(A,3,NULL);CHKERRV(ierr);
+    ierr = MatSetUp(A);CHKERRV(ierr);
+    ierr = MatGetSize(A,&N,NULL);CHKERRV(ierr);
+    ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRV(ierr);
+    for (Ii=Istart; Ii<Iend; Ii++) {
+      const PetscScalar rowScale = std::pow(10.0, (double)(Ii % 4));
+      v = 4.0*rowScale; ierr = MatSetValues(A,1,&Ii,1,&Ii,&v,INSERT_VALUES);CHKERRV(ierr);
+      if (Ii > 0)   {J = Ii - 1; v = -rowScale; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+      if (Ii < N-1) {J = Ii + 1; v = -rowScale; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+    }
+    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+
+    RCP<PETScAIJMatrix<Scalar,LO,GO,Node> > tpetraA = rcp(new PETScAIJMatrix<Scalar,LO,GO,Node>(A));
+    MV X(tpetraA->getDomainMap(), 2), B(tpetraA->getRangeMap(), 2), Y(X, Teuchos::Copy), AY(B, Teuchos::Copy);
+    X.randomize();
+    tpetraA->apply(X,B);
+
+    // Ruiz brings every row and column maximum to within the tolerance of one
+    Teuchos::ParameterList params;
+    params.set("Equilibration: type", std::string("Ruiz"));
+    params.set("Equilibration: max iterations", 100);
+    params.set("Equilibration: tolerance", tol);
+    EQ eq(tpetraA);
+    eq.setParameters(params);
+    eq.compute();
+    TEST_EQUALITY( eq.isComputed(), true );
+    TEST_EQUALITY( eq.getNumIterations() < 100, true );
+
+    Vec rowMax;
+    Array<PetscReal> colMax(N);
+    ierr = MatCreateVecs(A,NULL,&rowMax);CHKERRV(ierr);
+    ierr = MatGetRowMaxAbs(A,rowMax,NULL);CHKERRV(ierr);
+    ierr = MatGetColumnNorms(A,NORM_INFINITY,colMax.getRawPtr());CHKERRV(ierr);
+    {
+      const PetscScalar * r;
+      ierr = VecGetArrayRead(rowMax,&r);CHKERRV(ierr);
+      for (Ii=Istart; Ii<Iend; Ii++) {
+        TEST_COMPARE( std::abs(1.0 - PetscAbsScalar(r[Ii-Istart])), <=, 1.01*tol );
+      }
+      ierr = VecRestoreArrayRead(rowMax,&r);CHKERRV(ierr);
+      for (J=0; J<N; J++) {
+        TEST_COMPARE( std::abs(1.0 - colMax[J]), <=, 1.01*tol );
+      }
+    }
+
+    // The scaled system R*A*C y = R*b is solved by y = inv(C)*x
+    eq.scaleSolution(Y);
+    tpetraA->apply(Y,AY);
+    eq.scaleRHS(B);
+    AY.update(-1.0, B, 1.0);
+    Array<PetscReal> norms(2);
+    AY.normInf(norms());
+    TEST_COMPARE( norms[0], <=, 1e-12 );
+    TEST_COMPARE( norms[1], <=, 1e-12 );
+    eq.unscaleSolution(Y);
+    Y.update(-1.0, X, 1.0);
+    Y.normInf(norms());
+    TEST_COMPARE( norms[0], <=, 1e-12 );
+    TEST_COMPARE( norms[1], <=, 1e-12 );
+
+    // Unscaling the matrix restores it
+    eq.unscaleMatrix();
+    TEST_EQUALITY( eq.isComputed(), false );
+    tpetraA->apply(X,AY);
+    eq.unscaleResidual(B);
+    AY.update(-1.0, B, 1.0);
+    AY.normInf(norms());
+    TEST_COMPARE( norms[0], <=, 1e-10 );
+    TEST_COMPARE( norms[1], <=, 1e-10 );
+
+    // max-norm leaves every column maximum at exactly one
+    params.set("Equilibration: type", std::string("max-norm"));
+    eq.setParameters(params);
+    eq.compute();
+    TEST_EQUALITY( eq.getNumIterations(), 2 );
+    ierr = MatGetColumnNorms(A,NORM_INFINITY,colMax.getRawPtr());CHKERRV(ierr);
+    for (J=0; J<N; J++) {
+      TEST_FLOATING_EQUALITY( colMax[J], 1.0, 1e-14 );
+    }
+
+    params.set("Equilibration: type", std::string("geometric"));
+    TEST_THROW( eq.setParameters(params), std::invalid_argument );
+
+    ierr = VecDestroy(&rowMax);CHKERRV(ierr);
+    ierr = MatDestroy(&A);CHKERRV(ierr);
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( PETScAIJMatrix, NormCache, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef int LO;
+    const PetscInt THREE = 3;
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // A nonsymmetric tridiagonal matrix, so that the one and infinity norms differ
+    Mat A;
+    PetscInt Istart, Iend, Ii, J, N;
+    PetscScalar v;
+    ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRV(ierr);
+    ierr = MatSetSizes(A,THREE,THREE,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRV(ierr);
+    ierr = MatSetType(A, MATAIJ);CHKERRV(ierr);
+    ierr = MatMPIAIJSetPreallocation(A,3,NULL,2,NULL);CHKERRV(ierr);
+    ierr = MatSeqAIJSetPreallocation(A,3,NULL);CHKERRV(ierr);
+    ierr = MatSetUp(A);CHKERRV(ierr);
+    ierr = MatGetSize(A,&N,NULL);CHKERRV(ierr);
+    ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRV(ierr);
+    for (Ii=Istart; Ii<Iend; Ii++) {
+      v = 2.0 + Ii; ierr = MatSetValues(A,1,&Ii,1,&Ii,&v,INSERT_VALUES);CHKERRV(ierr);
+      if (Ii > 0)   {J = Ii - 1; v = -3.0; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+      if (Ii < N-1) {J = Ii + 1; v = 0.5; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+    }
+    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+
+    PETScAIJMatrix<Scalar,LO,GO,Node> tpetraA(A);
+    PetscReal frobenius, one, inf;
+    ierr = MatNorm(A,NORM_FROBENIUS,&frobenius);CHKERRV(ierr);
+    ierr = MatNorm(A,NORM_1,&one);CHKERRV(ierr);
+    ierr = MatNorm(A,NORM_INFINITY,&inf);CHKERRV(ierr);
+    PetscObjectState stateBefore, stateAfter;
+    ierr = PetscObjectStateGet((PetscObject)A,&stateBefore);CHKERRV(ierr);
+    TEST_FLOATING_EQUALITY( tpetraA.getFrobeniusNorm(), frobenius, 1e-14 );
+    TEST_FLOATING_EQUALITY( tpetraA.getOneNorm(), one, 1e-14 );
+    TEST_FLOATING_EQUALITY( tpetraA.getInfNorm(), inf, 1e-14 );
+    TEST_INEQUALITY( one, inf );
+
+    // Computing the norms leaves the matrix unchanged, so later queries hit the cache
+    ierr = PetscObjectStateGet((PetscObject)A,&stateAfter);CHKERRV(ierr);
+    TEST_EQUALITY( stateAfter, stateBefore );
+    TEST_FLOATING_EQUALITY( tpetraA.getOneNorm(), one, 1e-14 );
+    ierr = PetscObjectStateGet((PetscObject)A,&stateAfter);CHKERRV(ierr);
+    TEST_EQUALITY( stateAfter, stateBefore );
+
+    // Changing the matrix refreshes them
+    ierr = MatScale(A,-2.0);CHKERRV(ierr);
+    TEST_FLOATING_EQUALITY( tpetraA.getFrobeniusNorm(), 2*frobenius, 1e-14 );
+    TEST_FLOATING_EQUALITY( tpetraA.getOneNorm(), 2*one, 1e-14 );
+    TEST_FLOATING_EQUALITY( tpetraA.getInfNorm(), 2*inf, 1e-14 );
+
+    ierr = MatDestroy(&A);CHKERRV(ierr);
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( PETScAIJMatrix, BlockMatrix, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef int LO;
+    typedef Tpetra::MultiVector<Scalar,LO,GO,Node> MV;
+    const PetscInt BS = 3, TWO = 2;
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // A block tridiagonal BAIJ matrix with two 3x3 blocks per process
+    Mat A;
+    PetscInt Istart, Iend, Ii, J, N;
+    PetscScalar v;
+    ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRV(ierr);
+    ierr = MatSetSizes(A,TWO*BS,TWO*BS,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRV(ierr);
+    ierr = MatSetType(A, MATBAIJ);CHKERRV(ierr);
+    ierr = MatSetBlockSize(A,BS);CHKERRV(ierr);
+    ierr = MatMPIBAIJSetPreallocation(A,BS,2,NULL,2,NULL);CHKERRV(ierr);
+    ierr = MatSeqBAIJSetPreallocation(A,BS,3,NULL);CHKERRV(ierr);
+    ierr = MatSetUp(A);CHKERRV(ierr);
+    ierr = MatGetSize(A,&N,NULL);CHKERRV(ierr);
+    ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRV(ierr);
+    for (Ii=Istart; Ii<Iend; Ii++) {
+      const PetscInt block = Ii/BS;
+      for (J=block*BS; J<(block+1)*BS; J++) {
+        v = (Ii == J) ? 10.0 + Ii : 1.0/(1 + Ii + J); ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);
+      }
+      if (block > 0)        {J = Ii - BS; v = -1.0; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+      if (block < N/BS - 1) {J = Ii + BS; v = -2.0; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+    }
+    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+
+    PETScAIJMatrix<Scalar,LO,GO,Node> tpetraA(A);
+    TEST_EQUALITY( tpetraA.getBlockSize(), BS );
+    TEST_EQUALITY( (PetscInt)tpetraA.getGlobalNumRows(), N );
+
+    // The point rows match MatGetRow
+    const size_t maxEntries = tpetraA.getNodeMaxNumRowEntries();
+    Array<LO> indices(maxEntries);
+    Array<Scalar> values(maxEntries);
+    RCP<const Tpetra::Map<LO,GO,Node> > colMap = tpetraA.getColMap();
+    for (Ii=Istart; Ii<Iend; Ii++) {
+      size_t numEntries;
+      PetscInt ncols;
+      const PetscInt * cols;
+      const PetscScalar * vals;
+      tpetraA.getLocalRowCopy(Ii-Istart, indices(), values(), numEntries);
+      ierr = MatGetRow(A,Ii,&ncols,&cols,&vals);CHKERRV(ierr);
+      TEST_EQUALITY( (PetscInt)numEntries, ncols );
+      for (PetscInt k=0; k<ncols && k<(PetscInt)numEntries; k++) {
+        TEST_EQUALITY( colMap->getGlobalElement(indices[k]), cols[k] );
+        TEST_EQUALITY( values[k], vals[k] );
+      }
+      ierr = MatRestoreRow(A,Ii,&ncols,&cols,&vals);CHKERRV(ierr);
+    }
+
+    // A batched copy of all rows matches the rows one at a time
+    {
+      const LO numRows = Iend-Istart;
+      Array<size_t> rowptr;
+      Array<LO> cols;
+      Array<Scalar> vals;
+      xSDKTrilinos::getLocalRowsCopy<Scalar,LO,GO,Node>(tpetraA,0,numRows,rowptr,cols,vals);
+      TEST_EQUALITY( rowptr.size(), numRows+1 );
+      for (LO lrow=0; lrow < numRows; lrow++) {
+        size_t numEntries;
+        tpetraA.getLocalRowCopy(lrow, indices(), values(), numEntries);
+        TEST_EQUALITY( rowptr[lrow+1]-rowptr[lrow], numEntries );
+        for (size_t k=0; k<numEntries && rowptr[lrow]+k<rowptr[lrow+1]; k++) {
+          TEST_EQUALITY( cols[rowptr[lrow]+k], indices[k] );
+          TEST_EQUALITY( vals[rowptr[lrow]+k], values[k] );
+        }
+      }
+    }
+
+    // apply, and the BlockCrsMatrix copy, agree with MatMult
+    MV X(tpetraA.getDomainMap(), 1), Y(tpetraA.getRangeMap(), 1), Yblock(tpetraA.getRangeMap(), 1);
+    X.putScalar(1.0);
+    tpetraA.apply(X,Y);
+    RCP<Tpetra::Experimental::BlockCrsMatrix<Scalar,LO,GO,Node> > blockA =
+      xSDKTrilinos::deepCopyPETScBAIJMatrixToTpetraBlockCrsMatrix<Scalar,LO,GO,Node>(A);
+    TEST_EQUALITY( blockA->getBlockSize(), BS );
+    TEST_EQUALITY( (PetscInt)blockA->getGlobalNumRows(), N/BS );
+    blockA->apply(X,Yblock);
+
+    Vec x, y;
+    ierr = MatCreateVecs(A,&x,&y);CHKERRV(ierr);
+    ierr = VecSet(x,1.0);CHKERRV(ierr);
+    ierr = MatMult(A,x,y);CHKERRV(ierr);
+    {
+      const PetscScalar * yPETSc;
+      ArrayRCP<const Scalar> yTpetra = Y.get1dView(), yBlock = Yblock.get1dView();
+      ierr = VecGetArrayRead(y,&yPETSc);CHKERRV(ierr);
+      for (Ii=0; Ii<Iend-Istart; Ii++) {
+        TEST_FLOATING_EQUALITY( yTpetra[Ii], yPETSc[Ii], 1e-14 );
+        TEST_FLOATING_EQUALITY( yBlock[Ii], yPETSc[Ii], 1e-14 );
+      }
+      ierr = VecRestoreArrayRead(y,&yPETSc);CHKERRV(ierr);
+    }
+
+    // Matrices whose point rows are not available are rejected in every build
+    typedef PETScAIJMatrix<Scalar,LO,GO,Node> MAT;
+    Mat S;
+    ierr = MatCreate(PETSC_COMM_WORLD,&S);CHKERRV(ierr);
+    ierr = MatSetSizes(S,TWO*BS,TWO*BS,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRV(ierr);
+    ierr = MatSetType(S, MATSBAIJ);CHKERRV(ierr);
+    ierr = MatSetUp(S);CHKERRV(ierr);
+    ierr = MatAssemblyBegin(S,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+    ierr = MatAssemblyEnd(S,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+    TEST_THROW( rcp(new MAT(S)), std::invalid_argument );
+
+    ierr = MatDestroy(&S);CHKERRV(ierr);
+    ierr = VecDestroy(&x);CHKERRV(ierr);
+    ierr = VecDestroy(&y);CHKERRV(ierr);
+    ierr = MatDestroy(&A);CHKERRV(ierr);
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( PETScOperator, ShellAndMFFD, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef int LO;
+    typedef Tpetra::MultiVector<Scalar,LO,GO,Node> MV;
+    typedef Tpetra::PETScOperator<Scalar,LO,GO,Node> OP;
+    const PetscInt THREE = 3;
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // A shell matrix applying diag(1,2,...,N), with the same transpose
+    Mat A;
+    ierr = MatCreateShell(PETSC_COMM_WORLD,THREE,THREE,PETSC_DETERMINE,PETSC_DETERMINE,NULL,&A);CHKERRV(ierr);
+    ierr = MatShellSetOperation(A,MATOP_MULT,(void(*)(void))diagonalShellMult);CHKERRV(ierr);
+
+    RCP<OP> op = rcp(new OP(A));
+    ierr = MatDestroy(&A);CHKERRV(ierr); // the operator keeps its own reference
+    TEST_EQUALITY( op->hasTransposeApply(), false );
+    TEST_EQUALITY( op->getDomainMap()->getNodeNumElements(), (size_t)THREE );
+    TEST_EQUALITY( op->getRangeMap()->isSameAs(*op->getDomainMap()), true );
+
+    // Y = 2*A*X - Y, column by column, repeated to reuse the pooled Vecs
+    MV X(op->getDomainMap(), 3), Y(op->getRangeMap(), 3), Y0(op->getRangeMap(), 3);
+    X.randomize();
+    Y0.randomize();
+    const PetscInt start = op->getRangeMap()->getMinGlobalIndex();
+    for (int rep=0; rep<2; rep++) {
+      Tpetra::deep_copy(Y, Y0);
+      op->apply(X,Y,Teuchos::NO_TRANS,2.0,-1.0);
+      for (size_t c=0; c<3; c++) {
+        ArrayRCP<const Scalar> x = X.getData(c), y = Y.getData(c), y0 = Y0.getData(c);
+        for (LO i=0; i<THREE; i++) {
+          TEST_FLOATING_EQUALITY( y[i], 2.0*(1.0 + start + i)*x[i] - y0[i], 1e-14 );
+        }
+      }
+    }
+
+    // A matrix-free Jacobian of F(x) = 3*x
+    Mat J;
+    Vec u;
+    ierr = MatCreateMFFD(PETSC_COMM_WORLD,THREE,THREE,PETSC_DETERMINE,PETSC_DETERMINE,&J);CHKERRV(ierr);
+    ierr = MatMFFDSetFunction(J,tripleFunction,NULL);CHKERRV(ierr);
+    ierr = MatCreateVecs(J,&u,NULL);CHKERRV(ierr);
+    ierr = VecSet(u,1.0);CHKERRV(ierr);
+    ierr = MatMFFDSetBase(J,u,NULL);CHKERRV(ierr);
+    ierr = MatAssemblyBegin(J,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+    ierr = MatAssemblyEnd(J,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+
+    OP jacobian(J);
+    jacobian.apply(X,Y);
+    for (size_t c=0; c<3; c++) {
+      ArrayRCP<const Scalar> x = X.getData(c), y = Y.getData(c);
+      for (LO i=0; i<THREE; i++) {
+        TEST_FLOATING_EQUALITY( y[i], 3.0*x[i], 1e-6 );
+      }
+    }
+
+    ierr = VecDestroy(&u);CHKERRV(ierr);
+    ierr = MatDestroy(&J);CHKERRV(ierr);
+    op = Teuchos::null;
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( BelosPETScAdapter, MVOPTester, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef Belos::PETScMultiVec MV;
+    typedef Belos::MultiVecTraits<Scalar,MV> MVT;
+    typedef Teuchos::ScalarTraits<Scalar>::magnitudeType Magnitude;
+    const PetscInt TEN = 10;
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // A diagonally dominant tridiagonal matrix
+    Mat A;
+    PetscInt rstart, rend, N;
+    ierr = MatCreateAIJ(PETSC_COMM_WORLD,TEN,TEN,PETSC_DETERMINE,PETSC_DETERMINE,3,NULL,2,NULL,&A);CHKERRV(ierr);
+    ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRV(ierr);
+    ierr = MatGetSize(A,&N,NULL);CHKERRV(ierr);
+    for(PetscInt i=rstart; i<rend; i++) {
+      if(i > 0) { ierr = MatSetValue(A,i,i-1,-1.0,INSERT_VALUES);CHKERRV(ierr); }
+      ierr = MatSetValue(A,i,i,4.0,INSERT_VALUES);CHKERRV(ierr);
+      if(i < N-1) { ierr = MatSetValue(A,i,i+1,-1.0,INSERT_VALUES);CHKERRV(ierr); }
+    }
+    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+
+    Vec b, x;
+    ierr = MatCreateVecs(A,&x,&b);CHKERRV(ierr);
+
+    // The generic checks Belos runs on every adapter
+    RCP<Belos::OutputManager<Scalar> > om = rcp(new Belos::OutputManager<Scalar>(Belos::Errors, Teuchos::rcpFromRef(out)));
+    RCP<MV> ivec = MVT::Clone(MV(b), 4);
+    TEST_EQUALITY( MVT::HasConstantStride(*ivec), true );
+    TEST_EQUALITY( Belos::TestMultiVecTraits<Scalar,MV>(om,ivec), true );
+    TEST_EQUALITY( (Belos::TestOperatorTraits<Scalar,MV,Mat>(om,ivec,Teuchos::rcpFromRef(A))), true );
+
+    // Updating columns from a view that shares some of them uses their old values
+    {
+      std::vector<int> first(2), last(2);
+      first[0] = 0; first[1] = 1;
+      last[0] = 1; last[1] = 2;
+      MVT::MvRandom(*ivec);
+      RCP<MV> Y = MVT::CloneViewNonConst(*ivec, first);
+      RCP<const MV> Z = MVT::CloneView(*ivec, last);
+      RCP<MV> expected = MVT::CloneCopy(*ivec, first);
+      Teuchos::SerialDenseMatrix<int,Scalar> C(2,2);
+      C.random();
+      MVT::MvTimesMatAddMv(2.0, *MVT::CloneCopy(*ivec, last), C, 0.5, *expected);
+      MVT::MvTimesMatAddMv(2.0, *Z, C, 0.5, *Y);
+      MVT::MvAddMv(1.0, *Y, -1.0, *expected, *expected);
+      std::vector<Magnitude> norms(2);
+      MVT::MvNorm(*expected, norms);
+      TEST_COMPARE( norms[0], <=, 1e-12 );
+      TEST_COMPARE( norms[1], <=, 1e-12 );
+    }
+
+    // Solve A*x = b with GMRES without leaving PETSc
+    ierr = VecSet(b,1.0);CHKERRV(ierr);
+    ierr = VecSet(x,0.0);CHKERRV(ierr);
+    RCP<MV> X = rcp(new MV(x)), B = rcp(new MV(b));
+    RCP<Belos::LinearProblem<Scalar,MV,Mat> > problem =
+      rcp(new Belos::LinearProblem<Scalar,MV,Mat>(Teuchos::rcpFromRef(A),X,B));
+    TEST_EQUALITY( problem->setProblem(), true );
+    RCP<Teuchos::ParameterList> params = Teuchos::parameterList();
+    params->set("Convergence Tolerance", 1e-10);
+    Belos::BlockGmresSolMgr<Scalar,MV,Mat> solver(problem,params);
+    TEST_EQUALITY( solver.solve(), Belos::Converged );
+
+    // The solution was written into x itself
+    Vec r;
+    Magnitude rnorm, bnorm;
+    ierr = VecDuplicate(b,&r);CHKERRV(ierr);
+    ierr = MatMult(A,x,r);CHKERRV(ierr);
+    ierr = VecAYPX(r,-1.0,b);CHKERRV(ierr);
+    ierr = VecNorm(r,NORM_2,&rnorm);CHKERRV(ierr);
+    ierr = VecNorm(b,NORM_2,&bnorm);CHKERRV(ierr);
+    TEST_COMPARE( rnorm, <=, 1e-8*bnorm );
+
+    solver.reset(Belos::Problem);
+    problem = Teuchos::null;
+    X = Teuchos::null;
+    B = Teuchos::null;
+    ivec = Teuchos::null;
+    ierr = VecDestroy(&r);CHKERRV(ierr);
+    ierr = VecDestroy(&x);CHKERRV(ierr);
+    ierr = VecDestroy(&b);CHKERRV(ierr);
+    ierr = MatDestroy(&A);CHKERRV(ierr);
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+
+#ifdef HAVE_XSDKTRILINOS_ANASAZI
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( AnasaziPETScAdapter, BlockKrylovSchur, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef Belos::PETScMultiVec MV;
+    typedef Anasazi::MultiVecTraits<Scalar,MV> MVT;
+    typedef Anasazi::BasicEigenproblem<Scalar,MV,Mat> Problem;
+    const PetscInt TWENTY = 20;
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // tridiag(-1,2,-1), whose eigenvalues are 2-2*cos(k*pi/(N+1))
+    Mat A;
+    PetscInt rstart, rend, N;
+    ierr = MatCreateAIJ(PETSC_COMM_WORLD,TWENTY,TWENTY,PETSC_DETERMINE,PETSC_DETERMINE,3,NULL,2,NULL,&A);CHKERRV(ierr);
+    ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRV(ierr);
+    ierr = MatGetSize(A,&N,NULL);CHKERRV(ierr);
+    for(PetscInt i=rstart; i<rend; i++) {
+      if(i > 0) { ierr = MatSetValue(A,i,i-1,-1.0,INSERT_VALUES);CHKERRV(ierr); }
+      ierr = MatSetValue(A,i,i,2.0,INSERT_VALUES);CHKERRV(ierr);
+      if(i < N-1) { ierr = MatSetValue(A,i,i+1,-1.0,INSERT_VALUES);CHKERRV(ierr); }
+    }
+    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+
+    Vec v;
+    ierr = MatCreateVecs(A,&v,NULL);CHKERRV(ierr);
+
+    // The generic checks Anasazi runs on every adapter
+    RCP<Anasazi::OutputManager<Scalar> > om = rcp(new Anasazi::BasicOutputManager<Scalar>(Anasazi::Errors, Teuchos::rcpFromRef(out)));
+    RCP<MV> ivec = MVT::Clone(MV(v), 2);
+    MVT::MvRandom(*ivec);
+    TEST_EQUALITY( Anasazi::TestMultiVecTraits<Scalar,MV>(om,ivec), true );
+    TEST_EQUALITY( (Anasazi::TestOperatorTraits<Scalar,MV,Mat>(om,ivec,Teuchos::rcpFromRef(A))), true );
+
+    // The three largest eigenvalues
+    const int nev = 3;
+    RCP<Problem> problem = rcp(new Problem(Teuchos::rcpFromRef(A),ivec));
+    problem->setHermitian(true);
+    problem->setNEV(nev);
+    TEST_EQUALITY( problem->setProblem(), true );
+    Teuchos::ParameterList pl;
+    pl.set("Which", "LM");
+    pl.set("Block Size", 2);
+    pl.set("Num Blocks", 8);
+    pl.set("Maximum Restarts", 500);
+    pl.set("Convergence Tolerance", 1e-10);
+    Anasazi::BlockKrylovSchurSolMgr<Scalar,MV,Mat> solver(problem,pl);
+    TEST_EQUALITY( solver.solve(), Anasazi::Converged );
+
+    Anasazi::Eigensolution<Scalar,MV> sol = problem->getSolution();
+    TEST_COMPARE( sol.numVecs, >=, nev );
+    std::vector<double> evals;
+    for(int i=0; i<sol.numVecs; i++)
+      evals.push_back(sol.Evals[i].realpart);
+    std::sort(evals.begin(), evals.end());
+    std::reverse(evals.begin(), evals.end());
+    const double pi = 4.0*std::atan(1.0);
+    for(int k=0; k<nev; k++) {
+      TEST_FLOATING_EQUALITY( evals[k], 2.0 + 2.0*std::cos((k+1)*pi/(N+1)), 1e-8 );
+    }
+
+    problem = Teuchos::null;
+    ivec = Teuchos::null;
+    sol = Anasazi::Eigensolution<Scalar,MV>();
+    ierr = VecDestroy(&v);CHKERRV(ierr);
+    ierr = MatDestroy(&A);CHKERRV(ierr);
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+
+#  define ANASAZI_UNIT_TEST_GROUP( NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( AnasaziPETScAdapter, BlockKrylovSchur, PetscInt, NODE )
+#else
+#  define ANASAZI_UNIT_TEST_GROUP( NODE )
+#endif
+
+#if PETSC_VERSION_GE(3,11,0)
+  TEUCHOS_UNIT_TEST_TEMPLATE_2_DECL( PETScAIJMatrix, SELLApply, GO, Node )
+  {
+    typedef PetscScalar Scalar;
+    typedef int LO;
+    typedef Tpetra::MultiVector<Scalar,LO,GO,Node> MV;
+    const PetscInt TEN = 10;
+    PetscErrorCode ierr;
+
+    int argc = 0;
+    char ** argv;
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRV(ierr);
+
+    // A tridiagonal matrix with some longer rows, so that the SELL slices need padding
+    Mat A;
+    PetscInt Istart, Iend, Ii, J, N;
+    PetscScalar v;
+    ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRV(ierr);
+    ierr = MatSetSizes(A,TEN,TEN,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRV(ierr);
+    ierr = MatSetType(A, MATAIJ);CHKERRV(ierr);
+    ierr = MatMPIAIJSetPreallocation(A,5,NULL,5,NULL);CHKERRV(ierr);
+    ierr = MatSeqAIJSetPreallocation(A,5,NULL);CHKERRV(ierr);
+    ierr = MatSetUp(A);CHKERRV(ierr);
+    ierr = MatGetSize(A,&N,NULL);CHKERRV(ierr);
+    ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRV(ierr);
+    for (Ii=Istart; Ii<Iend; Ii++) {
+      v = 4.0 + Ii; ierr = MatSetValues(A,1,&Ii,1,&Ii,&v,INSERT_VALUES);CHKERRV(ierr);
+      if (Ii > 0)   {J = Ii - 1; v = -1.0; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+      if (Ii < N-1) {J = Ii + 1; v = -1.0; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+      if (Ii % 3 == 0) {J = (Ii + N/2) % N; v = 0.5; ierr = MatSetValues(A,1,&Ii,1,&J,&v,INSERT_VALUES);CHKERRV(ierr);}
+    }
+    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRV(ierr);
+
+    PETScAIJMatrix<Scalar,LO,GO,Node> tpetraA(A);
+    MV X(tpetraA.getDomainMap(), 3), Yaij(tpetraA.getRangeMap(), 3), Ysell(tpetraA.getRangeMap(), 3);
+    Array<PetscReal> norms(3);
+    X.randomize();
+    Yaij.randomize();
+    Tpetra::deep_copy(Ysell, Yaij);
+
+    // The SELL copy gives the same result as AIJ
+    tpetraA.apply(X,Yaij,Teuchos::NO_TRANS,2.0,0.5);
+    tpetraA.setApplyWithSELL(true);
+    TEST_EQUALITY( tpetraA.getApplyWithSELL(), true );
+    tpetraA.apply(X,Ysell,Teuchos::NO_TRANS,2.0,0.5);
+    Ysell.update(-1.0, Yaij, 1.0);
+    Ysell.normInf(norms());
+    for (int c=0; c<3; c++) {
+      TEST_COMPARE( norms[c], <=, 1e-12 );
+    }
+
+    // Changing the matrix converts it again
+    ierr = MatScale(A,3.0);CHKERRV(ierr);
+    tpetraA.apply(X,Ysell);
+    tpetraA.setApplyWithSELL(false);
+    tpetraA.apply(X,Yaij);
+    Ysell.update(-1.0, Yaij, 1.0);
+    Ysell.normInf(norms());
+    for (int c=0; c<3; c++) {
+      TEST_COMPARE( norms[c], <=, 1e-12 );
+    }
+
+    ierr = MatDestroy(&A);CHKERRV(ierr);
+    ierr = PetscFinalize();CHKERRV(ierr);
+  }
+#endif
+
 //
 // INSTANTIATIONS
 //
 
+#if PETSC_VERSION_GE(3,11,0)
+#define SELL_UNIT_TEST_GROUP( NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, SELLApply,         PetscInt, NODE )
+#else
+#define SELL_UNIT_TEST_GROUP( NODE )
+#endif
+
 #define UNIT_TEST_GROUP( NODE ) \
       TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, TheEyeOfTruth,     PetscInt, NODE ) \
       TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, ZeroMatrix,        PetscInt, NODE ) \
@@ -825,7 +2095,22 @@ inline void tupleToArray(Array<T> &arr, const tuple &tup)
       TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, FullMatrixTriDiag, PetscInt, NODE ) \
       TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, CopiesAndViews,    PetscInt, NODE ) \
       TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, AlphaBetaMultiply, PetscInt, NODE ) \
-      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, Typedefs,          PetscInt, NODE )
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, Typedefs,          PetscInt, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, ShellPC,           PetscInt, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, DeepCopy,          PetscInt, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, CreatePETScMat,    PetscInt, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, VectorViews,       PetscInt, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, LoadMatrix,        PetscInt, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, MultiVectorApply,  PetscInt, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, LocalRowCopy,      PetscInt, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, DiagonalCache,     PetscInt, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, Equilibration,     PetscInt, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, NormCache,         PetscInt, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScAIJMatrix, BlockMatrix,       PetscInt, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( PETScOperator,  ShellAndMFFD,      PetscInt, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_2_INSTANT( BelosPETScAdapter, MVOPTester,     PetscInt, NODE ) \
+      ANASAZI_UNIT_TEST_GROUP( NODE ) \
+      SELL_UNIT_TEST_GROUP( NODE )
 
 
   TPETRA_ETI_MANGLING_TYPEDEFS()
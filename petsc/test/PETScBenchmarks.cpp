@@ -0,0 +1,430 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+//
+// This driver times the PETSc wrappers on the 2D or 3D Laplace operator
+// and writes the results as JSON, so that performance regressions show
+// up next to the unit tests.
+//
+#include "BelosConfigDefs.hpp"
+#include "BelosLinearProblem.hpp"
+#include "BelosTpetraAdapter.hpp"
+#include "BelosPETScSolMgr.hpp"
+
+#include "Teuchos_CommandLineProcessor.hpp"
+#include "Teuchos_ParameterList.hpp"
+#include "Teuchos_StandardCatchMacros.hpp"
+#include "Teuchos_Time.hpp"
+#include "Teuchos_toString.hpp"
+
+#include "Tpetra_CrsMatrix.hpp"
+#include "Tpetra_DefaultPlatform.hpp"
+#include "Tpetra_MultiVector.hpp"
+#include "Tpetra_PETScAIJEquilibration.hpp"
+#include "Tpetra_PETScAIJMatrix.hpp"
+
+#include <petscksp.h>
+#include <petscversion.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The times of the repetitions of one benchmark, each the slowest over all processes
+struct BenchmarkResult {
+  std::string name;
+  std::vector<double> seconds;
+};
+
+template<class Body>
+BenchmarkResult runBenchmark(const std::string& name, const Teuchos::Comm<int>& comm, int repetitions, Body body)
+{
+  BenchmarkResult result;
+  result.name = name;
+  body(); // warm up
+  for(int rep = 0; rep < repetitions; rep++) {
+    comm.barrier();
+    Teuchos::Time timer(name);
+    timer.start(true);
+    body();
+    double local = timer.stop(), global;
+    Teuchos::reduceAll(comm, Teuchos::REDUCE_MAX, 1, &local, &global);
+    result.seconds.push_back(global);
+  }
+  return result;
+}
+
+// The number of iterations a solver needed on one variant of the problem
+struct IterationResult {
+  std::string name;
+  PetscInt iterations;
+};
+
+// The widest x86 SIMD instruction set this driver was compiled for.  PETSc's SELL kernels are chosen
+// the same way when PETSc is built, so runs of builds for different widths can be compared.
+const char* simdInstructionSet()
+{
+#if defined(__AVX512F__)
+  return "AVX-512";
+#elif defined(__AVX2__)
+  return "AVX2";
+#elif defined(__AVX__)
+  return "AVX";
+#elif defined(__SSE2__)
+  return "SSE2";
+#else
+  return "none";
+#endif
+}
+
+void writeJSON(std::ostream& out, const std::string& problem, int numProcs, PetscInt numRows,
+               const std::vector<BenchmarkResult>& results, const std::vector<IterationResult>& iterations)
+{
+  out << "{\n  \"benchmark\": \"PETScBenchmarks\",\n"
+      << "  \"problem\": \"" << problem << "\",\n"
+      << "  \"simd\": \"" << simdInstructionSet() << "\",\n"
+      << "  \"num_procs\": " << numProcs << ",\n"
+      << "  \"num_rows\": " << numRows << ",\n"
+      << "  \"results\": [\n";
+  for(size_t i = 0; i < results.size(); i++) {
+    const std::vector<double>& t = results[i].seconds;
+    double sum = 0;
+    for(size_t j = 0; j < t.size(); j++) sum += t[j];
+    out << "    {\"name\": \"" << results[i].name << "\", \"repetitions\": " << t.size()
+        << ", \"min_seconds\": " << *std::min_element(t.begin(), t.end())
+        << ", \"mean_seconds\": " << sum / t.size()
+        << ", \"max_seconds\": " << *std::max_element(t.begin(), t.end()) << "}"
+        << (i+1 < results.size() ? ",\n" : "\n");
+  }
+  out << "  ],\n  \"iterations\": [\n";
+  for(size_t i = 0; i < iterations.size(); i++) {
+    out << "    {\"name\": \"" << iterations[i].name << "\", \"iterations\": " << iterations[i].iterations << "}"
+        << (i+1 < iterations.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+}
+
+// Creates the 5-point (nz == 1) or 7-point Laplace operator on an nx by ny by nz grid
+PetscErrorCode createLaplacian(PetscInt nx, PetscInt ny, PetscInt nz, Mat* A)
+{
+  PetscErrorCode ierr;
+  const PetscInt N = nx*ny*nz;
+  PetscInt Istart, Iend;
+  ierr = MatCreate(PETSC_COMM_WORLD,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,PETSC_DECIDE,PETSC_DECIDE,N,N);CHKERRQ(ierr);
+  ierr = MatSetType(*A,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(*A,7,NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(*A,7,NULL,4,NULL);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(*A,&Istart,&Iend);CHKERRQ(ierr);
+  for(PetscInt row = Istart; row < Iend; row++) {
+    const PetscInt i = row % nx, j = (row / nx) % ny, k = row / (nx*ny);
+    PetscInt cols[7];
+    PetscScalar vals[7];
+    PetscInt n = 0;
+    if(k > 0)    { cols[n] = row - nx*ny; vals[n++] = -1.0; }
+    if(j > 0)    { cols[n] = row - nx;    vals[n++] = -1.0; }
+    if(i > 0)    { cols[n] = row - 1;     vals[n++] = -1.0; }
+    cols[n] = row; vals[n++] = (nz > 1 ? 6.0 : 4.0);
+    if(i < nx-1) { cols[n] = row + 1;     vals[n++] = -1.0; }
+    if(j < ny-1) { cols[n] = row + nx;    vals[n++] = -1.0; }
+    if(k < nz-1) { cols[n] = row + nx*ny; vals[n++] = -1.0; }
+    ierr = MatSetValues(*A,1,&row,n,cols,vals,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(*A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(*A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  return 0;
+}
+
+// Scales row i of A by 10^(i%4) and column j by 10^(-(j%3)), so that the scaling hides the Laplacian
+PetscErrorCode badlyScale(Mat A)
+{
+  PetscErrorCode ierr;
+  Vec left, right;
+  PetscInt start, end;
+  ierr = MatCreateVecs(A,&right,&left);CHKERRQ(ierr);
+  ierr = VecGetOwnershipRange(left,&start,&end);CHKERRQ(ierr);
+  for(PetscInt i = start; i < end; i++) {
+    ierr = VecSetValue(left,i,PetscPowReal(10.0,i%4),INSERT_VALUES);CHKERRQ(ierr);
+    ierr = VecSetValue(right,i,PetscPowReal(10.0,-(i%3)),INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = VecAssemblyBegin(left);CHKERRQ(ierr);
+  ierr = VecAssemblyEnd(left);CHKERRQ(ierr);
+  ierr = VecAssemblyBegin(right);CHKERRQ(ierr);
+  ierr = VecAssemblyEnd(right);CHKERRQ(ierr);
+  ierr = MatDiagonalScale(A,left,right);CHKERRQ(ierr);
+  ierr = VecDestroy(&left);CHKERRQ(ierr);
+  ierr = VecDestroy(&right);CHKERRQ(ierr);
+  return 0;
+}
+
+// The number of unpreconditioned GMRES iterations needed to reduce the residual of A x = b by 1e-8
+PetscErrorCode countIterations(Mat A, Vec b, PetscInt maxIters, PetscInt* iterations)
+{
+  PetscErrorCode ierr;
+  Vec x;
+  KSP ksp;
+  PC pc;
+  ierr = VecDuplicate(b,&x);CHKERRQ(ierr);
+  ierr = KSPCreate(PETSC_COMM_WORLD,&ksp);CHKERRQ(ierr);
+  ierr = KSPSetType(ksp,KSPGMRES);CHKERRQ(ierr);
+  ierr = KSPGetPC(ksp,&pc);CHKERRQ(ierr);
+  ierr = PCSetType(pc,PCNONE);CHKERRQ(ierr);
+  ierr = KSPSetTolerances(ksp,1e-8,PETSC_DEFAULT,PETSC_DEFAULT,maxIters);CHKERRQ(ierr);
+  ierr = KSPSetOperators(ksp,A,A);CHKERRQ(ierr);
+  ierr = KSPSolve(ksp,b,x);CHKERRQ(ierr);
+  ierr = KSPGetIterationNumber(ksp,iterations);CHKERRQ(ierr);
+  ierr = KSPDestroy(&ksp);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  typedef PetscScalar                              Scalar;
+  typedef int                                      LO;
+  typedef PetscInt                                 GO;
+  typedef Tpetra::Map<>::node_type                 Node;
+  typedef Tpetra::MultiVector<Scalar,LO,GO,Node>   MV;
+  typedef Tpetra::Operator<Scalar,LO,GO,Node>      OP;
+  typedef Tpetra::CrsMatrix<Scalar,LO,GO,Node>     CrsMatrix;
+  typedef Tpetra::PETScAIJMatrix<Scalar,LO,GO,Node> PETScAIJMatrix;
+  typedef Tpetra::PETScAIJEquilibration<Scalar,LO,GO,Node> PETScAIJEquilibration;
+
+  using Teuchos::ParameterList;
+  using Teuchos::RCP;
+  using Teuchos::rcp;
+
+  Teuchos::oblackholestream blackhole;
+  Teuchos::GlobalMPISession mpiSession(&argc,&argv,&blackhole);
+  RCP<const Teuchos::Comm<int> > comm = Tpetra::DefaultPlatform::getDefaultPlatform().getComm();
+
+  //
+  // Get parameters from command-line processor
+  //
+  int nx = 100, ny = -1, nz = 1;
+  int repetitions = 5;
+  int maxVecs = 32;
+  int solverIters = 20;
+  int maxGmresIters = 10000;
+  std::string jsonFile("PETScBenchmarks.json");
+  Teuchos::CommandLineProcessor cmdp(false,true);
+  cmdp.setOption("nx",&nx,"Number of grid points in x direction.");
+  cmdp.setOption("ny",&ny,"Number of grid points in y direction (default nx).");
+  cmdp.setOption("nz",&nz,"Number of grid points in z direction; 1 gives the 2D Laplacian.");
+  cmdp.setOption("repetitions",&repetitions,"Number of timed repetitions of each benchmark.");
+  cmdp.setOption("max-vecs",&maxVecs,"Largest number of vectors passed to apply.");
+  cmdp.setOption("solver-iters",&solverIters,"Number of iterations of each solve.");
+  cmdp.setOption("max-gmres-iters",&maxGmresIters,"Largest number of GMRES iterations when counting iterations.");
+  cmdp.setOption("json",&jsonFile,"File the results are written to.");
+  if(cmdp.parse(argc,argv) != Teuchos::CommandLineProcessor::PARSE_SUCCESSFUL) {
+    return -1;
+  }
+  if(ny < 0) ny = nx;
+
+  bool success = false;
+  try {
+    PetscErrorCode ierr;
+#ifdef HAVE_MPI
+    PETSC_COMM_WORLD = *(Teuchos::rcp_dynamic_cast<const Teuchos::MpiComm<int> >(comm)->getRawMpiComm());
+#endif
+    ierr = PetscInitialize(&argc,&argv,NULL,NULL);CHKERRQ(ierr);
+
+    Mat A;
+    ierr = createLaplacian(nx,ny,nz,&A);CHKERRQ(ierr);
+    std::vector<BenchmarkResult> results;
+
+    //
+    // Conversions between PETSc and Tpetra
+    //
+    RCP<CrsMatrix> tpetraA;
+    results.push_back(runBenchmark("deepCopyPETScAIJMatrixToTpetraCrsMatrix", *comm, repetitions, [&]() {
+      tpetraA = xSDKTrilinos::deepCopyPETScAIJMatrixToTpetraCrsMatrix<Scalar,LO,GO,Node>(A);
+    }));
+    results.push_back(runBenchmark("createPETScMatFromTpetraCrsMatrix", *comm, repetitions, [&]() {
+      Mat B;
+      xSDKTrilinos::createPETScMatFromTpetraCrsMatrix<Scalar,LO,GO,Node>(tpetraA,&B);
+      MatDestroy(&B);
+    }));
+
+    //
+    // PETScAIJMatrix
+    //
+    RCP<PETScAIJMatrix> wrappedA = rcp(new PETScAIJMatrix(A));
+    for(int numVecs = 1; numVecs <= maxVecs; numVecs *= 2) {
+      MV X(wrappedA->getDomainMap(),numVecs,false), Y(wrappedA->getRangeMap(),numVecs,false);
+      X.randomize();
+      results.push_back(runBenchmark("PETScAIJMatrix::apply/" + Teuchos::toString(numVecs), *comm, repetitions, [&]() {
+        wrappedA->apply(X,Y);
+      }));
+    }
+#if PETSC_VERSION_GE(3,11,0)
+    // The same products through the SELL-C-sigma copy, which the warm-up run converts
+    wrappedA->setApplyWithSELL(true);
+    for(int numVecs = 1; numVecs <= maxVecs; numVecs *= 2) {
+      MV X(wrappedA->getDomainMap(),numVecs,false), Y(wrappedA->getRangeMap(),numVecs,false);
+      X.randomize();
+      results.push_back(runBenchmark("PETScAIJMatrix::apply/SELL/" + Teuchos::toString(numVecs), *comm, repetitions, [&]() {
+        wrappedA->apply(X,Y);
+      }));
+    }
+    wrappedA->setApplyWithSELL(false);
+#endif
+    {
+      const size_t maxEntries = wrappedA->getNodeMaxNumRowEntries();
+      Teuchos::Array<LO> indices(maxEntries);
+      Teuchos::Array<Scalar> values(maxEntries);
+      const LO numLocalRows = wrappedA->getNodeNumRows();
+      results.push_back(runBenchmark("PETScAIJMatrix::getLocalRowCopy", *comm, repetitions, [&]() {
+        size_t numEntries;
+        for(LO i = 0; i < numLocalRows; i++)
+          wrappedA->getLocalRowCopy(i,indices(),values(),numEntries);
+      }));
+    }
+
+    //
+    // PETScSolMgr against calling KSPSolve on the same operator directly
+    //
+    {
+      Vec x, b;
+      KSP ksp;
+      PC pc;
+      ierr = MatCreateVecs(A,&x,&b);CHKERRQ(ierr);
+      ierr = VecSet(b,1.0);CHKERRQ(ierr);
+      ierr = KSPCreate(PETSC_COMM_WORLD,&ksp);CHKERRQ(ierr);
+      ierr = KSPSetType(ksp,KSPCG);CHKERRQ(ierr);
+      ierr = KSPGetPC(ksp,&pc);CHKERRQ(ierr);
+      ierr = PCSetType(pc,PCNONE);CHKERRQ(ierr);
+      ierr = KSPSetTolerances(ksp,0.0,PETSC_DEFAULT,PETSC_DEFAULT,solverIters);CHKERRQ(ierr);
+      ierr = KSPSetOperators(ksp,A,A);CHKERRQ(ierr);
+      results.push_back(runBenchmark("KSPSolve", *comm, repetitions, [&]() {
+        VecSet(x,0.0);
+        KSPSolve(ksp,b,x);
+      }));
+      ierr = KSPDestroy(&ksp);CHKERRQ(ierr);
+      ierr = VecDestroy(&x);CHKERRQ(ierr);
+      ierr = VecDestroy(&b);CHKERRQ(ierr);
+
+      RCP<MV> X = rcp(new MV(tpetraA->getDomainMap(),1));
+      RCP<MV> B = rcp(new MV(tpetraA->getRangeMap(),1,false));
+      B->putScalar(1.0);
+      ParameterList belosList;
+      belosList.set("Solver","cg");
+      belosList.set("Maximum Iterations",solverIters);
+      belosList.set("Convergence Tolerance",0.0);
+      RCP<Belos::LinearProblem<Scalar,MV,OP> > problem
+        = rcp(new Belos::LinearProblem<Scalar,MV,OP>(tpetraA,X,B));
+      problem->setProblem();
+      Belos::PETScSolMgr<Scalar,MV,OP> solver(problem,rcp(&belosList,false));
+      results.push_back(runBenchmark("PETScSolMgr::solve", *comm, repetitions, [&]() {
+        X->putScalar(0.0);
+        solver.solve();
+      }));
+    }
+
+    //
+    // GMRES iterations on a badly scaled Laplacian, before and after equilibration
+    //
+    std::vector<IterationResult> iterations;
+    {
+      Mat scaledA;
+      Vec b;
+      PetscInt its;
+      ierr = MatDuplicate(A,MAT_COPY_VALUES,&scaledA);CHKERRQ(ierr);
+      ierr = badlyScale(scaledA);CHKERRQ(ierr);
+      ierr = MatCreateVecs(scaledA,NULL,&b);CHKERRQ(ierr);
+      ierr = VecSet(b,1.0);CHKERRQ(ierr);
+      ierr = countIterations(scaledA,b,maxGmresIters,&its);CHKERRQ(ierr);
+      iterations.push_back(IterationResult{"GMRES/badly scaled", its});
+
+      const char* types[] = {"Ruiz", "max-norm"};
+      for(int t = 0; t < 2; t++) {
+        RCP<PETScAIJMatrix> wrappedScaledA = rcp(new PETScAIJMatrix(scaledA));
+        PETScAIJEquilibration equilibration(wrappedScaledA);
+        ParameterList equilibrationList;
+        equilibrationList.set("Equilibration: type", std::string(types[t]));
+        equilibration.setParameters(equilibrationList);
+        equilibration.compute();
+
+        // The right-hand side of ones becomes the row scaling itself
+        {
+          PetscScalar* bValues;
+          Teuchos::ArrayRCP<const Scalar> r = equilibration.getRowScaling()->get1dView();
+          ierr = VecGetArray(b,&bValues);CHKERRQ(ierr);
+          std::copy(r.begin(), r.end(), bValues);
+          ierr = VecRestoreArray(b,&bValues);CHKERRQ(ierr);
+        }
+        ierr = countIterations(scaledA,b,maxGmresIters,&its);CHKERRQ(ierr);
+        iterations.push_back(IterationResult{std::string("GMRES/equilibrated ") + types[t], its});
+        equilibration.unscaleMatrix();
+        ierr = VecSet(b,1.0);CHKERRQ(ierr);
+      }
+      ierr = VecDestroy(&b);CHKERRQ(ierr);
+      ierr = MatDestroy(&scaledA);CHKERRQ(ierr);
+    }
+
+    //
+    // Report the results
+    //
+    std::ostringstream problem;
+    problem << (nz > 1 ? "Laplace3D " : "Laplace2D ") << nx << "x" << ny;
+    if(nz > 1) problem << "x" << nz;
+    if(comm->getRank() == 0) {
+      std::ofstream out(jsonFile.c_str());
+      writeJSON(out,problem.str(),comm->getSize(),nx*ny*nz,results,iterations);
+      writeJSON(std::cout,problem.str(),comm->getSize(),nx*ny*nz,results,iterations);
+    }
+
+    wrappedA = Teuchos::null;
+    ierr = MatDestroy(&A);CHKERRQ(ierr);
+    ierr = PetscFinalize();CHKERRQ(ierr);
+    success = true;
+  }
+  TEUCHOS_STANDARD_CATCH_STATEMENTS(true, std::cerr, success);
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,128 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef _TPETRA_LOCALROWSCOPY_H_
+#define _TPETRA_LOCALROWSCOPY_H_
+
+#include "Tpetra_ConfigDefs.hpp"
+#include "Tpetra_RowMatrix.hpp"
+#include "Teuchos_Array.hpp"
+
+
+namespace Tpetra {
+
+//! LocalRowsCopyable: A RowMatrix that can copy a range of its local rows into CSR arrays in one call.
+
+/*! RowMatrix only offers one row per (virtual) call.  Adapters whose storage is already compressed
+    sparse rows implement this interface as well, so that conversions to other matrix formats can
+    copy whole blocks of rows at memory bandwidth.  Use xSDKTrilinos::getLocalRowsCopy(), which
+    falls back to getLocalRowCopy() for matrices that do not implement it.
+*/
+template<class Scalar = Details::DefaultTypes::scalar_type,
+         class LO = Details::DefaultTypes::local_ordinal_type,
+         class GO = Details::DefaultTypes::global_ordinal_type,
+         class Node = Details::DefaultTypes::node_type>
+class LocalRowsCopyable
+{
+public:
+  //! Destructor
+  virtual ~LocalRowsCopyable() {};
+
+  //! The offsets of the local rows [rowBegin,rowEnd) in a CSR copy of them; rowptr has rowEnd-rowBegin+1 entries.
+  virtual void getLocalRowPtrs(LO rowBegin, LO rowEnd, const Teuchos::ArrayView<size_t>& rowptr) const = 0;
+
+  //! Copy the local rows [rowBegin,rowEnd), with column Map indices, into CSR arrays laid out by getLocalRowPtrs().
+  virtual void getLocalRowsCopy(LO rowBegin, LO rowEnd, const Teuchos::ArrayView<const size_t>& rowptr,
+                                const Teuchos::ArrayView<LO>& cols, const Teuchos::ArrayView<Scalar>& vals) const = 0;
+};
+
+} // namespace Tpetra
+
+
+
+namespace xSDKTrilinos {
+
+//! Copy the local rows [rowBegin,rowEnd) of A, with column Map indices, into CSR arrays.
+/*! rowptr, cols and vals are resized as needed, so reusing them across calls avoids reallocation.
+    Matrices implementing Tpetra::LocalRowsCopyable fill the arrays in one call; any other RowMatrix
+    is copied one row at a time.
+*/
+template<class Scalar, class LO, class GO, class Node>
+void getLocalRowsCopy(const Tpetra::RowMatrix<Scalar,LO,GO,Node>& A, LO rowBegin, LO rowEnd,
+                      Teuchos::Array<size_t>& rowptr, Teuchos::Array<LO>& cols, Teuchos::Array<Scalar>& vals)
+{
+  typedef Tpetra::LocalRowsCopyable<Scalar,LO,GO,Node> Copyable;
+
+  TEUCHOS_TEST_FOR_EXCEPTION(rowBegin < 0 || rowEnd < rowBegin || rowEnd > static_cast<LO>(A.getNodeNumRows()),
+         std::invalid_argument, "xSDKTrilinos::getLocalRowsCopy(): [rowBegin,rowEnd) is not a range of local rows.");
+
+  const LO numRows = rowEnd - rowBegin;
+  const Copyable* copyable = dynamic_cast<const Copyable*>(&A);
+
+  rowptr.resize(numRows+1);
+  if(copyable != NULL) {
+    copyable->getLocalRowPtrs(rowBegin, rowEnd, rowptr());
+  }
+  else {
+    rowptr[0] = 0;
+    for(LO r = 0; r < numRows; r++)
+      rowptr[r+1] = rowptr[r] + A.getNumEntriesInLocalRow(rowBegin+r);
+  }
+
+  cols.resize(rowptr[numRows]);
+  vals.resize(rowptr[numRows]);
+  if(copyable != NULL) {
+    copyable->getLocalRowsCopy(rowBegin, rowEnd, rowptr(), cols(), vals());
+  }
+  else {
+    size_t numEntries;
+    for(LO r = 0; r < numRows; r++) {
+      const size_t len = rowptr[r+1] - rowptr[r];
+      A.getLocalRowCopy(rowBegin+r, cols(rowptr[r],len), vals(rowptr[r],len), numEntries);
+    }
+  }
+}
+
+} // namespace xSDKTrilinos
+
+#endif // _TPETRA_LOCALROWSCOPY_H_
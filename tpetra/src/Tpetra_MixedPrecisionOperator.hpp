@@ -0,0 +1,232 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef _TPETRA_MIXEDPRECISIONOPERATOR_H_
+#define _TPETRA_MIXEDPRECISIONOPERATOR_H_
+
+#include "Tpetra_ConfigDefs.hpp"
+#include "Tpetra_MultiVector.hpp"
+#include "Tpetra_Operator.hpp"
+#include <Kokkos_Core.hpp>
+
+
+namespace Tpetra {
+
+//! MixedPrecisionOperator: Applies an operator stored in a lower precision to vectors in a higher one.
+
+/*! The typical use is a single precision preconditioner inside a double precision Krylov solver:
+    the preconditioner's matrix and factors take half the memory and bandwidth, and the outer
+    iteration still converges to double precision accuracy.
+
+    apply() rounds X to LowScalar, applies the wrapped operator, and folds alpha, beta and the
+    conversion back to HighScalar into a single pass over Y.  The low precision vectors are kept
+    from one apply() to the next and only reallocated when the number of vectors changes.
+*/
+template<class HighScalar = double,
+         class LowScalar = float,
+         class LO = Details::DefaultTypes::local_ordinal_type,
+         class GO = Details::DefaultTypes::global_ordinal_type,
+         class Node = Details::DefaultTypes::node_type>
+class MixedPrecisionOperator :
+  virtual public Operator<HighScalar,LO,GO,Node>
+{
+public:
+  typedef HighScalar scalar_type;
+  typedef LO local_ordinal_type;
+  typedef GO global_ordinal_type;
+  typedef Node node_type;
+  typedef Map<LO,GO,Node> map_type;
+  typedef MultiVector<HighScalar,LO,GO,Node> MV;
+  typedef MultiVector<LowScalar,LO,GO,Node> low_MV;
+  typedef Operator<LowScalar,LO,GO,Node> low_operator_type;
+  typedef typename MV::impl_scalar_type impl_scalar_type;
+  typedef typename low_MV::impl_scalar_type low_impl_scalar_type;
+  typedef typename MV::dual_view_type::t_dev::device_type device_type;
+  typedef typename device_type::execution_space execution_space;
+
+  //! @name Constructor/Destructor Methods
+  //@{
+
+  //! Constructor
+  MixedPrecisionOperator(const Teuchos::RCP<const low_operator_type>& op);
+
+  //! Destructor
+  virtual ~MixedPrecisionOperator() {};
+
+  //@}
+
+  //! The wrapped low precision operator.
+  Teuchos::RCP<const low_operator_type> getOperator() const { return op_; };
+
+  //! @name Operator methods
+  //@{
+
+  //! The Map associated with the domain of this operator.
+  Teuchos::RCP<const map_type> getDomainMap() const { return op_->getDomainMap(); };
+
+  //! The Map associated with the range of this operator.
+  Teuchos::RCP<const map_type> getRangeMap() const { return op_->getRangeMap(); };
+
+  //! Computes Y = alpha*A*X + beta*Y, with A applied in LowScalar.
+  void apply(const MV& X,
+             MV& Y,
+             Teuchos::ETransp mode = Teuchos::NO_TRANS,
+             HighScalar alpha = Teuchos::ScalarTraits<HighScalar>::one(),
+             HighScalar beta = Teuchos::ScalarTraits<HighScalar>::zero()) const;
+
+  //! Whether apply() can apply the transpose; the same as for the wrapped operator.
+  bool hasTransposeApply() const { return op_->hasTransposeApply(); };
+
+  //@}
+
+private:
+  //! Computes Y = alpha*A*X + beta*Y for constant stride X and Y.
+  void applyConstantStride(const MV& X, MV& Y, Teuchos::ETransp mode, HighScalar alpha, HighScalar beta) const;
+
+  Teuchos::RCP<const low_operator_type> op_;
+
+  //! X and A*X in LowScalar
+  mutable Teuchos::RCP<low_MV> lowX_, lowY_;
+  //! Whether lowX_ and lowY_ were allocated for a transposed apply
+  mutable bool transposed_;
+};
+
+
+
+//! Constructor
+//==============================================================================
+template<class HighScalar, class LowScalar, class LO, class GO, class Node>
+MixedPrecisionOperator<HighScalar,LowScalar,LO,GO,Node>::MixedPrecisionOperator(const Teuchos::RCP<const low_operator_type>& op)
+  : op_(op), transposed_(false)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(op.is_null(), std::invalid_argument,
+         Teuchos::typeName (*this) << "::MixedPrecisionOperator(): The operator may not be null.");
+}
+
+
+
+//! Computes Y = alpha*A*X + beta*Y, with A applied in LowScalar.
+//==============================================================================
+template<class HighScalar, class LowScalar, class LO, class GO, class Node>
+void MixedPrecisionOperator<HighScalar,LowScalar,LO,GO,Node>::apply(const MV& X, MV& Y, Teuchos::ETransp mode, HighScalar alpha, HighScalar beta) const
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(X.getNumVectors() != Y.getNumVectors(), std::invalid_argument,
+         Teuchos::typeName (*this) << "::apply(X,Y): X and Y must have the same number of vectors.");
+
+  // The kernels work on whole local views; copy strided multivectors
+  if(!X.isConstantStride()) {
+    MV Xcopy(X, Teuchos::Copy);
+    apply(Xcopy, Y, mode, alpha, beta);
+  }
+  else if(!Y.isConstantStride()) {
+    MV Ycopy(Y, Teuchos::Copy);
+    applyConstantStride(X, Ycopy, mode, alpha, beta);
+    Tpetra::deep_copy(Y, Ycopy);
+  }
+  else {
+    applyConstantStride(X, Y, mode, alpha, beta);
+  }
+}
+
+
+
+//! Computes Y = alpha*A*X + beta*Y for constant stride X and Y.
+//==============================================================================
+template<class HighScalar, class LowScalar, class LO, class GO, class Node>
+void MixedPrecisionOperator<HighScalar,LowScalar,LO,GO,Node>::applyConstantStride(const MV& X, MV& Y, Teuchos::ETransp mode, HighScalar alpha, HighScalar beta) const
+{
+  typedef Kokkos::RangePolicy<execution_space, int> policy_type;
+  typedef typename MV::dual_view_type::t_dev view_type;
+  typedef typename low_MV::dual_view_type::t_dev low_view_type;
+
+  const size_t numVecs = X.getNumVectors();
+  const bool transposed = (mode != Teuchos::NO_TRANS);
+
+  // The low precision vectors live in the spaces of the wrapped operator
+  if(lowX_.is_null() || lowX_->getNumVectors() != numVecs || transposed != transposed_) {
+    lowX_ = Teuchos::rcp(new low_MV(transposed ? op_->getRangeMap() : op_->getDomainMap(), numVecs, false));
+    lowY_ = Teuchos::rcp(new low_MV(transposed ? op_->getDomainMap() : op_->getRangeMap(), numVecs, false));
+    transposed_ = transposed;
+  }
+
+  //
+  // Round X to LowScalar
+  //
+  const_cast<MV&>(X).template sync<device_type>();
+  lowX_->template sync<device_type>();
+  lowX_->template modify<device_type>();
+  const view_type x = X.template getLocalView<device_type>();
+  const low_view_type xLow = lowX_->template getLocalView<device_type>();
+  const int numRowsX = X.getLocalLength();
+  Kokkos::parallel_for(policy_type(0, numRowsX*numVecs), KOKKOS_LAMBDA(const int idx) {
+    xLow(idx % numRowsX, idx / numRowsX) = static_cast<low_impl_scalar_type>(x(idx % numRowsX, idx / numRowsX));
+  });
+
+  op_->apply(*lowX_, *lowY_, mode);
+
+  //
+  // Y = beta*Y + alpha*A*X, converting A*X back to HighScalar on the way
+  //
+  lowY_->template sync<device_type>();
+  Y.template sync<device_type>();
+  Y.template modify<device_type>();
+  const low_view_type yLow = lowY_->template getLocalView<device_type>();
+  const view_type y = Y.template getLocalView<device_type>();
+  const int numRowsY = Y.getLocalLength();
+  const impl_scalar_type a = alpha, b = beta;
+  if(beta == Teuchos::ScalarTraits<HighScalar>::zero()) {
+    Kokkos::parallel_for(policy_type(0, numRowsY*numVecs), KOKKOS_LAMBDA(const int idx) {
+      y(idx % numRowsY, idx / numRowsY) = a*static_cast<impl_scalar_type>(yLow(idx % numRowsY, idx / numRowsY));
+    });
+  }
+  else {
+    Kokkos::parallel_for(policy_type(0, numRowsY*numVecs), KOKKOS_LAMBDA(const int idx) {
+      y(idx % numRowsY, idx / numRowsY) = b*y(idx % numRowsY, idx / numRowsY)
+          + a*static_cast<impl_scalar_type>(yLow(idx % numRowsY, idx / numRowsY));
+    });
+  }
+}
+
+} // namespace Tpetra
+
+#endif // _TPETRA_MIXEDPRECISIONOPERATOR_H_
@@ -0,0 +1,391 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef _TPETRA_STENCILOPERATOR_H_
+#define _TPETRA_STENCILOPERATOR_H_
+
+#include "Tpetra_ConfigDefs.hpp"
+#include "Tpetra_MultiVector.hpp"
+#include "Tpetra_Operator.hpp"
+#include "Teuchos_CommHelpers.hpp"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+
+
+namespace Tpetra {
+
+//! StencilOperator: A matrix-free constant-coefficient 5-point (2D) or 7-point (3D) stencil.
+
+/*! Grid point (i,j,k) of an nx by ny by nz grid is row i + nx*(j + ny*k); nz = 1 gives the 2D stencil.
+    Neighbors outside of the grid are dropped, as for homogeneous Dirichlet boundary conditions.
+    The default coefficients are those of the Laplace operator.
+
+    Each process owns a contiguous slab of whole planes of the grid (lines of constant j in 2D,
+    planes of constant k in 3D), so apply() only exchanges one plane with each neighboring process.
+    The exchange is posted before the local part of the stencil is computed and completed afterwards,
+    and its buffers are kept from one apply() to the next.  The kernels run on the Node's execution
+    space with unit-stride inner loops along x.
+*/
+template<class Scalar = Details::DefaultTypes::scalar_type,
+         class LO = Details::DefaultTypes::local_ordinal_type,
+         class GO = Details::DefaultTypes::global_ordinal_type,
+         class Node = Details::DefaultTypes::node_type>
+class StencilOperator :
+  virtual public Operator<Scalar,LO,GO,Node>
+{
+public:
+  typedef Scalar scalar_type;
+  typedef LO local_ordinal_type;
+  typedef GO global_ordinal_type;
+  typedef Node node_type;
+  typedef Map<LO,GO,Node> map_type;
+  typedef MultiVector<Scalar,LO,GO,Node> MV;
+  typedef typename MV::impl_scalar_type impl_scalar_type;
+  typedef typename MV::dual_view_type::t_dev::device_type device_type;
+  typedef typename device_type::execution_space execution_space;
+
+  //! @name Constructor/Destructor Methods
+  //@{
+
+  //! Constructor
+  StencilOperator(const Teuchos::RCP<const Teuchos::Comm<int> >& comm, GO nx, GO ny, GO nz = 1);
+
+  //! Destructor
+  virtual ~StencilOperator() {};
+
+  //@}
+
+  //! @name Stencil query and modification methods
+  //@{
+
+  //! Set the coefficient of the center point and of its neighbors in each direction.
+  void setCoefficients(Scalar center, Scalar xCoeff, Scalar yCoeff, Scalar zCoeff = Teuchos::ScalarTraits<Scalar>::zero());
+
+  //! The coefficient of the center point.
+  Scalar getCenterCoefficient() const { return center_; };
+
+  //! The coefficient of the neighbors in direction 0 (x), 1 (y) or 2 (z).
+  Scalar getNeighborCoefficient(int dir) const { return coeffs_[dir]; };
+
+  //! The number of grid points in direction 0 (x), 1 (y) or 2 (z).
+  GO getGridSize(int dir) const { return dir == 0 ? nx_ : (dir == 1 ? ny_ : nz_); };
+
+  //! Whether this is the 7-point stencil.
+  bool is3D() const { return nz_ > 1; };
+
+  //! The number of entries in a plane of the grid, which is the unit of distribution.
+  size_t getPlaneSize() const { return planeSize_; };
+
+  //@}
+
+  //! @name Operator methods
+  //@{
+
+  //! The Map associated with the domain of this operator.
+  Teuchos::RCP<const map_type> getDomainMap() const { return map_; };
+
+  //! The Map associated with the range of this operator.
+  Teuchos::RCP<const map_type> getRangeMap() const { return map_; };
+
+  //! Computes Y = alpha*A*X + beta*Y.  The stencil is symmetric, so mode is ignored.
+  void apply(const MV& X,
+             MV& Y,
+             Teuchos::ETransp mode = Teuchos::NO_TRANS,
+             Scalar alpha = Teuchos::ScalarTraits<Scalar>::one(),
+             Scalar beta = Teuchos::ScalarTraits<Scalar>::zero()) const;
+
+  //! Whether apply() can apply the transpose.
+  bool hasTransposeApply() const { return true; };
+
+  //@}
+
+private:
+  typedef Kokkos::View<impl_scalar_type**, Kokkos::LayoutLeft, device_type> buffer_type;
+  typedef typename buffer_type::HostMirror host_buffer_type;
+
+  //! Computes Y = alpha*A*X + beta*Y for constant stride X and Y, with the halo exchange.
+  void applyConstantStride(const MV& X, MV& Y, Scalar alpha, Scalar beta) const;
+
+  //! Reallocates the halo buffers if the number of vectors changed.
+  void resizeBuffers(size_t numVecs) const;
+
+  //! Which process owns the given plane.
+  int getPlaneOwner(GO plane) const;
+
+  Teuchos::RCP<const Teuchos::Comm<int> > comm_;
+  Teuchos::RCP<const map_type> map_;
+  GO nx_, ny_, nz_;
+  size_t planeSize_, linesPerPlane_;
+  GO numPlanes_, firstPlane_, numLocalPlanes_;
+  //! The processes owning the planes just below and above ours, or -1
+  int prevRank_, nextRank_;
+  Scalar center_;
+  Scalar coeffs_[3];
+
+  //! Planes sent to and received from the neighboring processes
+  mutable buffer_type sendPrev_, sendNext_, recvPrev_, recvNext_;
+  mutable host_buffer_type hostSendPrev_, hostSendNext_, hostRecvPrev_, hostRecvNext_;
+};
+
+
+
+//! Constructor
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+StencilOperator<Scalar,LO,GO,Node>::StencilOperator(const Teuchos::RCP<const Teuchos::Comm<int> >& comm, GO nx, GO ny, GO nz)
+  : comm_(comm), nx_(nx), ny_(ny), nz_(nz), prevRank_(-1), nextRank_(-1)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(nx < 1 || ny < 1 || nz < 1, std::invalid_argument,
+         Teuchos::typeName (*this) << "::StencilOperator(): The grid dimensions must be positive.");
+
+  planeSize_ = is3D() ? nx_*ny_ : nx_;
+  linesPerPlane_ = is3D() ? ny_ : 1;
+  numPlanes_ = is3D() ? nz_ : ny_;
+
+  // Split the planes as evenly as possible, giving the remainder to the first processes
+  const int rank = comm_->getRank();
+  const int numProcs = comm_->getSize();
+  const GO base = numPlanes_ / numProcs, rem = numPlanes_ % numProcs;
+  numLocalPlanes_ = base + (rank < rem ? 1 : 0);
+  firstPlane_ = rank*base + std::min<GO>(rank, rem);
+  if(numLocalPlanes_ > 0) {
+    if(firstPlane_ > 0) prevRank_ = getPlaneOwner(firstPlane_-1);
+    if(firstPlane_+numLocalPlanes_ < numPlanes_) nextRank_ = getPlaneOwner(firstPlane_+numLocalPlanes_);
+  }
+
+  map_ = Teuchos::rcp(new map_type(numPlanes_*planeSize_, numLocalPlanes_*planeSize_, 0, comm_));
+
+  setCoefficients(is3D() ? 6 : 4, -1, -1, is3D() ? -1 : 0);
+}
+
+
+
+//! Set the coefficient of the center point and of its neighbors in each direction.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+void StencilOperator<Scalar,LO,GO,Node>::setCoefficients(Scalar center, Scalar xCoeff, Scalar yCoeff, Scalar zCoeff)
+{
+  center_ = center;
+  coeffs_[0] = xCoeff;
+  coeffs_[1] = yCoeff;
+  coeffs_[2] = zCoeff;
+}
+
+
+
+//! Which process owns the given plane.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+int StencilOperator<Scalar,LO,GO,Node>::getPlaneOwner(GO plane) const
+{
+  const int numProcs = comm_->getSize();
+  const GO base = numPlanes_ / numProcs, rem = numPlanes_ % numProcs;
+  if(plane < rem*(base+1))
+    return plane / (base+1);
+  return rem + (plane - rem*(base+1)) / base;
+}
+
+
+
+//! Reallocates the halo buffers if the number of vectors changed.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+void StencilOperator<Scalar,LO,GO,Node>::resizeBuffers(size_t numVecs) const
+{
+  if(sendPrev_.dimension_1() == numVecs)
+    return;
+  const size_t prevSize = (prevRank_ >= 0 ? planeSize_ : 0);
+  const size_t nextSize = (nextRank_ >= 0 ? planeSize_ : 0);
+  sendPrev_ = buffer_type("sendPrev", prevSize, numVecs);
+  recvPrev_ = buffer_type("recvPrev", prevSize, numVecs);
+  sendNext_ = buffer_type("sendNext", nextSize, numVecs);
+  recvNext_ = buffer_type("recvNext", nextSize, numVecs);
+  hostSendPrev_ = Kokkos::create_mirror_view(sendPrev_);
+  hostRecvPrev_ = Kokkos::create_mirror_view(recvPrev_);
+  hostSendNext_ = Kokkos::create_mirror_view(sendNext_);
+  hostRecvNext_ = Kokkos::create_mirror_view(recvNext_);
+}
+
+
+
+//! Computes Y = alpha*A*X + beta*Y.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+void StencilOperator<Scalar,LO,GO,Node>::apply(const MV& X, MV& Y, Teuchos::ETransp mode, Scalar alpha, Scalar beta) const
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(X.getNumVectors() != Y.getNumVectors(), std::invalid_argument,
+         Teuchos::typeName (*this) << "::apply(X,Y): X and Y must have the same number of vectors.");
+
+  // The kernels work on whole local views; copy strided multivectors
+  if(!X.isConstantStride()) {
+    MV Xcopy(X, Teuchos::Copy);
+    apply(Xcopy, Y, mode, alpha, beta);
+  }
+  else if(!Y.isConstantStride()) {
+    MV Ycopy(Y, Teuchos::Copy);
+    applyConstantStride(X, Ycopy, alpha, beta);
+    Tpetra::deep_copy(Y, Ycopy);
+  }
+  else {
+    applyConstantStride(X, Y, alpha, beta);
+  }
+}
+
+
+
+//! Computes Y = alpha*A*X + beta*Y for constant stride X and Y, with the halo exchange.
+//==============================================================================
+template<class Scalar, class LO, class GO, class Node>
+void StencilOperator<Scalar,LO,GO,Node>::applyConstantStride(const MV& X, MV& Y, Scalar alpha, Scalar beta) const
+{
+  typedef Kokkos::RangePolicy<execution_space, int> policy_type;
+  typedef typename MV::dual_view_type::t_dev view_type;
+
+  const int numVecs = X.getNumVectors();
+  const LO nx = nx_;
+  const LO planeSize = planeSize_;
+  const LO linesPerPlane = linesPerPlane_;
+  const LO numLocalPlanes = numLocalPlanes_;
+  const LO numLines = numLocalPlanes*linesPerPlane;
+  const LO lastPlaneStart = (numLocalPlanes-1)*planeSize;
+  const impl_scalar_type b = beta;
+  const impl_scalar_type ac = alpha*center_, ax = alpha*coeffs_[0], ay = alpha*coeffs_[1];
+  const impl_scalar_type ap = alpha*(is3D() ? coeffs_[2] : coeffs_[1]);
+  const bool threeD = is3D();
+  const bool betaIsZero = (beta == Teuchos::ScalarTraits<Scalar>::zero());
+
+  const_cast<MV&>(X).template sync<device_type>();
+  Y.template sync<device_type>();
+  Y.template modify<device_type>();
+  view_type x = X.template getLocalView<device_type>();
+  view_type y = Y.template getLocalView<device_type>();
+  TEUCHOS_TEST_FOR_EXCEPTION(x.ptr_on_device() == y.ptr_on_device() && numLines > 0, std::invalid_argument,
+         Teuchos::typeName (*this) << "::apply(X,Y): X and Y may not alias one another.");
+
+  //
+  // Post the halo exchange
+  //
+  resizeBuffers(numVecs);
+  Teuchos::Array<Teuchos::RCP<Teuchos::CommRequest<int> > > requests;
+  const buffer_type sendPrev = sendPrev_, sendNext = sendNext_;
+  if(prevRank_ >= 0) {
+    Kokkos::parallel_for(policy_type(0, planeSize*numVecs), KOKKOS_LAMBDA(const int idx) {
+      sendPrev(idx % planeSize, idx / planeSize) = x(idx % planeSize, idx / planeSize);
+    });
+    Kokkos::deep_copy(hostSendPrev_, sendPrev_);
+    requests.push_back(Teuchos::ireceive<int,impl_scalar_type>(*comm_,
+        Teuchos::arcp(hostRecvPrev_.ptr_on_device(), 0, planeSize*numVecs, false), prevRank_));
+  }
+  if(nextRank_ >= 0) {
+    Kokkos::parallel_for(policy_type(0, planeSize*numVecs), KOKKOS_LAMBDA(const int idx) {
+      sendNext(idx % planeSize, idx / planeSize) = x(lastPlaneStart + idx % planeSize, idx / planeSize);
+    });
+    Kokkos::deep_copy(hostSendNext_, sendNext_);
+    requests.push_back(Teuchos::ireceive<int,impl_scalar_type>(*comm_,
+        Teuchos::arcp(hostRecvNext_.ptr_on_device(), 0, planeSize*numVecs, false), nextRank_));
+  }
+  if(prevRank_ >= 0) {
+    requests.push_back(Teuchos::isend<int,impl_scalar_type>(*comm_,
+        Teuchos::arcp<const impl_scalar_type>(hostSendPrev_.ptr_on_device(), 0, planeSize*numVecs, false), prevRank_));
+  }
+  if(nextRank_ >= 0) {
+    requests.push_back(Teuchos::isend<int,impl_scalar_type>(*comm_,
+        Teuchos::arcp<const impl_scalar_type>(hostSendNext_.ptr_on_device(), 0, planeSize*numVecs, false), nextRank_));
+  }
+
+  //
+  // Compute everything that only needs local data, one grid line per work item.  Each term
+  // is its own unit-stride loop; the neighbors that do not exist are decided once per line.
+  //
+  Kokkos::parallel_for(policy_type(0, numLines*numVecs), KOKKOS_LAMBDA(const int idx) {
+    const int line = idx % numLines, v = idx / numLines;
+    const int plane = line / linesPerPlane, j = line % linesPerPlane;
+    const impl_scalar_type* xl = &x(line*nx, v);
+    impl_scalar_type* yl = &y(line*nx, v);
+
+    if(betaIsZero) {
+      for(int i = 0; i < nx; i++) yl[i] = ac*xl[i];
+    }
+    else {
+      for(int i = 0; i < nx; i++) yl[i] = b*yl[i] + ac*xl[i];
+    }
+    for(int i = 1; i < nx; i++) yl[i] += ax*xl[i-1];
+    for(int i = 0; i < nx-1; i++) yl[i] += ax*xl[i+1];
+    if(threeD && j > 0) {
+      for(int i = 0; i < nx; i++) yl[i] += ay*xl[i-nx];
+    }
+    if(threeD && j < linesPerPlane-1) {
+      for(int i = 0; i < nx; i++) yl[i] += ay*xl[i+nx];
+    }
+    if(plane > 0) {
+      for(int i = 0; i < nx; i++) yl[i] += ap*xl[i-planeSize];
+    }
+    if(plane < numLocalPlanes-1) {
+      for(int i = 0; i < nx; i++) yl[i] += ap*xl[i+planeSize];
+    }
+  });
+
+  //
+  // Complete the halo exchange and add the contributions of the neighboring planes
+  //
+  if(!requests.empty()) {
+    Teuchos::waitAll(*comm_, requests());
+  }
+  const buffer_type recvPrev = recvPrev_, recvNext = recvNext_;
+  if(prevRank_ >= 0) {
+    Kokkos::deep_copy(recvPrev_, hostRecvPrev_);
+    Kokkos::parallel_for(policy_type(0, planeSize*numVecs), KOKKOS_LAMBDA(const int idx) {
+      y(idx % planeSize, idx / planeSize) += ap*recvPrev(idx % planeSize, idx / planeSize);
+    });
+  }
+  if(nextRank_ >= 0) {
+    Kokkos::deep_copy(recvNext_, hostRecvNext_);
+    Kokkos::parallel_for(policy_type(0, planeSize*numVecs), KOKKOS_LAMBDA(const int idx) {
+      y(lastPlaneStart + idx % planeSize, idx / planeSize) += ap*recvNext(idx % planeSize, idx / planeSize);
+    });
+  }
+}
+
+} // namespace Tpetra
+
+#endif // _TPETRA_STENCILOPERATOR_H_
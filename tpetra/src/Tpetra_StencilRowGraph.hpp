@@ -0,0 +1,469 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef _TPETRA_STENCILROWGRAPH_H_
+#define _TPETRA_STENCILROWGRAPH_H_
+
+#include "Tpetra_ConfigDefs.hpp"
+#include "Tpetra_RowGraph.hpp"
+#include "Tpetra_Map.hpp"
+#include "Tpetra_Import.hpp"
+#include "Tpetra_Export.hpp"
+#include "Teuchos_CommHelpers.hpp"
+#include <Kokkos_Core.hpp>
+#include <algorithm>
+#include <cstdlib>
+
+
+namespace Tpetra {
+
+//! One point of a compile-time stencil description, given by its offset from the center point.
+template<int DX, int DY, int DZ = 0>
+struct StencilPoint {
+  static const int dx = DX;
+  static const int dy = DY;
+  static const int dz = DZ;
+};
+
+namespace Details {
+
+//! The P-th type of a parameter pack.
+template<int P, class First, class... Rest>
+struct StencilPointAt : StencilPointAt<P-1, Rest...> {};
+
+template<class First, class... Rest>
+struct StencilPointAt<0, First, Rest...> : First {};
+
+} // namespace Details
+
+//! A compile-time stencil description on a 2D or 3D structured grid.
+/*! Dim is the dimension of the grid and Points is a list of StencilPoint.  The order of the points
+    is the order of the entries in each row of a StencilRowGraph or StencilRowMatrix.
+*/
+template<int Dim, class... Points>
+struct StencilShape {
+  static const int dim = Dim;
+  static const int numPoints = sizeof...(Points);
+
+  //! The P-th point, as a compile-time constant.
+  template<int P>
+  struct point : Details::StencilPointAt<P, Points...> {};
+
+  //! The offset of point p in direction d, for code that does not need it at compile time.
+  static int offset(int p, int d)
+  {
+    const int offsets[sizeof...(Points)][3] = { {Points::dx, Points::dy, Points::dz}... };
+    return offsets[p][d];
+  }
+};
+
+//! The 5-point stencil: center, west, east, south, north.
+typedef StencilShape<2, StencilPoint<0,0>, StencilPoint<-1,0>, StencilPoint<1,0>,
+                        StencilPoint<0,-1>, StencilPoint<0,1> > FivePointStencil;
+
+//! The 9-point stencil: the 5-point stencil and the four diagonal neighbors.
+typedef StencilShape<2, StencilPoint<0,0>, StencilPoint<-1,0>, StencilPoint<1,0>,
+                        StencilPoint<0,-1>, StencilPoint<0,1>, StencilPoint<-1,-1>,
+                        StencilPoint<1,-1>, StencilPoint<-1,1>, StencilPoint<1,1> > NinePointStencil;
+
+//! The 7-point stencil: center, west, east, south, north, bottom, top.
+typedef StencilShape<3, StencilPoint<0,0,0>, StencilPoint<-1,0,0>, StencilPoint<1,0,0>,
+                        StencilPoint<0,-1,0>, StencilPoint<0,1,0>,
+                        StencilPoint<0,0,-1>, StencilPoint<0,0,1> > SevenPointStencil;
+
+namespace Details {
+
+//! The part of a structured grid that a process owns, and how its neighbors map to local columns.
+/*! Rows are numbered i + nx*(j + ny*k).  A process owns the rows [firstRow,endRow), which are whole
+    planes of the grid, and its column Map holds those rows followed by the ghost rows
+    [lowStart,firstRow) and [endRow,highEnd), so local column indices follow from the global index.
+*/
+template<class LO, class GO>
+struct StencilGrid {
+  typedef LO local_ordinal_type;
+  typedef GO global_ordinal_type;
+
+  GO nx, ny, nz;
+  GO firstRow, endRow, lowStart, highEnd;
+
+  //! Whether (i,j,k) is a point of the grid.
+  KOKKOS_INLINE_FUNCTION bool contains(GO i, GO j, GO k) const
+  {
+    return i >= 0 && i < nx && j >= 0 && j < ny && k >= 0 && k < nz;
+  }
+
+  //! The local column index of global row g, which must be owned or ghosted.
+  KOKKOS_INLINE_FUNCTION LO localColumn(GO g) const
+  {
+    if(g < firstRow)
+      return (endRow - firstRow) + (g - lowStart);
+    if(g >= endRow)
+      return (endRow - firstRow) + (firstRow - lowStart) + (g - endRow);
+    return g - firstRow;
+  }
+
+  //! The global row of grid point (i,j,k).
+  KOKKOS_INLINE_FUNCTION GO globalRow(GO i, GO j, GO k) const
+  {
+    return i + nx*(j + ny*k);
+  }
+};
+
+} // namespace Details
+
+//! StencilRowGraph: The graph of a constant stencil on a structured grid, generated on the fly.
+
+/*! Each process owns a contiguous slab of whole planes of the grid (lines of constant j in 2D,
+    planes of constant k in 3D), as evenly split as possible.  Neighbors outside of the grid are
+    dropped, as for homogeneous Dirichlet boundary conditions.  Nothing is stored per row.
+*/
+template<class Shape,
+         class LO = Details::DefaultTypes::local_ordinal_type,
+         class GO = Details::DefaultTypes::global_ordinal_type,
+         class Node = Details::DefaultTypes::node_type>
+class StencilRowGraph :
+  virtual public RowGraph<LO,GO,Node>
+{
+private:
+  typedef Teuchos::Comm<int> Comm;
+
+public:
+  typedef LO local_ordinal_type;
+  typedef GO global_ordinal_type;
+  typedef Node node_type;
+  typedef Shape shape_type;
+  typedef Details::StencilGrid<LO,GO> grid_type;
+
+  //! @name Constructor/Destructor Methods
+  //@{
+
+  //! Constructor.  For 2D stencils nz must be 1.
+  StencilRowGraph(const Teuchos::RCP<const Comm>& comm, GO nx, GO ny, GO nz = 1);
+
+  //! Destructor
+  virtual ~StencilRowGraph() {};
+
+  //@}
+
+  //! @name Graph query methods
+  //@{
+
+  //! The communicator over which this graph is distributed.
+  Teuchos::RCP<const Comm> getComm() const { return comm_; };
+
+  //! The Kokkos Node instance.
+  Teuchos::RCP<Node> getNode() const { return rowMap_->getNode(); };
+
+  //! The Map that describes this graph's distribution of rows over processes.
+  Teuchos::RCP<const Map<LO,GO,Node> > getRowMap() const { return rowMap_; };
+
+  //! The Map that describes this graph's distribution of columns over processes.
+  Teuchos::RCP<const Map<LO,GO,Node> > getColMap() const { return colMap_; };
+
+  //! The Map associated with the domain of this graph.
+  Teuchos::RCP<const Map<LO,GO,Node> > getDomainMap() const { return rowMap_; };
+
+  //! The Map associated with the range of this graph.
+  Teuchos::RCP<const Map<LO,GO,Node> > getRangeMap() const { return rowMap_; };
+
+  //! The Import from the domain Map to the column Map, or null on a single process.
+  Teuchos::RCP<const Import<LO,GO,Node> > getImporter() const { return importer_; };
+
+  //! This graph's Export object; the row and range Maps are the same, so it is null.
+  Teuchos::RCP<const Export<LO,GO,Node> > getExporter() const { return Teuchos::null; };
+
+  //! Returns the number of global rows in the graph.
+  global_size_t getGlobalNumRows() const { return rowMap_->getGlobalNumElements(); };
+
+  //! Returns the number of global columns in the graph.
+  global_size_t getGlobalNumCols() const { return rowMap_->getGlobalNumElements(); };
+
+  //! Returns the number of rows owned on the calling node.
+  size_t getNodeNumRows() const { return rowMap_->getNodeNumElements(); };
+
+  //! Returns the number of columns connected to the locally owned rows of this graph.
+  size_t getNodeNumCols() const { return colMap_->getNodeNumElements(); };
+
+  //! Returns the index base for global indices for this graph.
+  GO getIndexBase() const { return rowMap_->getIndexBase(); };
+
+  //! Returns the global number of entries in the graph.
+  global_size_t getGlobalNumEntries() const { return nnzGlobal_; };
+
+  //! Returns the local number of entries in the graph.
+  size_t getNodeNumEntries() const { return nnzLocal_; };
+
+  //! Returns the current number of entries on this node in the specified global row.
+  size_t getNumEntriesInGlobalRow(GO globalRow) const;
+
+  //! Returns the current number of entries on this node in the specified local row.
+  size_t getNumEntriesInLocalRow(LO localRow) const;
+
+  //! Returns the number of global diagonal entries, based on global row/column index comparisons.
+  global_size_t getGlobalNumDiags() const { return hasCenter_ ? getGlobalNumRows() : 0; };
+
+  //! Returns the number of local diagonal entries, based on global row/column index comparisons.
+  size_t getNodeNumDiags() const { return hasCenter_ ? getNodeNumRows() : 0; };
+
+  //! Returns the maximum number of entries across all rows/columns on all nodes.
+  size_t getGlobalMaxNumRowEntries() const { return maxEntriesGlobal_; };
+
+  //! Returns the maximum number of entries across all rows/columns on this node.
+  size_t getNodeMaxNumRowEntries() const { return maxEntriesLocal_; };
+
+  //! Indicates whether the graph has a well-defined column map.
+  bool hasColMap() const { return true; };
+
+  //! Indicates whether the graph is lower triangular.
+  bool isLowerTriangular() const { return isLower_; };
+
+  //! Indicates whether the graph is upper triangular.
+  bool isUpperTriangular() const { return isUpper_; };
+
+  //! If graph indices are in the local range, this function returns true. Otherwise, this function returns false. */
+  bool isLocallyIndexed() const { return true; };
+
+  //! If graph indices are in the global range, this function returns true. Otherwise, this function returns false. */
+  bool isGloballyIndexed() const { return false; };
+
+  //! Whether fillComplete() has been called and the graph is in compute mode.
+  bool isFillComplete() const { return true; };
+
+  //@}
+
+  //! @name Extraction Methods
+  //@{
+
+  //! Extract a list of entries in a specified global row of the graph. Put into pre-allocated storage.
+  void getGlobalRowCopy(GO globalRow, const Teuchos::ArrayView<GO> &indices, size_t &numIndices) const;
+
+  //! Extract a list of entries in a specified local row of the graph. Put into storage allocated by calling routine.
+  void getLocalRowCopy(LO localRow, const Teuchos::ArrayView<LO> &indices, size_t &numIndices) const;
+
+  //! The grid and its local part, as used by the kernels of StencilRowMatrix.
+  const grid_type& getGrid() const { return grid_; };
+
+  //! Which points of the stencil exist in the given global row; returns how many do.
+  size_t getRowPoints(GO globalRow, bool* exists) const;
+
+  //@}
+
+private:
+  Teuchos::RCP<const Comm> comm_;
+  Teuchos::RCP<const Map<LO,GO,Node> > rowMap_, colMap_;
+  Teuchos::RCP<const Import<LO,GO,Node> > importer_;
+  grid_type grid_;
+  global_size_t nnzGlobal_;
+  size_t nnzLocal_, maxEntriesLocal_, maxEntriesGlobal_;
+  bool hasCenter_, isLower_, isUpper_;
+};
+
+
+
+//! Constructor
+//==============================================================================
+template<class Shape, class LO, class GO, class Node>
+StencilRowGraph<Shape,LO,GO,Node>::StencilRowGraph(const Teuchos::RCP<const Comm>& comm, GO nx, GO ny, GO nz)
+  : comm_(comm)
+{
+  using Teuchos::rcp;
+
+  TEUCHOS_TEST_FOR_EXCEPTION(nx < 1 || ny < 1 || nz < 1, std::invalid_argument,
+         Teuchos::typeName (*this) << "::StencilRowGraph(): The grid dimensions must be positive.");
+  TEUCHOS_TEST_FOR_EXCEPTION(Shape::dim == 2 && nz != 1, std::invalid_argument,
+         Teuchos::typeName (*this) << "::StencilRowGraph(): A 2D stencil requires nz = 1.");
+
+  grid_.nx = nx;
+  grid_.ny = ny;
+  grid_.nz = nz;
+
+  // Split the planes as evenly as possible, giving the remainder to the first processes
+  const GO planeSize = (Shape::dim == 3 ? nx*ny : nx);
+  const GO numPlanes = (Shape::dim == 3 ? nz : ny);
+  const int rank = comm_->getRank();
+  const int numProcs = comm_->getSize();
+  const GO base = numPlanes / numProcs, rem = numPlanes % numProcs;
+  const GO firstPlane = rank*base + std::min<GO>(rank, rem);
+  const GO endPlane = firstPlane + base + (rank < rem ? 1 : 0);
+
+  // The ghost planes are as deep as the stencil reaches across planes
+  int halo = 0;
+  hasCenter_ = false;
+  isLower_ = isUpper_ = true;
+  for(int p = 0; p < Shape::numPoints; p++) {
+    const int dx = Shape::offset(p,0), dy = Shape::offset(p,1), dz = Shape::offset(p,2);
+    halo = std::max(halo, std::abs(Shape::dim == 3 ? dz : dy));
+    const GO shift = dx + nx*(dy + ny*dz);
+    if(shift == 0) hasCenter_ = true;
+    if(shift > 0) isLower_ = false;
+    if(shift < 0) isUpper_ = false;
+  }
+
+  grid_.firstRow = firstPlane*planeSize;
+  grid_.endRow = endPlane*planeSize;
+  grid_.lowStart = grid_.firstRow;
+  grid_.highEnd = grid_.endRow;
+  if(endPlane > firstPlane) {
+    grid_.lowStart = std::max<GO>(firstPlane-halo, 0)*planeSize;
+    grid_.highEnd = std::min<GO>(endPlane+halo, numPlanes)*planeSize;
+  }
+
+  rowMap_ = rcp(new Map<LO,GO,Node>(numPlanes*planeSize, grid_.endRow-grid_.firstRow, 0, comm_));
+
+  Teuchos::Array<GO> colGIDs;
+  colGIDs.reserve(grid_.highEnd - grid_.lowStart);
+  for(GO g = grid_.firstRow; g < grid_.endRow; g++) colGIDs.push_back(g);
+  for(GO g = grid_.lowStart; g < grid_.firstRow; g++) colGIDs.push_back(g);
+  for(GO g = grid_.endRow; g < grid_.highEnd; g++) colGIDs.push_back(g);
+  colMap_ = rcp(new Map<LO,GO,Node>(Teuchos::OrdinalTraits<global_size_t>::invalid(), colGIDs(), 0, comm_));
+  if(numProcs > 1)
+    importer_ = rcp(new Import<LO,GO,Node>(rowMap_, colMap_));
+
+  // Count the entries; a point exists in (dims[d] - |offset|) places along each direction
+  const GO dims[3] = {nx, ny, nz};
+  nnzGlobal_ = 0;
+  for(int p = 0; p < Shape::numPoints; p++) {
+    global_size_t count = 1;
+    for(int d = 0; d < 3; d++)
+      count *= std::max<GO>(dims[d] - std::abs(Shape::offset(p,d)), 0);
+    nnzGlobal_ += count;
+  }
+  nnzLocal_ = maxEntriesLocal_ = 0;
+  bool exists[Shape::numPoints];
+  for(GO g = grid_.firstRow; g < grid_.endRow; g++) {
+    const size_t numEntries = getRowPoints(g, exists);
+    nnzLocal_ += numEntries;
+    maxEntriesLocal_ = std::max(maxEntriesLocal_, numEntries);
+  }
+  Teuchos::reduceAll<int,size_t>(*comm_, Teuchos::REDUCE_MAX, maxEntriesLocal_, Teuchos::outArg(maxEntriesGlobal_));
+}
+
+
+
+//! Which points of the stencil exist in the given global row; returns how many do.
+//==============================================================================
+template<class Shape, class LO, class GO, class Node>
+size_t StencilRowGraph<Shape,LO,GO,Node>::getRowPoints(GO globalRow, bool* exists) const
+{
+  const GO i = globalRow % grid_.nx;
+  const GO j = (globalRow / grid_.nx) % grid_.ny;
+  const GO k = globalRow / (grid_.nx*grid_.ny);
+  size_t numEntries = 0;
+  for(int p = 0; p < Shape::numPoints; p++) {
+    exists[p] = grid_.contains(i+Shape::offset(p,0), j+Shape::offset(p,1), k+Shape::offset(p,2));
+    if(exists[p]) numEntries++;
+  }
+  return numEntries;
+}
+
+
+
+//! Returns the current number of entries on this node in the specified global row.
+//==============================================================================
+template<class Shape, class LO, class GO, class Node>
+size_t StencilRowGraph<Shape,LO,GO,Node>::getNumEntriesInGlobalRow(GO globalRow) const
+{
+  if(globalRow < grid_.firstRow || globalRow >= grid_.endRow)
+    return Teuchos::OrdinalTraits<size_t>::invalid();
+  bool exists[Shape::numPoints];
+  return getRowPoints(globalRow, exists);
+}
+
+
+
+//! Returns the current number of entries on this node in the specified local row.
+//==============================================================================
+template<class Shape, class LO, class GO, class Node>
+size_t StencilRowGraph<Shape,LO,GO,Node>::getNumEntriesInLocalRow(LO localRow) const
+{
+  return getNumEntriesInGlobalRow(grid_.firstRow + localRow);
+}
+
+
+
+//! Extract a list of entries in a specified global row of the graph. Put into pre-allocated storage.
+//==============================================================================
+template<class Shape, class LO, class GO, class Node>
+void StencilRowGraph<Shape,LO,GO,Node>::getGlobalRowCopy(GO globalRow, const Teuchos::ArrayView<GO> &indices, size_t &numIndices) const
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(globalRow < grid_.firstRow || globalRow >= grid_.endRow, std::invalid_argument,
+         Teuchos::typeName (*this) << "::getGlobalRowCopy(): Row " << globalRow << " is not owned by this process.");
+
+  bool exists[Shape::numPoints];
+  numIndices = getRowPoints(globalRow, exists);
+  TEUCHOS_TEST_FOR_EXCEPTION(static_cast<size_t>(indices.size()) < numIndices, std::runtime_error,
+         Teuchos::typeName (*this) << "::getGlobalRowCopy(): The array of indices is too small for row " << globalRow << ".");
+
+  size_t pos = 0;
+  for(int p = 0; p < Shape::numPoints; p++) {
+    if(exists[p])
+      indices[pos++] = globalRow + Shape::offset(p,0) + grid_.nx*(Shape::offset(p,1) + grid_.ny*Shape::offset(p,2));
+  }
+}
+
+
+
+//! Extract a list of entries in a specified local row of the graph. Put into storage allocated by calling routine.
+//==============================================================================
+template<class Shape, class LO, class GO, class Node>
+void StencilRowGraph<Shape,LO,GO,Node>::getLocalRowCopy(LO localRow, const Teuchos::ArrayView<LO> &indices, size_t &numIndices) const
+{
+  const GO globalRow = grid_.firstRow + localRow;
+  TEUCHOS_TEST_FOR_EXCEPTION(localRow < 0 || globalRow >= grid_.endRow, std::invalid_argument,
+         Teuchos::typeName (*this) << "::getLocalRowCopy(): Row " << localRow << " is not a local row.");
+
+  bool exists[Shape::numPoints];
+  numIndices = getRowPoints(globalRow, exists);
+  TEUCHOS_TEST_FOR_EXCEPTION(static_cast<size_t>(indices.size()) < numIndices, std::runtime_error,
+         Teuchos::typeName (*this) << "::getLocalRowCopy(): The array of indices is too small for row " << localRow << ".");
+
+  size_t pos = 0;
+  for(int p = 0; p < Shape::numPoints; p++) {
+    if(exists[p])
+      indices[pos++] = grid_.localColumn(globalRow + Shape::offset(p,0) + grid_.nx*(Shape::offset(p,1) + grid_.ny*Shape::offset(p,2)));
+  }
+}
+
+} // namespace Tpetra
+
+#endif // _TPETRA_STENCILROWGRAPH_H_
@@ -0,0 +1,604 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef _TPETRA_STENCILROWMATRIX_H_
+#define _TPETRA_STENCILROWMATRIX_H_
+
+#include "Tpetra_ConfigDefs.hpp"
+#include "Tpetra_RowMatrix.hpp"
+#include "Tpetra_MultiVector.hpp"
+#include "Tpetra_Vector.hpp"
+#include "Tpetra_StencilRowGraph.hpp"
+#include <Kokkos_Core.hpp>
+
+
+namespace Tpetra {
+
+namespace Details {
+
+//! The stencil coefficients, passed to the kernels by value.
+template<class Scalar, int N>
+struct StencilCoefficients {
+  Scalar c[N];
+
+  KOKKOS_INLINE_FUNCTION const Scalar& operator[](int p) const { return c[p]; }
+};
+
+//! Sum of the stencil points P, P+1, ..., N-1 at one grid point, unrolled at compile time.
+template<class Shape, int P, int N, bool transposed>
+struct StencilSum {
+  template<class Grid, class XView, class Coeffs>
+  KOKKOS_FORCEINLINE_FUNCTION static typename XView::non_const_value_type
+  apply(const Grid& grid, const XView& x, const Coeffs& c, int v,
+        typename Grid::global_ordinal_type row, typename Grid::global_ordinal_type i,
+        typename Grid::global_ordinal_type j, typename Grid::global_ordinal_type k)
+  {
+    typedef typename Shape::template point<P> point;
+    const int dx = transposed ? -point::dx : point::dx;
+    const int dy = transposed ? -point::dy : point::dy;
+    const int dz = transposed ? -point::dz : point::dz;
+
+    typename XView::non_const_value_type sum = StencilSum<Shape,P+1,N,transposed>::apply(grid, x, c, v, row, i, j, k);
+    if(grid.contains(i+dx, j+dy, k+dz))
+      sum += c[P] * x(grid.localColumn(row + dx + grid.nx*(dy + grid.ny*dz)), v);
+    return sum;
+  }
+};
+
+template<class Shape, int N, bool transposed>
+struct StencilSum<Shape,N,N,transposed> {
+  template<class Grid, class XView, class Coeffs>
+  KOKKOS_FORCEINLINE_FUNCTION static typename XView::non_const_value_type
+  apply(const Grid&, const XView&, const Coeffs&, int,
+        typename Grid::global_ordinal_type, typename Grid::global_ordinal_type,
+        typename Grid::global_ordinal_type, typename Grid::global_ordinal_type)
+  {
+    return typename XView::non_const_value_type();
+  }
+};
+
+//! Computes Y = alpha*A*X + beta*Y (or with A^T) for one row and vector per work item.
+template<class Shape, class Grid, class XView, class YView, bool transposed>
+struct StencilApplyFunctor {
+  typedef typename YView::non_const_value_type scalar_type;
+  typedef typename Grid::local_ordinal_type LO;
+  typedef typename Grid::global_ordinal_type GO;
+
+  Grid grid;
+  XView x;
+  YView y;
+  StencilCoefficients<scalar_type, Shape::numPoints> c;
+  scalar_type alpha, beta;
+  LO numRows;
+
+  KOKKOS_INLINE_FUNCTION void operator()(const LO idx) const
+  {
+    const LO r = idx % numRows;
+    const int v = idx / numRows;
+    const GO row = grid.firstRow + r;
+    const GO i = row % grid.nx, j = (row / grid.nx) % grid.ny, k = row / (grid.nx*grid.ny);
+
+    const scalar_type sum = StencilSum<Shape,0,Shape::numPoints,transposed>::apply(grid, x, c, v, row, i, j, k);
+    if(beta == scalar_type())
+      y(r,v) = alpha*sum;
+    else
+      y(r,v) = beta*y(r,v) + alpha*sum;
+  }
+};
+
+} // namespace Details
+
+//! StencilRowMatrix: A matrix-free RowMatrix for a constant-coefficient stencil on a structured grid.
+
+/*! The stencil is described at compile time by a StencilShape, such as FivePointStencil,
+    NinePointStencil or SevenPointStencil, and its coefficients are given at run time.  The graph
+    queries, row copies, diagonal and Frobenius norm are all generated from the shape, so this
+    class can be handed to anything that takes a RowMatrix (e.g. Ifpack2 preconditioners)
+    without assembling a CrsMatrix.
+
+    apply() imports X into the column Map and runs a Kokkos kernel on the Node's execution space
+    in which the loop over the stencil points is unrolled at compile time.  Row views are
+    supported; the first call to getLocalRowView() builds a compressed copy of the local rows,
+    which is kept until the coefficients change.
+*/
+template<class Shape,
+         class Scalar = Details::DefaultTypes::scalar_type,
+         class LO = Details::DefaultTypes::local_ordinal_type,
+         class GO = Details::DefaultTypes::global_ordinal_type,
+         class Node = Details::DefaultTypes::node_type>
+class StencilRowMatrix :
+  virtual public RowMatrix<Scalar,LO,GO,Node>
+{
+private:
+  typedef Teuchos::Comm<int>                   Comm;
+  typedef MultiVector<Scalar,LO,GO,Node>       MV;
+  typedef StencilRowGraph<Shape,LO,GO,Node>    Graph;
+
+public:
+  typedef Scalar scalar_type;
+  typedef LO local_ordinal_type;
+  typedef GO global_ordinal_type;
+  typedef Node node_type;
+  typedef Shape shape_type;
+  typedef typename RowMatrix<Scalar,LO,GO,Node>::mag_type mag_type;
+  typedef typename MV::impl_scalar_type impl_scalar_type;
+  typedef typename MV::dual_view_type::t_dev::device_type device_type;
+
+  //! @name Constructors/Destructor
+  //@{
+
+  //! Constructor.
+  /*! \param coefficients - One coefficient per point of Shape, in the same order.
+      For 2D stencils nz must be 1.
+  */
+  StencilRowMatrix(const Teuchos::RCP<const Comm>& comm, GO nx, GO ny, GO nz,
+                   const Teuchos::ArrayView<const Scalar>& coefficients);
+
+  //! Destructor
+  virtual ~StencilRowMatrix() {};
+  //@}
+
+  //! @name Stencil query and modification methods
+  //@{
+
+  //! Replace the coefficients of the stencil points.
+  void setCoefficients(const Teuchos::ArrayView<const Scalar>& coefficients);
+
+  //! The coefficients of the stencil points.
+  Teuchos::ArrayView<const Scalar> getCoefficients() const { return coeffs_(); };
+
+  //@}
+
+  //! @name Extraction methods
+  //@{
+
+    //! The current number of entries on the calling process in the specified global row.
+    size_t getNumEntriesInGlobalRow(GO globalRow) const { return graph_->getNumEntriesInGlobalRow(globalRow); };
+
+    //! The current number of entries on the calling process in the specified local row.
+    size_t getNumEntriesInLocalRow(LO localRow) const { return graph_->getNumEntriesInLocalRow(localRow); };
+
+    //! Get a copy of the given local row's entries.
+    void getLocalRowCopy(LO LocalRow, const Teuchos::ArrayView<LO> & Indices, const Teuchos::ArrayView<Scalar> & Values, size_t & NumEntries) const;
+
+    //! Get a copy of the given global row's entries.
+    void getGlobalRowCopy(GO GlobalRow, const Teuchos::ArrayView<GO> & Indices, const Teuchos::ArrayView<Scalar> & Values, size_t & NumEntries) const;
+
+    //! The matrix is locally indexed, so there are no global row views; this throws.
+    void getGlobalRowView(GO GlobalRow, Teuchos::ArrayView<const GO> & indices, Teuchos::ArrayView<const Scalar> & values) const;
+
+    //! Get a constant, nonpersisting, locally indexed view of the given row.
+    void getLocalRowView(LO LocalRow, Teuchos::ArrayView<const LO> & indices, Teuchos::ArrayView<const Scalar> & values) const;
+
+    //! Get a copy of the diagonal entries, distributed by the row Map.
+    void getLocalDiagCopy(Vector<Scalar,LO,GO,Node> & diag) const;
+  //@}
+
+  //! @name Mathematical functions
+  //@{
+
+    //! Computes Y = alpha*op(A)*X + beta*Y.
+    void apply(const MV & X,
+               MV & Y,
+               Teuchos::ETransp mode = Teuchos::NO_TRANS,
+               Scalar alpha = Teuchos::ScalarTraits<Scalar>::one(),
+               Scalar beta = Teuchos::ScalarTraits<Scalar>::zero()
+               ) const;
+
+    //! The coefficients are the same in every row, so the matrix cannot be scaled row by row; this throws.
+    void leftScale(const Vector<Scalar,LO,GO,Node> & x);
+
+    //! The coefficients are the same in every column, so the matrix cannot be scaled column by column; this throws.
+    void rightScale(const Vector<Scalar,LO,GO,Node> & x);
+  //@}
+
+  //! @name Attribute access functions
+  //@{
+
+    //! Whether fillComplete() has been called.
+    bool isFillComplete() const { return graph_->isFillComplete(); };
+
+    //! Whether the matrix is lower triangular.
+    bool isLowerTriangular() const { return graph_->isLowerTriangular(); };
+
+    //! Whether the matrix is upper triangular.
+    bool isUpperTriangular() const { return graph_->isUpperTriangular(); };
+
+    //! Whether matrix indices are locally indexed.
+    bool isLocallyIndexed() const { return graph_->isLocallyIndexed(); };
+
+    //! Whether matrix indices are globally indexed.
+    bool isGloballyIndexed() const {return graph_->isGloballyIndexed(); };
+
+    //! Whether this object implements getLocalRowView() and getGlobalRowView().
+    bool supportsRowViews() const { return true; };
+
+    //! Whether apply() can apply the transpose or conjugate transpose.
+    bool hasTransposeApply() const { return true; };
+
+    //! The Frobenius norm of the matrix, computed from the coefficients and the grid size.
+    mag_type getFrobeniusNorm() const;
+
+    //! The index base for global indices in this matrix.
+    GO getIndexBase() const { return getRowMap()->getIndexBase(); };
+
+    //! The global number of stored (structurally nonzero) entries.
+    global_size_t getGlobalNumEntries() const { return graph_->getGlobalNumEntries(); };
+
+    //! The global number of rows of this matrix.
+    global_size_t getGlobalNumRows() const { return graph_->getGlobalNumRows(); };
+
+    //! The global number of columns of this matrix.
+    global_size_t getGlobalNumCols() const { return graph_->getGlobalNumCols(); };
+
+    //! The number of global diagonal entries, based on global row/column index comparisons.
+    global_size_t getGlobalNumDiags() const { return graph_->getGlobalNumDiags(); };
+
+    //! The local number of stored (structurally nonzero) entries.
+    size_t getNodeNumEntries() const { return graph_->getNodeNumEntries(); };
+
+    //! The number of rows owned by the calling process.
+    size_t getNodeNumRows() const { return graph_->getNodeNumRows(); };
+
+    //! The number of columns needed to apply the forward operator on this node.
+    size_t getNodeNumCols() const { return graph_->getNodeNumCols(); };
+
+    //! The number of local diagonal entries, based on global row/column index comparisons.
+    size_t getNodeNumDiags() const { return graph_->getNodeNumDiags(); };
+
+    //! The Map associated with the domain of this operator, which must be compatible with X.getMap().
+    Teuchos::RCP<const Map<LO,GO,Node> > getDomainMap() const { return graph_->getDomainMap(); };
+
+    //! The Map associated with the range of this operator, which must be compatible with Y.getMap().
+    Teuchos::RCP<const Map<LO,GO,Node> > getRangeMap() const  { return graph_->getRangeMap(); };
+
+    //! The Map that describes the distribution of rows over processes.
+    Teuchos::RCP<const Map<LO,GO,Node> > getRowMap() const { return graph_->getRowMap(); }
+
+    //! The Map that describes the distribution of columns over processes.
+    Teuchos::RCP<const Map<LO,GO,Node> > getColMap() const { return graph_->getColMap(); };
+
+    //! The RowGraph associated with this matrix.
+    Teuchos::RCP<const RowGraph<LO,GO,Node> > getGraph() const { return graph_; };
+
+    //! The communicator over which this matrix is distributed.
+    Teuchos::RCP<const Teuchos::Comm<int> > getComm() const { return graph_->getComm(); };
+
+    //! The Kokkos Node instance.
+    Teuchos::RCP<Node> getNode() const { return graph_->getNode(); };
+
+    //! The maximum number of entries across all rows/columns on all nodes.
+    size_t getGlobalMaxNumRowEntries() const { return graph_->getGlobalMaxNumRowEntries(); };
+
+    //! The maximum number of entries across all rows/columns on this node.
+    size_t getNodeMaxNumRowEntries() const { return graph_->getNodeMaxNumRowEntries(); };
+
+    //! Whether this matrix has a well-defined column map.
+    bool hasColMap() const { return graph_->hasColMap(); };
+  //@}
+
+private:
+  //! Computes Y = alpha*op(A)*X + beta*Y for constant stride Y.
+  void applyConstantStride(const MV& X, MV& Y, Teuchos::ETransp mode, Scalar alpha, Scalar beta) const;
+
+  //! Builds the compressed copy of the local rows returned by getLocalRowView().
+  void fillRowViewCache() const;
+
+  Teuchos::RCP<const Graph> graph_;
+  Teuchos::Array<Scalar> coeffs_;
+
+  //! The compressed local rows, built on the first call to getLocalRowView()
+  mutable Teuchos::ArrayRCP<size_t> viewRowPtrs_;
+  mutable Teuchos::ArrayRCP<LO> viewInds_;
+  mutable Teuchos::ArrayRCP<Scalar> viewVals_;
+};
+
+
+
+//! Constructor
+//==============================================================================
+template<class Shape, class Scalar, class LO, class GO, class Node>
+StencilRowMatrix<Shape,Scalar,LO,GO,Node>::StencilRowMatrix(const Teuchos::RCP<const Comm>& comm, GO nx, GO ny, GO nz,
+                                                            const Teuchos::ArrayView<const Scalar>& coefficients)
+{
+  graph_ = Teuchos::rcp(new Graph(comm, nx, ny, nz));
+  setCoefficients(coefficients);
+}
+
+
+
+//! Replace the coefficients of the stencil points.
+//==============================================================================
+template<class Shape, class Scalar, class LO, class GO, class Node>
+void StencilRowMatrix<Shape,Scalar,LO,GO,Node>::setCoefficients(const Teuchos::ArrayView<const Scalar>& coefficients)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(coefficients.size() != Shape::numPoints, std::invalid_argument,
+         Teuchos::typeName (*this) << "::setCoefficients(): Expected " << Shape::numPoints
+         << " coefficients, got " << coefficients.size() << ".");
+  coeffs_.assign(coefficients.begin(), coefficients.end());
+  viewRowPtrs_ = Teuchos::null;
+  viewInds_ = Teuchos::null;
+  viewVals_ = Teuchos::null;
+}
+
+
+
+//! Get a copy of the given local row's entries.
+//==============================================================================
+template<class Shape, class Scalar, class LO, class GO, class Node>
+void StencilRowMatrix<Shape,Scalar,LO,GO,Node>::getLocalRowCopy(LO LocalRow, const Teuchos::ArrayView<LO> & Indices, const Teuchos::ArrayView<Scalar> & Values, size_t & NumEntries) const
+{
+  graph_->getLocalRowCopy(LocalRow, Indices, NumEntries);
+  TEUCHOS_TEST_FOR_EXCEPTION(static_cast<size_t>(Values.size()) < NumEntries, std::runtime_error,
+         Teuchos::typeName (*this) << "::getLocalRowCopy(): The array of values is too small for row " << LocalRow << ".");
+
+  bool exists[Shape::numPoints];
+  graph_->getRowPoints(graph_->getGrid().firstRow + LocalRow, exists);
+  size_t pos = 0;
+  for(int p = 0; p < Shape::numPoints; p++) {
+    if(exists[p]) Values[pos++] = coeffs_[p];
+  }
+}
+
+
+
+//! Get a copy of the given global row's entries.
+//==============================================================================
+template<class Shape, class Scalar, class LO, class GO, class Node>
+void StencilRowMatrix<Shape,Scalar,LO,GO,Node>::getGlobalRowCopy(GO GlobalRow, const Teuchos::ArrayView<GO> & Indices, const Teuchos::ArrayView<Scalar> & Values, size_t & NumEntries) const
+{
+  graph_->getGlobalRowCopy(GlobalRow, Indices, NumEntries);
+  TEUCHOS_TEST_FOR_EXCEPTION(static_cast<size_t>(Values.size()) < NumEntries, std::runtime_error,
+         Teuchos::typeName (*this) << "::getGlobalRowCopy(): The array of values is too small for row " << GlobalRow << ".");
+
+  bool exists[Shape::numPoints];
+  graph_->getRowPoints(GlobalRow, exists);
+  size_t pos = 0;
+  for(int p = 0; p < Shape::numPoints; p++) {
+    if(exists[p]) Values[pos++] = coeffs_[p];
+  }
+}
+
+
+
+//! The matrix is locally indexed, so there are no global row views.
+//==============================================================================
+template<class Shape, class Scalar, class LO, class GO, class Node>
+void StencilRowMatrix<Shape,Scalar,LO,GO,Node>::getGlobalRowView(GO GlobalRow, Teuchos::ArrayView<const GO> & indices, Teuchos::ArrayView<const Scalar> & values) const
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(true, std::runtime_error,
+         Teuchos::typeName (*this) << "::getGlobalRowView(): The matrix is locally indexed; use getLocalRowView() or getGlobalRowCopy().");
+}
+
+
+
+//! Builds the compressed copy of the local rows returned by getLocalRowView().
+//==============================================================================
+template<class Shape, class Scalar, class LO, class GO, class Node>
+void StencilRowMatrix<Shape,Scalar,LO,GO,Node>::fillRowViewCache() const
+{
+  const size_t numRows = getNodeNumRows();
+  Teuchos::ArrayRCP<size_t> rowPtrs(numRows+1);
+  Teuchos::ArrayRCP<LO> inds(getNodeNumEntries());
+  Teuchos::ArrayRCP<Scalar> vals(getNodeNumEntries());
+
+  size_t pos = 0, numEntries;
+  for(size_t r = 0; r < numRows; r++) {
+    rowPtrs[r] = pos;
+    getLocalRowCopy(r, inds.view(pos, inds.size()-pos), vals.view(pos, vals.size()-pos), numEntries);
+    pos += numEntries;
+  }
+  rowPtrs[numRows] = pos;
+
+  viewRowPtrs_ = rowPtrs;
+  viewInds_ = inds;
+  viewVals_ = vals;
+}
+
+
+
+//! Get a constant, nonpersisting, locally indexed view of the given row.
+//==============================================================================
+template<class Shape, class Scalar, class LO, class GO, class Node>
+void StencilRowMatrix<Shape,Scalar,LO,GO,Node>::getLocalRowView(LO LocalRow, Teuchos::ArrayView<const LO> & indices, Teuchos::ArrayView<const Scalar> & values) const
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(LocalRow < 0 || static_cast<size_t>(LocalRow) >= getNodeNumRows(), std::invalid_argument,
+         Teuchos::typeName (*this) << "::getLocalRowView(): Row " << LocalRow << " is not a local row.");
+  if(viewRowPtrs_.is_null())
+    fillRowViewCache();
+
+  const size_t start = viewRowPtrs_[LocalRow];
+  const size_t numEntries = viewRowPtrs_[LocalRow+1] - start;
+  indices = viewInds_.view(start, numEntries);
+  values = viewVals_.view(start, numEntries);
+}
+
+
+
+//! Get a copy of the diagonal entries, distributed by the row Map.
+//==============================================================================
+template<class Shape, class Scalar, class LO, class GO, class Node>
+void StencilRowMatrix<Shape,Scalar,LO,GO,Node>::getLocalDiagCopy(Vector<Scalar,LO,GO,Node> & diag) const
+{
+  Scalar center = Teuchos::ScalarTraits<Scalar>::zero();
+  for(int p = 0; p < Shape::numPoints; p++) {
+    if(Shape::offset(p,0) == 0 && Shape::offset(p,1) == 0 && Shape::offset(p,2) == 0)
+      center += coeffs_[p];
+  }
+  diag.putScalar(center);
+}
+
+
+
+//! Computes Y = alpha*op(A)*X + beta*Y.
+//==============================================================================
+template<class Shape, class Scalar, class LO, class GO, class Node>
+void StencilRowMatrix<Shape,Scalar,LO,GO,Node>::apply(const MV & X, MV & Y, Teuchos::ETransp mode, Scalar alpha, Scalar beta) const
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(X.getNumVectors() != Y.getNumVectors(), std::invalid_argument,
+         Teuchos::typeName (*this) << "::apply(X,Y): X and Y must have the same number of vectors.");
+
+  if(!Y.isConstantStride()) {
+    MV Ycopy(Y, Teuchos::Copy);
+    applyConstantStride(X, Ycopy, mode, alpha, beta);
+    Tpetra::deep_copy(Y, Ycopy);
+  }
+  else {
+    applyConstantStride(X, Y, mode, alpha, beta);
+  }
+}
+
+
+
+//! Computes Y = alpha*op(A)*X + beta*Y for constant stride Y.
+//==============================================================================
+template<class Shape, class Scalar, class LO, class GO, class Node>
+void StencilRowMatrix<Shape,Scalar,LO,GO,Node>::applyConstantStride(const MV& X, MV& Y, Teuchos::ETransp mode, Scalar alpha, Scalar beta) const
+{
+  typedef typename MV::dual_view_type::t_dev view_type;
+  typedef Details::StencilGrid<LO,GO> grid_type;
+  typedef typename device_type::execution_space execution_space;
+
+  const size_t numVecs = X.getNumVectors();
+  const LO numRows = getNodeNumRows();
+
+  // Bring the ghost rows of X into the column Map.  This also gives the kernel a copy
+  // of X when it is not constant stride or when it aliases Y.
+  Teuchos::RCP<const MV> Xcol = Teuchos::rcpFromRef(X);
+  if(!graph_->getImporter().is_null()) {
+    Teuchos::RCP<MV> Ximported = Teuchos::rcp(new MV(getColMap(), numVecs, false));
+    Ximported->doImport(X, *graph_->getImporter(), INSERT);
+    Xcol = Ximported;
+  }
+  else {
+    const_cast<MV&>(X).template sync<device_type>();
+    Y.template sync<device_type>();
+    if(!X.isConstantStride() ||
+       X.template getLocalView<device_type>().ptr_on_device() == Y.template getLocalView<device_type>().ptr_on_device())
+      Xcol = Teuchos::rcp(new MV(X, Teuchos::Copy));
+  }
+
+  const_cast<MV&>(*Xcol).template sync<device_type>();
+  Y.template sync<device_type>();
+  Y.template modify<device_type>();
+  view_type x = Xcol->template getLocalView<device_type>();
+  view_type y = Y.template getLocalView<device_type>();
+
+  Details::StencilCoefficients<impl_scalar_type, Shape::numPoints> c;
+  for(int p = 0; p < Shape::numPoints; p++) {
+    c.c[p] = (mode == Teuchos::CONJ_TRANS ? Teuchos::ScalarTraits<Scalar>::conjugate(coeffs_[p]) : coeffs_[p]);
+  }
+
+  Kokkos::RangePolicy<execution_space, LO> policy(0, numRows*numVecs);
+  if(mode == Teuchos::NO_TRANS) {
+    Details::StencilApplyFunctor<Shape, grid_type, view_type, view_type, false> functor;
+    functor.grid = graph_->getGrid();
+    functor.x = x;
+    functor.y = y;
+    functor.c = c;
+    functor.alpha = alpha;
+    functor.beta = beta;
+    functor.numRows = numRows;
+    Kokkos::parallel_for(policy, functor);
+  }
+  else {
+    Details::StencilApplyFunctor<Shape, grid_type, view_type, view_type, true> functor;
+    functor.grid = graph_->getGrid();
+    functor.x = x;
+    functor.y = y;
+    functor.c = c;
+    functor.alpha = alpha;
+    functor.beta = beta;
+    functor.numRows = numRows;
+    Kokkos::parallel_for(policy, functor);
+  }
+}
+
+
+
+//! The coefficients are the same in every row, so the matrix cannot be scaled row by row.
+//==============================================================================
+template<class Shape, class Scalar, class LO, class GO, class Node>
+void StencilRowMatrix<Shape,Scalar,LO,GO,Node>::leftScale(const Vector<Scalar,LO,GO,Node> & x)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(true, std::runtime_error,
+         Teuchos::typeName (*this) << "::leftScale(): A constant-coefficient stencil cannot be scaled row by row.");
+}
+
+
+
+//! The coefficients are the same in every column, so the matrix cannot be scaled column by column.
+//==============================================================================
+template<class Shape, class Scalar, class LO, class GO, class Node>
+void StencilRowMatrix<Shape,Scalar,LO,GO,Node>::rightScale(const Vector<Scalar,LO,GO,Node> & x)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(true, std::runtime_error,
+         Teuchos::typeName (*this) << "::rightScale(): A constant-coefficient stencil cannot be scaled column by column.");
+}
+
+
+
+//! The Frobenius norm of the matrix, computed from the coefficients and the grid size.
+//==============================================================================
+template<class Shape, class Scalar, class LO, class GO, class Node>
+typename StencilRowMatrix<Shape,Scalar,LO,GO,Node>::mag_type StencilRowMatrix<Shape,Scalar,LO,GO,Node>::getFrobeniusNorm() const
+{
+  typedef Teuchos::ScalarTraits<Scalar> STS;
+
+  // Point p appears in (dims[d] - |offset|) places along each direction
+  const Details::StencilGrid<LO,GO>& grid = graph_->getGrid();
+  const GO dims[3] = {grid.nx, grid.ny, grid.nz};
+  mag_type sum = Teuchos::ScalarTraits<mag_type>::zero();
+  for(int p = 0; p < Shape::numPoints; p++) {
+    mag_type count = 1;
+    for(int d = 0; d < 3; d++)
+      count *= std::max<GO>(dims[d] - std::abs(Shape::offset(p,d)), 0);
+    const mag_type absc = STS::magnitude(coeffs_[p]);
+    sum += count*absc*absc;
+  }
+  return Teuchos::ScalarTraits<mag_type>::squareroot(sum);
+}
+
+} // namespace Tpetra
+
+#endif // _TPETRA_STENCILROWMATRIX_H_
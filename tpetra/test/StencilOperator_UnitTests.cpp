@@ -0,0 +1,424 @@
+// @HEADER
+// ***********************************************************************
+//
+//       xSDKTrilinos: Extreme-scale Software Development Kit Package
+//                 Copyright (2016) Sandia Corporation
+//
+// Under terms of Contract DE-AC04-94AL85000 with Sandia Corporation,
+// the U.S. Government retains certain rights in this software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact Alicia Klinvex    (amklinv@sandia.gov)
+//                    James Willenbring (jmwille@sandia.gov)
+//                    Michael Heroux    (maherou@sandia.gov)         
+//
+// ***********************************************************************
+// @HEADER
+
+#include <Teuchos_CommHelpers.hpp>
+#include "Teuchos_UnitTestHarness.hpp"
+
+#include <Tpetra_ConfigDefs.hpp>
+#include <Tpetra_MixedPrecisionOperator.hpp>
+#include <Tpetra_StencilOperator.hpp>
+#include <Tpetra_StencilRowMatrix.hpp>
+#include <Tpetra_CrsMatrix.hpp>
+#include <Tpetra_MultiVector.hpp>
+#include "Tpetra_DefaultPlatform.hpp"
+#include "Tpetra_ETIHelperMacros.h"
+#include "Ifpack2_Relaxation.hpp"
+
+namespace {
+
+  using Teuchos::RCP;
+  using Teuchos::rcp;
+  using Teuchos::Comm;
+  using Teuchos::Array;
+  using Teuchos::ArrayView;
+  using Teuchos::ScalarTraits;
+  using Teuchos::tuple;
+
+  using Tpetra::Map;
+  using Tpetra::MultiVector;
+  using Tpetra::CrsMatrix;
+  using Tpetra::MixedPrecisionOperator;
+  using Tpetra::StencilOperator;
+  using Tpetra::StencilRowMatrix;
+
+  //
+  // Assembles the matrix of a stencil operator, one row at a time
+  //
+  template<class Scalar, class LO, class GO, class Node>
+  RCP<CrsMatrix<Scalar,LO,GO,Node> >
+  assembleStencil(const StencilOperator<Scalar,LO,GO,Node>& op)
+  {
+    const GO nx = op.getGridSize(0), ny = op.getGridSize(1), nz = op.getGridSize(2);
+    RCP<const Map<LO,GO,Node> > map = op.getRangeMap();
+    RCP<CrsMatrix<Scalar,LO,GO,Node> > A = rcp(new CrsMatrix<Scalar,LO,GO,Node>(map, 7));
+    ArrayView<const GO> myGIDs = map->getNodeElementList();
+    for(size_t r = 0; r < map->getNodeNumElements(); r++) {
+      const GO row = myGIDs[r];
+      const GO i = row % nx, j = (row / nx) % ny, k = row / (nx*ny);
+      Array<GO> cols(1, row);
+      Array<Scalar> vals(1, op.getCenterCoefficient());
+      if(i > 0)    { cols.push_back(row-1);     vals.push_back(op.getNeighborCoefficient(0)); }
+      if(i < nx-1) { cols.push_back(row+1);     vals.push_back(op.getNeighborCoefficient(0)); }
+      if(j > 0)    { cols.push_back(row-nx);    vals.push_back(op.getNeighborCoefficient(1)); }
+      if(j < ny-1) { cols.push_back(row+nx);    vals.push_back(op.getNeighborCoefficient(1)); }
+      if(k > 0)    { cols.push_back(row-nx*ny); vals.push_back(op.getNeighborCoefficient(2)); }
+      if(k < nz-1) { cols.push_back(row+nx*ny); vals.push_back(op.getNeighborCoefficient(2)); }
+      A->insertGlobalValues(row, cols(), vals());
+    }
+    A->fillComplete();
+    return A;
+  }
+
+  //
+  // Compares alpha*A*X + beta*Y for the stencil and its assembled matrix
+  //
+  template<class Scalar, class LO, class GO, class Node>
+  void compareWithAssembled(const StencilOperator<Scalar,LO,GO,Node>& op, size_t numVecs,
+                            Scalar alpha, Scalar beta, Teuchos::FancyOStream& out, bool& success)
+  {
+    typedef MultiVector<Scalar,LO,GO,Node> MV;
+    typedef typename ScalarTraits<Scalar>::magnitudeType Mag;
+
+    RCP<CrsMatrix<Scalar,LO,GO,Node> > A = assembleStencil(op);
+    MV X(op.getDomainMap(), numVecs), Y(op.getRangeMap(), numVecs);
+    X.randomize();
+    Y.randomize();
+    MV Yref(Y, Teuchos::Copy);
+
+    op.apply(X, Y, Teuchos::NO_TRANS, alpha, beta);
+    A->apply(X, Yref, Teuchos::NO_TRANS, alpha, beta);
+
+    Array<Mag> norms(numVecs), refNorms(numVecs);
+    Yref.norm2(refNorms());
+    Yref.update(-ScalarTraits<Scalar>::one(), Y, ScalarTraits<Scalar>::one());
+    Yref.norm2(norms());
+    for(size_t v = 0; v < numVecs; v++) {
+      TEST_COMPARE(norms[v], <=, 100*ScalarTraits<Scalar>::eps()*refNorms[v]);
+    }
+  }
+
+  //
+  // Assembles a RowMatrix through its global row copies
+  //
+  template<class Scalar, class LO, class GO, class Node>
+  RCP<CrsMatrix<Scalar,LO,GO,Node> >
+  assembleRowMatrix(const Tpetra::RowMatrix<Scalar,LO,GO,Node>& op)
+  {
+    RCP<const Map<LO,GO,Node> > map = op.getRowMap();
+    RCP<CrsMatrix<Scalar,LO,GO,Node> > A = rcp(new CrsMatrix<Scalar,LO,GO,Node>(map, op.getNodeMaxNumRowEntries()));
+    ArrayView<const GO> myGIDs = map->getNodeElementList();
+    Array<GO> cols(op.getNodeMaxNumRowEntries());
+    Array<Scalar> vals(op.getNodeMaxNumRowEntries());
+    for(size_t r = 0; r < map->getNodeNumElements(); r++) {
+      size_t numEntries;
+      op.getGlobalRowCopy(myGIDs[r], cols(), vals(), numEntries);
+      A->insertGlobalValues(myGIDs[r], cols(0,numEntries), vals(0,numEntries));
+    }
+    A->fillComplete();
+    return A;
+  }
+
+  //
+  // Compares alpha*op(A)*X + beta*Y for a RowMatrix and its assembled copy
+  //
+  template<class Scalar, class LO, class GO, class Node>
+  void compareRowMatrixApply(const Tpetra::RowMatrix<Scalar,LO,GO,Node>& op, const CrsMatrix<Scalar,LO,GO,Node>& A,
+                             size_t numVecs, Teuchos::ETransp mode, Scalar alpha, Scalar beta,
+                             Teuchos::FancyOStream& out, bool& success)
+  {
+    typedef MultiVector<Scalar,LO,GO,Node> MV;
+    typedef typename ScalarTraits<Scalar>::magnitudeType Mag;
+
+    MV X(op.getDomainMap(), numVecs), Y(op.getRangeMap(), numVecs);
+    X.randomize();
+    Y.randomize();
+    MV Yref(Y, Teuchos::Copy);
+
+    op.apply(X, Y, mode, alpha, beta);
+    A.apply(X, Yref, mode, alpha, beta);
+
+    Array<Mag> norms(numVecs), refNorms(numVecs);
+    Yref.norm2(refNorms());
+    Yref.update(-ScalarTraits<Scalar>::one(), Y, ScalarTraits<Scalar>::one());
+    Yref.norm2(norms());
+    for(size_t v = 0; v < numVecs; v++) {
+      TEST_COMPARE(norms[v], <=, 100*ScalarTraits<Scalar>::eps()*refNorms[v]);
+    }
+  }
+
+
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_3_DECL( StencilOperator, Laplace2D, LO, GO, Node )
+  {
+    typedef double Scalar;
+    RCP<const Comm<int> > comm = Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+    const int numProcs = comm->getSize();
+
+    // Also covers processes with no planes when ny < numProcs
+    Array<GO> nys = tuple<GO>(1, 2*numProcs+1, numProcs > 1 ? numProcs-1 : 1);
+    for(int t = 0; t < nys.size(); t++) {
+      StencilOperator<Scalar,LO,GO,Node> op(comm, 7, nys[t]);
+      TEST_EQUALITY_CONST( op.is3D(), false );
+      TEST_EQUALITY( op.getRangeMap()->getGlobalNumElements(), static_cast<Tpetra::global_size_t>(7*nys[t]) );
+      compareWithAssembled<Scalar,LO,GO,Node>(op, 1, 1.0, 0.0, out, success);
+      compareWithAssembled<Scalar,LO,GO,Node>(op, 3, 2.0, -0.5, out, success);
+    }
+  }
+
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_3_DECL( StencilOperator, Laplace3D, LO, GO, Node )
+  {
+    typedef double Scalar;
+    RCP<const Comm<int> > comm = Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+    const int numProcs = comm->getSize();
+
+    StencilOperator<Scalar,LO,GO,Node> op(comm, 5, 4, 2*numProcs+1);
+    TEST_EQUALITY_CONST( op.is3D(), true );
+    TEST_EQUALITY( op.getPlaneSize(), static_cast<size_t>(20) );
+    compareWithAssembled<Scalar,LO,GO,Node>(op, 1, 1.0, 0.0, out, success);
+    compareWithAssembled<Scalar,LO,GO,Node>(op, 4, -1.0, 3.0, out, success);
+
+    // The same operator with other coefficients, applied twice to reuse the halo buffers
+    op.setCoefficients(10.0, -1.0, -2.0, -3.0);
+    compareWithAssembled<Scalar,LO,GO,Node>(op, 4, 1.0, 1.0, out, success);
+    compareWithAssembled<Scalar,LO,GO,Node>(op, 2, 0.5, 0.0, out, success);
+  }
+
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_3_DECL( StencilOperator, NonConstantStride, LO, GO, Node )
+  {
+    typedef double Scalar;
+    typedef MultiVector<Scalar,LO,GO,Node> MV;
+    typedef ScalarTraits<Scalar>::magnitudeType Mag;
+    RCP<const Comm<int> > comm = Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+
+    StencilOperator<Scalar,LO,GO,Node> op(comm, 4, 3, 2*comm->getSize());
+    MV X(op.getDomainMap(), 3), Y(op.getRangeMap(), 3), Yref(op.getRangeMap(), 2);
+    X.randomize();
+    Y.putScalar(1.0);
+    Yref.putScalar(1.0);
+
+    Array<size_t> cols = tuple<size_t>(0, 2);
+    RCP<const MV> Xsub = X.subView(cols());
+    RCP<MV> Ysub = Y.subViewNonConst(cols());
+    TEST_EQUALITY_CONST( Xsub->isConstantStride(), false );
+
+    op.apply(*Xsub, *Ysub, Teuchos::NO_TRANS, 1.0, 1.0);
+    MV Xcopy(*Xsub, Teuchos::Copy);
+    op.apply(Xcopy, Yref, Teuchos::NO_TRANS, 1.0, 1.0);
+
+    Array<Mag> norms(2);
+    Yref.update(-1.0, *Ysub, 1.0);
+    Yref.norm2(norms());
+    TEST_COMPARE(norms[0], <=, 100*ScalarTraits<Scalar>::eps());
+    TEST_COMPARE(norms[1], <=, 100*ScalarTraits<Scalar>::eps());
+
+    // The column that was not part of the view is untouched
+    Array<Mag> middle(1);
+    Y.getVector(1)->norm2(middle());
+    TEST_EQUALITY( middle[0], std::sqrt(static_cast<Mag>(Y.getGlobalLength())) );
+  }
+
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_3_DECL( StencilRowMatrix, RowQueries, LO, GO, Node )
+  {
+    typedef double Scalar;
+    typedef StencilRowMatrix<Tpetra::NinePointStencil,Scalar,LO,GO,Node> StencilMatrix;
+    RCP<const Comm<int> > comm = Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+
+    // A nonsymmetric 9-point stencil, on more lines than processes
+    Array<Scalar> coeffs = tuple<Scalar>(8.0, -1.0, -2.0, -3.0, -4.0, -0.5, -0.25, -0.125, -0.0625);
+    StencilMatrix op(comm, 6, 3*comm->getSize()+1, 1, coeffs());
+    RCP<CrsMatrix<Scalar,LO,GO,Node> > A = assembleRowMatrix(op);
+
+    TEST_EQUALITY( op.getGlobalNumEntries(), A->getGlobalNumEntries() );
+    TEST_EQUALITY( op.getNodeNumEntries(), A->getNodeNumEntries() );
+    TEST_EQUALITY( op.getGlobalMaxNumRowEntries(), A->getGlobalMaxNumRowEntries() );
+    TEST_EQUALITY( op.getGlobalNumDiags(), A->getGlobalNumDiags() );
+    TEST_EQUALITY_CONST( op.isLowerTriangular(), false );
+    TEST_EQUALITY_CONST( op.isUpperTriangular(), false );
+    TEST_FLOATING_EQUALITY( op.getFrobeniusNorm(), A->getFrobeniusNorm(), 100*ScalarTraits<Scalar>::eps() );
+
+    // The local row copies and views agree with the global ones through the column Map
+    ArrayView<const GO> myGIDs = op.getRowMap()->getNodeElementList();
+    RCP<const Map<LO,GO,Node> > colMap = op.getColMap();
+    Array<LO> localCols(9);
+    Array<GO> globalCols(9);
+    Array<Scalar> localVals(9), globalVals(9);
+    for(size_t r = 0; r < op.getNodeNumRows(); r++) {
+      size_t numLocal, numGlobal;
+      ArrayView<const LO> viewCols;
+      ArrayView<const Scalar> viewVals;
+      op.getLocalRowCopy(r, localCols(), localVals(), numLocal);
+      op.getGlobalRowCopy(myGIDs[r], globalCols(), globalVals(), numGlobal);
+      op.getLocalRowView(r, viewCols, viewVals);
+      TEST_EQUALITY( numLocal, numGlobal );
+      TEST_EQUALITY( numLocal, op.getNumEntriesInLocalRow(r) );
+      TEST_EQUALITY( static_cast<size_t>(viewCols.size()), numLocal );
+      for(size_t e = 0; e < numLocal; e++) {
+        TEST_EQUALITY( colMap->getGlobalElement(localCols[e]), globalCols[e] );
+        TEST_EQUALITY( viewCols[e], localCols[e] );
+        TEST_EQUALITY( localVals[e], globalVals[e] );
+        TEST_EQUALITY( viewVals[e], localVals[e] );
+      }
+    }
+
+    Tpetra::Vector<Scalar,LO,GO,Node> diag(op.getRowMap()), refDiag(op.getRowMap());
+    op.getLocalDiagCopy(diag);
+    A->getLocalDiagCopy(refDiag);
+    refDiag.update(-1.0, diag, 1.0);
+    TEST_EQUALITY_CONST( refDiag.normInf(), 0.0 );
+
+    TEST_THROW( op.leftScale(diag), std::runtime_error );
+  }
+
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_3_DECL( StencilRowMatrix, Apply, LO, GO, Node )
+  {
+    typedef double Scalar;
+    RCP<const Comm<int> > comm = Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+    const int numProcs = comm->getSize();
+
+    Array<Scalar> coeffs2D = tuple<Scalar>(8.0, -1.0, -2.0, -3.0, -4.0, -0.5, -0.25, -0.125, -0.0625);
+    StencilRowMatrix<Tpetra::NinePointStencil,Scalar,LO,GO,Node> op2D(comm, 5, 2*numProcs+1, 1, coeffs2D());
+    RCP<CrsMatrix<Scalar,LO,GO,Node> > A2D = assembleRowMatrix(op2D);
+    compareRowMatrixApply<Scalar,LO,GO,Node>(op2D, *A2D, 1, Teuchos::NO_TRANS, 1.0, 0.0, out, success);
+    compareRowMatrixApply<Scalar,LO,GO,Node>(op2D, *A2D, 3, Teuchos::NO_TRANS, 2.0, -1.0, out, success);
+    compareRowMatrixApply<Scalar,LO,GO,Node>(op2D, *A2D, 3, Teuchos::TRANS, 0.5, 1.0, out, success);
+
+    Array<Scalar> coeffs3D = tuple<Scalar>(6.0, -1.0, -1.5, -1.0, -0.5, -2.0, -0.25);
+    StencilRowMatrix<Tpetra::SevenPointStencil,Scalar,LO,GO,Node> op3D(comm, 4, 3, numProcs+2, coeffs3D());
+    RCP<CrsMatrix<Scalar,LO,GO,Node> > A3D = assembleRowMatrix(op3D);
+    compareRowMatrixApply<Scalar,LO,GO,Node>(op3D, *A3D, 2, Teuchos::NO_TRANS, 1.0, 0.0, out, success);
+    compareRowMatrixApply<Scalar,LO,GO,Node>(op3D, *A3D, 2, Teuchos::TRANS, -1.0, 2.0, out, success);
+  }
+
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_3_DECL( StencilRowMatrix, Ifpack2Relaxation, LO, GO, Node )
+  {
+    typedef double Scalar;
+    typedef MultiVector<Scalar,LO,GO,Node> MV;
+    typedef Tpetra::RowMatrix<Scalar,LO,GO,Node> RowMatrix;
+    typedef ScalarTraits<Scalar>::magnitudeType Mag;
+    RCP<const Comm<int> > comm = Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+
+    Array<Scalar> coeffs = tuple<Scalar>(4.0, -1.0, -1.0, -1.0, -1.0);
+    RCP<StencilRowMatrix<Tpetra::FivePointStencil,Scalar,LO,GO,Node> > op =
+        rcp(new StencilRowMatrix<Tpetra::FivePointStencil,Scalar,LO,GO,Node>(comm, 8, 2*comm->getSize()+2, 1, coeffs()));
+    RCP<CrsMatrix<Scalar,LO,GO,Node> > A = assembleRowMatrix(*op);
+
+    // Ifpack2 runs on the matrix-free operator and gives the same result as on the assembled one
+    Teuchos::ParameterList params;
+    params.set("relaxation: type", "Jacobi");
+    params.set("relaxation: sweeps", 3);
+    Ifpack2::Relaxation<RowMatrix> prec(Teuchos::rcp_implicit_cast<const RowMatrix>(op));
+    Ifpack2::Relaxation<RowMatrix> refPrec(Teuchos::rcp_implicit_cast<const RowMatrix>(A));
+    prec.setParameters(params);
+    refPrec.setParameters(params);
+    prec.initialize();
+    prec.compute();
+    refPrec.initialize();
+    refPrec.compute();
+
+    MV B(op->getRangeMap(), 2), X(op->getDomainMap(), 2), Xref(op->getDomainMap(), 2);
+    B.randomize();
+    prec.apply(B, X);
+    refPrec.apply(B, Xref);
+
+    Array<Mag> norms(2), refNorms(2);
+    Xref.norm2(refNorms());
+    Xref.update(-1.0, X, 1.0);
+    Xref.norm2(norms());
+    TEST_COMPARE(norms[0], <=, 100*ScalarTraits<Scalar>::eps()*refNorms[0]);
+    TEST_COMPARE(norms[1], <=, 100*ScalarTraits<Scalar>::eps()*refNorms[1]);
+  }
+
+#ifdef HAVE_TPETRA_INST_FLOAT
+  ////
+  TEUCHOS_UNIT_TEST_TEMPLATE_3_DECL( MixedPrecisionOperator, FloatStencil, LO, GO, Node )
+  {
+    typedef MultiVector<double,LO,GO,Node> MV;
+    RCP<const Comm<int> > comm = Tpetra::DefaultPlatform::getDefaultPlatform ().getComm ();
+
+    // A single precision operator applied to double precision vectors agrees to single precision
+    RCP<StencilOperator<float,LO,GO,Node> > lowOp = rcp(new StencilOperator<float,LO,GO,Node>(comm, 6, 5, 2*comm->getSize()));
+    StencilOperator<double,LO,GO,Node> op(comm, 6, 5, 2*comm->getSize());
+    MixedPrecisionOperator<double,float,LO,GO,Node> mixedOp(lowOp);
+    TEST_EQUALITY_CONST( mixedOp.hasTransposeApply(), true );
+
+    const double alphas[2] = {1.0, 2.0}, betas[2] = {0.0, -0.5};
+    for(int t = 0; t < 2; t++) {
+      MV X(op.getDomainMap(), 3), Y(op.getRangeMap(), 3);
+      X.randomize();
+      Y.randomize();
+      MV Yref(Y, Teuchos::Copy);
+
+      mixedOp.apply(X, Y, Teuchos::NO_TRANS, alphas[t], betas[t]);
+      op.apply(X, Yref, Teuchos::NO_TRANS, alphas[t], betas[t]);
+
+      Array<double> norms(3), refNorms(3);
+      Yref.norm2(refNorms());
+      Yref.update(-1.0, Y, 1.0);
+      Yref.norm2(norms());
+      for(size_t v = 0; v < 3; v++) {
+        TEST_COMPARE(norms[v], <=, 100*ScalarTraits<float>::eps()*refNorms[v]);
+        TEST_COMPARE(norms[v], >, 0.0);
+      }
+    }
+  }
+
+#define MIXED_PRECISION_TEST_GROUP( LO, GO, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_3_INSTANT( MixedPrecisionOperator, FloatStencil, LO, GO, NODE )
+#else
+#define MIXED_PRECISION_TEST_GROUP( LO, GO, NODE )
+#endif // HAVE_TPETRA_INST_FLOAT
+
+//
+// INSTANTIATIONS
+//
+
+#define UNIT_TEST_GROUP( LO, GO, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_3_INSTANT( StencilOperator, Laplace2D,         LO, GO, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_3_INSTANT( StencilOperator, Laplace3D,         LO, GO, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_3_INSTANT( StencilOperator, NonConstantStride, LO, GO, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_3_INSTANT( StencilRowMatrix, RowQueries,       LO, GO, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_3_INSTANT( StencilRowMatrix, Apply,            LO, GO, NODE ) \
+      TEUCHOS_UNIT_TEST_TEMPLATE_3_INSTANT( StencilRowMatrix, Ifpack2Relaxation, LO, GO, NODE ) \
+      MIXED_PRECISION_TEST_GROUP( LO, GO, NODE )
+
+
+  TPETRA_ETI_MANGLING_TYPEDEFS()
+
+  TPETRA_INSTANTIATE_LGN( UNIT_TEST_GROUP )
+
+}